@@ -0,0 +1,43 @@
+#include "buffer/background_flusher.h"
+
+#include "buffer/buffer_pool_manager.h"
+
+BackgroundFlusher::BackgroundFlusher(BufferPoolManager *bpm, chrono::milliseconds interval, size_t pages_per_round,
+                                     size_t checkpoint_rounds)
+    : bpm_(bpm), interval_(interval), pages_per_round_(pages_per_round), checkpoint_rounds_(checkpoint_rounds) {}
+
+BackgroundFlusher::~BackgroundFlusher() { Stop(); }
+
+void BackgroundFlusher::Start() {
+  if (thread_.joinable())
+    return;
+  stop_ = false;
+  thread_ = thread(&BackgroundFlusher::Run, this);
+}
+
+void BackgroundFlusher::Stop() {
+  if (!thread_.joinable())
+    return;
+  {
+    lock_guard<mutex> lock(latch_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  thread_.join();
+}
+
+//每隔interval_写回一批脏页，每隔checkpoint_rounds_轮做一次检查点
+void BackgroundFlusher::Run() {
+  size_t round = 0;
+  unique_lock<mutex> lock(latch_);
+  while (!cv_.wait_for(lock, interval_, [this] { return stop_; })) {
+    lock.unlock();
+    round++;
+    if (checkpoint_rounds_ != 0 && round % checkpoint_rounds_ == 0) {
+      bpm_->Checkpoint();
+    } else {
+      bpm_->FlushDirtyPages(pages_per_round_);
+    }
+    lock.lock();
+  }
+}
@@ -1,5 +1,7 @@
 #include "buffer/buffer_pool_manager.h"
 
+#include <cstring>
+
 #include "glog/logging.h"
 #include "page/bitmap_page.h"
 
@@ -10,11 +12,22 @@
 static const char EMPTY_PAGE_DATA[PAGE_SIZE] = {0};
 
 //默认构造函数：初始化Buffer Pool Manager
-BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager)
+BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, ReplacerType replacer_type)
     : pool_size_(pool_size), disk_manager_(disk_manager) {
-  //初始化页面数组和LRU替换器
+  //初始化页面数组和指定类型的替换器
   pages_ = new Page[pool_size_];
-  replacer_ = new LRUReplacer(pool_size_);
+  prefetched_.assign(pool_size_, false);
+  switch (replacer_type) {
+    case ReplacerType::CLOCK:
+      replacer_ = new CLOCKReplacer(pool_size_);
+      break;
+    case ReplacerType::LRU_K:
+      replacer_ = new LRUKReplacer(pool_size_);
+      break;
+    default:
+      replacer_ = new LRUReplacer(pool_size_);
+      break;
+  }
 
   //初始化空闲列表
   for (size_t i = 0; i < pool_size_; i++) {
@@ -22,14 +35,20 @@ BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager
   }
 }
 
+//不持有页帧的缓冲池（如ParallelBufferPoolManager），只负责把请求分发给各个实例
+BufferPoolManager::BufferPoolManager(DiskManager *disk_manager)
+    : pool_size_(0), pages_(nullptr), disk_manager_(disk_manager), replacer_(nullptr) {}
+
 //默认析构函数：销毁Buffer Pool Manager
 BufferPoolManager::~BufferPoolManager() {
-  //遍历页面表，将所有页面刷新至磁盘
-  for (auto &page : page_table_) {
-    FlushPage(page.first);
-  }
-
-  // 释放页面数组和LRU替换器
+  //先停止预读和后台写线程，再将剩余的脏页写回磁盘，干净的页面无需写回
+  //写回的数据在DiskManager::Close时同步到磁盘
+  StopPrefetcher();
+  StopBackgroundFlusher();
+  FlushAllDirtyPages();
+  flush_io_.reset();
+
+  // 释放页面数组和替换器
   delete[] pages_;
   delete replacer_;
 }
@@ -38,7 +57,23 @@ BufferPoolManager::~BufferPoolManager() {
  * TODO: Student Implement
  */
 //根据逻辑页号获取对应的数据页，如果该数据页不在内存中，则需要从磁盘中进行读取
-Page *BufferPoolManager::FetchPage(page_id_t page_id) {
+Page *BufferPoolManager::FetchPage(page_id_t page_id, BufferRing *ring) {
+  bool from_disk = false;
+  Page *page = FetchPageInternal(page_id, from_disk);
+  //批量读取时，只有扫描自己从磁盘读入的页面才交给缓冲环管理
+  //超出环大小的旧页面在释放latch_之后交还给它们所在的缓冲池，避免同时持有多个实例的latch_
+  if (page != nullptr && from_disk && ring != nullptr) {
+    ring->Add(this, page_id);
+    BufferPoolManager *owner;
+    page_id_t old_page_id;
+    while (ring->NextToRelease(&owner, &old_page_id)) {
+      owner->DiscardPage(old_page_id);
+    }
+  }
+  return page;
+}
+
+Page *BufferPoolManager::FetchPageInternal(page_id_t page_id, bool &from_disk) {
   // 1.     Search the page table for the requested page (P).
   // 1.1    If P exists, pin it and return it immediately.
   // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
@@ -47,6 +82,9 @@ Page *BufferPoolManager::FetchPage(page_id_t page_id) {
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
 
+  unique_lock<recursive_mutex> lock(latch_);
+  //如果该页面正在被后台预读，等待读取完成
+  WaitForIo(lock, page_id);
   //在页面表中查找请求的页面（P）
   auto itr = page_table_.find(page_id);
 
@@ -55,37 +93,27 @@ Page *BufferPoolManager::FetchPage(page_id_t page_id) {
   Page *target_frame;
 
   //如果找到页面（P），对其进行引用，并立即返回
+  //预读后第一次被访问的页面视同从磁盘读入，以便缓冲环回收它
   if (itr != page_table_.end()) {
     frame_idx = itr->second;
     target_frame = &pages_[frame_idx];
+    if (prefetched_[frame_idx]) {
+      prefetched_[frame_idx] = false;
+      from_disk = true;
+    }
     //页面被引用
     target_frame->pin_count_++;
     replacer_->Pin(frame_idx);
     return target_frame;
   }
 
-  //如果没找到，先从空闲列表中寻找替换页面（R）
-  if (!free_list_.empty()) {
-    frame_idx = free_list_.front();
-    free_list_.pop_front();
-  }
-  else {
-    //如果空闲列表也没有，就从替换器中找
-    if (!replacer_->Victim(&frame_idx))
-      return nullptr;
-  }
-
-  //获取替换页面（R）
+  //如果没找到，从空闲列表或替换器中寻找替换页面（R），脏页会在其中写回磁盘
+  frame_idx = TryToFindFreePage();
+  if (frame_idx == INVALID_FRAME_ID)
+    return nullptr;
   target_frame = &pages_[frame_idx];
 
-  //如果替换页面（R）为脏页，将其写回磁盘
-  if (target_frame->IsDirty()) {
-    disk_manager_->WritePage(target_frame->page_id_, target_frame->data_);
-    target_frame->is_dirty_ = false;
-  }
-
-  //从页面表中删除脏页，插入新的页面（P）
-  page_table_.erase(target_frame->page_id_);
+  //在页面表中插入新的页面（P）
   page_table_.insert({page_id, frame_idx});
 
   //更新页面（P）的元数据，从磁盘读取页面内容
@@ -96,6 +124,7 @@ Page *BufferPoolManager::FetchPage(page_id_t page_id) {
 
   //从磁盘读取页面（P）的内容
   disk_manager_->ReadPage(target_frame->page_id_, target_frame->data_);
+  from_disk = true;
 
   //返回指向页面（P）的指针
   return target_frame;
@@ -113,54 +142,79 @@ Page *BufferPoolManager::NewPage(page_id_t &page_id)
   // 3.   Update P's metadata, zero out memory and add P to the page table.
   // 4.   Set the page ID output parameter. Return a pointer to P.
 
-  //检查缓冲池中是否所有页面都被引用
-  size_t idx = 0;
-  for (idx = 0; idx < pool_size_; idx++) {
-    if (pages_[idx].GetPinCount() <= 0)
-      break;
+  unique_lock<recursive_mutex> lock(latch_);
+  //先找到可用的页帧，如果所有页面都被引用，返回nullptr
+  frame_id_t frame_idx = TryToFindFreePage();
+  if (frame_idx == INVALID_FRAME_ID)
+    return nullptr;
+
+  //分配新的页面ID，分配失败时归还页帧
+  auto new_page_id = AllocatePage();
+  if (new_page_id == INVALID_PAGE_ID) {
+    free_list_.push_back(frame_idx);
+    return nullptr;
   }
+  WaitForIo(lock, new_page_id);
+  //旧的副本仍被引用时不能交出该页，归还页帧和页面ID
+  if (!DropStalePage(new_page_id)) {
+    free_list_.push_back(frame_idx);
+    DeallocatePage(new_page_id);
+    return nullptr;
+  }
+
+  //设置页面ID并返回新的页面
+  page_id = new_page_id;
+  return InitNewPage(frame_idx, new_page_id);
+}
 
-  //如果所有页面都被引用，返回nullptr
-  if (idx == pool_size_)
+//页面ID已经由外部（如ParallelBufferPoolManager）在磁盘上分配好，只需要为其准备页帧
+Page *BufferPoolManager::NewPageWithId(page_id_t page_id) {
+  unique_lock<recursive_mutex> lock(latch_);
+  WaitForIo(lock, page_id);
+  if (!DropStalePage(page_id))
     return nullptr;
+  frame_id_t frame_idx = TryToFindFreePage();
+  if (frame_idx == INVALID_FRAME_ID)
+    return nullptr;
+  return InitNewPage(frame_idx, page_id);
+}
 
-  frame_id_t frame_idx;
-  Page *target_frame;
+//将新页面装入页帧：加入页面表，清零内存，并增加页面的引用计数
+Page *BufferPoolManager::InitNewPage(frame_id_t frame_id, page_id_t page_id) {
+  Page *target_frame = &pages_[frame_id];
+  page_table_.insert({page_id, frame_id});
 
+  target_frame->page_id_ = page_id;
+  target_frame->ResetMemory();
+  target_frame->is_dirty_ = false;
+  target_frame->pin_count_ = 1;
+  prefetched_[frame_id] = false;
+  replacer_->Pin(frame_id);
+  return target_frame;
+}
+
+//从空闲列表或替换器中获取一个可用的页帧，被替换的脏页会先写回磁盘
+frame_id_t BufferPoolManager::TryToFindFreePage() {
+  frame_id_t frame_idx;
   //首先从空闲列表中获取
   if (!free_list_.empty()) {
     frame_idx = free_list_.front();
     free_list_.pop_front();
+    prefetched_[frame_idx] = false;
+    return frame_idx;
   }
-  else {
-    //如果空闲列表没有，从替换器中获取
-    if (!replacer_->Victim(&frame_idx))
-      return nullptr;
-  }
-  target_frame = &pages_[frame_idx];
-
-  //如果页面为脏页，写回磁盘
-  if (target_frame->IsDirty()) {
-    disk_manager_->WritePage(target_frame->page_id_, target_frame->data_);
-    target_frame->is_dirty_ = false;
+  //如果空闲列表没有，从替换器中获取
+  if (!replacer_->Victim(&frame_idx))
+    return INVALID_FRAME_ID;
+
+  //如果页面为脏页，写回磁盘，并从页面表中删除旧的页面
+  Page *victim = &pages_[frame_idx];
+  if (victim->IsDirty()) {
+    WriteBack(victim);
   }
-
-  //分配新的页面ID
-  auto new_page_id = AllocatePage();
-
-  //从页面表中删除旧的页面，插入新的页面
-  page_table_.erase(target_frame->page_id_);
-  page_table_.insert({new_page_id, frame_idx});
-
-  //更新页面元数据，清零内存，增加页面的引用计数
-  target_frame->page_id_ = new_page_id;
-  target_frame->ResetMemory();
-  target_frame->pin_count_++;
-  replacer_->Pin(frame_idx);
-
-  //设置页面ID并返回新的页面
-  page_id = new_page_id;
-  return target_frame;
+  page_table_.erase(victim->page_id_);
+  prefetched_[frame_idx] = false;
+  return frame_idx;
 }
 
 /**
@@ -174,6 +228,8 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
   // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
   
+  unique_lock<recursive_mutex> lock(latch_);
+  WaitForIo(lock, page_id);
   //检查页面是否在页面表中
   auto page_itr = page_table_.find(page_id);
   frame_id_t frame_idx;
@@ -193,12 +249,12 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
 
   //如果页面为脏页，写回磁盘
   if (target_page->IsDirty()) {
-    disk_manager_->WritePage(target_page->page_id_, target_page->data_);
-    target_page->is_dirty_ = false;
+    WriteBack(target_page);
   }
 
-  //从页表中删除页面并释放页面
+  //从页表和替换器中删除页面并释放页面
   page_table_.erase(target_page->page_id_);
+  replacer_->Remove(frame_idx);
   DeallocatePage(target_page->page_id_);
 
   //重置页面元数据并将页面ID添加到空闲列表
@@ -213,11 +269,33 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
   return true;
 }
 
+//将未被引用的页面移出缓冲池，页帧放回空闲列表，磁盘上的页面保持分配状态
+bool BufferPoolManager::DiscardPage(page_id_t page_id) {
+  scoped_lock<recursive_mutex> lock(latch_);
+  auto itr = page_table_.find(page_id);
+  if (itr == page_table_.end())
+    return false;
+  frame_id_t frame_idx = itr->second;
+  Page *target_page = &pages_[frame_idx];
+  if (target_page->pin_count_ > 0)
+    return false;
+
+  if (target_page->IsDirty()) {
+    WriteBack(target_page);
+  }
+  page_table_.erase(itr);
+  replacer_->Remove(frame_idx);
+  target_page->page_id_ = INVALID_PAGE_ID;
+  free_list_.push_back(frame_idx);
+  return true;
+}
+
 /**
  * TODO: Student Implement
  */
 //取消固定一个数据页
 bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
+  scoped_lock<recursive_mutex> lock(latch_);
   //在页面表中查找给定的页面ID
   auto itr = page_table_.find(page_id);
   frame_id_t frame_idx;
@@ -231,8 +309,11 @@ bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
   frame_idx = itr->second;
   target_frame = &pages_[frame_idx];
 
-  //根据参数设置页面帧的脏页状态
-  target_frame->is_dirty_ = is_dirty;
+  //如果调用者修改了页面，将其标记为脏页；is_dirty为false时不能清除其他调用者留下的脏页标记
+  if (is_dirty) {
+    target_frame->is_dirty_ = true;
+    dirty_pages_.insert(page_id);
+  }
 
   //如果页面帧的引用计数为0，返回false
   if (target_frame->pin_count_ == 0)
@@ -253,6 +334,11 @@ bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
  */
 //将数据页转储到磁盘中
 bool BufferPoolManager::FlushPage(page_id_t page_id) {
+  unique_lock<recursive_mutex> lock(latch_);
+  //正在写回的页面可能复制的是旧的内容，等它写完再写，以免旧的内容覆盖这次写入
+  io_cv_.wait(lock, [this, page_id] {
+    return io_pending_.find(page_id) == io_pending_.end() && flushing_.find(page_id) == flushing_.end();
+  });
   //使用find()方法在page_table_中寻找对应的page_id
   auto table_itr = page_table_.find(page_id);
 
@@ -264,16 +350,287 @@ bool BufferPoolManager::FlushPage(page_id_t page_id) {
   frame_id_t frame_id = table_itr->second;
   Page *target_page = &pages_[frame_id];
 
-  //利用disk_manager_将对应的Page对象写入磁盘
-  disk_manager_->WritePage(target_page->page_id_, target_page->data_);
-
-  //页面被写入磁盘后，更新其状态为非脏页
-  target_page->is_dirty_ = false;
+  //利用disk_manager_将对应的Page对象写入磁盘，并更新其状态为非脏页
+  WriteBack(target_page);
 
   //如果一切正常，则返回true
   return true;
 }
 
+//将预读请求放入队列，由预读线程在后台完成读取；第一次预读时启动预读线程
+bool BufferPoolManager::PrefetchPage(page_id_t page_id) {
+  if (page_id == INVALID_PAGE_ID)
+    return false;
+  {
+    scoped_lock<recursive_mutex> lock(latch_);
+    if (page_table_.find(page_id) != page_table_.end())
+      return true;
+  }
+  lock_guard<mutex> lock(prefetch_latch_);
+  if (prefetch_stop_ || prefetch_queue_.size() >= min(pool_size_, PREFETCH_QUEUE_SIZE))
+    return false;
+  prefetch_queue_.push_back(page_id);
+  if (!prefetch_thread_.joinable())
+    prefetch_thread_ = thread(&BufferPoolManager::PrefetchWorker, this);
+  prefetch_cv_.notify_one();
+  return true;
+}
+
+//一次取出多个预读请求，作为一批异步读请求提交；异步I/O上下文只由预读线程使用
+void BufferPoolManager::PrefetchWorker() {
+  auto io = disk_manager_->CreateAsyncIoContext(min(pool_size_, ASYNC_IO_QUEUE_DEPTH));
+  vector<page_id_t> batch;
+  unique_lock<mutex> lock(prefetch_latch_);
+  while (true) {
+    prefetch_cv_.wait(lock, [this] { return prefetch_stop_ || !prefetch_queue_.empty(); });
+    if (prefetch_stop_)
+      return;
+    batch.clear();
+    while (!prefetch_queue_.empty() && batch.size() < io->GetQueueDepth()) {
+      batch.push_back(prefetch_queue_.front());
+      prefetch_queue_.pop_front();
+    }
+    lock.unlock();
+    LoadPages(batch, io.get());
+    lock.lock();
+  }
+}
+
+void BufferPoolManager::StopPrefetcher() {
+  {
+    lock_guard<mutex> lock(prefetch_latch_);
+    prefetch_stop_ = true;
+    prefetch_queue_.clear();
+  }
+  prefetch_cv_.notify_all();
+  if (prefetch_thread_.joinable())
+    prefetch_thread_.join();
+}
+
+//读盘期间不持有latch_：页面被标记为正在读取并暂时引用，防止被替换或删除
+void BufferPoolManager::LoadPages(const vector<page_id_t> &page_ids, AsyncIoContext *io) {
+  vector<frame_id_t> frames;
+  {
+    scoped_lock<recursive_mutex> lock(latch_);
+    for (auto page_id : page_ids) {
+      //已在缓冲池中的页面和磁盘上未分配的页面都不需要读取
+      if (page_table_.find(page_id) != page_table_.end() || disk_manager_->IsPageFree(page_id))
+        continue;
+      frame_id_t frame_idx = TryToFindFreePage();
+      if (frame_idx == INVALID_FRAME_ID)
+        break;
+      Page *page = &pages_[frame_idx];
+      page->page_id_ = page_id;
+      page->pin_count_ = 1;
+      page->is_dirty_ = false;
+      page_table_.insert({page_id, frame_idx});
+      io_pending_.insert(page_id);
+      frames.push_back(frame_idx);
+    }
+  }
+  if (frames.empty())
+    return;
+
+  //整批读请求只提交一次，等待全部完成
+  for (auto frame_idx : frames) {
+    io->PrepareRead(pages_[frame_idx].page_id_, pages_[frame_idx].data_, frame_idx);
+  }
+  io->Submit();
+  vector<IoCompletion> completions;
+  while (completions.size() < frames.size()) {
+    io->Poll(completions, frames.size() - completions.size());
+  }
+
+  {
+    scoped_lock<recursive_mutex> lock(latch_);
+    for (auto &completion : completions) {
+      auto frame_idx = static_cast<frame_id_t>(completion.tag_);
+      Page *page = &pages_[frame_idx];
+      io_pending_.erase(page->page_id_);
+      page->pin_count_ = 0;
+      //读取失败的页面不能留在缓冲池中，之后的FetchPage会重新读取
+      if (!completion.success_) {
+        page_table_.erase(page->page_id_);
+        page->page_id_ = INVALID_PAGE_ID;
+        free_list_.push_back(frame_idx);
+        continue;
+      }
+      prefetched_[frame_idx] = true;
+      replacer_->Unpin(frame_idx);
+    }
+  }
+  io_cv_.notify_all();
+}
+
+void BufferPoolManager::WaitForIo(unique_lock<recursive_mutex> &lock, page_id_t page_id) {
+  io_cv_.wait(lock, [this, page_id] { return io_pending_.find(page_id) == io_pending_.end(); });
+}
+
+bool BufferPoolManager::DropStalePage(page_id_t page_id) {
+  auto itr = page_table_.find(page_id);
+  if (itr == page_table_.end())
+    return true;
+  frame_id_t frame_idx = itr->second;
+  Page *page = &pages_[frame_idx];
+  if (page->pin_count_ > 0) {
+    LOG(ERROR) << "page " << page_id << " is allocated while still pinned in the buffer pool" << endl;
+    return false;
+  }
+  page_table_.erase(itr);
+  dirty_pages_.erase(page_id);
+  replacer_->Remove(frame_idx);
+  page->page_id_ = INVALID_PAGE_ID;
+  page->is_dirty_ = false;
+  prefetched_[frame_idx] = false;
+  free_list_.push_back(frame_idx);
+  return true;
+}
+
+void BufferPoolManager::WriteBack(Page *page) {
+  disk_manager_->WritePage(page->page_id_, page->data_);
+  page->is_dirty_ = false;
+  dirty_pages_.erase(page->page_id_);
+}
+
+//写回期间页面保持引用，不会被替换或删除；写回前就标记为干净页，写回期间再被修改的页面会重新成为脏页
+void BufferPoolManager::PinForWriteBack(Page *page) {
+  if (page->pin_count_++ == 0)
+    replacer_->Pin(page_table_[page->page_id_]);
+  page->is_dirty_ = false;
+  dirty_pages_.erase(page->page_id_);
+  flushing_.insert(page->page_id_);
+}
+
+//写回期间不持有latch_：先在页面读锁下复制页面内容，不会写出写线程改了一半的页面，
+//再把复制的内容作为一批异步写请求提交；只有一页时直接同步写回
+void BufferPoolManager::WriteBackBatch(const vector<Page *> &pages) {
+  if (pages.empty())
+    return;
+  vector<char> buffer(pages.size() * PAGE_SIZE);
+  for (size_t i = 0; i < pages.size(); i++) {
+    pages[i]->RLatch();
+    memcpy(buffer.data() + i * PAGE_SIZE, pages[i]->GetData(), PAGE_SIZE);
+    pages[i]->RUnlatch();
+  }
+  //写入期间读取这些页面的请求等待写入完成
+  {
+    scoped_lock<recursive_mutex> lock(latch_);
+    for (auto page : pages) {
+      io_pending_.insert(page->page_id_);
+    }
+  }
+
+  vector<bool> written(pages.size(), false);
+  if (pages.size() == 1) {
+    disk_manager_->WritePage(pages.front()->page_id_, buffer.data());
+    written[0] = true;
+  } else {
+    if (flush_io_ == nullptr)
+      flush_io_ = disk_manager_->CreateAsyncIoContext(ASYNC_IO_QUEUE_DEPTH);
+    vector<IoCompletion> completions;
+    size_t next = 0;
+    while (next < pages.size()) {
+      size_t batch_end = next;
+      while (batch_end < pages.size() &&
+             flush_io_->PrepareWrite(pages[batch_end]->page_id_, buffer.data() + batch_end * PAGE_SIZE, batch_end)) {
+        batch_end++;
+      }
+      flush_io_->Submit();
+      completions.clear();
+      while (completions.size() < batch_end - next) {
+        flush_io_->Poll(completions, batch_end - next - completions.size());
+      }
+      for (auto &completion : completions) {
+        written[completion.tag_] = completion.success_;
+      }
+      next = batch_end;
+    }
+  }
+
+  //写失败的页面重新标记为脏页，留给下一次写回
+  {
+    scoped_lock<recursive_mutex> lock(latch_);
+    for (size_t i = 0; i < pages.size(); i++) {
+      Page *page = pages[i];
+      io_pending_.erase(page->page_id_);
+      flushing_.erase(page->page_id_);
+      if (!written[i]) {
+        page->is_dirty_ = true;
+        dirty_pages_.insert(page->page_id_);
+      }
+      if (--page->pin_count_ == 0)
+        replacer_->Unpin(page_table_[page->page_id_]);
+    }
+  }
+  io_cv_.notify_all();
+}
+
+//从上次停止的位置开始，依次写回未被引用的脏页，被引用的页面可能正在被修改，留到以后再写
+size_t BufferPoolManager::FlushDirtyPages(size_t max_pages) {
+  lock_guard<mutex> flush_lock(flush_latch_);
+  vector<Page *> victims;
+  {
+    scoped_lock<recursive_mutex> lock(latch_);
+    size_t remaining = dirty_pages_.size();
+    auto itr = dirty_pages_.lower_bound(flush_cursor_);
+    while (victims.size() < max_pages && remaining-- > 0) {
+      if (itr == dirty_pages_.end())
+        itr = dirty_pages_.begin();
+      page_id_t page_id = *itr++;
+      Page *page = &pages_[page_table_[page_id]];
+      if (page->pin_count_ > 0)
+        continue;
+      flush_cursor_ = page_id + 1;
+      victims.push_back(page);
+    }
+    for (auto page : victims) {
+      PinForWriteBack(page);
+    }
+  }
+  WriteBackBatch(victims);
+  return victims.size();
+}
+
+//检查点：写回所有脏页，并将磁盘文件同步到稳定存储
+void BufferPoolManager::Checkpoint() {
+  FlushAllDirtyPages();
+  disk_manager_->Sync();
+}
+
+void BufferPoolManager::FlushAllDirtyPages() {
+  lock_guard<mutex> flush_lock(flush_latch_);
+  vector<Page *> victims;
+  {
+    scoped_lock<recursive_mutex> lock(latch_);
+    for (auto page_id : dirty_pages_) {
+      victims.push_back(&pages_[page_table_[page_id]]);
+    }
+    for (auto page : victims) {
+      PinForWriteBack(page);
+    }
+  }
+  WriteBackBatch(victims);
+}
+
+size_t BufferPoolManager::GetDirtyPageCount() {
+  scoped_lock<recursive_mutex> lock(latch_);
+  return dirty_pages_.size();
+}
+
+void BufferPoolManager::StartBackgroundFlusher(chrono::milliseconds interval, size_t pages_per_round,
+                                               size_t checkpoint_rounds) {
+  StopBackgroundFlusher();
+  flusher_ = make_unique<BackgroundFlusher>(this, interval, pages_per_round, checkpoint_rounds);
+  flusher_->Start();
+}
+
+void BufferPoolManager::StopBackgroundFlusher() {
+  if (flusher_ != nullptr) {
+    flusher_->Stop();
+    flusher_.reset();
+  }
+}
+
 page_id_t BufferPoolManager::AllocatePage() {
   int next_page_id = disk_manager_->AllocatePage();
   return next_page_id;
@@ -289,9 +646,12 @@ bool BufferPoolManager::IsPageFree(page_id_t page_id) {
 
 // Only used for debug
 bool BufferPoolManager::CheckAllUnpinned() {
+  scoped_lock<recursive_mutex> lock(latch_);
   bool res = true;
+  //正在被后台预读或写回的页面由后台线程临时引用，不计入
   for (size_t i = 0; i < pool_size_; i++) {
-    if (pages_[i].pin_count_ != 0) {
+    if (pages_[i].pin_count_ != 0 && io_pending_.find(pages_[i].page_id_) == io_pending_.end() &&
+        flushing_.find(pages_[i].page_id_) == flushing_.end()) {
       res = false;
       LOG(ERROR) << "page " << pages_[i].page_id_ << " pin count:" << pages_[i].pin_count_ << endl;
     }
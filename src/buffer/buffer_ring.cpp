@@ -0,0 +1,27 @@
+#include "buffer/buffer_ring.h"
+
+#include <algorithm>
+
+BufferRing::BufferRing(size_t ring_size, size_t activation_threshold)
+    : ring_size_(ring_size == 0 ? 1 : ring_size), activation_threshold_(activation_threshold) {}
+
+//扫描读入的页面超过缓冲池的一部分后才开始回收页帧，小表仍然可以完整地留在缓冲池中
+BufferRing BufferRing::ForBulkRead(size_t pool_size) {
+  size_t threshold = pool_size / BULK_READ_POOL_FRACTION;
+  return BufferRing(std::min<size_t>(BULK_READ_RING_SIZE, std::max<size_t>(threshold, 1)), threshold);
+}
+
+void BufferRing::Add(BufferPoolManager *bpm, page_id_t page_id) {
+  pages_read_++;
+  pages_.emplace_back(bpm, page_id);
+}
+
+//环生效后，超出ring_size的最旧页面需要交还给缓冲池
+bool BufferRing::NextToRelease(BufferPoolManager **bpm, page_id_t *page_id) {
+  if (!IsActive() || pages_.size() <= ring_size_)
+    return false;
+  *bpm = pages_.front().first;
+  *page_id = pages_.front().second;
+  pages_.pop_front();
+  return true;
+}
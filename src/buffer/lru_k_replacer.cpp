@@ -0,0 +1,61 @@
+#include "buffer/lru_k_replacer.h"
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k) : capacity_(num_pages), k_(k == 0 ? 1 : k) {}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+void LRUKReplacer::Erase(FrameHistory &history) {
+  (history.in_cache_list_ ? cache_list_ : history_list_).erase(history.key_);
+  history.evictable_ = false;
+}
+
+//优先替换访问次数不足k次的帧（后向k距离为无穷大），其中最早访问的先被替换
+//如果所有可替换的帧都已访问k次，替换倒数第k次访问时间最早的帧
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  auto &victim_list = history_list_.empty() ? cache_list_ : history_list_;
+  if (victim_list.empty())
+    return false;
+
+  *frame_id = victim_list.begin()->second;
+  victim_list.erase(victim_list.begin());
+  //该帧将装入新的页面，之前的访问记录不再有意义
+  histories_.erase(*frame_id);
+  return true;
+}
+
+//Pin函数在每次获取页面时被调用，记为一次访问，并将帧从可替换的集合中移除
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  auto &history = histories_[frame_id];
+  if (history.evictable_)
+    Erase(history);
+  history.accesses_.push_back(current_timestamp_++);
+  if (history.accesses_.size() > k_)
+    history.accesses_.pop_front();
+}
+
+//Unpin函数在引用计数变为0时被调用，根据访问次数将帧放入对应的集合
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  auto &history = histories_[frame_id];
+  if (history.evictable_)
+    return;
+  if (history_list_.size() + cache_list_.size() >= capacity_)
+    return;
+  //排序关键字为记录中最早的一次访问时间：访问次数不足k次时即为第一次访问时间，达到k次时即为倒数第k次访问时间
+  //没有访问记录的帧（如预读的页面）按当前时间排序，但不计为一次访问
+  history.evictable_ = true;
+  history.in_cache_list_ = history.accesses_.size() >= k_;
+  history.key_ = {history.accesses_.empty() ? current_timestamp_++ : history.accesses_.front(), frame_id};
+  (history.in_cache_list_ ? cache_list_ : history_list_).insert(history.key_);
+}
+
+//页面被丢弃后，帧的访问记录一并删除，避免新装入的页面继承旧的访问次数
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  auto itr = histories_.find(frame_id);
+  if (itr == histories_.end())
+    return;
+  if (itr->second.evictable_)
+    Erase(itr->second);
+  histories_.erase(itr);
+}
+
+size_t LRUKReplacer::Size() { return history_list_.size() + cache_list_.size(); }
@@ -0,0 +1,91 @@
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include "glog/logging.h"
+
+//将总的页帧数平均分配给各个缓冲池实例，余数分给前面的实例
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size,
+                                                     DiskManager *disk_manager, ReplacerType replacer_type)
+    : BufferPoolManager(disk_manager), pool_size_(pool_size), disk_manager_(disk_manager) {
+  ASSERT(num_instances > 0, "Buffer pool must have at least one instance.");
+  ASSERT(pool_size >= num_instances, "Every buffer pool instance needs at least one frame.");
+  instances_.reserve(num_instances);
+  for (size_t i = 0; i < num_instances; i++) {
+    size_t instance_size = pool_size / num_instances + (i < pool_size % num_instances ? 1 : 0);
+    instances_.push_back(new BufferPoolManager(instance_size, disk_manager, replacer_type));
+  }
+}
+
+//先停止后台写线程，再销毁所有实例，每个实例在析构时会将自己的脏页刷新至磁盘
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  StopBackgroundFlusher();
+  for (auto instance : instances_) {
+    delete instance;
+  }
+}
+
+//缓冲环中记录的是实际读入页面的实例，回收页面时会交还给对应的实例
+Page *ParallelBufferPoolManager::FetchPage(page_id_t page_id, BufferRing *ring) {
+  return GetInstance(page_id)->FetchPage(page_id, ring);
+}
+
+bool ParallelBufferPoolManager::PrefetchPage(page_id_t page_id) {
+  return page_id != INVALID_PAGE_ID && GetInstance(page_id)->PrefetchPage(page_id);
+}
+
+bool ParallelBufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
+  return GetInstance(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+bool ParallelBufferPoolManager::FlushPage(page_id_t page_id) { return GetInstance(page_id)->FlushPage(page_id); }
+
+//先在磁盘上分配页面ID，再交给该ID对应的实例；如果该实例的页帧全部被引用，则释放刚分配的ID
+Page *ParallelBufferPoolManager::NewPage(page_id_t &page_id) {
+  page_id_t new_page_id = disk_manager_->AllocatePage();
+  if (new_page_id == INVALID_PAGE_ID)
+    return nullptr;
+  Page *page = GetInstance(new_page_id)->NewPageWithId(new_page_id);
+  if (page == nullptr) {
+    disk_manager_->DeAllocatePage(new_page_id);
+    return nullptr;
+  }
+  page_id = new_page_id;
+  return page;
+}
+
+bool ParallelBufferPoolManager::DeletePage(page_id_t page_id) { return GetInstance(page_id)->DeletePage(page_id); }
+
+bool ParallelBufferPoolManager::IsPageFree(page_id_t page_id) { return disk_manager_->IsPageFree(page_id); }
+
+bool ParallelBufferPoolManager::CheckAllUnpinned() {
+  bool res = true;
+  for (auto instance : instances_) {
+    res = instance->CheckAllUnpinned() && res;
+  }
+  return res;
+}
+
+//每个实例分到同样多的写回配额
+size_t ParallelBufferPoolManager::FlushDirtyPages(size_t max_pages) {
+  size_t per_instance = (max_pages + instances_.size() - 1) / instances_.size();
+  size_t flushed = 0;
+  for (auto instance : instances_) {
+    flushed += instance->FlushDirtyPages(per_instance);
+  }
+  return flushed;
+}
+
+//所有实例的脏页写回之后只同步一次磁盘文件
+void ParallelBufferPoolManager::Checkpoint() {
+  for (auto instance : instances_) {
+    instance->FlushAllDirtyPages();
+  }
+  disk_manager_->Sync();
+}
+
+size_t ParallelBufferPoolManager::GetDirtyPageCount() {
+  size_t count = 0;
+  for (auto instance : instances_) {
+    count += instance->GetDirtyPageCount();
+  }
+  return count;
+}
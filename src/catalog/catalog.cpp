@@ -153,7 +153,8 @@ dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schem
 
   /** TABLE_META **/
   /* set table_metadata */
-  TableMetadata *t_meta = TableMetadata::Create(this_t_id, table_name, new_heap->GetFirstPageId(), schema);
+  TableMetadata *t_meta = TableMetadata::Create(this_t_id, table_name, new_heap->GetFirstPageId(),
+                                                  new_heap->GetFreeSpaceMapPageId(), schema);
 
   /** TABLE_INFO **/
   /* set  table_info */
@@ -454,7 +455,7 @@ dberr_t CatalogManager::LoadTable(const table_id_t table_id, const page_id_t pag
   
   /* construct t_heap */
   TableHeap *t_heap = TableHeap::Create(buffer_pool_manager_, 
-                      t_meta->GetFirstPageId(), t_meta->GetSchema(),
+                      t_meta->GetFirstPageId(), t_meta->GetFreeSpaceMapPageId(), t_meta->GetSchema(),
                       log_manager_, lock_manager_);
   
   /* construct table_info */
@@ -84,23 +84,45 @@ uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta) {
     return buf - p;
 }
 
+//键中任意一列唯一时键唯一，否则索引允许重复键
+bool IndexInfo::IsUnique() const {
+  for (uint32_t i = 0; i < key_schema_->GetColumnCount(); i++)
+    if (key_schema_->GetColumn(i)->IsUnique())
+      return true;
+  return false;
+}
+
 Index *IndexInfo::CreateIndex(BufferPoolManager *buffer_pool_manager, const string &index_type) {
-  size_t max_size = 0;
-  for (auto col : key_schema_->GetColumns()) {
-    max_size += col->GetLength();
+  bool unique = IsUnique();
+  //单个非空的int或float列上的索引使用定长键的B+树，直接比较原始值
+  if (index_type == "bptree" && key_schema_->GetColumnCount() == 1 && !key_schema_->GetColumn(0)->IsNullable()) {
+    TypeId type = key_schema_->GetColumn(0)->GetType();
+    if (type == TypeId::kTypeInt)
+      return new FixedKeyBPlusTreeIndex<int32_t>(meta_data_->index_id_, key_schema_, buffer_pool_manager, unique);
+    if (type == TypeId::kTypeFloat)
+      return new FixedKeyBPlusTreeIndex<float>(meta_data_->index_id_, key_schema_, buffer_pool_manager, unique);
   }
+  //键以规范化形式存储，按编码后的长度选择键的大小
+  size_t max_size = KeyManager::EncodedKeySize(key_schema_);
+  //含char列的键长度可变，使用按键的实际长度存储的槽页面，避免每个键都占用char列的声明长度
+  bool has_char = false;
+  for (uint32_t i = 0; i < key_schema_->GetColumnCount(); i++)
+    has_char = has_char || key_schema_->GetColumn(i)->GetType() == TypeId::kTypeChar;
+  if (index_type == "bptree" && has_char && max_size <= KeyManager::MAX_KEY_SIZE &&
+      KeyManager::MaxCompactKeySize(key_schema_) <= SlottedBPlusTree::MAX_KEY_SIZE)
+    return new SlottedBPlusTreeIndex(meta_data_->index_id_, key_schema_, buffer_pool_manager, unique);
 
   if (index_type == "bptree") {
-    if (max_size <= 8)
+    if (max_size <= 16)
       max_size = 16;
-    else if (max_size <= 24)
+    else if (max_size <= 32)
       max_size = 32;
-    else if (max_size <= 56)
+    else if (max_size <= 64)
       max_size = 64;
-    else if (max_size <= 120)
+    else if (max_size <= 128)
       max_size = 128;
-    else if (max_size <= 248)
-      max_size = 256;
+    else if (max_size <= KeyManager::MAX_KEY_SIZE)
+      max_size = KeyManager::MAX_KEY_SIZE;
     else {
       LOG(ERROR) << "GenericKey size is too large";
       return nullptr;
@@ -108,5 +130,5 @@ Index *IndexInfo::CreateIndex(BufferPoolManager *buffer_pool_manager, const stri
   } else {
     return nullptr;
   }
-  return new BPlusTreeIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager);
+  return new BPlusTreeIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager, unique);
 }
@@ -18,6 +18,9 @@ uint32_t TableMetadata::SerializeTo(char *buf) const {
     // table heap root page id
     MACH_WRITE_TO(page_id_t, buf, root_page_id_);
     buf += 4;
+    // free space map root page id
+    MACH_WRITE_TO(page_id_t, buf, free_space_map_page_id_);
+    buf += 4;
     // table schema
     buf += schema_->SerializeTo(buf);
     ASSERT(buf - p == ofs, "Unexpected serialize size.");
@@ -29,7 +32,7 @@ uint32_t TableMetadata::SerializeTo(char *buf) const {
  * DONE: Student Implement
  */
 uint32_t TableMetadata::GetSerializedSize() const {
-  int fix_size = sizeof(uint32_t) * 4; // MAGIC_NUM, table_id, table_name_len, table_root_id
+  int fix_size = sizeof(uint32_t) * 5; // MAGIC_NUM, table_id, table_name_len, table_root_id, free_space_map_id
   int name_str_len = table_name_.size();
   int schema_size = schema_->GetSerializedSize();
 
@@ -44,7 +47,8 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta) {
     // magic num
     uint32_t magic_num = MACH_READ_UINT32(buf);
     buf += 4;
-    ASSERT(magic_num == TABLE_METADATA_MAGIC_NUM, "Failed to deserialize table info.");
+    ASSERT(magic_num == TABLE_METADATA_MAGIC_NUM || magic_num == TABLE_METADATA_NO_FSM_MAGIC_NUM,
+           "Failed to deserialize table info.");
     // table id
     table_id_t table_id = MACH_READ_FROM(table_id_t, buf);
     buf += 4;
@@ -56,11 +60,17 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta) {
     // table heap root page id
     page_id_t root_page_id = MACH_READ_FROM(page_id_t, buf);
     buf += 4;
+    // free space map root page id, the old layout has none and the heap rebuilds the map from its pages
+    page_id_t free_space_map_page_id = INVALID_PAGE_ID;
+    if (magic_num == TABLE_METADATA_MAGIC_NUM) {
+        free_space_map_page_id = MACH_READ_FROM(page_id_t, buf);
+        buf += 4;
+    }
     // table schema
     TableSchema *schema = nullptr;
     buf += TableSchema::DeserializeFrom(buf, schema);
     // allocate space for table metadata
-    table_meta = new TableMetadata(table_id, table_name, root_page_id, schema);
+    table_meta = new TableMetadata(table_id, table_name, root_page_id, free_space_map_page_id, schema);
     return buf - p;
 }
 
@@ -70,10 +80,15 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta) {
  * @param heap Memory heap passed by TableInfo
  */
 TableMetadata *TableMetadata::Create(table_id_t table_id, std::string table_name, page_id_t root_page_id,
-                                     TableSchema *schema) {
+                                     page_id_t free_space_map_page_id, TableSchema *schema) {
   // allocate space for table metadata
-  return new TableMetadata(table_id, table_name, root_page_id, schema);
+  return new TableMetadata(table_id, table_name, root_page_id, free_space_map_page_id, schema);
 }
 
-TableMetadata::TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema)
-    : table_id_(table_id), table_name_(table_name), root_page_id_(root_page_id), schema_(schema) {}
+TableMetadata::TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id,
+                             page_id_t free_space_map_page_id, TableSchema *schema)
+    : table_id_(table_id),
+      table_name_(table_name),
+      root_page_id_(root_page_id),
+      free_space_map_page_id_(free_space_map_page_id),
+      schema_(schema) {}
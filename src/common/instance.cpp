@@ -12,7 +12,9 @@ DBStorageEngine::DBStorageEngine(std::string db_name, bool init, uint32_t buffer
   }
   // Initialize components
   disk_mgr_ = new DiskManager(db_file_name_);
-  bpm_ = new BufferPoolManager(buffer_pool_size, disk_mgr_);
+  bpm_ = new ParallelBufferPoolManager(DEFAULT_BUFFER_POOL_INSTANCES, buffer_pool_size, disk_mgr_,
+                                       ReplacerType::LRU_K);
+  bpm_->StartBackgroundFlusher();
 
   // Allocate static page for db storage engine
   if (init) {
@@ -5,6 +5,7 @@
 #include <sys/types.h>
 
 #include <chrono>
+#include <thread>
 
 #include "common/result_writer.h"
 #include "executor/executors/delete_executor.h"
@@ -95,7 +96,7 @@ dberr_t ExecuteEngine::ExecutePlan(const AbstractPlanNodeRef &plan, std::vector<
       Row row(fields); // Create a new row using the fields
       if (!executor->Next(&row, &rid)) break;
       if (result_set != nullptr) {
-        result_set->push_back(row);
+        result_set->push_back(std::move(row));
       }
     }
   } catch (const exception &ex) {
@@ -581,17 +582,31 @@ dberr_t ExecuteEngine::ExecuteShowIndexes(pSyntaxNode ast, ExecuteContext *conte
   TableSchema *t_schema = table_info->GetSchema();
   IndexSchema *i_schema = index_info->GetIndexKeySchema();
   TableHeap *table_heap = table_info->GetTableHeap();
-  // insert index entry
-  for (auto row_itr = table_heap->Begin(txn); row_itr != table_heap->End(); ++row_itr) {
-    Row row = *row_itr;
-    
-    Row key(INVALID_ROWID);
-    row.GetKeyFromRow(t_schema, i_schema, key);
-    ASSERT(key.GetFieldCount() == i_schema->GetColumnCount(), "GetKeyFromRow fails.");
-
-    idx->InsertEntry(key, row.GetRowId(), txn);
+  // build the index from all rows of the table at once: every core scans a share of the heap pages and sorts its
+  // entries, then the sorted entries are merged and the tree is built bottom-up
+  size_t threads = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<TableBatchIterator> partitions = table_heap->BeginPartitions(txn, threads);
+  std::vector<std::vector<Row>> batches(partitions.size());
+  std::vector<size_t> positions(partitions.size(), 0);
+  std::vector<Index::EntrySource> sources;
+  for (size_t i = 0; i < partitions.size(); i++) {
+    sources.emplace_back([&, i](Row &key, RowId &row_id) {
+      std::vector<Row> &batch = batches[i];
+      if (positions[i] == batch.size()) {
+        if (!partitions[i].NextBatch(batch)) {
+          return false;
+        }
+        positions[i] = 0;
+      }
+      Row &row = batch[positions[i]++];
+      row.GetKeyFromRow(t_schema, i_schema, key);
+      ASSERT(key.GetFieldCount() == i_schema->GetColumnCount(), "GetKeyFromRow fails.");
+      row_id = row.GetRowId();
+      return true;
+    });
   }
-  
+  idx->BulkLoad(sources, txn);
+
   return DB_FAILED;
 }
 
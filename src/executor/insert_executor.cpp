@@ -1,4 +1,8 @@
 #include "executor/executors/insert_executor.h"
+
+#include <algorithm>
+#include <numeric>
+
 #include "values.h"
 
 InsertExecutor::InsertExecutor(ExecuteContext *exec_ctx, const InsertPlanNode *plan,
@@ -9,51 +13,150 @@ void InsertExecutor::Init() {
   if (child_executor_) {
     child_executor_->Init();
   }
+  batch_.clear();
+  cursor_ = 0;
 }
 
 bool InsertExecutor::Next(Row *row, RowId *rid) {
-  // 检查是否有子执行器，并尝试获取下一行记录和对应的行标识
-  if (child_executor_ && child_executor_->Next(row, rid)) {
-    // 获取表名
-    const std::string &table_name = plan_->GetTableName();
-
-    // 从目录管理器获取表信息
-    CatalogManager *catalog_manager = exec_ctx_->GetCatalog();
-    TableInfo *table_info;
-    auto result = catalog_manager->GetTable(table_name, table_info);
-    if (result != DB_SUCCESS) {
-      return false;
+  // 当前批次的行都已经返回，插入下一批
+  if (cursor_ == batch_.size() && !InsertBatch()) {
+    return false;
+  }
+  // 返回插入的行及其行标识
+  row->~Row();
+  new (row) Row(batch_[cursor_]);
+  *rid = batch_[cursor_].GetRowId();
+  cursor_++;
+  return true;
+}
+
+// 从子执行器中取出一批行，检查唯一索引后一次写入堆表，再逐行插入所有索引
+bool InsertExecutor::InsertBatch() {
+  batch_.clear();
+  cursor_ = 0;
+  if (!child_executor_) {
+    return false;
+  }
+  while (batch_.size() < INSERT_BATCH_SIZE) {
+    std::vector<Field> fields;
+    Row child_row(fields);
+    RowId child_rid;
+    if (!child_executor_->Next(&child_row, &child_rid)) {
+      break;
     }
+    batch_.push_back(child_row);
+  }
+  if (batch_.empty()) {
+    return false;
+  }
 
-    // 从行记录中提取字段值
-    const std::vector<Field> &fields = reinterpret_cast<const std::vector<Field> &>(row->GetFields());
+  // 获取表名，从目录管理器获取表信息
+  const std::string &table_name = plan_->GetTableName();
+  CatalogManager *catalog_manager = exec_ctx_->GetCatalog();
+  TableInfo *table_info;
+  auto result = catalog_manager->GetTable(table_name, table_info);
+  if (result != DB_SUCCESS) {
+    batch_.clear();
+    return false;
+  }
 
-    // 将行记录插入表中
-    if (!table_info->GetTableHeap()->InsertTuple(*row, reinterpret_cast<Transaction *>(rid))) {
+  // 取出每个索引上整批行的键
+  std::vector<IndexInfo *> index_infos;
+  catalog_manager->GetTableIndexes(table_name, index_infos);
+  std::vector<std::vector<Row>> index_keys(index_infos.size());
+  for (uint32_t i = 0; i < index_infos.size(); i++) {
+    const Schema *index_key_schema = index_infos[i]->GetIndexKeySchema();
+    const std::vector<Column *> &index_cols = index_key_schema->GetColumns();
+    std::vector<uint32_t> col_pos(index_key_schema->GetColumnCount());
+    for (uint32_t j = 0; j < index_key_schema->GetColumnCount(); j++) {
+      table_info->GetSchema()->GetColumnIndex(index_cols[j]->GetName(), col_pos[j]);
+    }
+    index_keys[i].reserve(batch_.size());
+    for (auto &row : batch_) {
+      std::vector<Field> index_key_fields;
+      for (uint32_t pos : col_pos) {
+        index_key_fields.push_back(*row.GetField(pos));
+      }
+      index_keys[i].emplace_back(index_key_fields);
+    }
+  }
+
+  // 写入堆表之前检查唯一索引：批内的键不能重复，在索引上一次查找整批键也不能已存在，否则整批不插入
+  Transaction *txn = exec_ctx_->GetTransaction();
+  for (uint32_t i = 0; i < index_infos.size(); i++) {
+    if (!index_infos[i]->IsUnique()) {
+      continue;
+    }
+    std::vector<std::vector<RowId>> existing;
+    if (HasDuplicateKeys(index_keys[i]) ||
+        index_infos[i]->GetIndex()->ScanKeys(index_keys[i], existing, txn) == DB_SUCCESS) {
+      batch_.clear();
       return false;
     }
+  }
 
-    // 插入所有索引
-    std::vector<IndexInfo *> index_infos;
-    catalog_manager->GetTableIndexes(table_name, index_infos);
+  // 将整批行记录插入表中
+  TableHeap *table_heap = table_info->GetTableHeap();
+  if (!table_heap->InsertTuples(batch_, txn)) {
+    batch_.clear();
+    return false;
+  }
+
+  // 插入所有索引；检查之后其他写入者插入了相同的键时，撤销这一批已插入的索引项和堆表中的行
+  for (size_t r = 0; r < batch_.size(); r++) {
     for (uint32_t i = 0; i < index_infos.size(); i++) {
-      const Schema *index_key_schema = index_infos[i]->GetIndexKeySchema();
-      const std::vector<Column *> &index_cols = index_key_schema->GetColumns();
-      std::vector<Field> index_key_fields;
-      for (uint32_t j = 0; j < index_key_schema->GetColumnCount(); j++) {
-        uint32_t col_pos;
-        table_info->GetSchema()->GetColumnIndex(index_cols[j]->GetName(), col_pos);
-        index_key_fields.push_back(fields[col_pos]);
+      result = index_infos[i]->GetIndex()->InsertEntry(index_keys[i][r], batch_[r].GetRowId(), txn);
+      if (result == DB_SUCCESS) {
+        continue;
       }
-      Row index_key_row(index_key_fields);
-      result = index_infos[i]->GetIndex()->InsertEntry(index_key_row, *rid, nullptr);
-      if (result != DB_SUCCESS) {
-        return false;
+      for (size_t u = 0; u <= r; u++) {
+        for (uint32_t k = 0; k < (u < r ? index_infos.size() : i); k++) {
+          index_infos[k]->GetIndex()->RemoveEntry(index_keys[k][u], batch_[u].GetRowId(), txn);
+        }
+      }
+      for (auto &inserted : batch_) {
+        table_heap->ApplyDelete(inserted.GetRowId(), txn);
       }
+      batch_.clear();
+      return false;
     }
-
-    return true;
   }
+  return true;
+}
 
+// 按键排序后比较相邻的键；含空值的键互不相等，排在最前
+bool InsertExecutor::HasDuplicateKeys(const std::vector<Row> &keys) {
+  auto has_null = [&keys](size_t index) {
+    for (uint32_t j = 0; j < keys[index].GetFieldCount(); j++) {
+      if (keys[index].GetField(j)->IsNull()) {
+        return true;
+      }
+    }
+    return false;
+  };
+  auto less = [&keys, &has_null](size_t lhs, size_t rhs) {
+    if (has_null(lhs) || has_null(rhs)) {
+      return has_null(lhs) && !has_null(rhs);
+    }
+    for (uint32_t j = 0; j < keys[lhs].GetFieldCount(); j++) {
+      const Field *left = keys[lhs].GetField(j);
+      const Field *right = keys[rhs].GetField(j);
+      if (left->CompareLessThan(*right) == CmpBool::kTrue) {
+        return true;
+      }
+      if (right->CompareLessThan(*left) == CmpBool::kTrue) {
+        return false;
+      }
+    }
+    return false;
+  };
+  std::vector<size_t> order(keys.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), less);
+  for (size_t i = 1; i < order.size(); i++) {
+    if (!has_null(order[i - 1]) && !less(order[i - 1], order[i])) {
+      return true;
+    }
+  }
   return false;
 }
@@ -5,7 +5,7 @@ SeqScanExecutor::SeqScanExecutor(ExecuteContext *exec_ctx, const SeqScanPlanNode
       plan_(plan){}
 
 void SeqScanExecutor::Init() {
-  /* get table_heap_.Begin() */
+  /* get table_heap_ and a page-at-a-time iterator over it */
   string t_name = plan_->GetTableName();
   auto *catalog = exec_ctx_->GetCatalog();
   TableInfo *table_info;
@@ -13,24 +13,35 @@ void SeqScanExecutor::Init() {
     ASSERT(false, sprintf("table_name: %s does not exists.", t_name.c_str()));
   }
   table_heap_ = table_info->GetTableHeap();
-  cur_ = table_heap_->Begin(exec_ctx_->GetTransaction());
+  ring_ = std::make_unique<BufferRing>(BufferRing::ForBulkRead(exec_ctx_->GetBufferPoolManager()->GetPoolSize()));
+  batch_itr_ = std::make_unique<TableBatchIterator>(table_heap_->BeginBatch(exec_ctx_->GetTransaction(), ring_.get()));
+  batch_.clear();
+  batch_heap_.Reset();
+  cursor_ = 0;
 
-  /* get predicate */
+  /* get predicate, evaluated on the tuple bytes inside the page */
   filter_predicate_ = plan_->GetPredicate();
+  filter_ = nullptr;
+  if (filter_predicate_ != nullptr) {
+    filter_ = [predicate = filter_predicate_.get()](const RowView &view) {
+      return predicate->Evaluate(view).CompareEquals(Field(kTypeInt, 1)) == CmpBool::kTrue;
+    };
+  }
 }
 
 bool SeqScanExecutor::Next(Row *row, RowId *rid) {
-  while (cur_ != table_heap_->End()) {
-    Row row_tobe_filtered = *cur_;
-    auto is_valid = filter_predicate_->Evaluate(&row_tobe_filtered);
-    cur_++;
-    if (is_valid.CompareEquals(Field(kTypeInt, 1)) == CmpBool::kTrue) {
-      /* predicate is true */
-      new(row) Row(row_tobe_filtered);
-      new(rid) RowId(row_tobe_filtered.GetRowId());
-      return true;
+  /* current page exhausted, read the matching tuples of the next one */
+  if (cursor_ == batch_.size()) {
+    cursor_ = 0;
+    batch_.clear();
+    batch_heap_.Reset();
+    if (!batch_itr_->NextBatch(batch_, filter_, &batch_heap_)) {
+      return false;
     }
   }
-  
-  return false;
+  const Row &result = batch_[cursor_++];
+  row->~Row();
+  new(row) Row(result, exec_ctx_->GetArena());
+  new(rid) RowId(result.GetRowId());
+  return true;
 }
@@ -0,0 +1,61 @@
+#ifndef MINISQL_BACKGROUND_FLUSHER_H
+#define MINISQL_BACKGROUND_FLUSHER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+using namespace std;
+
+class BufferPoolManager;
+
+/**
+ * BackgroundFlusher runs a thread that writes dirty pages of a buffer pool ahead of eviction, so foreground
+ * FetchPage/NewPage calls rarely have to write a victim back synchronously.
+ *
+ * Every interval the thread writes at most pages_per_round unpinned dirty pages. Every checkpoint_rounds rounds it
+ * runs a checkpoint instead, which writes every dirty page. Stop wakes the thread up immediately, so shutting down
+ * never waits for more than the round in progress.
+ */
+class BackgroundFlusher {
+ public:
+  /**
+   * @param bpm buffer pool whose dirty pages are written
+   * @param interval time between two rounds
+   * @param pages_per_round maximum number of pages written in one round
+   * @param checkpoint_rounds number of rounds between two checkpoints, 0 to never checkpoint
+   */
+  BackgroundFlusher(BufferPoolManager *bpm, chrono::milliseconds interval, size_t pages_per_round,
+                    size_t checkpoint_rounds);
+
+  ~BackgroundFlusher();
+
+  DISALLOW_COPY_AND_MOVE(BackgroundFlusher);
+
+  /** Start the flusher thread, does nothing if it is already running */
+  void Start();
+
+  /** Stop the flusher thread and wait for the round in progress to finish */
+  void Stop();
+
+  bool IsRunning() const { return thread_.joinable(); }
+
+ private:
+  void Run();
+
+ private:
+  BufferPoolManager *bpm_;
+  chrono::milliseconds interval_;
+  size_t pages_per_round_;
+  size_t checkpoint_rounds_;
+  thread thread_;
+  mutex latch_;
+  condition_variable cv_;
+  bool stop_{false};
+};
+
+#endif  // MINISQL_BACKGROUND_FLUSHER_H
@@ -1,10 +1,21 @@
 #ifndef MINISQL_BUFFER_POOL_MANAGER_H
 #define MINISQL_BUFFER_POOL_MANAGER_H
 
+#include <condition_variable>
+#include <deque>
 #include <list>
+#include <memory>
 #include <mutex>
+#include <set>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
+#include "buffer/background_flusher.h"
+#include "buffer/buffer_ring.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
 #include "page/disk_file_meta_page.h"
 #include "page/page.h"
@@ -14,24 +25,77 @@ using namespace std;
 
 class BufferPoolManager
 {
+  friend class ParallelBufferPoolManager;
+
  public:
-  explicit BufferPoolManager(size_t pool_size, DiskManager *disk_manager);
+  explicit BufferPoolManager(size_t pool_size, DiskManager *disk_manager,
+                             ReplacerType replacer_type = ReplacerType::LRU);
+
+  virtual ~BufferPoolManager();
+
+  /**
+   * Fetch a page and pin it.
+   * @param page_id id of the page to fetch
+   * @param ring optional bulk-read hint; pages read from disk on behalf of the ring are recycled by it
+   * @return the pinned page, nullptr if every frame is pinned
+   */
+  virtual Page *FetchPage(page_id_t page_id, BufferRing *ring = nullptr);
+
+  /**
+   * Ask for a page to be read into the buffer pool in the background and return immediately. The page is left
+   * unpinned; a FetchPage issued while the read is still in progress waits for it. Pages that are free on disk,
+   * already resident, or that cannot get a frame are skipped.
+   * @return false if the request was dropped because too many prefetches are pending
+   */
+  virtual bool PrefetchPage(page_id_t page_id);
 
-  ~BufferPoolManager();
+  virtual bool UnpinPage(page_id_t page_id, bool is_dirty);
 
-  Page *FetchPage(page_id_t page_id);
+  virtual bool FlushPage(page_id_t page_id);
+
+  virtual Page *NewPage(page_id_t &page_id);
+
+  virtual bool DeletePage(page_id_t page_id);
+
+  virtual bool IsPageFree(page_id_t page_id);
+
+  virtual bool CheckAllUnpinned();
+
+  /** @return the number of frames managed by this buffer pool */
+  virtual size_t GetPoolSize() { return pool_size_; }
+
+  /**
+   * Write at most max_pages unpinned dirty pages back to disk, continuing after the last page written by the
+   * previous call.
+   * @return the number of pages written
+   */
+  virtual size_t FlushDirtyPages(size_t max_pages);
 
-  bool UnpinPage(page_id_t page_id, bool is_dirty);
+  /**
+   * Write every dirty page back to disk, pinned or not, and sync the disk file. Clean pages are not touched.
+   * Pinned pages are read under their read latch, so the caller must not hold the write latch of a dirty page.
+   */
+  virtual void Checkpoint();
 
-  bool FlushPage(page_id_t page_id);
+  /** @return the number of dirty pages in the buffer pool */
+  virtual size_t GetDirtyPageCount();
 
-  Page *NewPage(page_id_t &page_id);
+  /**
+   * Start a background thread that writes dirty pages ahead of eviction and runs periodic checkpoints.
+   * @see BackgroundFlusher
+   */
+  void StartBackgroundFlusher(chrono::milliseconds interval = chrono::milliseconds(FLUSHER_INTERVAL_MS),
+                              size_t pages_per_round = FLUSHER_PAGES_PER_ROUND,
+                              size_t checkpoint_rounds = CHECKPOINT_INTERVAL_ROUNDS);
 
-  bool DeletePage(page_id_t page_id);
+  /** Stop the background flusher, if any. */
+  void StopBackgroundFlusher();
 
-  bool IsPageFree(page_id_t page_id);
-  
-  bool CheckAllUnpinned();
+ protected:
+  /**
+   * Used by pools that own no frames themselves and only dispatch to other instances.
+   */
+  explicit BufferPoolManager(DiskManager *disk_manager);
 
  private:
   /**
@@ -44,8 +108,87 @@ class BufferPoolManager
    */
   void DeallocatePage(page_id_t page_id);
 
+  /**
+   * Fetch and pin a page under latch_.
+   * @param[out] from_disk whether the page had to be read from disk
+   */
+  Page *FetchPageInternal(page_id_t page_id, bool &from_disk);
+
+  /**
+   * Drop an unpinned page from the pool, writing it back if dirty, and return its frame to the free list.
+   * The page stays allocated on disk.
+   * @return false if the page is not resident or is pinned
+   */
+  bool DiscardPage(page_id_t page_id);
+
+  /**
+   * Body of the prefetch thread: load queued pages until StopPrefetcher is called.
+   */
+  void PrefetchWorker();
+
+  /**
+   * Read pages into free or victim frames with one batched submission on io. latch_ is released during the disk
+   * reads; the pages are marked as pending in io_pending_ meanwhile.
+   */
+  void LoadPages(const vector<page_id_t> &page_ids, AsyncIoContext *io);
+
+  /**
+   * Stop the prefetch thread and drop the requests it has not served yet.
+   */
+  void StopPrefetcher();
+
+  /**
+   * Wait until no background read of page_id is in progress. lock must hold latch_ exactly once.
+   */
+  void WaitForIo(unique_lock<recursive_mutex> &lock, page_id_t page_id);
+
+  /**
+   * Drop a resident copy of a page that is being (re)allocated, such as one left behind by a prefetch that ran
+   * just before the page was handed out. Caller must hold latch_ and have waited for its io.
+   * @return false if the resident copy is still pinned, so the page can not be handed out
+   */
+  bool DropStalePage(page_id_t page_id);
+
+  /**
+   * Write every dirty page back to disk without syncing the disk file.
+   */
+  void FlushAllDirtyPages();
+
+  /**
+   * Write a resident page back to disk and mark it clean. Caller must hold latch_.
+   */
+  void WriteBack(Page *page);
+
+  /**
+   * Pin a dirty page for WriteBackBatch and mark it clean. Caller must hold latch_.
+   */
+  void PinForWriteBack(Page *page);
+
+  /**
+   * Write pages pinned by PinForWriteBack back with batched asynchronous writes, then unpin them. latch_ is not
+   * held during the writes: every page is copied under its read latch first and stays in io_pending_ until its
+   * write completes. Pages whose write failed are marked dirty again. Caller must hold flush_latch_.
+   */
+  void WriteBackBatch(const vector<Page *> &pages);
+
+  /**
+   * Take a frame from the free list, or evict one chosen by the replacer (writing it back if dirty).
+   * @return the frame id, INVALID_FRAME_ID if every frame is pinned
+   */
   frame_id_t TryToFindFreePage();
 
+  /**
+   * Bring a page whose id has already been allocated on disk into a fresh, zeroed and pinned frame.
+   * Used when page ids are handed out by someone other than this instance.
+   * @return nullptr if every frame is pinned, or if a stale copy of the page is still pinned here
+   */
+  Page *NewPageWithId(page_id_t page_id);
+
+  /**
+   * Install page_id into frame_id as a new zeroed and pinned page. Caller must hold latch_.
+   */
+  Page *InitNewPage(frame_id_t frame_id, page_id_t page_id);
+
  private:
   size_t pool_size_;                                 // number of pages in buffer pool
   Page *pages_;                                      // array of pages
@@ -54,6 +197,20 @@ class BufferPoolManager
   Replacer *replacer_;                               // to find an unpinned page for replacement
   list<frame_id_t> free_list_;                       // to find a free page for replacement
   recursive_mutex latch_;                            // to protect shared data structure
+  set<page_id_t> dirty_pages_;                       // resident pages that differ from their copy on disk
+  page_id_t flush_cursor_{0};                        // where the next FlushDirtyPages call starts
+  unique_ptr<BackgroundFlusher> flusher_;            // writes dirty pages in the background
+  mutex flush_latch_;                                // serializes write-backs, taken before latch_
+  unique_ptr<AsyncIoContext> flush_io_;              // batches write-backs, created on first use under flush_latch_
+  unordered_set<page_id_t> io_pending_;              // pages being read by the prefetch thread or written back
+  unordered_set<page_id_t> flushing_;                // pages pinned by the write-back in progress
+  condition_variable_any io_cv_;                     // signalled when a background read finishes
+  vector<bool> prefetched_;                          // frames filled by a prefetch and not fetched since
+  thread prefetch_thread_;                           // serves prefetch_queue_, started on first use
+  deque<page_id_t> prefetch_queue_;                  // pages waiting to be prefetched
+  mutex prefetch_latch_;                             // protects prefetch_queue_ and prefetch_stop_
+  condition_variable prefetch_cv_;                   // signalled when a request is queued
+  bool prefetch_stop_{false};
 };
 
 #endif  // MINISQL_BUFFER_POOL_MANAGER_H
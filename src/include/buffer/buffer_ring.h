@@ -0,0 +1,62 @@
+#ifndef MINISQL_BUFFER_RING_H
+#define MINISQL_BUFFER_RING_H
+
+#include <deque>
+#include <utility>
+
+#include "common/config.h"
+
+using namespace std;
+
+class BufferPoolManager;
+
+/**
+ * BufferRing is a bulk-read access hint passed to BufferPoolManager::FetchPage by large sequential scans.
+ *
+ * The ring remembers the pages the scan itself had to read from disk. Once the scan has brought in more than
+ * activation_threshold pages, it keeps at most ring_size of them in the buffer pool: older pages are handed back
+ * to their pool's free list, and the next pages of the scan reuse those frames. A full scan of a large table thus
+ * recycles a small private set of frames instead of flushing the whole working set, while small tables still stay
+ * cached. Pages that were already resident when the scan touched them are never released by the ring.
+ *
+ * A ring belongs to a single scan and is not thread-safe.
+ */
+class BufferRing {
+ public:
+  /**
+   * @param ring_size number of scan pages that may stay in the pool once the ring is active
+   * @param activation_threshold number of pages the scan may read before the ring starts recycling frames
+   */
+  explicit BufferRing(size_t ring_size = BULK_READ_RING_SIZE, size_t activation_threshold = 0);
+
+  /**
+   * Build a ring for a bulk read through a pool of pool_size frames: recycling starts once the scan has read
+   * 1 / BULK_READ_POOL_FRACTION of the pool.
+   */
+  static BufferRing ForBulkRead(size_t pool_size);
+
+  /**
+   * Record that bpm read page_id from disk on behalf of this scan.
+   */
+  void Add(BufferPoolManager *bpm, page_id_t page_id);
+
+  /**
+   * Take the next page the scan should give back to its pool.
+   * @return false if the ring holds no page that needs to be released
+   */
+  bool NextToRelease(BufferPoolManager **bpm, page_id_t *page_id);
+
+  /** @return whether the scan has read enough pages for the ring to recycle frames */
+  bool IsActive() const { return pages_read_ > activation_threshold_; }
+
+  /** @return number of scan pages the ring currently tracks */
+  size_t Size() const { return pages_.size(); }
+
+ private:
+  size_t ring_size_;
+  size_t activation_threshold_;
+  size_t pages_read_{0};
+  deque<pair<BufferPoolManager *, page_id_t>> pages_;  // pages read by this scan, oldest first
+};
+
+#endif  // MINISQL_BUFFER_RING_H
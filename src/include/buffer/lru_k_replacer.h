@@ -0,0 +1,67 @@
+#ifndef MINISQL_LRU_K_REPLACER_H
+#define MINISQL_LRU_K_REPLACER_H
+
+#include <deque>
+#include <set>
+#include <unordered_map>
+#include <utility>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+using namespace std;
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * Every Pin counts as one access to the frame. The backward K-distance of a frame is the difference between the
+ * current time and the time of its K-th most recent access. Victim evicts the frame with the largest backward
+ * K-distance. Frames with fewer than K recorded accesses have an infinite backward K-distance and are evicted first,
+ * oldest first access first, so pages touched once by a large scan leave the pool before frequently used pages.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k number of past accesses remembered per frame
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = LRUK_REPLACER_K);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+ private:
+  struct FrameHistory {
+    deque<size_t> accesses_;  // timestamps of the last k accesses, oldest first
+    bool evictable_{false};
+    bool in_cache_list_{false};
+    pair<size_t, frame_id_t> key_;  // position in history_list_ or cache_list_ while evictable
+  };
+
+  /**
+   * Remove an evictable frame from the list it is in.
+   */
+  void Erase(FrameHistory &history);
+
+  size_t capacity_;
+  size_t k_;
+  size_t current_timestamp_{0};
+  unordered_map<frame_id_t, FrameHistory> histories_;
+  set<pair<size_t, frame_id_t>> history_list_;  // evictable frames with fewer than k accesses
+  set<pair<size_t, frame_id_t>> cache_list_;    // evictable frames with k accesses, by k-th most recent access
+};
+
+#endif  // MINISQL_LRU_K_REPLACER_H
@@ -0,0 +1,65 @@
+#ifndef MINISQL_PARALLEL_BUFFER_POOL_MANAGER_H
+#define MINISQL_PARALLEL_BUFFER_POOL_MANAGER_H
+
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+
+/**
+ * ParallelBufferPoolManager splits the buffer pool into several independent BufferPoolManager instances, each with
+ * its own frames, page table, replacer and latch. A page always lives in the instance chosen by hashing its page id,
+ * so threads touching different pages rarely contend on the same latch. It exposes the same interface as
+ * BufferPoolManager and can be used wherever a BufferPoolManager is expected.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * @param num_instances number of buffer pool instances
+   * @param pool_size total number of frames, split evenly across the instances
+   * @param disk_manager disk manager shared by all instances
+   * @param replacer_type replacement policy used by every instance
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            ReplacerType replacer_type = ReplacerType::LRU);
+
+  ~ParallelBufferPoolManager() override;
+
+  Page *FetchPage(page_id_t page_id, BufferRing *ring = nullptr) override;
+
+  bool PrefetchPage(page_id_t page_id) override;
+
+  bool UnpinPage(page_id_t page_id, bool is_dirty) override;
+
+  bool FlushPage(page_id_t page_id) override;
+
+  Page *NewPage(page_id_t &page_id) override;
+
+  bool DeletePage(page_id_t page_id) override;
+
+  bool IsPageFree(page_id_t page_id) override;
+
+  bool CheckAllUnpinned() override;
+
+  size_t GetPoolSize() override { return pool_size_; }
+
+  size_t FlushDirtyPages(size_t max_pages) override;
+
+  void Checkpoint() override;
+
+  size_t GetDirtyPageCount() override;
+
+  size_t GetNumInstances() const { return instances_.size(); }
+
+ private:
+  /**
+   * @return the instance responsible for page_id
+   */
+  BufferPoolManager *GetInstance(page_id_t page_id) { return instances_[page_id % instances_.size()]; }
+
+ private:
+  size_t pool_size_;                        // total number of frames over all instances
+  vector<BufferPoolManager *> instances_;   // buffer pool instances
+  DiskManager *disk_manager_;               // shared disk manager used to hand out page ids
+};
+
+#endif  // MINISQL_PARALLEL_BUFFER_POOL_MANAGER_H
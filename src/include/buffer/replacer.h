@@ -4,6 +4,11 @@
 #include <cstdio>
 #include "common/config.h"
 
+/**
+ * Replacement policies a BufferPoolManager can be built with.
+ */
+enum class ReplacerType { LRU, CLOCK, LRU_K };
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -32,6 +37,12 @@ public:
    */
   virtual void Unpin(frame_id_t frame_id) = 0;
 
+  /**
+   * Forget a frame whose page has been dropped from the buffer pool. The frame is no longer victimizable.
+   * @param frame_id the id of the frame to remove
+   */
+  virtual void Remove(frame_id_t frame_id) { Pin(frame_id); }
+
   /** @return the number of elements in the replacer that can be victimized */
   virtual size_t Size() = 0;
 };
@@ -7,7 +7,9 @@
 #include "common/macros.h"
 #include "common/rowid.h"
 #include "index/b_plus_tree_index.h"
+#include "index/fixed_key_b_plus_tree_index.h"
 #include "index/generic_key.h"
+#include "index/slotted_b_plus_tree_index.h"
 #include "record/schema.h"
 
 class IndexMetadata {
@@ -81,6 +83,9 @@ class IndexInfo {
 
   IndexSchema *GetIndexKeySchema() { return key_schema_; }
 
+  // whether the index rejects duplicate keys, which it does if any of its key columns is unique
+  bool IsUnique() const;
+
  private:
   explicit IndexInfo() : meta_data_{nullptr}, index_{nullptr}, key_schema_{nullptr} {}
 
@@ -23,7 +23,7 @@ class TableMetadata {
    * will create new table schema and owned by mem heap
    */
   static TableMetadata *Create(table_id_t table_id, std::string table_name, page_id_t root_page_id,
-                               TableSchema *schema);
+                               page_id_t free_space_map_page_id, TableSchema *schema);
 
   inline table_id_t GetTableId() const { return table_id_; }
 
@@ -31,18 +31,24 @@ class TableMetadata {
 
   inline uint32_t GetFirstPageId() const { return root_page_id_; }
 
+  inline page_id_t GetFreeSpaceMapPageId() const { return free_space_map_page_id_; }
+
   inline Schema *GetSchema() const { return schema_; }
 
  private:
   TableMetadata() = delete;
 
-  TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema);
+  TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id,
+                page_id_t free_space_map_page_id, TableSchema *schema);
 
  private:
-  static constexpr uint32_t TABLE_METADATA_MAGIC_NUM = 344528;
+  static constexpr uint32_t TABLE_METADATA_MAGIC_NUM = 344529;
+  // metadata written before the free space map page id was stored, read with an in-memory free space map
+  static constexpr uint32_t TABLE_METADATA_NO_FSM_MAGIC_NUM = 344528;
   table_id_t table_id_;
   std::string table_name_;
   page_id_t root_page_id_;   // the first page of table_heap
+  page_id_t free_space_map_page_id_;   // the root page of table_heap's free space map
   Schema *schema_;
 };
 
@@ -1,6 +1,7 @@
 #ifndef MINISQL_CONFIG_H
 #define MINISQL_CONFIG_H
 
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 
@@ -15,6 +16,21 @@ static constexpr int INDEX_ROOTS_PAGE_ID = 1;   // logical page id of the index
 
 static constexpr int PAGE_SIZE = 4096;                  // size of a data page in byte
 static constexpr int DEFAULT_BUFFER_POOL_SIZE = 20480;  // default size of buffer pool
+static constexpr int DEFAULT_BUFFER_POOL_INSTANCES = 8;  // default number of buffer pool instances
+static constexpr size_t LRUK_REPLACER_K = 2;             // number of past accesses tracked by the LRU-K replacer
+static constexpr size_t BULK_READ_RING_SIZE = 32;        // frames a large sequential scan may keep in the pool
+static constexpr size_t BULK_READ_POOL_FRACTION = 4;     // scans reading more than 1/4 of the pool use a ring
+static constexpr int FLUSHER_INTERVAL_MS = 50;            // time between two rounds of the background flusher
+static constexpr size_t FLUSHER_PAGES_PER_ROUND = 256;    // dirty pages written per background flusher round
+static constexpr size_t CHECKPOINT_INTERVAL_ROUNDS = 100; // background flusher rounds between two checkpoints
+static constexpr size_t PREFETCH_QUEUE_SIZE = 64;         // pending prefetch requests per buffer pool instance
+static constexpr size_t TABLE_SCAN_READAHEAD_PAGES = 8;   // heap pages a sequential scan reads ahead
+static constexpr size_t ASYNC_IO_QUEUE_DEPTH = 32;        // page requests one async I/O context keeps in flight
+static constexpr size_t ASYNC_IO_THREADS = 4;             // threads serving async I/O when io_uring is unavailable
+static constexpr size_t INSERT_BATCH_SIZE = 1024;         // rows an insert executor hands to the table heap at once
+static constexpr int OPTIMISTIC_READ_RETRIES = 8;          // optimistic B+ tree descents before taking read latches
+static constexpr size_t INDEX_BUILD_SORT_MEMORY = 64 << 20; // bytes an index build sorts in memory before spilling
+static constexpr double INDEX_FILL_FACTOR = 0.9;            // fraction of each B+ tree page filled by a bulk load
 
 static constexpr uint32_t FIELD_NULL_LEN = UINT32_MAX;
 static constexpr uint32_t VARCHAR_MAX_LEN = PAGE_SIZE / 2;  // max length of varchar
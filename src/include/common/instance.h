@@ -5,6 +5,7 @@
 #include <string>
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/parallel_buffer_pool_manager.h"
 #include "catalog/catalog.h"
 #include "common/config.h"
 #include "common/dberr.h"
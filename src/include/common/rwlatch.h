@@ -1,6 +1,7 @@
 #ifndef MINISQL_RWLATCH_H
 #define MINISQL_RWLATCH_H
 
+#include <atomic>
 #include <climits>
 #include <condition_variable>
 #include <mutex>
@@ -85,4 +86,53 @@ class ReaderWriterLatch {
   bool writer_entered_{false};
 };
 
+/**
+ * Version counter for optimistic reads, also known as a sequence lock. Writers are serialized by another latch and
+ * make the version odd while they modify the protected data, even again when they are done. A reader records the
+ * version, reads without locking and validates afterwards that the version did not change, retrying otherwise.
+ * Unlike ReaderWriterLatch, readers never write to the latch, so they do not bounce its cache line between cores.
+ */
+class VersionLatch {
+ public:
+  VersionLatch() = default;
+
+  DISALLOW_COPY(VersionLatch);
+
+  /**
+   * Mark the start of a write. The caller must exclude other writers.
+   */
+  void BeginWrite() {
+    version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    /* the odd version becomes visible before any of the writes that follow */
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  /**
+   * Mark the end of a write.
+   */
+  void EndWrite() { version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+  /**
+   * Record the version before an optimistic read.
+   * @return false if a writer is active, the read must be retried then
+   */
+  bool ReadVersion(uint64_t &version) const {
+    version = version_.load(std::memory_order_acquire);
+    return (version & 1) == 0;
+  }
+
+  /**
+   * @return true if no writer started since ReadVersion returned version, i.e. everything read in between is
+   * consistent
+   */
+  bool Validate(uint64_t version) const {
+    /* the reads before stay before the version check */
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
+
+ private:
+  std::atomic<uint64_t> version_{0};
+};
+
 #endif  // MINISQL_RWLATCH_H
@@ -5,6 +5,7 @@
 #include "catalog/catalog.h"
 #include "common/macros.h"
 #include "transaction/transaction.h"
+#include "utils/mem_heap.h"
 
 class ExecuteContext {
  public:
@@ -30,6 +31,12 @@ class ExecuteContext {
   /** @return the buffer pool manager */
   BufferPoolManager *GetBufferPoolManager() { return bpm_; }
 
+  /**
+   * @return the arena that rows produced by this query can be built in. Everything allocated in it is released at
+   * once when the context is destroyed, so rows using it must not outlive the context.
+   */
+  ArenaMemHeap *GetArena() { return &arena_; }
+
   bool flag_quit_;
 
  private:
@@ -39,6 +46,8 @@ class ExecuteContext {
   CatalogManager *catalog_;
   /** The buffer pool manager associated with this executor context */
   BufferPoolManager *bpm_;
+  /** Per-query arena for the rows produced while executing */
+  ArenaMemHeap arena_;
 };
 
 #endif  // MINISQL_EXECUTE_CONTEXT_H
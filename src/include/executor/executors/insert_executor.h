@@ -12,7 +12,8 @@
 /**
  * InsertExecutor executes an insert on a table.
  *
- * Inserted values are always pulled from a child executor.
+ * Inserted values are always pulled from a child executor. They are inserted into the table heap in batches of up
+ * to INSERT_BATCH_SIZE rows and then returned one by one.
  */
 class InsertExecutor : public AbstractExecutor {
  public:
@@ -42,9 +43,22 @@ class InsertExecutor : public AbstractExecutor {
   const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
 
  private:
+  /**
+   * Pull the next batch of rows from the child and insert them into the table and its indexes.
+   * @return false if the child has no more rows or the insert failed
+   */
+  bool InsertBatch();
+
+  /** @return true if two of keys are equal, keys with a null field equal no other key */
+  static bool HasDuplicateKeys(const std::vector<Row> &keys);
+
   /** The insert plan node to be executed*/
   const InsertPlanNode *plan_;
   std::unique_ptr<AbstractExecutor> child_executor_;
+  /** Rows of the current batch, with the rids they were inserted at */
+  std::vector<Row> batch_;
+  /** Next row of batch_ to return */
+  size_t cursor_{0};
 };
 
 #endif  // MINISQL_INSERT_EXECUTOR_H
@@ -5,6 +5,8 @@
 #ifndef MINISQL_SEQ_SCAN_EXECUTOR_H
 #define MINISQL_SEQ_SCAN_EXECUTOR_H
 
+#include <functional>
+#include <memory>
 #include <vector>
 
 #include "executor/execute_context.h"
@@ -12,7 +14,8 @@
 #include "executor/plans/seq_scan_plan.h"
 
 /**
- * The SeqScanExecutor executor executes a sequential table scan.
+ * The SeqScanExecutor executor executes a sequential table scan. Tuples are read a heap page at a time and the
+ * predicate is evaluated on their serialized bytes; only the tuples that satisfy it are turned into rows.
  */
 class SeqScanExecutor : public AbstractExecutor {
  public:
@@ -41,8 +44,18 @@ class SeqScanExecutor : public AbstractExecutor {
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
   TableHeap *table_heap_;
-  TableIterator cur_;
+  /** Bulk-read ring that keeps a large scan from flushing the buffer pool */
+  std::unique_ptr<BufferRing> ring_;
+  std::unique_ptr<TableBatchIterator> batch_itr_;
+  /** Matching tuples of the current heap page, built in batch_heap_ */
+  std::vector<Row> batch_;
+  /** Holds the rows of one batch; reset before the next page is read */
+  ArenaMemHeap batch_heap_;
+  /** Next tuple of batch_ to return */
+  size_t cursor_{0};
   AbstractExpressionRef filter_predicate_;
+  /** Predicate evaluated on the tuple bytes, so that only matching tuples are deserialized */
+  std::function<bool(const RowView &)> filter_;
 };
 
 #endif  // MINISQL_SEQ_SCAN_EXECUTOR_H
@@ -1,11 +1,18 @@
 #ifndef MINISQL_B_PLUS_TREE_H
 #define MINISQL_B_PLUS_TREE_H
 
+#include <atomic>
+#include <fstream>
+#include <functional>
 #include <queue>
 #include <string>
 #include <vector>
 
+#include "common/rwlatch.h"
 #include "index/index_iterator.h"
+#include "index/index_range_iterator.h"
+#include "index/page_reclaimer.h"
+#include "index/posting_list.h"
 #include "page/b_plus_tree_internal_page.h"
 #include "page/b_plus_tree_leaf_page.h"
 #include "page/b_plus_tree_page.h"
@@ -16,10 +23,25 @@
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) Keys are unique unless the tree is created non-unique. A key of a non-unique tree is then stored once, and
+ *     all its row ids beyond the first go to a sorted posting list in overflow pages (see PostingList).
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ * (5) Safe for concurrent readers and writers through latch crabbing. Lookups take read latches top-down and release
+ *     each parent once its child is latched. Insert and Remove first descend optimistically, write-latching only the
+ *     leaf, and apply the change there if the leaf can neither split nor underflow. Otherwise they restart with write
+ *     latches from the root, releasing all ancestors of a page as soon as that page is safe for the operation.
+ *     root_latch_ protects root_page_id_ and is held until the root page is latched, or for the whole operation if
+ *     the root itself may change.
+ * (6) Leaves are linked in both directions, so iterators and range scans also run in descending key order, and the
+ *     smallest and largest keys take one descent to the leftmost or rightmost leaf. A writer that relinks a leaf
+ *     write-latches its right neighbour, which may belong to another parent; leaves of one parent are only latched
+ *     right to left while that parent is held.
+ * (7) Before crabbing, descents try optimistic lock coupling on the page versions: internal pages are read without
+ *     latches and each one is validated after its child's version is recorded, so that read-heavy lookups write no
+ *     shared latch state. GetValue does not even latch the leaf. A descent that keeps colliding with writers falls
+ *     back to crabbing after OPTIMISTIC_READ_RETRIES attempts.
  */
 class BPlusTree {
   using InternalPage = BPlusTreeInternalPage;
@@ -27,32 +49,81 @@ class BPlusTree {
 
  public:
   explicit BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager, const KeyManager &comparator,
-                     int leaf_max_size = UNDEFINED_SIZE, int internal_max_size = UNDEFINED_SIZE);
+                     int leaf_max_size = UNDEFINED_SIZE, int internal_max_size = UNDEFINED_SIZE, bool unique = true);
 
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
 
-  // Insert a key-value pair into this B+ tree. Return false when duplicate.
+  // Insert a key-value pair into this B+ tree. Return false when the key (the pair if not unique) is a duplicate.
   bool Insert(GenericKey *key, const RowId &value, Transaction *transaction = nullptr);
 
-  // Remove a key and its value from this B+ tree.
+  // Remove a key and all its values from this B+ tree.
   void Remove(const GenericKey *key, Transaction *transaction = nullptr);
 
-  // return the value associated with a given key
+  // Remove one key-value pair from this B+ tree, the key goes away with its last value.
+  void Remove(const GenericKey *key, const RowId &value, Transaction *transaction = nullptr);
+
+  // return the values associated with a given key, in row id order if there are several
   bool GetValue(const GenericKey *key, std::vector<RowId> &result, Transaction *transaction = nullptr);
 
+  /**
+   * Look up a batch of keys with one shared descent: the keys are visited in sorted order, and each one only climbs
+   * the pinned path as far as the lowest page whose range covers it, instead of starting over from the root.
+   * @param result resized to the number of keys, result[i] receives the values of keys[i] as GetValue returns them
+   * @return the number of keys that exist
+   */
+  size_t GetValues(const std::vector<GenericKey *> &keys, std::vector<std::vector<RowId>> &result,
+                   Transaction *transaction = nullptr);
+
+  /**
+   * Build the tree bottom-up from entries sorted by key, filling pages to fill_factor of their capacity. An entry
+   * whose key equals the previous one is skipped in a unique tree, as Insert would reject it, and goes to the
+   * key's posting list otherwise.
+   * @param next stores the next entry and returns true, or returns false after the last one
+   * @return false if the tree is not empty
+   */
+  bool BulkLoad(const std::function<bool(GenericKey *&key, RowId &value)> &next,
+                double fill_factor = INDEX_FILL_FACTOR);
+
   IndexIterator Begin();
 
   IndexIterator Begin(const GenericKey *key);
 
   IndexIterator End();
 
-  // expose for test purpose
+  // Reverse iterators, over all entries or those with keys not greater than key, going down to End()
+  IndexIterator RBegin();
+
+  IndexIterator RBegin(const GenericKey *key);
+
+  /**
+   * Copy the smallest key (the largest if max is true) to key, which must have room for a key of this tree, and
+   * append its values to result, in row id order.
+   * @return false if the tree is empty
+   */
+  bool GetExtreme(bool max, GenericKey *key, std::vector<RowId> &result, Transaction *transaction = nullptr);
+
+  /**
+   * Scan the keys between lower and upper, whose inclusive flags tell whether a key equal to them is in range.
+   * A null bound leaves that side of the range open. The iterator returns the row ids leaf by leaf, starting from
+   * upper and in descending order if reverse is true.
+   */
+  IndexRangeIterator BeginRange(const GenericKey *lower, bool lower_inclusive, const GenericKey *upper,
+                                bool upper_inclusive, bool reverse = false);
+
+  // Append the values of all keys between lower and upper to result, in key order (descending if reverse)
+  void ScanRange(const GenericKey *lower, bool lower_inclusive, const GenericKey *upper, bool upper_inclusive,
+                 std::vector<RowId> &result, Transaction *transaction = nullptr, bool reverse = false);
+
+  // expose for test purpose, takes no latches
   Page *FindLeafPage(const GenericKey *key, page_id_t page_id = INVALID_PAGE_ID, bool leftMost = false);
 
   // used to check whether all pages are unpinned
   bool Check();
 
+  // number of removed pages not freed yet because readers still pin them, for tests
+  size_t GetPendingDeleteCount() { return page_reclaimer_.GetPendingCount(); }
+
   // destroy the b plus tree
   void Destroy(page_id_t current_page_id = INVALID_PAGE_ID);
 
@@ -68,25 +139,128 @@ class BPlusTree {
   }
 
  private:
+  // operation a descent is made for, deciding when a page is safe
+  enum class Operation { INSERT, REMOVE };
+
+  /**
+   * Pages write-latched by a pessimistic operation, from the highest one kept down to the leaf, and pages it
+   * removed from the tree. Everything is released together by ReleaseWriteSet.
+   */
+  struct WriteSet {
+    std::vector<Page *> latched_pages_;
+    std::vector<page_id_t> deleted_pages_;
+    bool root_locked_{false};
+  };
+
+  // Fetch and latch a page for a descent: a write latch on the leaf of an optimistic write, a read latch otherwise
+  Page *FetchLatched(page_id_t page_id, bool write_leaf);
+
+  // The child of page a descent for key goes on with, see FindLeafPageLatched for a null key
+  page_id_t ChildToFollow(InternalPage *page, const GenericKey *key, bool leftMost);
+
+  // Crab down from the latched page to a leaf, which is returned pinned and latched
+  Page *DescendLatched(Page *page, const GenericKey *key, bool leftMost, bool write_leaf);
+
+  /**
+   * Descend from the root without latches, validating every internal page after its child's version is recorded.
+   * @return the pinned but unlatched leaf, whose version is stored in version, or nullptr if the tree is empty or
+   * a writer got in the way
+   */
+  Page *FindLeafPageOptimistic(const GenericKey *key, bool leftMost, uint64_t &version);
+
+  // Descend optimistically, falling back to crabbing from the root. Return nullptr if the tree is empty. A null key
+  // finds the leftmost leaf if leftMost is true and the rightmost one otherwise.
+  Page *FindLeafPageLatched(const GenericKey *key, bool leftMost = false, bool write_leaf = false);
+
+  // a page on the path shared by the keys of GetValues, pinned but not latched
+  struct PathEntry {
+    Page *page_;
+    // version of the page when its parent routed to it
+    uint64_t version_;
+    // index of the child the path continues with, -1 on the leaf
+    int child_;
+  };
+
+  /**
+   * Find the values of key starting from path, which is left ending at the leaf of key. key must not be less than
+   * the key the path was last used for.
+   * @return false if a writer got in the way, the path must then be released
+   */
+  bool GetValueOnPath(const GenericKey *key, std::vector<PathEntry> &path, std::vector<RowId> &result,
+                      bool &key_exists);
+
+  // Write-latch the path from the root, return nullptr (with root_latch_ held) if the tree is empty
+  Page *FindLeafPagePessimistic(const GenericKey *key, Operation op, WriteSet &write_set);
+
+  // Whether op applied below node can never change node's parent
+  bool IsSafe(BPlusTreePage *node, Operation op) const;
+
+  // Add value to the values of key, which is in the write latched leaf. Return false if the pair exists.
+  bool InsertIntoPostingList(LeafPage *leaf, GenericKey *key, const RowId &value);
+
+  // what removing a pair does to the leaf holding its key
+  enum class RemoveAction { NONE, VALUE_REMOVED, REMOVE_KEY };
+
+  /**
+   * Remove value (all values if nullptr) of key from the write latched leaf as far as the leaf itself stays put:
+   * a value leaving a posting list is removed right away, while the key has to go if it loses its only value.
+   */
+  RemoveAction RemoveFromPostingList(LeafPage *leaf, const GenericKey *key, const RowId *value);
+
+  // Remove key from the leaf and free its posting list, return the new size of the leaf
+  int RemoveKey(LeafPage *leaf, const GenericKey *key);
+
+  // Remove value of key, or the key with all its values if value is nullptr
+  void RemoveEntry(const GenericKey *key, const RowId *value);
+
+  // Release root_latch_ and every latched page except the last one
+  void ReleaseAncestors(WriteSet &write_set);
+
+  // Release everything held by write_set, then delete the pages it removed from the tree
+  void ReleaseWriteSet(WriteSet &write_set);
+
+  // the two rightmost pages of one level during a bulk load
+  struct BulkLoadLevel {
+    // already appended to the level above, kept pinned so that cur_ can borrow from it at the end
+    Page *prev_{nullptr};
+    Page *cur_{nullptr};
+  };
+
+  // Start a new rightmost page on level, appending the page it replaces to the level above
+  void BulkLoadNextPage(std::vector<BulkLoadLevel> &levels, size_t level, int internal_fill);
+
+  // Append a child to the rightmost page of internal level, starting a new page once it holds internal_fill children
+  void BulkLoadAppend(std::vector<BulkLoadLevel> &levels, size_t level, GenericKey *key, page_id_t child,
+                      int internal_fill);
+
+  // Fix up the last page of every level and return the root
+  page_id_t BulkLoadFinish(std::vector<BulkLoadLevel> &levels, int internal_fill);
+
   void StartNewTree(GenericKey *key, const RowId &value);
 
-  bool InsertIntoLeaf(GenericKey *key, const RowId &value, Transaction *transaction = nullptr);
+  bool InsertIntoLeaf(GenericKey *key, const RowId &value, WriteSet &write_set);
 
   void InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlusTreePage *new_node,
                         Transaction *transaction = nullptr);
 
+  // The new page is returned pinned
   LeafPage *Split(LeafPage *node, Transaction *transaction);
 
+  // Point the prev link of the leaf after leaf back at it, write-latching that leaf
+  void LinkBackFromNext(LeafPage *leaf);
+
+  // Start a reverse iterator at entry idx of the read latched leaf, below the keys of leaf on an earlier one if idx < 0
+  IndexIterator RBeginAt(Page *page, int idx);
+
   InternalPage *Split(InternalPage *node, Transaction *transaction);
 
   template <typename N>
-  bool CoalesceOrRedistribute(N *&node, Transaction *transaction = nullptr);
+  void CoalesceOrRedistribute(N *node, WriteSet &write_set);
 
-  bool Coalesce(InternalPage *&neighbor_node, InternalPage *&node, InternalPage *&parent, int index,
-                Transaction *transaction = nullptr);
+  void Coalesce(InternalPage *neighbor_node, InternalPage *node, InternalPage *parent, int index,
+                WriteSet &write_set);
 
-  bool Coalesce(LeafPage *&neighbor_node, LeafPage *&node, InternalPage *&parent, int index,
-                Transaction *transaction = nullptr);
+  void Coalesce(LeafPage *neighbor_node, LeafPage *node, InternalPage *parent, int index, WriteSet &write_set);
 
   void Redistribute(LeafPage *neighbor_node, LeafPage *node, int index);
 
@@ -103,11 +277,17 @@ class BPlusTree {
 
   // member variable
   index_id_t index_id_;
-  page_id_t root_page_id_{INVALID_PAGE_ID};
+  // read without root_latch_ by optimistic descents
+  std::atomic<page_id_t> root_page_id_{INVALID_PAGE_ID};
+  // held by writers changing root_page_id_, and by crabbing descents until the root page is latched
+  ReaderWriterLatch root_latch_;
   BufferPoolManager *buffer_pool_manager_;
   KeyManager processor_;
+  // frees the pages write sets remove from the tree
+  PageReclaimer page_reclaimer_;
   int leaf_max_size_;
   int internal_max_size_;
+  bool unique_;
 };
 
 #endif  // MINISQL_B_PLUS_TREE_H
@@ -7,7 +7,9 @@
 
 class BPlusTreeIndex : public Index {
  public:
-  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, BufferPoolManager *buffer_pool_manager);
+  // a non-unique index keeps a posting list of row ids for every key that occurs in several rows
+  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, BufferPoolManager *buffer_pool_manager,
+                 bool unique = true);
 
   dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) override;
 
@@ -15,14 +17,37 @@ class BPlusTreeIndex : public Index {
 
   dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn, string compare_operator = "=") override;
 
+  // Read the smallest or largest key from the leftmost or rightmost leaf
+  dberr_t ScanExtreme(bool max, Row &key, std::vector<RowId> &result, Transaction *txn) override;
+
+  // Resolve all keys in one pass over the tree, see BPlusTree::GetValues
+  dberr_t ScanKeys(const std::vector<Row> &keys, std::vector<std::vector<RowId>> &result, Transaction *txn) override;
+
   dberr_t Destroy() override;
 
+  // Sort the entries of every source on its own thread, externally if they do not fit into memory, merge them in
+  // parallel and build the tree bottom-up if it is empty
+  dberr_t BulkLoad(const std::vector<EntrySource> &sources, Transaction *txn) override;
+
   IndexIterator GetBeginIterator();
 
   IndexIterator GetBeginIterator(GenericKey *key);
 
   IndexIterator GetEndIterator();
 
+  // Iterators over the entries in descending key order, which end at GetEndIterator(). No executor uses them yet.
+  IndexIterator GetRBeginIterator();
+
+  IndexIterator GetRBeginIterator(GenericKey *key);
+
+  /**
+   * Scan the keys between lower and upper, null for an open side, returning their row ids in batches. The inclusive
+   * flags tell whether keys equal to a bound are in range. A reverse iterator starts from upper and returns the row
+   * ids in descending order. The fixed key and slotted indexes offer the same scan; no executor plans one yet.
+   */
+  IndexRangeIterator GetRangeIterator(const Row *lower, bool lower_inclusive, const Row *upper, bool upper_inclusive,
+                                      bool reverse = false);
+
  protected:
   // comparator for key
   KeyManager processor_;
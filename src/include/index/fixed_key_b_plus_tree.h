@@ -0,0 +1,17 @@
+#ifndef MINISQL_FIXED_KEY_B_PLUS_TREE_H
+#define MINISQL_FIXED_KEY_B_PLUS_TREE_H
+
+#include "index/specialized_b_plus_tree.h"
+#include "page/fixed_key_b_plus_tree_page.h"
+
+/**
+ * B+ tree specialized for keys of one fixed-width type, instantiated for int32_t and float.
+ *
+ * It keeps the contract of BPlusTree but stores plain KeyType values, so pages hold more entries and key comparisons
+ * compile down to a single instruction instead of going through KeyManager. The tree algorithms are those of
+ * SpecializedBPlusTree.
+ */
+template <typename KeyType>
+using FixedKeyBPlusTree = SpecializedBPlusTree<FixedKeyFormat<KeyType>>;
+
+#endif  // MINISQL_FIXED_KEY_B_PLUS_TREE_H
@@ -0,0 +1,55 @@
+#ifndef MINISQL_FIXED_KEY_B_PLUS_TREE_INDEX_H
+#define MINISQL_FIXED_KEY_B_PLUS_TREE_INDEX_H
+
+#include "index/fixed_key_b_plus_tree.h"
+#include "index/index.h"
+
+/**
+ * Index on a single non-nullable int or float column, backed by FixedKeyBPlusTree.
+ * KeyType must match the column type: int32_t for kTypeInt, float for kTypeFloat.
+ */
+template <typename KeyType>
+class FixedKeyBPlusTreeIndex : public Index {
+ public:
+  // a non-unique index keeps a posting list of row ids for every key that occurs in several rows
+  FixedKeyBPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, BufferPoolManager *buffer_pool_manager,
+                         bool unique = true);
+
+  dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  dberr_t RemoveEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn, string compare_operator = "=") override;
+
+  // Resolve all keys in one pass over the tree, see SpecializedBPlusTree::GetValues
+  dberr_t ScanKeys(const std::vector<Row> &keys, std::vector<std::vector<RowId>> &result, Transaction *txn) override;
+
+  // Read the smallest or largest key from the leftmost or rightmost leaf
+  dberr_t ScanExtreme(bool max, Row &key, std::vector<RowId> &result, Transaction *txn) override;
+
+  dberr_t Destroy() override;
+
+  // Sort the entries of every source on its own thread, externally if they do not fit into memory, merge them in
+  // parallel and build the tree bottom-up if it is empty
+  dberr_t BulkLoad(const std::vector<EntrySource> &sources, Transaction *txn) override;
+
+  /**
+   * Scan the keys between lower and upper, null for an open side, as BPlusTreeIndex::GetRangeIterator does. A bound
+   * whose field is null leaves the range empty.
+   */
+  typename FixedKeyBPlusTree<KeyType>::RangeIterator GetRangeIterator(const Row *lower, bool lower_inclusive,
+                                                                      const Row *upper, bool upper_inclusive,
+                                                                      bool reverse = false);
+
+ protected:
+  /**
+   * Read the key value out of the first field of key.
+   * @return false if the field is null
+   */
+  static bool ExtractKey(const Row &key, KeyType *value);
+
+  // container
+  FixedKeyBPlusTree<KeyType> container_;
+};
+
+#endif  // MINISQL_FIXED_KEY_B_PLUS_TREE_INDEX_H
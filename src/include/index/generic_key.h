@@ -22,64 +22,82 @@ class GenericKey {
   char data[0];
 };
 
+/**
+ * KeyManager turns key rows into GenericKeys and compares them.
+ *
+ * Keys are stored in an order-preserving normalized form, so that two keys compare like their rows with a single
+ * memcmp. Every key column is encoded as a null flag byte (0 for null, which sorts first, 1 otherwise) followed by a
+ * fixed-width image of its value:
+ *  - int:   4 bytes, big-endian with the sign bit flipped
+ *  - float: 4 bytes, big-endian IEEE bits with the sign bit flipped for positive values and all bits flipped for
+ *           negative ones (-0.0 is stored as 0.0)
+ *  - char:  the data zero-padded to the column length, then its length as 4 big-endian bytes
+ * The image of a null value is all zeros. The rest of the key buffer is zero-filled as well.
+ *
+ * Pages that store keys of variable length use the compact form of a normalized key (see ToCompactKey), which drops
+ * the padding of char columns and orders the same way under a byte-wise comparison.
+ */
 class KeyManager {
  public: /**/
+  /** Largest key size an index is created with */
+  static constexpr int MAX_KEY_SIZE = 256;
+
   [[nodiscard]] inline GenericKey *InitKey() const {
     return (GenericKey *)malloc(key_size_);  // remember delete
   }
 
-  inline void SerializeFromKey(GenericKey *key_buf, const Row &key, Schema *schema) const {
-    // initialize to 0
-    [[maybe_unused]] uint32_t size = key.GetSerializedSize(schema);
-    ASSERT(key.GetFieldCount() == schema->GetColumnCount(), "field nums not match.");
-    ASSERT(size <= (uint32_t)key_size_, "Index key size exceed max key size.");
-    memset(key_buf->data, 0, key_size_);
-    key.SerializeTo(key_buf->data, schema);
-  }
+  void SerializeFromKey(GenericKey *key_buf, const Row &key, Schema *schema) const;
 
-  inline void DeserializeToKey(const GenericKey *key_buf, Row &key, Schema *schema) const {
-    [[maybe_unused]] uint32_t ofs = key.DeserializeFrom(const_cast<char *>(key_buf->data), schema);
-    ASSERT(ofs <= (uint32_t)key_size_, "Index key size exceed max key size.");
-  }
+  void DeserializeToKey(const GenericKey *key_buf, Row &key, Schema *schema) const;
 
-  // compare
+  // compare, normalized keys order like the rows they encode
   [[nodiscard]] inline int CompareKeys(const GenericKey *lhs, const GenericKey *rhs) const {
-    //    ASSERT(malloc_usable_size((void *)&lhs) == malloc_usable_size((void *)&rhs), "key size not match.");
-    uint32_t column_count = key_schema_->GetColumnCount();
-    Row lhs_key(INVALID_ROWID);
-    Row rhs_key(INVALID_ROWID);
-    DeserializeToKey(lhs, lhs_key, key_schema_);
-    DeserializeToKey(rhs, rhs_key, key_schema_);
-
-    for (uint32_t i = 0; i < column_count; i++) {
-      Field *lhs_value = lhs_key.GetField(i);
-      Field *rhs_value = rhs_key.GetField(i);
-
-      if (lhs_value->CompareLessThan(*rhs_value) == CmpBool::kTrue) {
-        return -1;
-      }
-
-      if (lhs_value->CompareGreaterThan(*rhs_value) == CmpBool::kTrue) {
-        return 1;
-      }
-    }
-    // equals
-    return 0;
+    return memcmp(lhs->data, rhs->data, encoded_size_);
   }
 
   inline int GetKeySize() const { return key_size_; }
 
+  /**
+   * @return number of bytes a key of this schema takes in normalized form
+   */
+  static uint32_t EncodedKeySize(const Schema *key_schema);
+
+  /**
+   * Write the compact form of a normalized key to buf: every column keeps its null flag, a null value has no image,
+   * int and float keep their 4 bytes, and char stores only its data, with every zero byte escaped as 0x00 0x01 and
+   * terminated by 0x00 0x00. Compact keys compare like the keys they come from as byte strings, a key that is a
+   * prefix of another ordering first.
+   * @return the size of the compact key, at most MaxCompactKeySize
+   */
+  uint32_t ToCompactKey(const GenericKey *key, char *buf) const;
+
+  /**
+   * Restore the normalized key from its compact form at buf, as written by ToCompactKey.
+   */
+  void FromCompactKey(const char *buf, GenericKey *key) const;
+
+  /**
+   * @return the largest size a compact key of this schema takes
+   */
+  static uint32_t MaxCompactKeySize(const Schema *key_schema);
+
   KeyManager(const KeyManager &other) {
     this->key_schema_ = other.key_schema_;
     this->key_size_ = other.key_size_;
+    this->encoded_size_ = other.encoded_size_;
   }
 
   // constructor
-  KeyManager(Schema *key_schema, size_t key_size) : key_size_(key_size), key_schema_(key_schema) {}
+  KeyManager(Schema *key_schema, size_t key_size)
+      : key_size_(key_size), key_schema_(key_schema), encoded_size_(EncodedKeySize(key_schema)) {
+    ASSERT(encoded_size_ <= key_size_, "Index key size exceed max key size.");
+  }
 
  private:
   int key_size_;
   Schema *key_schema_;
+  // bytes of a key that hold encoded columns
+  int encoded_size_;
 };
 
 #endif  // MINISQL_GENERIC_KEY_H
@@ -1,7 +1,9 @@
 #ifndef MINISQL_INDEX_H
 #define MINISQL_INDEX_H
 
+#include <functional>
 #include <memory>
+#include <vector>
 
 #include "common/dberr.h"
 #include "record/row.h"
@@ -20,8 +22,56 @@ class Index {
   virtual dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn,
                           string compare_operator = "=") = 0;
 
+  /**
+   * Look up the rows of every key in keys, as ScanKey with "=" does for one key: result[i] receives the row ids of
+   * keys[i]. Index types that can not share work between keys scan them one by one.
+   * @return DB_KEY_NOT_FOUND if none of the keys exists
+   */
+  virtual dberr_t ScanKeys(const std::vector<Row> &keys, std::vector<std::vector<RowId>> &result, Transaction *txn) {
+    result.assign(keys.size(), {});
+    bool found = false;
+    for (size_t i = 0; i < keys.size(); i++) {
+      found |= ScanKey(keys[i], result[i], txn) == DB_SUCCESS;
+    }
+    return found ? DB_SUCCESS : DB_KEY_NOT_FOUND;
+  }
+
+  /**
+   * Find the smallest key of the index, or the largest if max is true, and the row ids of that key, as MIN and MAX
+   * of the indexed columns. The key is stored into the empty row key, null values order before all others. Index
+   * types that can not reach their extremes directly return DB_FAILED, leaving the caller to scan. The tree indexes
+   * all implement it; no executor plans MIN or MAX on it yet.
+   * @return DB_KEY_NOT_FOUND if the index is empty
+   */
+  virtual dberr_t ScanExtreme([[maybe_unused]] bool max, [[maybe_unused]] Row &key,
+                              [[maybe_unused]] std::vector<RowId> &result, [[maybe_unused]] Transaction *txn) {
+    return DB_FAILED;
+  }
+
   virtual dberr_t Destroy() = 0;
 
+  // stores the next key and row id and returns true, or returns false after the last one
+  using EntrySource = std::function<bool(Row &key, RowId &row_id)>;
+
+  /**
+   * Fill the index with all entries produced by sources. Different sources may be read at the same time, each by
+   * its own thread; among entries with equal keys those of earlier sources come first. Entries rejected by
+   * InsertEntry are skipped. Index types that can not be built in bulk insert the entries one by one.
+   */
+  virtual dberr_t BulkLoad(const std::vector<EntrySource> &sources, Transaction *txn) {
+    for (auto &next : sources) {
+      while (true) {
+        Row key(INVALID_ROWID);
+        RowId row_id;
+        if (!next(key, row_id)) {
+          break;
+        }
+        InsertEntry(key, row_id, txn);
+      }
+    }
+    return DB_SUCCESS;
+  }
+
  protected:
   index_id_t index_id_;
   IndexSchema *key_schema_;
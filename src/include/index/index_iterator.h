@@ -1,8 +1,25 @@
 #ifndef MINISQL_INDEX_ITERATOR_H
 #define MINISQL_INDEX_ITERATOR_H
 
+#include <vector>
+
 #include "page/b_plus_tree_leaf_page.h"
 
+/**
+ * Iterator over the leaf chain of a BPlusTree.
+ *
+ * The iterator keeps its current leaf pinned but latches it only while reading an entry or stepping forward, so it
+ * never blocks writers between two calls. A scan running beside writers therefore sees every entry that stays in
+ * place, but may miss or repeat entries moved by a concurrent split or merge. The key returned by operator* points
+ * into the leaf and is only stable while no writer changes that leaf.
+ * A key with a posting list is returned once for each of its row ids, which are read from the list as a whole when
+ * the iterator reaches the key.
+ * A reverse iterator walks the chain backwards along the prev links of the leaves, returning the keys in descending
+ * order and the row ids of a key in descending row id order. Both directions end at the same end iterator. As a
+ * split or merge moves keys to the right, where a reverse iterator has already been, it copies out its current entry
+ * and steps on below that key, not below its position: it neither misses nor repeats keys a writer moves, and catches
+ * up with the new leaves of a previous leaf that split (see FollowSplit). The key it returns points into the iterator.
+ */
 class IndexIterator {
   using LeafPage = BPlusTreeLeafPage;
 
@@ -10,14 +27,20 @@ class IndexIterator {
   // you may define your own constructor based on your member variables
   explicit IndexIterator();
 
-  explicit IndexIterator(page_id_t page_id, BufferPoolManager *bpm, int index = 0);
+  /**
+   * Take over the caller's pin on leaf, nullptr for the end iterator. A reverse iterator also takes over the read
+   * latch on leaf, releasing it once it has copied out its entry, and compares keys with processor, which must
+   * outlive it.
+   */
+  explicit IndexIterator(Page *leaf, BufferPoolManager *bpm, int index = 0, bool reverse = false,
+                         const KeyManager *processor = nullptr);
 
   ~IndexIterator();
 
   /** Return the key/value pair this iterator is currently pointing at. */
   std::pair<GenericKey *, RowId> operator*();
 
-  /** Move to the next key/value pair.*/
+  /** Move to the next key/value pair, the previous one for a reverse iterator. */
   IndexIterator &operator++();
 
   /** Return whether two iterators are equal */
@@ -26,12 +49,37 @@ class IndexIterator {
   /** Return whether two iterators are not equal. */
   bool operator!=(const IndexIterator &itr) const;
 
+  /**
+   * Step of a reverse scan onto frame, the latched leaf reached through the prev link of the leaf left_page_id.
+   * If frame split after that link was read, its keys from the split point on went to new leaves between the two,
+   * and no longer lead to left_page_id. Move frame right along the next links as long as the next leaf starts below
+   * resume, the smallest key the scan has returned, holding only one latch at a time: frame stays pinned while the
+   * next leaf is checked. INVALID_PAGE_ID as left_page_id catches up with a split of the leaf the scan is on.
+   */
+  static void FollowSplit(Page *&frame, page_id_t left_page_id, const GenericKey *resume,
+                          const KeyManager &processor, BufferPoolManager *bpm);
+
  private:
   page_id_t current_page_id{INVALID_PAGE_ID};
+  Page *frame{nullptr};
   LeafPage *page{nullptr};
   int item_index{0};
   BufferPoolManager *buffer_pool_manager{nullptr};
-  // add your own private member variables here
+  // row ids of the current key if it has a posting list, empty until they are read, and the current one of them
+  std::vector<RowId> postings;
+  size_t posting_index{0};
+  bool reverse{false};
+  // compares keys for a reverse iterator
+  const KeyManager *processor{nullptr};
+  // the key and the value of the entry a reverse iterator is at, copied out when it gets there
+  std::vector<char> current_key;
+  RowId slot;
+
+  // Read the posting list of the current key if it has one and it is not read yet, the leaf is latched
+  void LoadPostings();
+
+  // Copy out the entry at item_index of the latched leaf for a reverse iterator
+  void TakeEntry();
 };
 
 #endif  // MINISQL_INDEX_ITERATOR_H
@@ -0,0 +1,79 @@
+#ifndef MINISQL_INDEX_RANGE_ITERATOR_H
+#define MINISQL_INDEX_RANGE_ITERATOR_H
+
+#include <vector>
+
+#include "common/macros.h"
+#include "page/b_plus_tree_leaf_page.h"
+
+/**
+ * Scan over the keys of a BPlusTree up to a bound, returning their row ids one leaf at a time.
+ *
+ * BPlusTree::BeginRange creates it at the first key within the lower bound, so a scan costs one descent plus the
+ * leaves (and posting pages) of the keys in range: each leaf is cut at the upper bound with a binary search, and the
+ * scan ends there without visiting the next leaf. A reverse scan starts at the last key within the upper bound and
+ * walks the prev links of the leaves down to the lower bound, returning keys and row ids in descending order. Like
+ * IndexIterator it keeps its current leaf pinned between calls and latches it only while reading, so it may miss or
+ * repeat entries moved by a concurrent split or merge; a reverse scan does not repeat keys moved into the previous
+ * leaf, and follows the new leaves of a previous leaf that split after its prev link was read.
+ */
+class IndexRangeIterator {
+  using LeafPage = BPlusTreeLeafPage;
+
+ public:
+  /**
+   * Take over the caller's pin on leaf, nullptr for an empty scan. The scan starts at entry index of leaf, which
+   * may be past its end, and stops before the first key greater than bound (or not less than it if bound_inclusive
+   * is false). bound is copied, nullptr leaves the range open.
+   * A reverse scan starts right before entry index, which may be past the end of leaf, and stops after the last key
+   * less than bound (or not greater than it if bound_inclusive is false). It also takes over the read latch on leaf,
+   * which index was found under, and reads leaf before releasing it.
+   */
+  IndexRangeIterator(Page *leaf, int index, const GenericKey *bound, bool bound_inclusive, const KeyManager &processor,
+                     BufferPoolManager *bpm, bool reverse = false);
+
+  IndexRangeIterator(IndexRangeIterator &&other) noexcept;
+
+  ~IndexRangeIterator();
+
+  DISALLOW_COPY(IndexRangeIterator);
+
+  /**
+   * Replace the contents of row_ids with the row ids of the next leaf holding keys in range, in key order and the
+   * row ids of a key in row id order (both descending for a reverse scan).
+   * @return false if the scan has reached its end (row_ids is left empty)
+   */
+  bool NextBatch(std::vector<RowId> &row_ids);
+
+  /** @return true once every key in range has been returned */
+  bool IsEnd() const { return frame_ == nullptr; }
+
+ private:
+  // @return the index of the first key of leaf beyond the upper bound, GetSize() if there is none. last tells
+  // whether the leaf reaches the bound, so that the scan ends with it.
+  int UpperIndex(LeafPage *leaf, bool &last);
+
+  // @return the index of the first key of leaf within the lower bound of a reverse scan, 0 if all are
+  int LowerIndex(LeafPage *leaf, bool &last);
+
+  // Append the row ids in range of the read latched frame_ to row_ids, then move frame_ on to the next leaf
+  void ReadLeaf(std::vector<RowId> &row_ids);
+
+  Page *frame_;
+  // the next entry to return, or for a reverse scan the entry after it
+  int index_;
+  // the encoded bound the scan ends at, empty if there is none
+  std::vector<char> bound_;
+  bool bound_inclusive_;
+  bool reverse_;
+  // the key a reverse scan goes on below: the smallest one it has returned, or the first one above its range
+  std::vector<char> resume_;
+  // the leaf a reverse scan read before frame_, INVALID_PAGE_ID before the first one
+  page_id_t left_page_id_{INVALID_PAGE_ID};
+  // the row ids a reverse scan read from its first leaf in the constructor
+  std::vector<RowId> first_batch_;
+  KeyManager processor_;
+  BufferPoolManager *buffer_pool_manager_;
+};
+
+#endif  // MINISQL_INDEX_RANGE_ITERATOR_H
@@ -0,0 +1,42 @@
+#ifndef MINISQL_PAGE_RECLAIMER_H
+#define MINISQL_PAGE_RECLAIMER_H
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+
+/**
+ * Frees the pages a B+ tree unlinks from its structure.
+ *
+ * A reader that reached a page before a writer unlinked it may still pin the page, and the buffer pool refuses to
+ * delete a pinned page. Such pages are kept here and tried again by every later Reclaim, so each one is freed by the
+ * first writer that comes after its last reader. Whatever is still kept is deleted with the reclaimer.
+ */
+class PageReclaimer {
+ public:
+  explicit PageReclaimer(BufferPoolManager *buffer_pool_manager) : buffer_pool_manager_(buffer_pool_manager) {}
+
+  ~PageReclaimer() { Reclaim({}); }
+
+  PageReclaimer(const PageReclaimer &) = delete;
+
+  PageReclaimer &operator=(const PageReclaimer &) = delete;
+
+  // Delete the given pages together with those kept by earlier calls, keeping the ones that are still pinned
+  void Reclaim(const std::vector<page_id_t> &page_ids);
+
+  // number of pages waiting for their readers, for tests
+  size_t GetPendingCount();
+
+ private:
+  BufferPoolManager *buffer_pool_manager_;
+  // protects pending_
+  std::mutex latch_;
+  std::vector<page_id_t> pending_;
+  // lets Reclaim skip the latch when there is nothing to do
+  std::atomic<bool> has_pending_{false};
+};
+
+#endif  // MINISQL_PAGE_RECLAIMER_H
@@ -0,0 +1,54 @@
+#ifndef MINISQL_POSTING_LIST_H
+#define MINISQL_POSTING_LIST_H
+
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/rowid.h"
+#include "page/b_plus_tree_posting_page.h"
+
+/**
+ * Posting lists of a non-unique BPlusTree.
+ *
+ * A key with a single row id stores it in its leaf slot as usual. Once a second row id is added, the row ids move to
+ * a chain of BPlusTreePostingPage and the slot holds a reference to the head page instead: a RowId whose slot number
+ * is POSTING_SLOT, which no table page ever reaches. The head page of a list never changes while the list exists.
+ *
+ * The pages of a list are only read or written while the leaf holding its key is latched, so they have no latches
+ * of their own. All functions taking a slot value work on the value as read from that leaf and update it in place;
+ * the caller writes it back.
+ */
+class PostingList {
+ public:
+  static constexpr uint32_t POSTING_SLOT = UINT32_MAX;
+
+  /** @return whether a leaf slot value refers to a posting list */
+  static bool IsList(const RowId &slot_value) { return slot_value.GetSlotNum() == POSTING_SLOT; }
+
+  /**
+   * Add value to the row ids of slot_value, turning a single row id into a list.
+   * @return false if value is already there
+   */
+  static bool Insert(BufferPoolManager *bpm, RowId &slot_value, const RowId &value);
+
+  /**
+   * Remove value from the posting list slot_value refers to. A list left with one row id is freed and slot_value
+   * becomes that row id.
+   * @return false if value is not in the list
+   */
+  static bool Remove(BufferPoolManager *bpm, RowId &slot_value, const RowId &value);
+
+  /** Append the row ids of slot_value to result in order, a single row id or all of a list. */
+  static void Read(BufferPoolManager *bpm, const RowId &slot_value, std::vector<RowId> &result);
+
+  /**
+   * Store the given row ids, in any order and without duplicates.
+   * @return the slot value: the row id itself if there is only one, a new posting list otherwise
+   */
+  static RowId Create(BufferPoolManager *bpm, std::vector<RowId> &values);
+
+  /** Free the pages of the list slot_value refers to, if it is one. */
+  static void Destroy(BufferPoolManager *bpm, const RowId &slot_value);
+};
+
+#endif  // MINISQL_POSTING_LIST_H
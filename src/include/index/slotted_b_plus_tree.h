@@ -0,0 +1,18 @@
+#ifndef MINISQL_SLOTTED_B_PLUS_TREE_H
+#define MINISQL_SLOTTED_B_PLUS_TREE_H
+
+#include "index/specialized_b_plus_tree.h"
+#include "page/slotted_b_plus_tree_page.h"
+
+/**
+ * B+ tree over keys of variable length, stored in slotted pages (see SlottedBPlusTreePage).
+ *
+ * It keeps the contract of BPlusTree for byte string keys, such as the compact keys of KeyManager, so that a page
+ * holds as many keys as their actual sizes allow rather than as many slots of the longest possible key. Keys are
+ * prefix compressed within each page, and the separator a leaf split pushes up is the shortest prefix of the right
+ * page's first key that is still greater than the left page's last key (suffix truncation), so internal pages hold
+ * short separators and the tree stays shallow. The tree algorithms are those of SpecializedBPlusTree.
+ */
+using SlottedBPlusTree = SpecializedBPlusTree<SlottedKeyFormat>;
+
+#endif  // MINISQL_SLOTTED_B_PLUS_TREE_H
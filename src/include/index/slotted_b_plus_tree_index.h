@@ -0,0 +1,53 @@
+#ifndef MINISQL_SLOTTED_B_PLUS_TREE_INDEX_H
+#define MINISQL_SLOTTED_B_PLUS_TREE_INDEX_H
+
+#include <string_view>
+
+#include "index/slotted_b_plus_tree.h"
+#include "index/generic_key.h"
+#include "index/index.h"
+
+/**
+ * Index on keys with char columns, backed by SlottedBPlusTree. Keys are stored in the compact form of their
+ * normalized keys, so a char column takes the bytes of its value rather than its declared length.
+ * The compact keys of the schema must not exceed SlottedBPlusTree::MAX_KEY_SIZE.
+ */
+class SlottedBPlusTreeIndex : public Index {
+ public:
+  // a non-unique index keeps a posting list of row ids for every key that occurs in several rows
+  SlottedBPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, BufferPoolManager *buffer_pool_manager,
+                        bool unique = true);
+
+  dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  dberr_t RemoveEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn, string compare_operator = "=") override;
+
+  // Resolve all keys in one pass over the tree, see SpecializedBPlusTree::GetValues
+  dberr_t ScanKeys(const std::vector<Row> &keys, std::vector<std::vector<RowId>> &result, Transaction *txn) override;
+
+  // Read the smallest or largest key from the leftmost or rightmost leaf
+  dberr_t ScanExtreme(bool max, Row &key, std::vector<RowId> &result, Transaction *txn) override;
+
+  dberr_t Destroy() override;
+
+  // Sort the entries of every source on its own thread, externally if they do not fit into memory, merge them in
+  // parallel and build the tree bottom-up if it is empty
+  dberr_t BulkLoad(const std::vector<EntrySource> &sources, Transaction *txn) override;
+
+  // Scan the keys between lower and upper, null for an open side, as BPlusTreeIndex::GetRangeIterator does
+  SlottedBPlusTree::RangeIterator GetRangeIterator(const Row *lower, bool lower_inclusive, const Row *upper,
+                                                   bool upper_inclusive, bool reverse = false);
+
+ protected:
+  // Encode key into buf, which holds SlottedBPlusTree::MAX_KEY_SIZE bytes, returning the compact key
+  std::string_view EncodeKey(const Row &key, char *buf) const;
+
+  // normalizes keys, whose compact form the tree stores
+  KeyManager processor_;
+  // container
+  SlottedBPlusTree container_;
+};
+
+#endif  // MINISQL_SLOTTED_B_PLUS_TREE_INDEX_H
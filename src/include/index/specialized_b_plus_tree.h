@@ -0,0 +1,244 @@
+#ifndef MINISQL_SPECIALIZED_B_PLUS_TREE_H
+#define MINISQL_SPECIALIZED_B_PLUS_TREE_H
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/macros.h"
+#include "common/rowid.h"
+#include "common/rwlatch.h"
+#include "index/page_reclaimer.h"
+#include "transaction/transaction.h"
+
+/**
+ * B+ tree over a page format of its own, shared by the trees that store keys without KeyManager: FixedKeyBPlusTree
+ * (plain int or float keys) and SlottedBPlusTree (compact byte string keys).
+ *
+ * Format provides Key, the key type the tree takes, KeyBuf, an owned copy of a key, and the LeafPage and
+ * InternalPage types. The pages decide how many entries they hold and when they split, are underfull or filled by a
+ * bulk load, so the tree itself never counts entries or bytes.
+ * (1) Keys are unique unless the tree is created non-unique. A key of a non-unique tree is stored once, and all its
+ *     row ids beyond the first go to a posting list (see PostingList), as in BPlusTree.
+ * (2) Insert splits full pages along the path latched during descent, so parent page ids are not maintained.
+ * (3) Remove deletes the entry from its leaf. A leaf left underfull is merged with a sibling under the same parent
+ *     if both fit into one page, and merges propagate upwards; pages are not redistributed. Merged pages are freed
+ *     through a PageReclaimer once no reader pins them.
+ * (4) Leaves are linked in both directions: range scans run in either order, and GetExtreme reaches the smallest or
+ *     largest key with one descent.
+ * (5) Latch crabbing as in BPlusTree: lookups and scans take read latches, and writers first write-latch only the
+ *     leaf. An insert that splits the leaf, or a remove that leaves it underfull, redoes its descent with write
+ *     latches, keeping only the pages above the lowest one that absorbs the change. root_latch_ protects
+ *     root_page_id_. A writer relinking a leaf latches its right neighbour; siblings of one parent are only latched
+ *     right to left while that parent is held.
+ * (6) Descents first try optimistic lock coupling on the page versions, falling back to crabbing when they keep
+ *     colliding with writers. GetValue reads its leaf without latching it, so pages must tolerate being searched
+ *     while they are written.
+ */
+template <typename Format>
+class SpecializedBPlusTree {
+  using Key = typename Format::Key;
+  using KeyBuf = typename Format::KeyBuf;
+  using LeafPage = typename Format::LeafPage;
+  using InternalPage = typename Format::InternalPage;
+
+ public:
+  // largest key the tree takes
+  static constexpr int MAX_KEY_SIZE = LeafPage::MAX_KEY_SIZE;
+
+  /**
+   * Scan over the keys of the tree up to a bound, returning their row ids one leaf at a time, as IndexRangeIterator
+   * does for BPlusTree. It keeps its current leaf pinned between calls and latches it only while reading, so it
+   * may miss or repeat entries moved by a concurrent split or merge; a reverse scan follows the new leaves of a
+   * previous leaf that split after its prev link was read.
+   */
+  class RangeIterator {
+   public:
+    /**
+     * Take over the caller's pin on leaf, nullptr for an empty scan. The scan starts at entry index of leaf (right
+     * before it if reverse), which may be past its end, and stops at bound, as IndexRangeIterator does. bound is
+     * copied, nullptr leaves the range open. A reverse scan takes over the read latch on leaf and reads leaf before
+     * releasing it.
+     */
+    RangeIterator(Page *leaf, int index, const Key *bound, bool bound_inclusive, BufferPoolManager *bpm,
+                  bool reverse = false);
+
+    RangeIterator(RangeIterator &&other) noexcept;
+
+    ~RangeIterator();
+
+    DISALLOW_COPY(RangeIterator);
+
+    /**
+     * Replace the contents of row_ids with the row ids of the next leaf holding keys in range, in key order and the
+     * row ids of a key in row id order (both descending for a reverse scan).
+     * @return false if the scan has reached its end (row_ids is left empty)
+     */
+    bool NextBatch(std::vector<RowId> &row_ids);
+
+    /** @return true once every key in range has been returned */
+    bool IsEnd() const { return frame_ == nullptr; }
+
+   private:
+    // @return the index of the first key of leaf beyond the bound of a forward scan, and whether the scan ends there
+    int UpperIndex(LeafPage *leaf, bool &last) const;
+
+    // @return the index of the first key of leaf within the bound of a reverse scan, and whether the scan ends there
+    int LowerIndex(LeafPage *leaf, bool &last) const;
+
+    // Append the row ids in range of the read latched frame_ to row_ids, then move frame_ on to the next leaf
+    void ReadLeaf(std::vector<RowId> &row_ids);
+
+    // Move the latched frame_ of a reverse scan right along the next links while the next leaf starts below resume_,
+    // as IndexIterator::FollowSplit does, when it no longer links to left_page_id_ because it split
+    void FollowSplit();
+
+    Page *frame_;
+    // the next entry to return, or for a reverse scan the entry after it
+    int index_;
+    KeyBuf bound_;
+    bool has_bound_;
+    bool bound_inclusive_;
+    bool reverse_;
+    // the key a reverse scan goes on below, the smallest one it has returned or the first one above its range: a
+    // merge may move the keys of its last leaf into the next one
+    KeyBuf resume_;
+    bool has_resume_{false};
+    // the leaf a reverse scan read before frame_, INVALID_PAGE_ID before the first one
+    page_id_t left_page_id_{INVALID_PAGE_ID};
+    // the row ids a reverse scan read from its first leaf in the constructor
+    std::vector<RowId> first_batch_;
+    BufferPoolManager *buffer_pool_manager_;
+  };
+
+  SpecializedBPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager, bool unique = true);
+
+  bool IsEmpty() const { return root_page_id_ == INVALID_PAGE_ID; }
+
+  // Insert a key-value pair into this B+ tree. Return false when the key (the pair if not unique) is a duplicate.
+  bool Insert(const Key &key, const RowId &value, Transaction *transaction = nullptr);
+
+  // Remove a key and all its values from this B+ tree. Return false if the key does not exist.
+  bool Remove(const Key &key, Transaction *transaction = nullptr);
+
+  // Remove one value of a key, and the key with its last value. Return false if the pair does not exist.
+  bool Remove(const Key &key, const RowId &value, Transaction *transaction = nullptr);
+
+  /**
+   * Build the tree bottom-up from entries sorted by key, filling pages to fill_factor of their capacity. An entry
+   * whose key equals the previous one is skipped by a unique tree, as Insert would reject it, and added to the key's
+   * posting list otherwise.
+   * @param next stores the next entry and returns true, or returns false after the last one. key must stay valid
+   * until the next call.
+   * @return false if the tree is not empty
+   */
+  bool BulkLoad(const std::function<bool(Key &key, RowId &value)> &next, double fill_factor = INDEX_FILL_FACTOR);
+
+  // Append the values associated with a given key to result
+  bool GetValue(const Key &key, std::vector<RowId> &result, Transaction *transaction = nullptr);
+
+  /**
+   * Look up a batch of keys in key order, reading every leaf once for all keys it holds.
+   * @param result resized to the number of keys, result[i] receives the values of keys[i] as GetValue returns them
+   * @return the number of keys that exist
+   */
+  size_t GetValues(const std::vector<Key> &keys, std::vector<std::vector<RowId>> &result,
+                   Transaction *transaction = nullptr);
+
+  /**
+   * Copy the smallest key (the largest if max is true) to key and append its values to result.
+   * @return false if the tree is empty
+   */
+  bool GetExtreme(bool max, KeyBuf &key, std::vector<RowId> &result, Transaction *transaction = nullptr);
+
+  /**
+   * Scan the keys between lower and upper, whose inclusive flags tell whether a key equal to them is in range. A
+   * null bound leaves that side of the range open. A reverse scan starts from upper and goes down.
+   */
+  RangeIterator BeginRange(const Key *lower, bool lower_inclusive, const Key *upper, bool upper_inclusive,
+                           bool reverse = false);
+
+  // Append the values of all keys between lower and upper to result, in key order (descending if reverse)
+  void ScanRange(const Key *lower, bool lower_inclusive, const Key *upper, bool upper_inclusive,
+                 std::vector<RowId> &result, Transaction *transaction = nullptr, bool reverse = false);
+
+  // Number of levels of the tree, 0 if it is empty
+  int GetHeight();
+
+  // Free all pages of the tree, leaving it empty
+  void Destroy();
+
+  // used to check whether all pages are unpinned
+  bool Check();
+
+  // number of removed pages not freed yet because readers still pin them, for tests
+  size_t GetPendingDeleteCount() { return page_reclaimer_.GetPendingCount(); }
+
+ private:
+  // deep enough for any tree that fits into a 32-bit page id space
+  static constexpr int MAX_HEIGHT = 32;
+
+  // the rightmost page of a level during a bulk load, with the separator below which its subtree starts
+  struct BulkLoadLevel {
+    Page *page_;
+    KeyBuf low_;
+  };
+
+  // The child a descent for key goes on with, the first one (the last one if rightmost) for a null key.
+  // INVALID_PAGE_ID if the page read without latches is inconsistent.
+  static page_id_t ChildToFollow(const InternalPage *page, const Key *key, bool rightmost);
+
+  // Descend from the root to the leaf that holds key without latches. The leaf is returned pinned and unlatched with
+  // its version, nullptr if the tree is empty or a writer got in the way.
+  Page *FindLeafPageOptimistic(const Key *key, bool rightmost, uint64_t &version);
+
+  // Find the leaf like FindLeafPageOptimistic, crabbing down from the root if optimistic descents keep failing. The
+  // leaf is returned pinned and latched (write latched if write_leaf), nullptr if the tree is empty.
+  Page *FindLeafPage(const Key *key, bool write_leaf = false, bool rightmost = false);
+
+  void StartNewTree(const Key &key, const RowId &value);
+
+  // Add value to the posting list of the key at index. Return false for a unique tree or a duplicate value.
+  bool InsertIntoPostingList(LeafPage *leaf, int index, const RowId &value);
+
+  // Insert into leaf at index, which is full, splitting it and the parents write-latched in path[0, depth)
+  void SplitLeaf(Page *page, int index, const Key &key, const RowId &value, Page **path, int depth);
+
+  // Insert the separator key and the new right sibling into the parents write-latched in path[0, depth)
+  void InsertIntoParent(page_id_t left_id, KeyBuf key, page_id_t right_id, Page **path, int depth);
+
+  // Point the prev link of the leaf after leaf back at it, write-latching that leaf
+  void LinkBackFromNext(LeafPage *leaf);
+
+  // Remove the key, or only value if it is not null
+  bool RemoveEntry(const Key &key, const RowId *value);
+
+  // Merge the leaf of key and its ancestors with their siblings as long as they are underfull
+  void Rebalance(const Key &key);
+
+  // Start a new rightmost page on level of a bulk load, whose subtree starts at low, appending the page it replaces
+  // to the level above
+  Page *BulkLoadNextPage(std::vector<BulkLoadLevel> &levels, size_t level, const KeyBuf &low, double fill_factor);
+
+  // Append child, whose subtree starts at low, to the rightmost page of level. low is copied, as it may come from
+  // levels, which starting a new level reallocates.
+  void BulkLoadAppend(std::vector<BulkLoadLevel> &levels, size_t level, KeyBuf low, page_id_t child,
+                      double fill_factor);
+
+  void DestroyPage(page_id_t page_id);
+
+  void UpdateRootPageId(bool insert_record = false);
+
+  index_id_t index_id_;
+  // read without root_latch_ by optimistic descents
+  std::atomic<page_id_t> root_page_id_{INVALID_PAGE_ID};
+  // held by writers changing root_page_id_, and by crabbing descents until the root page is latched
+  ReaderWriterLatch root_latch_;
+  BufferPoolManager *buffer_pool_manager_;
+  // frees the pages merges remove from the tree
+  PageReclaimer page_reclaimer_;
+  bool unique_;
+};
+
+#endif  // MINISQL_SPECIALIZED_B_PLUS_TREE_H
@@ -0,0 +1,89 @@
+#ifndef MINISQL_TREE_INDEX_UTIL_H
+#define MINISQL_TREE_INDEX_UTIL_H
+
+#include <string>
+#include <vector>
+
+#include "index/index.h"
+#include "utils/parallel_sorter.h"
+
+/**
+ * Code shared by the index types backed by a B+ tree: BPlusTreeIndex, FixedKeyBPlusTreeIndex and
+ * SlottedBPlusTreeIndex. They differ in how a row is encoded into a key of their tree, which the callers pass in.
+ */
+namespace TreeIndexUtil {
+/**
+ * Answer Index::ScanKey for compare_operator. "=" looks the key up, the other operators scan the ranges the key
+ * bounds, which costs one descent plus the leaves in range; "<>" scans below and above the key.
+ * @param lookup appends the row ids of the key to result
+ * @param scan scan(lower, lower_inclusive, upper, upper_inclusive) appends the row ids of a range to result. The key
+ * bounds the sides whose flag lower or upper is true, the other side is open.
+ * @return DB_KEY_NOT_FOUND if result is empty
+ */
+template <typename Lookup, typename Scan>
+dberr_t ScanKey(const std::string &compare_operator, std::vector<RowId> &result, const Lookup &lookup,
+                const Scan &scan) {
+  if (compare_operator == "=") {
+    lookup();
+  } else if (compare_operator == ">") {
+    scan(true, false, false, false);
+  } else if (compare_operator == ">=") {
+    scan(true, true, false, false);
+  } else if (compare_operator == "<") {
+    scan(false, false, true, false);
+  } else if (compare_operator == "<=") {
+    scan(false, false, true, true);
+  } else if (compare_operator == "<>") {
+    scan(false, false, true, false);
+    scan(true, false, false, false);
+  }
+  if (!result.empty())
+    return DB_SUCCESS;
+  else
+    return DB_KEY_NOT_FOUND;
+}
+
+/**
+ * Implement Index::BulkLoad on tree. Every source is read on its own thread, which encodes its entries into records
+ * of record_size bytes and sorts them by less, externally if they do not fit into memory; the sorted sources are
+ * merged in parallel. The sort is stable, so among equal keys the entry produced first comes first: a unique tree
+ * keeps that one, a non-unique tree keeps them all. The tree is built bottom-up if it is empty, otherwise the entries
+ * are inserted one by one in order.
+ * @tparam Key the key type of the tree's BulkLoad
+ * @param encode encode(key, row_id, record) writes an entry into record, or returns false to leave it out
+ * @param decode decode(record, key, row_id) reads an entry back. key may point into record, which stays valid until
+ * the next entry is read.
+ */
+template <typename Key, typename Tree, typename Less, typename Encode, typename Decode>
+void BulkLoad(Tree &tree, const std::vector<Index::EntrySource> &sources, size_t record_size, Less less,
+              const Encode &encode, const Decode &decode, Transaction *txn) {
+  using Sorter = ParallelSorter<Less>;
+  Sorter sorter(record_size, sources.size(), less);
+  sorter.Sort([&](size_t index, typename Sorter::Partition &partition) {
+    std::vector<char> record(record_size);
+    while (true) {
+      Row key(INVALID_ROWID);
+      RowId row_id;
+      if (!sources[index](key, row_id))
+        break;
+      if (encode(key, row_id, record.data()))
+        partition.Add(record.data());
+    }
+  });
+  auto sorted = [&](Key &key, RowId &row_id) {
+    char *record = sorter.Next();
+    if (record == nullptr)
+      return false;
+    decode(record, key, row_id);
+    return true;
+  };
+  if (!tree.BulkLoad(sorted)) {
+    Key key{};
+    RowId row_id;
+    while (sorted(key, row_id))
+      tree.Insert(key, row_id, txn);
+  }
+}
+}  // namespace TreeIndexUtil
+
+#endif  // MINISQL_TREE_INDEX_UTIL_H
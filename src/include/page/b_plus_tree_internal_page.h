@@ -48,6 +48,9 @@ class BPlusTreeInternalPage : public BPlusTreePage {
 
   page_id_t Lookup(const GenericKey *key, const KeyManager &KP);
 
+  // index of the child that contains key, -1 if the page has fewer than two children
+  int LookupIndex(const GenericKey *key, const KeyManager &KP);
+
   void PopulateNewRoot(const page_id_t &old_value, GenericKey *new_key, const page_id_t &new_value);
 
   int InsertNodeAfter(const page_id_t &old_value, GenericKey *new_key, const page_id_t &new_value);
@@ -67,11 +70,12 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, GenericKey *middle_key,
                          BufferPoolManager *buffer_pool_manager);
 
+  // Append a child after the last one and adopt it, the page must not be full. Used by bulk loading.
+  void CopyLastFrom(GenericKey *key, page_id_t value, BufferPoolManager *buffer_pool_manager);
+
  private:
   void CopyNFrom(void *src, int size, BufferPoolManager *buffer_pool_manager);
 
-  void CopyLastFrom(GenericKey *key, page_id_t value, BufferPoolManager *buffer_pool_manager);
-
   void CopyFirstFrom(page_id_t value, BufferPoolManager *buffer_pool_manager);
 
   char data_[PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE];
@@ -6,20 +6,23 @@
  *
  * Store indexed key and record id(record id = page id combined with slot id,
  * see include/common/rid.h for detailed implementation) together within leaf
- * page. Only support unique key.
+ * page. Every key is stored once; in a non-unique tree the RID of a key with
+ * several rows refers to its posting list instead (see index/posting_list.h).
 
  * Leaf page format (keys are stored in order):
  *  ----------------------------------------------------------------------
  * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
  *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 24 bytes in total):
+ *  Header format (size in byte, 36 bytes in total):
  *  ---------------------------------------------------------------------
- * | PageType (4) | CurrentSize (4) | MaxSize (4) | ParentPageId (4) |
+ * | PageType (4) | KeySize (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  ------------------------------
- * | PageId (4) | NextPageId (4)
- *  ------------------------------
+ *  --------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | NextPageId (4) | PrevPageId (4)
+ *  --------------------------------------------------------------
+ * The leaves form a doubly linked list in key order, so that scans can walk
+ * them in either direction.
  */
 #include <utility>
 #include <vector>
@@ -27,7 +30,7 @@
 #include "index/generic_key.h"
 #include "page/b_plus_tree_page.h"
 
-#define LEAF_PAGE_HEADER_SIZE 32
+#define LEAF_PAGE_HEADER_SIZE 36
 #define LEAF_PAGE_SIZE(_key_size) (((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / ((_key_size) + sizeof(RowId))) - 1)
 // #define LEAF_PAGE_SIZE 4 // only use this line when debugging
 
@@ -43,6 +46,10 @@ class BPlusTreeLeafPage : public BPlusTreePage {
 
   void SetNextPageId(page_id_t next_page_id);
 
+  page_id_t GetPrevPageId() const;
+
+  void SetPrevPageId(page_id_t prev_page_id);
+
   GenericKey *KeyAt(int index);
 
   void SetKeyAt(int index, GenericKey *key);
@@ -78,14 +85,16 @@ class BPlusTreeLeafPage : public BPlusTreePage {
 
   void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
 
+  // Append a pair after the last one, the page must not be full. Used by bulk loading.
+  void CopyLastFrom(GenericKey *key, const RowId value);
+
  private:
   void CopyNFrom(void *src, int size);
 
-  void CopyLastFrom(GenericKey *key, const RowId value);
-
   void CopyFirstFrom(GenericKey *key, const RowId value);
 
   page_id_t next_page_id_{INVALID_PAGE_ID};
+  page_id_t prev_page_id_{INVALID_PAGE_ID};
 
   char data_[PAGE_SIZE - LEAF_PAGE_HEADER_SIZE];
 };
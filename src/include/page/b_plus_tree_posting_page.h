@@ -0,0 +1,95 @@
+#ifndef MINISQL_B_PLUS_TREE_POSTING_PAGE_H
+#define MINISQL_B_PLUS_TREE_POSTING_PAGE_H
+
+#include <cstring>
+
+#include "common/config.h"
+#include "common/rowid.h"
+
+/**
+ * b_plus_tree_posting_page.h
+ *
+ * One page of a posting list: the sorted row ids sharing one key of a non-unique BPlusTree. A posting list is a
+ * chain of these pages, every page holding row ids greater than those of the pages before it. Row ids are ordered
+ * by RowId::Get, i.e. by page id and then slot.
+ *
+ * Format (size in byte):
+ *  ----------------------------------------------------------------
+ * | NextPageId (4) | Size (4) | RID(1) (8) | ... | RID(n) (8) |
+ *  ----------------------------------------------------------------
+ */
+class BPlusTreePostingPage {
+ public:
+  static constexpr int HEADER_SIZE = 8;
+  static constexpr int MAX_SIZE = (PAGE_SIZE - HEADER_SIZE) / sizeof(RowId);
+
+  void Init(page_id_t next_page_id = INVALID_PAGE_ID) {
+    next_page_id_ = next_page_id;
+    size_ = 0;
+  }
+
+  page_id_t GetNextPageId() const { return next_page_id_; }
+
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  int GetSize() const { return size_; }
+
+  bool IsFull() const { return size_ == MAX_SIZE; }
+
+  RowId ValueAt(int index) const { return values_[index]; }
+
+  /** @return the first index i so that ValueAt(i) >= value, GetSize() if there is none */
+  int ValueIndex(const RowId &value) const {
+    int l = 0, r = size_;
+    while (l < r) {
+      int m = l + (r - l) / 2;
+      if (values_[m].Get() < value.Get()) {
+        l = m + 1;
+      } else {
+        r = m;
+      }
+    }
+    return l;
+  }
+
+  /** Insert at index, which must keep the row ids ordered. The page must not be full. */
+  void InsertAt(int index, const RowId &value) {
+    memmove(values_ + index + 1, values_ + index, (size_ - index) * sizeof(RowId));
+    values_[index] = value;
+    size_++;
+  }
+
+  void RemoveAt(int index) {
+    memmove(values_ + index, values_ + index + 1, (size_ - index - 1) * sizeof(RowId));
+    size_--;
+  }
+
+  /** Append count row ids greater than all on this page. The page must have room for them. */
+  void Append(const RowId *values, int count) {
+    memcpy(values_ + size_, values, count * sizeof(RowId));
+    size_ += count;
+  }
+
+  /** Move the upper half of the row ids to the empty page recipient, which is linked after this page. */
+  void MoveHalfTo(BPlusTreePostingPage *recipient, page_id_t recipient_id) {
+    int half = size_ / 2;
+    recipient->Append(values_ + half, size_ - half);
+    size_ = half;
+    recipient->next_page_id_ = next_page_id_;
+    next_page_id_ = recipient_id;
+  }
+
+  /** Replace the contents of this page with those of page, including its link. */
+  void CopyFrom(const BPlusTreePostingPage *page) {
+    next_page_id_ = page->next_page_id_;
+    size_ = 0;
+    Append(page->values_, page->size_);
+  }
+
+ private:
+  page_id_t next_page_id_;
+  int size_;
+  RowId values_[0];
+};
+
+#endif  // MINISQL_B_PLUS_TREE_POSTING_PAGE_H
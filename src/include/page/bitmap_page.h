@@ -1,11 +1,16 @@
 #ifndef MINISQL_BITMAP_PAGE_H
 #define MINISQL_BITMAP_PAGE_H
 
-#include <bitset>
+#include <cstdint>
 
 #include "common/config.h"
 #include "common/macros.h"
 
+/**
+ * BitmapPage records which pages of an extent are allocated, one bit per page (bit i % 8 of byte i / 8, 1 means
+ * allocated). Free pages are found by scanning the bitmap a 64-bit word at a time, starting from the word that last
+ * had a free page.
+ */
 template <size_t PageSize>
 class BitmapPage {
  public:
@@ -15,8 +20,9 @@ class BitmapPage {
   static constexpr size_t GetMaxSupportedSize() { return 8 * MAX_CHARS; }
 
   /**
+   * Allocate the first free page at or after the last known free position, wrapping around.
    * @param page_offset Index in extent of the page allocated.
-   * @return true if successfully allocate a page.
+   * @return true if successfully allocate a page, false if the extent is full.
    */
   bool AllocatePage(uint32_t &page_offset);
 
@@ -30,6 +36,11 @@ class BitmapPage {
    */
   bool IsPageFree(uint32_t page_offset) const;
 
+  /**
+   * @return number of allocated pages in the extent
+   */
+  uint32_t GetAllocatedPages() const { return page_allocated_; }
+
  private:
   /**
    * check a bit(byte_index, bit_index) in bytes is free(value 0).
@@ -40,15 +51,22 @@ class BitmapPage {
    */
   bool IsPageFreeLow(uint32_t byte_index, uint8_t bit_index) const;
 
+  /**
+   * Find a zero bit by scanning 64-bit words from next_free_page_, wrapping around.
+   * @return offset of a free page, GetMaxSupportedSize() if there is none
+   */
+  uint32_t FindFreePage() const;
+
   /** Note: need to update if modify page structure. */
   static constexpr size_t MAX_CHARS = PageSize - 2 * sizeof(uint32_t);
+  static constexpr size_t NUM_WORDS = MAX_CHARS / sizeof(uint64_t);
+  static_assert(MAX_CHARS % sizeof(uint64_t) == 0, "Bitmap must consist of whole 64-bit words.");
 
  private:
   /** The space occupied by all members of the class should be equal to the PageSize */
-  [[maybe_unused]] uint32_t page_allocated_{0};
-  [[maybe_unused]] uint32_t next_free_page_{0};
-  std::bitset<8 * MAX_CHARS> allocate_pages;
-  [[maybe_unused]] unsigned char bytes[MAX_CHARS];
+  uint32_t page_allocated_{0};
+  uint32_t next_free_page_{0};
+  unsigned char bytes[MAX_CHARS];
 };
 
 #endif  // MINISQL_BITMAP_PAGE_H
@@ -0,0 +1,385 @@
+#ifndef MINISQL_FIXED_KEY_B_PLUS_TREE_PAGE_H
+#define MINISQL_FIXED_KEY_B_PLUS_TREE_PAGE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "common/rowid.h"
+#include "page/b_plus_tree_page.h"
+
+/**
+ * fixed_key_b_plus_tree_page.h
+ *
+ * Pages of FixedKeyBPlusTree, the B+ tree specialized for keys of one fixed-width type (e.g. int32_t or float).
+ * Keys are stored as plain values and compared with the type's own operator<, so a search never goes through
+ * KeyManager. Both pages share the BPlusTreePage header; its key size is sizeof(KeyType). They provide the page
+ * interface SpecializedBPlusTree expects, counting entries: a page is underfull below a quarter of MAX_SIZE.
+ *
+ * Keys and values are kept in two separate arrays, so the keys a search reads are contiguous: a branchless binary
+ * search narrows the range down to one cache line of keys, which is then counted with SIMD compares (see
+ * FixedKeySearch).
+ *
+ * Leaf page format (keys are stored in order, n = MAX_SIZE):
+ *  --------------------------------------------------------------------------------------------
+ * | HEADER (28) | NextPageId (4) | PrevPageId (4) | KEY(1) | ... | KEY(n) | RID(1) | ... | RID(n) |
+ *  --------------------------------------------------------------------------------------------
+ *
+ * Internal page format (the first key is invalid, PAGE_ID(i) holds keys K with KEY(i) <= K < KEY(i+1)):
+ *  ----------------------------------------------------------------------------------
+ * | HEADER (28) | KEY(0) | KEY(1) | ... | KEY(n) | PAGE_ID(0) | PAGE_ID(1) | ... | PAGE_ID(n) |
+ *  ----------------------------------------------------------------------------------
+ */
+
+/**
+ * In-page key search. Search<Upper> returns the number of keys less than key, or not greater than it if Upper, in
+ * a sorted array. int32_t and float keys are counted with SSE2 (AVX2 if the build enables it) compare and movemask
+ * instructions, other types and the tail of the window with scalar compares.
+ */
+namespace FixedKeySearch {
+// keys counted after the binary search, one cache line of 4-byte keys
+static constexpr int SCAN_WINDOW = 16;
+
+template <bool Upper, typename KeyType>
+inline int CountScalar(const KeyType *keys, int n, KeyType key) {
+  int count = 0;
+  for (int i = 0; i < n; i++) {
+    count += Upper ? !(key < keys[i]) : keys[i] < key;
+  }
+  return count;
+}
+
+template <bool Upper, typename KeyType>
+inline int Count(const KeyType *keys, int n, KeyType key) {
+  int i = 0;
+  int count = 0;
+#if defined(__SSE2__)
+  if constexpr (std::is_same<KeyType, int32_t>::value) {
+#if defined(__AVX2__)
+    __m256i key8 = _mm256_set1_epi32(key);
+    for (; i + 8 <= n; i += 8) {
+      __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+      /* lanes greater than key (for Upper) or less than it */
+      __m256i gt = Upper ? _mm256_cmpgt_epi32(v, key8) : _mm256_cmpgt_epi32(key8, v);
+      int bits = __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(gt)));
+      count += Upper ? 8 - bits : bits;
+    }
+#endif
+    __m128i key4 = _mm_set1_epi32(key);
+    for (; i + 4 <= n; i += 4) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i));
+      __m128i gt = Upper ? _mm_cmpgt_epi32(v, key4) : _mm_cmpgt_epi32(key4, v);
+      int bits = __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(gt)));
+      count += Upper ? 4 - bits : bits;
+    }
+  } else if constexpr (std::is_same<KeyType, float>::value) {
+#if defined(__AVX2__)
+    __m256 key8 = _mm256_set1_ps(key);
+    for (; i + 8 <= n; i += 8) {
+      __m256 v = _mm256_loadu_ps(keys + i);
+      __m256 in = Upper ? _mm256_cmp_ps(v, key8, _CMP_LE_OQ) : _mm256_cmp_ps(v, key8, _CMP_LT_OQ);
+      count += __builtin_popcount(_mm256_movemask_ps(in));
+    }
+#endif
+    __m128 key4 = _mm_set1_ps(key);
+    for (; i + 4 <= n; i += 4) {
+      __m128 v = _mm_loadu_ps(keys + i);
+      __m128 in = Upper ? _mm_cmple_ps(v, key4) : _mm_cmplt_ps(v, key4);
+      count += __builtin_popcount(_mm_movemask_ps(in));
+    }
+  }
+#endif
+  return count + CountScalar<Upper>(keys + i, n - i, key);
+}
+
+template <bool Upper, typename KeyType>
+inline int Search(const KeyType *keys, int n, KeyType key) {
+  const KeyType *base = keys;
+  /* branchless binary search: the answer stays within [base, base + len], and the pointer moves by a conditional
+   * add instead of a jump the CPU would have to predict */
+  while (n > SCAN_WINDOW) {
+    int half = n / 2;
+    bool right = Upper ? !(key < base[half - 1]) : base[half - 1] < key;
+    base += right ? half : 0;
+    n -= half;
+  }
+  return static_cast<int>(base - keys) + Count<Upper>(base, n, key);
+}
+}  // namespace FixedKeySearch
+
+template <typename KeyType>
+class FixedKeyLeafPage : public BPlusTreePage {
+  static_assert(std::is_trivially_copyable<KeyType>::value, "Fixed keys must be trivially copyable.");
+
+ public:
+  static constexpr int HEADER_SIZE = 36;
+  static constexpr int MAX_SIZE = (PAGE_SIZE - HEADER_SIZE) / (sizeof(KeyType) + sizeof(RowId));
+  static constexpr int MAX_KEY_SIZE = sizeof(KeyType);
+
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID) {
+    SetPageType(IndexPageType::LEAF_PAGE);
+    SetKeySize(sizeof(KeyType));
+    SetSize(0);
+    SetMaxSize(MAX_SIZE);
+    SetParentPageId(parent_id);
+    SetPageId(page_id);
+    next_page_id_ = INVALID_PAGE_ID;
+    prev_page_id_ = INVALID_PAGE_ID;
+  }
+
+  page_id_t GetNextPageId() const { return next_page_id_; }
+
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  page_id_t GetPrevPageId() const { return prev_page_id_; }
+
+  void SetPrevPageId(page_id_t prev_page_id) { prev_page_id_ = prev_page_id; }
+
+  KeyType KeyAt(int index) const { return Keys()[index]; }
+
+  RowId ValueAt(int index) const { return Values()[index]; }
+
+  void SetValueAt(int index, const RowId &value) { Values()[index] = value; }
+
+  /** @return a value less than, equal to or greater than zero if the key at index is less than, equal to or greater
+   * than key */
+  int CompareAt(int index, const KeyType &key) const {
+    return Keys()[index] < key ? -1 : (key < Keys()[index] ? 1 : 0);
+  }
+
+  /** @return the first index i so that KeyAt(i) >= key, GetSize() if there is none */
+  int KeyIndex(const KeyType &key) const { return FixedKeySearch::Search<false>(Keys(), ReadSize(), key); }
+
+  /** @return the first index i so that KeyAt(i) > key, GetSize() if there is none */
+  int UpperIndex(const KeyType &key) const { return FixedKeySearch::Search<true>(Keys(), ReadSize(), key); }
+
+  /**
+   * Insert at index, which must keep the keys ordered.
+   * @return false if the page is full, leaving it unchanged
+   */
+  bool InsertAt(int index, const KeyType &key, const RowId &value) {
+    if (GetSize() >= MAX_SIZE)
+      return false;
+    int moved = GetSize() - index;
+    memmove(Keys() + index + 1, Keys() + index, moved * sizeof(KeyType));
+    memmove(Values() + index + 1, Values() + index, moved * sizeof(RowId));
+    Keys()[index] = key;
+    Values()[index] = value;
+    IncreaseSize(1);
+    return true;
+  }
+
+  void RemoveAt(int index) {
+    int moved = GetSize() - index - 1;
+    memmove(Keys() + index, Keys() + index + 1, moved * sizeof(KeyType));
+    memmove(Values() + index, Values() + index + 1, moved * sizeof(RowId));
+    IncreaseSize(-1);
+  }
+
+  /**
+   * Insert into this full page at index, moving the upper half of the pairs to the empty page recipient. The pages
+   * are not linked.
+   * @return the key separating this page from recipient
+   */
+  KeyType InsertAndSplit(int index, const KeyType &key, const RowId &value, FixedKeyLeafPage *recipient) {
+    int half = GetSize() / 2;
+    int moved = GetSize() - half;
+    memcpy(recipient->Keys(), Keys() + half, moved * sizeof(KeyType));
+    memcpy(recipient->Values(), Values() + half, moved * sizeof(RowId));
+    recipient->SetSize(moved);
+    SetSize(half);
+    if (index <= half) {
+      InsertAt(index, key, value);
+    } else {
+      recipient->InsertAt(index - half, key, value);
+    }
+    return recipient->KeyAt(0);
+  }
+
+  /**
+   * Append all pairs of right, the page after this one, and take over its next page. right is left empty.
+   * @return false if the pairs do not fit, leaving both pages unchanged
+   */
+  bool MergeFrom(FixedKeyLeafPage *right) {
+    if (GetSize() + right->GetSize() > MAX_SIZE)
+      return false;
+    memcpy(Keys() + GetSize(), right->Keys(), right->GetSize() * sizeof(KeyType));
+    memcpy(Values() + GetSize(), right->Values(), right->GetSize() * sizeof(RowId));
+    IncreaseSize(right->GetSize());
+    right->SetSize(0);
+    next_page_id_ = right->next_page_id_;
+    return true;
+  }
+
+  /** @return true if an insert can not split the page */
+  bool IsInsertSafe() const { return GetSize() < MAX_SIZE; }
+
+  /** @return true if removing a pair can not leave the page underfull */
+  bool IsRemoveSafe() const { return GetSize() > MAX_SIZE / 4; }
+
+  bool IsUnderfull() const { return GetSize() < MAX_SIZE / 4; }
+
+  /** @return true once a bulk load filling pages to fill_factor has to start a new page */
+  bool IsFilled(double fill_factor) const {
+    return GetSize() >= std::clamp(static_cast<int>(MAX_SIZE * fill_factor), 1, MAX_SIZE);
+  }
+
+  static int KeySize([[maybe_unused]] const KeyType &key) { return sizeof(KeyType); }
+
+  /** @return the key that separates a page ending with left_last from the next page starting with right_first */
+  static KeyType Separator([[maybe_unused]] const KeyType &left_last, const KeyType &right_first) {
+    return right_first;
+  }
+
+ private:
+  // the size bounded by the capacity, for searches that may read the page while it is being written
+  int ReadSize() const { return std::min(GetSize(), MAX_SIZE); }
+
+  KeyType *Keys() { return reinterpret_cast<KeyType *>(data_); }
+
+  const KeyType *Keys() const { return reinterpret_cast<const KeyType *>(data_); }
+
+  RowId *Values() { return reinterpret_cast<RowId *>(data_ + MAX_SIZE * sizeof(KeyType)); }
+
+  const RowId *Values() const { return reinterpret_cast<const RowId *>(data_ + MAX_SIZE * sizeof(KeyType)); }
+
+  page_id_t next_page_id_;
+  page_id_t prev_page_id_;
+  char data_[PAGE_SIZE - HEADER_SIZE];
+};
+
+template <typename KeyType>
+class FixedKeyInternalPage : public BPlusTreePage {
+  static_assert(std::is_trivially_copyable<KeyType>::value, "Fixed keys must be trivially copyable.");
+
+ public:
+  static constexpr int HEADER_SIZE = 28;
+  static constexpr int MAX_SIZE = (PAGE_SIZE - HEADER_SIZE) / (sizeof(KeyType) + sizeof(page_id_t));
+
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID) {
+    SetPageType(IndexPageType::INTERNAL_PAGE);
+    SetKeySize(sizeof(KeyType));
+    SetSize(0);
+    SetMaxSize(MAX_SIZE);
+    SetParentPageId(parent_id);
+    SetPageId(page_id);
+  }
+
+  KeyType KeyAt(int index) const { return Keys()[index]; }
+
+  page_id_t ValueAt(int index) const { return Values()[index]; }
+
+  /** @return the first index i >= 1 so that KeyAt(i) > key, GetSize() if there is none */
+  int UpperIndex(const KeyType &key) const {
+    int size = std::min(GetSize(), MAX_SIZE);
+    return size <= 1 ? size : 1 + FixedKeySearch::Search<true>(Keys() + 1, size - 1, key);
+  }
+
+  /** Turn this empty page into a root with two children separated by key. */
+  void PopulateNewRoot(page_id_t left, const KeyType &key, page_id_t right) {
+    Values()[0] = left;
+    Keys()[1] = key;
+    Values()[1] = right;
+    SetSize(2);
+  }
+
+  /**
+   * Insert the child holding the keys from key on at index, which must keep the keys ordered. The key of the first
+   * child is never read.
+   * @return false if the page is full, leaving it unchanged
+   */
+  bool InsertAt(int index, const KeyType &key, page_id_t child) {
+    if (GetSize() >= MAX_SIZE)
+      return false;
+    int moved = GetSize() - index;
+    memmove(Keys() + index + 1, Keys() + index, moved * sizeof(KeyType));
+    memmove(Values() + index + 1, Values() + index, moved * sizeof(page_id_t));
+    Keys()[index] = key;
+    Values()[index] = child;
+    IncreaseSize(1);
+    return true;
+  }
+
+  void RemoveAt(int index) {
+    int moved = GetSize() - index - 1;
+    memmove(Keys() + index, Keys() + index + 1, moved * sizeof(KeyType));
+    memmove(Values() + index, Values() + index + 1, moved * sizeof(page_id_t));
+    IncreaseSize(-1);
+  }
+
+  /**
+   * Insert into this full page at index, moving the upper half of the children to the empty page recipient.
+   * @return the key separating this page from recipient, kept as the recipient's unused first key
+   */
+  KeyType InsertAndSplit(int index, const KeyType &key, page_id_t child, FixedKeyInternalPage *recipient) {
+    int half = GetSize() / 2;
+    int moved = GetSize() - half;
+    memcpy(recipient->Keys(), Keys() + half, moved * sizeof(KeyType));
+    memcpy(recipient->Values(), Values() + half, moved * sizeof(page_id_t));
+    recipient->SetSize(moved);
+    SetSize(half);
+    if (index <= half) {
+      InsertAt(index, key, child);
+    } else {
+      recipient->InsertAt(index - half, key, child);
+    }
+    return recipient->KeyAt(0);
+  }
+
+  /**
+   * Append all children of right, the page after this one, whose subtree starts at separator. right is left empty.
+   * @return false if the children do not fit, leaving both pages unchanged
+   */
+  bool MergeFrom(FixedKeyInternalPage *right, const KeyType &separator) {
+    if (GetSize() + right->GetSize() > MAX_SIZE)
+      return false;
+    memcpy(Keys() + GetSize(), right->Keys(), right->GetSize() * sizeof(KeyType));
+    memcpy(Values() + GetSize(), right->Values(), right->GetSize() * sizeof(page_id_t));
+    Keys()[GetSize()] = separator;
+    IncreaseSize(right->GetSize());
+    right->SetSize(0);
+    return true;
+  }
+
+  /** @return true if inserting a child can not split the page */
+  bool IsInsertSafe() const { return GetSize() < MAX_SIZE; }
+
+  /** @return true if removing a child can not leave the page underfull */
+  bool IsRemoveSafe() const { return GetSize() > MAX_SIZE / 4; }
+
+  bool IsUnderfull() const { return GetSize() < MAX_SIZE / 4; }
+
+  /** @return true once a bulk load filling pages to fill_factor has to start a new page */
+  bool IsFilled(double fill_factor) const {
+    return GetSize() >= std::clamp(static_cast<int>(MAX_SIZE * fill_factor), 2, MAX_SIZE);
+  }
+
+ private:
+  KeyType *Keys() { return reinterpret_cast<KeyType *>(data_); }
+
+  const KeyType *Keys() const { return reinterpret_cast<const KeyType *>(data_); }
+
+  page_id_t *Values() { return reinterpret_cast<page_id_t *>(data_ + MAX_SIZE * sizeof(KeyType)); }
+
+  const page_id_t *Values() const { return reinterpret_cast<const page_id_t *>(data_ + MAX_SIZE * sizeof(KeyType)); }
+
+  char data_[PAGE_SIZE - HEADER_SIZE];
+};
+
+/** Pages and key types of FixedKeyBPlusTree, see SpecializedBPlusTree. */
+template <typename KeyType>
+struct FixedKeyFormat {
+  // the key as passed to the tree
+  using Key = KeyType;
+  // a key the tree keeps a copy of
+  using KeyBuf = KeyType;
+  using LeafPage = FixedKeyLeafPage<KeyType>;
+  using InternalPage = FixedKeyInternalPage<KeyType>;
+};
+
+#endif  // MINISQL_FIXED_KEY_B_PLUS_TREE_PAGE_H
@@ -0,0 +1,56 @@
+#ifndef MINISQL_FREE_SPACE_MAP_PAGE_H
+#define MINISQL_FREE_SPACE_MAP_PAGE_H
+
+#include <utility>
+
+#include "common/config.h"
+
+/**
+ * One page of a table's free space map. Pages of the map are chained through NextPageId and list the heap pages in
+ * the order they were added to the table, together with the free bytes last recorded for each of them.
+ *
+ * Format (size in byte):
+ *  ----------------------------------------------------------------------------------------
+ * | NextPageId (4) | EntryCount (4) | Page_1 id (4) | Page_1 free space (4) | ... |
+ *  ----------------------------------------------------------------------------------------
+ */
+class FreeSpaceMapPage {
+ public:
+  void Init() {
+    next_page_id_ = INVALID_PAGE_ID;
+    count_ = 0;
+  }
+
+  page_id_t GetNextPageId() const { return next_page_id_; }
+
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  uint32_t GetCount() const { return count_; }
+
+  bool IsFull() const { return count_ >= MAX_ENTRY_COUNT; }
+
+  page_id_t GetPageId(uint32_t index) const { return entries_[index].first; }
+
+  uint32_t GetFreeSpace(uint32_t index) const { return entries_[index].second; }
+
+  void SetFreeSpace(uint32_t index, uint32_t free_space) { entries_[index].second = free_space; }
+
+  /**
+   * @return false if the page is full
+   */
+  bool Append(page_id_t page_id, uint32_t free_space) {
+    if (IsFull())
+      return false;
+    entries_[count_++] = {page_id, free_space};
+    return true;
+  }
+
+  static constexpr uint32_t MAX_ENTRY_COUNT = (PAGE_SIZE - 8) / 8;
+
+ private:
+  page_id_t next_page_id_;
+  uint32_t count_;
+  std::pair<page_id_t, uint32_t> entries_[0];
+};
+
+#endif  // MINISQL_FREE_SPACE_MAP_PAGE_H
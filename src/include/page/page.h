@@ -38,11 +38,17 @@ class Page {
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline bool IsDirty() { return is_dirty_; }
 
-  /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  /** Acquire the page write latch. Holding it also fails the validation of concurrent optimistic reads. */
+  inline void WLatch() {
+    rwlatch_.WLock();
+    version_latch_.BeginWrite();
+  }
 
   /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  inline void WUnlatch() {
+    version_latch_.EndWrite();
+    rwlatch_.WUnlock();
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
@@ -50,6 +56,18 @@ class Page {
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /**
+   * Start an optimistic read of a pinned page, which takes no latch.
+   * @return false if the page is write latched, the version is unusable then
+   */
+  inline bool ReadVersion(uint64_t &version) { return version_latch_.ReadVersion(version); }
+
+  /**
+   * @return true if the page was not write latched since ReadVersion returned version. After this page's own write
+   * latch was acquired, the version is one more than before.
+   */
+  inline bool ValidateVersion(uint64_t version) { return version_latch_.Validate(version); }
+
   /** @return the page LSN. */
   inline lsn_t GetLSN() { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -78,6 +96,8 @@ class Page {
   bool is_dirty_ = false;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** Version of the page data, bumped by the write latch. */
+  VersionLatch version_latch_;
 };
 
 #endif  // MINISQL_PAGE_H
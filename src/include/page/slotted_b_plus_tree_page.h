@@ -0,0 +1,382 @@
+#ifndef MINISQL_SLOTTED_B_PLUS_TREE_PAGE_H
+#define MINISQL_SLOTTED_B_PLUS_TREE_PAGE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "common/macros.h"
+#include "common/rowid.h"
+#include "page/b_plus_tree_page.h"
+
+/**
+ * slotted_b_plus_tree_page.h
+ *
+ * Pages of SlottedBPlusTree, the B+ tree for keys of variable length (compact keys, see KeyManager::ToCompactKey).
+ * A key takes only its own bytes instead of a slot sized for the longest key of the index, so pages of short char
+ * keys hold many more entries. Keys are byte strings compared lexicographically, a prefix ordering first.
+ *
+ * A slot directory grows from the front of the page and the key bytes grow from its end. Every slot holds the
+ * offset and size of its key and the value. Keys are prefix compressed: the longest prefix shared by all keys of
+ * the page is stored once, and the slots refer to the rest of their key only. A removed key leaves its bytes behind
+ * until the page is rebuilt, which an insert does when it runs out of contiguous space or shortens the prefix.
+ * The pages provide the page interface SpecializedBPlusTree expects, counting bytes: a split divides the bytes of a
+ * page evenly rather than its entries, and a page is underfull below a quarter of its capacity. Offsets and sizes
+ * read from a page are bounded by its capacity, so a page may be searched while it is written; the tree validates
+ * such a search before using its result.
+ *
+ * Page format (KeyBytes counts the live key bytes, the prefix included):
+ *  -----------------------------------------------------------------------------------------------------------------
+ * | HEADER (28) | NextPageId (4) | PrevPageId (4) | PrefixOffset (2) | PrefixSize (2) | FreeEnd (2) | KeyBytes (2) |
+ *  -----------------------------------------------------------------------------------------------------------------
+ * | SLOT(0) | SLOT(1) | ... | SLOT(n-1) | free space | KEY(n-1) | ... | PREFIX | ... | KEY(0) |
+ *  -----------------------------------------------------------------------------------------------------------------
+ *
+ * Leaf pages (ValueType RowId) are chained both ways by NextPageId and PrevPageId. Internal pages (ValueType
+ * page_id_t) work like FixedKeyInternalPage: the first key is empty and never used, and PAGE_ID(i) holds the keys K
+ * with KEY(i) <= K < KEY(i+1). The empty first key does not count for the prefix.
+ */
+template <typename ValueType>
+class SlottedBPlusTreePage : public BPlusTreePage {
+  static_assert(std::is_trivially_copyable<ValueType>::value, "Slot values must be trivially copyable.");
+
+  struct Slot {
+    uint16_t offset_;
+    uint16_t size_;
+    ValueType value_;
+  };
+
+ public:
+  // a key with its value, as moved between pages by splits
+  using Entry = std::pair<std::string, ValueType>;
+
+  static constexpr int HEADER_SIZE = 44;
+  // bytes available to slots and keys
+  static constexpr int CAPACITY = PAGE_SIZE - HEADER_SIZE;
+  static constexpr int SLOT_SIZE = sizeof(Slot);
+  // most entries a page holds, with empty keys
+  static constexpr int MAX_SIZE = CAPACITY / SLOT_SIZE;
+  // largest key a page takes: four of them with their slots fill at most a page, so a split always finds two halves
+  // that fit
+  static constexpr int MAX_KEY_SIZE = CAPACITY / 4 - SLOT_SIZE;
+
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID) {
+    SetPageType(std::is_same<ValueType, RowId>::value ? IndexPageType::LEAF_PAGE : IndexPageType::INTERNAL_PAGE);
+    SetKeySize(MAX_KEY_SIZE);
+    SetSize(0);
+    SetMaxSize(MAX_SIZE);
+    SetParentPageId(parent_id);
+    SetPageId(page_id);
+    next_page_id_ = INVALID_PAGE_ID;
+    prev_page_id_ = INVALID_PAGE_ID;
+    prefix_offset_ = CAPACITY;
+    prefix_size_ = 0;
+    free_end_ = CAPACITY;
+    key_bytes_ = 0;
+  }
+
+  page_id_t GetNextPageId() const { return next_page_id_; }
+
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  page_id_t GetPrevPageId() const { return prev_page_id_; }
+
+  void SetPrevPageId(page_id_t prev_page_id) { prev_page_id_ = prev_page_id; }
+
+  std::string_view GetPrefix() const { return Bytes(prefix_offset_, prefix_size_); }
+
+  /** @return the key at index, the empty string for the first key of an internal page */
+  std::string KeyAt(int index) const {
+    if (index < FirstKey())
+      return std::string();
+    std::string key(GetPrefix());
+    key.append(Suffix(index));
+    return key;
+  }
+
+  ValueType ValueAt(int index) const { return Slots()[index].value_; }
+
+  void SetValueAt(int index, const ValueType &value) { Slots()[index].value_ = value; }
+
+  /** @return a value less than, equal to or greater than zero if the key at index is less than, equal to or greater
+   * than key */
+  int CompareAt(int index, std::string_view key) const {
+    std::string_view prefix = GetPrefix();
+    size_t common = std::min(prefix.size(), key.size());
+    int cmp = prefix.substr(0, common).compare(key.substr(0, common));
+    if (cmp != 0)
+      return cmp;
+    if (key.size() < prefix.size())
+      return 1;
+    return Suffix(index).compare(key.substr(prefix.size()));
+  }
+
+  /** @return the first index i so that KeyAt(i) >= key, GetSize() if there is none */
+  int KeyIndex(std::string_view key) const { return Search(key, false); }
+
+  /** @return the first index i so that KeyAt(i) > key, GetSize() if there is none */
+  int UpperIndex(std::string_view key) const { return Search(key, true); }
+
+  /** Turn this empty internal page into a root with two children separated by key. */
+  void PopulateNewRoot(page_id_t left, const std::string &key, page_id_t right) {
+    std::vector<Entry> entries{{std::string(), left}, {key, right}};
+    Build(entries, 0, entries.size());
+  }
+
+  /** @return bytes taken by slots and live keys */
+  int UsedBytes() const { return key_bytes_ + GetSize() * SLOT_SIZE; }
+
+  /** @return true if inserting any key up to MAX_KEY_SIZE succeeds, even one that leaves the page without prefix */
+  bool IsInsertSafe() const {
+    int compressed = std::max(GetSize() - FirstKey(), 0);
+    return UsedBytes() + compressed * prefix_size_ + MAX_KEY_SIZE + SLOT_SIZE <= CAPACITY;
+  }
+
+  /** @return true if removing any pair can not leave the page underfull */
+  bool IsRemoveSafe() const { return UsedBytes() >= CAPACITY / 2; }
+
+  bool IsUnderfull() const { return UsedBytes() < CAPACITY / 4; }
+
+  /** @return true once a bulk load filling pages to fill_factor of their bytes has to start a new page */
+  bool IsFilled(double fill_factor) const {
+    return UsedBytes() >= std::clamp(static_cast<int>(CAPACITY * fill_factor), CAPACITY / 2, CAPACITY);
+  }
+
+  /**
+   * Insert at index, which must keep the keys ordered. The key of the first slot of an internal page is not stored.
+   * @return false if the page has no room for the pair, leaving it unchanged
+   */
+  bool InsertAt(int index, std::string_view key, const ValueType &value) {
+    if (index < FirstKey()) {
+      ASSERT(GetSize() == 0, "Only an empty internal page gets a first child.");
+      key = std::string_view();
+    } else if (GetSize() == FirstKey() || CommonPrefix(GetPrefix(), key) < prefix_size_ ||
+               free_end_ - GetSize() * SLOT_SIZE < static_cast<int>(key.size() - prefix_size_) + SLOT_SIZE) {
+      /* the prefix changes or the free space is fragmented: rebuild the page with the new key */
+      std::vector<Entry> entries;
+      GetEntries(entries);
+      entries.insert(entries.begin() + index, Entry(std::string(key), value));
+      if (BuiltSize(entries, 0, entries.size(), IsLeafPage()) > CAPACITY)
+        return false;
+      Build(entries, 0, entries.size());
+      return true;
+    } else {
+      key = key.substr(prefix_size_);
+    }
+    if (UsedBytes() + static_cast<int>(key.size()) + SLOT_SIZE > CAPACITY)
+      return false;
+    Slot slot{Place(key), static_cast<uint16_t>(key.size()), value};
+    memmove(Slots() + index + 1, Slots() + index, (GetSize() - index) * SLOT_SIZE);
+    Slots()[index] = slot;
+    IncreaseSize(1);
+    return true;
+  }
+
+  /** Remove the pair at index. The prefix stays as it is. */
+  void RemoveAt(int index) {
+    key_bytes_ -= Slots()[index].size_;
+    memmove(Slots() + index, Slots() + index + 1, (GetSize() - index - 1) * SLOT_SIZE);
+    IncreaseSize(-1);
+  }
+
+  /**
+   * Insert into this full page at index, moving the upper part of the pairs to the empty page recipient so that
+   * both hold about as many bytes. The pages are not linked.
+   * @return the key separating this page from recipient: for leaves the shortest one (see Separator), for internal
+   * pages the key moved up, which becomes the recipient's empty first key
+   */
+  std::string InsertAndSplit(int index, std::string_view key, const ValueType &value, SlottedBPlusTreePage *recipient) {
+    std::vector<Entry> entries;
+    GetEntries(entries);
+    entries.insert(entries.begin() + index, Entry(std::string(key), value));
+    size_t split = SplitPoint(entries, IsLeafPage());
+    recipient->Build(entries, split, entries.size());
+    Build(entries, 0, split);
+    if (IsLeafPage())
+      return Separator(entries[split - 1].first, entries[split].first);
+    return std::move(entries[split].first);
+  }
+
+  /**
+   * Append all pairs of right, the page after this one, and for leaves take over its next page. The empty first key
+   * of an internal right is replaced by separator, the key its subtree starts at. right is left empty.
+   * @return false if the pairs do not fit, leaving both pages unchanged
+   */
+  bool MergeFrom(SlottedBPlusTreePage *right, std::string_view separator = std::string_view()) {
+    std::vector<Entry> entries;
+    GetEntries(entries);
+    size_t first = entries.size();
+    right->GetEntries(entries);
+    if (!IsLeafPage() && first < entries.size())
+      entries[first].first.assign(separator);
+    if (BuiltSize(entries, 0, entries.size(), IsLeafPage()) > CAPACITY)
+      return false;
+    Build(entries, 0, entries.size());
+    right->SetSize(0);
+    if (IsLeafPage())
+      next_page_id_ = right->next_page_id_;
+    return true;
+  }
+
+  static int KeySize(std::string_view key) { return key.size(); }
+
+  /**
+   * Suffix truncation: the shortest prefix of right_first that is still greater than left_last, which separates a
+   * leaf ending with left_last from the next leaf starting with right_first.
+   */
+  static std::string Separator(std::string_view left_last, std::string_view right_first) {
+    return std::string(right_first.substr(0, CommonPrefix(left_last, right_first) + 1));
+  }
+
+  /** Append all pairs of the page to entries. */
+  void GetEntries(std::vector<Entry> &entries) const {
+    for (int i = 0; i < GetSize(); i++) {
+      entries.emplace_back(KeyAt(i), ValueAt(i));
+    }
+  }
+
+  /**
+   * Replace the pairs of the page with entries[begin, end), which must be sorted. The page keeps its type, ids and
+   * links.
+   */
+  void Build(const std::vector<Entry> &entries, size_t begin, size_t end) {
+    size_t first = begin + FirstKey();
+    /* all keys share the prefix of the first and the last one */
+    std::string_view prefix;
+    if (first < end) {
+      prefix = entries[first].first;
+      prefix = prefix.substr(0, CommonPrefix(prefix, entries[end - 1].first));
+    }
+    free_end_ = CAPACITY;
+    key_bytes_ = 0;
+    prefix_size_ = prefix.size();
+    prefix_offset_ = Place(prefix);
+    for (size_t i = begin; i < end; i++) {
+      std::string_view key = i < first ? std::string_view() : std::string_view(entries[i].first).substr(prefix.size());
+      Slots()[i - begin] = Slot{Place(key), static_cast<uint16_t>(key.size()), entries[i].second};
+    }
+    SetSize(end - begin);
+  }
+
+  /** @return the bytes taken by slots and keys of a page of the given type built from entries[begin, end) */
+  static int BuiltSize(const std::vector<Entry> &entries, size_t begin, size_t end, bool leaf) {
+    size_t first = begin + (leaf ? 0 : 1);
+    int size = (end - begin) * SLOT_SIZE;
+    if (first >= end)
+      return size;
+    int prefix_size = CommonPrefix(entries[first].first, entries[end - 1].first);
+    size += prefix_size;
+    for (size_t i = first; i < end; i++) {
+      size += entries[i].first.size() - prefix_size;
+    }
+    return size;
+  }
+
+  /**
+   * Choose where to split sorted entries that do not fit into one page: the halves [0, split) and [split, size) both
+   * fit and are as even in bytes as possible. The key at split separates the halves; in internal pages it moves up
+   * and becomes the empty first key of the right half.
+   */
+  static size_t SplitPoint(const std::vector<Entry> &entries, bool leaf) {
+    size_t best = 0;
+    int best_size = CAPACITY + 1;
+    for (size_t split = 1; split < entries.size(); split++) {
+      int size = std::max(BuiltSize(entries, 0, split, leaf), BuiltSize(entries, split, entries.size(), leaf));
+      if (size < best_size) {
+        best = split;
+        best_size = size;
+      }
+    }
+    ASSERT(best_size <= CAPACITY, "No split of the page fits.");
+    return best;
+  }
+
+  static size_t CommonPrefix(std::string_view lhs, std::string_view rhs) {
+    size_t size = std::min(lhs.size(), rhs.size());
+    size_t i = 0;
+    while (i < size && lhs[i] == rhs[i])
+      i++;
+    return i;
+  }
+
+ private:
+  // the first key that is stored: internal pages leave out their first one
+  int FirstKey() const { return IsLeafPage() ? 0 : 1; }
+
+  Slot *Slots() { return reinterpret_cast<Slot *>(data_); }
+
+  const Slot *Slots() const { return reinterpret_cast<const Slot *>(data_); }
+
+  // bytes within the page, cut at its end if offset and size were read while the page was written
+  std::string_view Bytes(uint16_t offset, uint16_t size) const {
+    offset = std::min<uint16_t>(offset, CAPACITY);
+    return {data_ + offset, std::min<size_t>(size, CAPACITY - offset)};
+  }
+
+  std::string_view Suffix(int index) const { return Bytes(Slots()[index].offset_, Slots()[index].size_); }
+
+  // @return the first index in [FirstKey(), GetSize()) whose key is not less than key (greater than key if upper)
+  int Search(std::string_view key, bool upper) const {
+    int begin = FirstKey();
+    /* the size is bounded by the capacity as well */
+    int end = std::min(GetSize(), MAX_SIZE);
+    if (begin >= end)
+      return end;
+    /* comparing with the prefix first places keys outside of it with a single comparison */
+    std::string_view prefix = GetPrefix();
+    size_t common = std::min(prefix.size(), key.size());
+    int cmp = key.substr(0, common).compare(prefix.substr(0, common));
+    if (cmp < 0 || (cmp == 0 && key.size() < prefix.size()))
+      return begin;
+    if (cmp > 0)
+      return end;
+    std::string_view rest = key.substr(prefix.size());
+    while (begin < end) {
+      int mid = begin + (end - begin) / 2;
+      int result = Suffix(mid).compare(rest);
+      if (result < 0 || (upper && result == 0)) {
+        begin = mid + 1;
+      } else {
+        end = mid;
+      }
+    }
+    return begin;
+  }
+
+  // copy bytes into the free space below the keys
+  uint16_t Place(std::string_view bytes) {
+    free_end_ -= bytes.size();
+    memcpy(data_ + free_end_, bytes.data(), bytes.size());
+    key_bytes_ += bytes.size();
+    return free_end_;
+  }
+
+  page_id_t next_page_id_;
+  page_id_t prev_page_id_;
+  uint16_t prefix_offset_;
+  uint16_t prefix_size_;
+  uint16_t free_end_;
+  uint16_t key_bytes_;
+  char data_[CAPACITY];
+};
+
+using SlottedLeafPage = SlottedBPlusTreePage<RowId>;
+
+using SlottedInternalPage = SlottedBPlusTreePage<page_id_t>;
+
+/** Pages and key types of SlottedBPlusTree, see SpecializedBPlusTree. */
+struct SlottedKeyFormat {
+  // the key as passed to the tree
+  using Key = std::string_view;
+  // a key the tree keeps a copy of
+  using KeyBuf = std::string;
+  using LeafPage = SlottedLeafPage;
+  using InternalPage = SlottedInternalPage;
+};
+
+#endif  // MINISQL_SLOTTED_B_PLUS_TREE_PAGE_H
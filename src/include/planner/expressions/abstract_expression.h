@@ -9,6 +9,7 @@
 #include <vector>
 
 #include "record/row.h"
+#include "record/row_view.h"
 #include "record/schema.h"
 
 class AbstractExpression;
@@ -36,6 +37,13 @@ class AbstractExpression {
   /** @return The field obtained by evaluating the row */
   virtual Field Evaluate(const Row *row) const = 0;
 
+  /**
+   * Evaluate the expression directly on the serialized bytes of a row, without materializing it. Char fields of
+   * the result may point into the viewed buffer.
+   * @return The field obtained by evaluating the row view
+   */
+  virtual Field Evaluate(const RowView &row) const = 0;
+
   /**
    * Returns the field obtained by evaluating a JOIN.
    * @param left_row The left row
@@ -20,19 +20,21 @@
  * | Field Nums | Null bitmap |
  * -------------------------------------------
  *
- *
+ * The fields of a row, including the data of its char fields, live in a MemHeap. By default every row owns a small
+ * ArenaMemHeap of its own; rows that share a lifetime (e.g. the rows produced by one query) can instead be built in
+ * a shared heap, which must outlive them and is not freed by the row.
  */
 class Row {
  public:
   /**
    * Row used for insert
    * Field integrity should check by upper level
+   * @param heap heap to allocate the fields in, nullptr for a heap owned by the row
    */
-  explicit Row(std::vector<Field> &fields) : heap_(new SimpleMemHeap) {
+  explicit Row(std::vector<Field> &fields, MemHeap *heap = nullptr) : Row(RowId(), heap) {
     // deep copy
     for (auto &field : fields) {
-      void *buf = heap_->Allocate(sizeof(Field));
-      fields_.push_back(new (buf) Field(field));
+      fields_.push_back(CopyField(field));
       if (field.IsNull())
         null_nums++;
     }
@@ -47,32 +49,47 @@ class Row {
 
   /**
    * Row used for deserialize and update
+   * @param heap heap to allocate the fields in, nullptr for a heap owned by the row
    */
-  explicit Row(RowId rid) : rid_(rid), heap_(new SimpleMemHeap) {}
+  explicit Row(RowId rid, MemHeap *heap = nullptr)
+      : rid_(rid), heap_(heap != nullptr ? heap : new ArenaMemHeap(OWN_HEAP_CHUNK_SIZE)), own_heap_(heap == nullptr) {}
 
   /**
-   * Row copy function, deep copy
+   * Row copy function, deep copy into a heap owned by the new row
    */
-  Row(const Row &other) : heap_(new SimpleMemHeap) {
-    if (!fields_.empty()) {
-      for (auto &field : fields_) {
-        heap_->Free(field);
-      }
-      fields_.clear();
-    }
-    rid_ = other.rid_;
+  Row(const Row &other) : Row(other, nullptr) {}
+
+  /**
+   * Deep copy other into heap, nullptr for a heap owned by the new row
+   */
+  Row(const Row &other, MemHeap *heap) : Row(other.rid_, heap) {
     for (auto &field : other.fields_) {
-      void *buf = heap_->Allocate(sizeof(Field));
-      fields_.push_back(new (buf) Field(*field));
-      if (field->IsNull()) null_nums++;
+      fields_.push_back(CopyField(*field));
     }
-
     fields_nums = other.fields_nums;
+    null_nums = other.null_nums;
+  }
+
+  /**
+   * Take over the fields and the heap of other, which is left empty
+   */
+  Row(Row &&other) noexcept
+      : rid_(other.rid_),
+        fields_(std::move(other.fields_)),
+        heap_(other.heap_),
+        own_heap_(other.own_heap_),
+        fields_nums(other.fields_nums),
+        null_nums(other.null_nums) {
+    other.fields_.clear();
+    other.heap_ = nullptr;
+    other.own_heap_ = false;
+    other.fields_nums = other.null_nums = 0;
   }
 
-  //析构函数的纯虚函数
+  //析构函数的纯虚函数；字段都分配在heap_中，不需要单独析构，共享的heap_不由行释放
   virtual ~Row() {
-    delete heap_;
+    if (own_heap_)
+      delete heap_;
   }
 
   /**
@@ -109,13 +126,22 @@ class Row {
   Row &operator=(const Row &other) = delete;
 
  private:
+  /** First chunk size of the heap a row owns; enough for the fields of a typical row */
+  static constexpr size_t OWN_HEAP_CHUNK_SIZE = 256;
+
   RowId rid_{};
-  std::vector<Field *> fields_; /** Make sure that all field ptr are destructed*/
+  std::vector<Field *> fields_; /** Fields are allocated in heap_ and never own their data */
 
   MemHeap *heap_ {nullptr};
+  bool own_heap_{true};
   uint32_t fields_nums{0};
   uint32_t null_nums{0};
 
+  /**
+   * Copy field into heap_, together with its char data
+   */
+  Field *CopyField(const Field &field);
+
   /**
    * Helper function for SerializeTo and DeserializeFrom to write to a buffer
    */
@@ -0,0 +1,78 @@
+#ifndef MINISQL_ROW_VIEW_H
+#define MINISQL_ROW_VIEW_H
+
+#include <vector>
+
+#include "common/macros.h"
+#include "common/rowid.h"
+#include "record/field.h"
+#include "record/row.h"
+#include "record/schema.h"
+
+/**
+ * RowView is a read-only, non-owning view of a serialized row (see Row for the format), e.g. a tuple inside a
+ * pinned TablePage. Field values are read in place: integers and floats by offset, chars as a pointer into the
+ * buffer. The buffer must stay valid and unchanged while the view is used.
+ *
+ * A view can be re-pointed at another tuple with Reset, which reuses its offset table, so scanning a page with one
+ * view allocates nothing per tuple. Use Materialize to build an owning Row from the viewed tuple.
+ */
+class RowView {
+ public:
+  RowView() = default;
+
+  RowView(const char *buf, Schema *schema, RowId rid) { Reset(buf, schema, rid); }
+
+  /**
+   * Point the view at the serialized row in buf and locate each of its fields.
+   */
+  void Reset(const char *buf, Schema *schema, RowId rid);
+
+  [[nodiscard]] inline RowId GetRowId() const { return rid_; }
+
+  inline size_t GetFieldCount() const { return offsets_.size(); }
+
+  inline bool IsNull(uint32_t idx) const {
+    ASSERT(idx < offsets_.size(), "Failed to access field");
+    return offsets_[idx] == NULL_OFFSET;
+  }
+
+  inline TypeId GetTypeId(uint32_t idx) const { return schema_->GetColumn(idx)->GetType(); }
+
+  /** @return value of a non-null int field */
+  int32_t GetInt(uint32_t idx) const;
+
+  /** @return value of a non-null float field */
+  float GetFloat(uint32_t idx) const;
+
+  /**
+   * @param[out] len length of the char data
+   * @return pointer to the data of a non-null char field, inside the viewed buffer
+   */
+  const char *GetChars(uint32_t idx, uint32_t *len) const;
+
+  /**
+   * @return the field at idx. Char fields do not own their data: they point into the viewed buffer.
+   */
+  Field GetField(uint32_t idx) const;
+
+  /** @return number of bytes the viewed row occupies */
+  inline uint32_t GetSerializedSize() const { return size_; }
+
+  /**
+   * Deserialize the viewed row into row, which must have no fields yet. The rid of the view is copied too.
+   * @return number of bytes read
+   */
+  uint32_t Materialize(Row *row) const;
+
+ private:
+  static constexpr uint32_t NULL_OFFSET = UINT32_MAX;
+
+  const char *buf_{nullptr};
+  Schema *schema_{nullptr};
+  RowId rid_{};
+  std::vector<uint32_t> offsets_;  // offset of each field in buf_, NULL_OFFSET for null fields
+  uint32_t size_{0};
+};
+
+#endif  // MINISQL_ROW_VIEW_H
@@ -0,0 +1,189 @@
+#ifndef MINISQL_ASYNC_IO_H
+#define MINISQL_ASYNC_IO_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <sys/uio.h>
+
+#include "common/config.h"
+
+using namespace std;
+
+class DiskManager;
+
+/**
+ * Backends an AsyncIoContext can be built on. AUTO picks io_uring when the kernel allows it and falls back to the
+ * I/O thread pool otherwise.
+ */
+enum class AsyncIoBackend { AUTO, IO_URING, THREAD_POOL };
+
+/**
+ * Result of one asynchronous page request.
+ */
+struct IoCompletion {
+  uint64_t tag_;   // tag given when the request was prepared
+  bool success_;   // false if the read or write failed
+};
+
+/**
+ * AsyncIoContext queues page reads and writes and hands them to the disk in batches.
+ *
+ * Requests are first prepared (no system call), then sent together by Submit, and their completions are collected
+ * with Poll. The buffers passed to PrepareRead/PrepareWrite must stay valid until the request completes. A context
+ * is meant to be driven by one thread at a time; different threads should use different contexts. It must be
+ * destroyed before its DiskManager, and waits for its in-flight requests when destroyed.
+ */
+class AsyncIoContext {
+ public:
+  AsyncIoContext(DiskManager *disk_manager, size_t queue_depth);
+
+  virtual ~AsyncIoContext() = default;
+
+  /**
+   * Queue a read of a logical page into page_data.
+   * @return false if queue_depth requests are already prepared or in flight
+   */
+  bool PrepareRead(page_id_t logical_page_id, char *page_data, uint64_t tag);
+
+  /**
+   * Queue a write of page_data to a logical page.
+   * @return false if queue_depth requests are already prepared or in flight
+   */
+  bool PrepareWrite(page_id_t logical_page_id, const char *page_data, uint64_t tag);
+
+  /**
+   * Send every prepared request to the disk in one submission. Requests the kernel refuses are handed to Poll as
+   * failed completions.
+   * @return the number of requests submitted
+   */
+  virtual size_t Submit() = 0;
+
+  /**
+   * Append finished requests to completions, waiting until at least min_complete are available. min_complete is
+   * capped by the number of requests still outstanding.
+   * @return the number of completions appended
+   */
+  virtual size_t Poll(vector<IoCompletion> &completions, size_t min_complete) = 0;
+
+  /** @return number of requests prepared or submitted whose completion has not been polled yet */
+  size_t Outstanding() const { return prepared_.size() + in_flight_ + ready_.size(); }
+
+  size_t GetQueueDepth() const { return queue_depth_; }
+
+  virtual AsyncIoBackend GetBackend() const = 0;
+
+ protected:
+  struct Request {
+    bool is_write_;
+    page_id_t physical_page_id_;
+    char *data_;
+    uint64_t tag_;
+  };
+
+  /** Move at most max_count ready completions to completions. */
+  size_t TakeReady(vector<IoCompletion> &completions, size_t max_count);
+
+  DiskManager *disk_manager_;
+  size_t queue_depth_;
+  vector<Request> prepared_;    // prepared but not submitted yet
+  size_t in_flight_{0};         // submitted but not completed yet
+  deque<IoCompletion> ready_;   // completed but not polled yet
+};
+
+/**
+ * AsyncIoContext backed by a Linux io_uring instance, driven with raw system calls.
+ */
+class IoUringContext : public AsyncIoContext {
+ public:
+  /**
+   * @return a context, nullptr if io_uring is not available on this system
+   */
+  static unique_ptr<AsyncIoContext> Create(DiskManager *disk_manager, size_t queue_depth);
+
+  ~IoUringContext() override;
+
+  size_t Submit() override;
+
+  size_t Poll(vector<IoCompletion> &completions, size_t min_complete) override;
+
+  AsyncIoBackend GetBackend() const override { return AsyncIoBackend::IO_URING; }
+
+ private:
+  IoUringContext(DiskManager *disk_manager, size_t queue_depth);
+
+  bool Setup();
+
+  /** Move completions from the completion ring to ready_. */
+  void Reap();
+
+  int ring_fd_{-1};
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  void *sqes_{nullptr};
+  size_t sqes_size_{0};
+  unsigned *sq_head_{nullptr};
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  void *cqes_{nullptr};
+  unsigned sq_entries_{0};
+  vector<Request> slots_;       // request behind each submission queue entry
+  vector<struct iovec> iovecs_;  // buffers of each submission queue entry
+};
+
+/**
+ * Fixed set of threads running blocking I/O for ThreadPoolIoContext.
+ */
+class IoThreadPool {
+ public:
+  explicit IoThreadPool(size_t num_threads);
+
+  ~IoThreadPool();
+
+  void Enqueue(function<void()> task);
+
+ private:
+  void Run();
+
+  vector<thread> workers_;
+  deque<function<void()>> tasks_;
+  mutex latch_;
+  condition_variable cv_;
+  bool stop_{false};
+};
+
+/**
+ * AsyncIoContext that runs each request as a blocking pread/pwrite on the DiskManager's I/O thread pool.
+ */
+class ThreadPoolIoContext : public AsyncIoContext {
+ public:
+  ThreadPoolIoContext(DiskManager *disk_manager, size_t queue_depth, IoThreadPool *pool);
+
+  ~ThreadPoolIoContext() override;
+
+  size_t Submit() override;
+
+  size_t Poll(vector<IoCompletion> &completions, size_t min_complete) override;
+
+  AsyncIoBackend GetBackend() const override { return AsyncIoBackend::THREAD_POOL; }
+
+ private:
+  IoThreadPool *pool_;
+  mutex latch_;                 // protects done_ against the pool threads
+  condition_variable cv_;
+  deque<IoCompletion> done_;    // completed by the pool threads, not yet moved to ready_
+};
+
+#endif  // MINISQL_ASYNC_IO_H
@@ -2,15 +2,17 @@
 #define DISK_MGR_H
 
 #include <atomic>
-#include <fstream>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include "common/config.h"
 #include "common/macros.h"
 #include "page/bitmap_page.h"
 #include "page/disk_file_meta_page.h"
+#include "storage/async_io.h"
 
 /**
  * DiskManager takes care of the allocation and de allocation of pages within a database. It performs the reading and
@@ -19,6 +21,14 @@
  * Disk page storage format: (Free Page BitMap Size = PAGE_SIZE * 8, we note it as N)
  * | Meta Page | Free Page BitMap 1 | Page 1 | Page 2 | ....
  *      | Page N | Free Page BitMap 2 | Page N+1 | ... | Page 2N | ... |
+ *
+ * The free page bitmaps of all extents are kept in memory, so allocating, freeing and checking pages costs no disk
+ * I/O. Changed bitmaps are written back lazily, together with the meta page, at Sync.
+ *
+ * Pages are read and written with pread/pwrite on a raw file descriptor, so reads and writes of different pages
+ * from different threads run in parallel. Writes are not flushed one by one: they only become durable at Sync,
+ * which also writes the meta page back. Batches of page requests can be issued asynchronously through an
+ * AsyncIoContext created by CreateAsyncIoContext.
  */
 class DiskManager {
  public:
@@ -58,6 +68,20 @@ class DiskManager {
    */
   bool IsPageFree(page_id_t logical_page_id);
 
+  /**
+   * Create a context issuing batched asynchronous page reads and writes against this database file.
+   * @param queue_depth maximum number of requests the context keeps outstanding
+   * @param backend io_uring, the I/O thread pool, or AUTO to use io_uring when the kernel supports it
+   * @return the context, nullptr if IO_URING was requested but is not available
+   */
+  std::unique_ptr<AsyncIoContext> CreateAsyncIoContext(size_t queue_depth,
+                                                       AsyncIoBackend backend = AsyncIoBackend::AUTO);
+
+  /**
+   * Write the meta page back and flush every write issued so far to stable storage.
+   */
+  void Sync();
+
   /**
    * Shut down the disk manager and close all the file resources.
    */
@@ -72,20 +96,41 @@ class DiskManager {
   static constexpr size_t BITMAP_SIZE = BitmapPage<PAGE_SIZE>::GetMaxSupportedSize();
 
  private:
+  friend class AsyncIoContext;
+  friend class IoUringContext;
+  friend class ThreadPoolIoContext;
+
   /**
    * Helper function to get disk file size
    */
-  int GetFileSize(const std::string &file_name);
+  size_t GetFileSize();
+
+  /**
+   * @return physical page id of the free page bitmap of an extent
+   */
+  static page_id_t BitmapPhysicalPageId(uint32_t extent_index);
+
+  /**
+   * @return the cached free page bitmap of an extent. Caller must hold meta_latch_.
+   */
+  BitmapPage<PAGE_SIZE> *GetExtentBitmap(uint32_t extent_index);
+
+  /**
+   * Raise the cached file size to at least end
+   */
+  void ExtendFileSize(size_t end);
 
   /**
    * Read physical page from disk
+   * @return false on I/O error
    */
-  void ReadPhysicalPage(page_id_t physical_page_id, char *page_data);
+  bool ReadPhysicalPage(page_id_t physical_page_id, char *page_data);
 
   /**
    * Write data to physical page in disk
+   * @return false on I/O error
    */
-  void WritePhysicalPage(page_id_t physical_page_id, const char *page_data);
+  bool WritePhysicalPage(page_id_t physical_page_id, const char *page_data);
 
   /**
    * Map logical page id to physical page id
@@ -93,13 +138,23 @@ class DiskManager {
   page_id_t MapPageId(page_id_t logical_page_id);
 
  private:
-  // stream to write db file
-  std::fstream db_io_;
+  // file descriptor of db file
+  int db_fd_{-1};
   std::string file_name_;
-  // with multiple buffer pool instances, need to protect file access
-  std::recursive_mutex db_io_latch_;
+  // size of db file, kept up to date by WritePhysicalPage instead of asking the file system on every read
+  std::atomic<size_t> file_size_{0};
+  // protects allocation metadata: the meta page and the free page bitmaps
+  std::recursive_mutex meta_latch_;
+  // cached free page bitmap of every extent, and whether it changed since the last Sync
+  std::vector<std::unique_ptr<char[]>> extent_bitmaps_;
+  std::vector<bool> bitmap_dirty_;
+  // every extent before this one is full
+  uint32_t first_free_extent_{0};
   bool closed{false};
   char meta_data_[PAGE_SIZE];
+  // threads serving ThreadPoolIoContext requests, created by the first context that needs them
+  std::unique_ptr<IoThreadPool> io_thread_pool_;
+  std::once_flag io_thread_pool_once_;
 };
 
 #endif
@@ -0,0 +1,102 @@
+#ifndef MINISQL_FREE_SPACE_MAP_H
+#define MINISQL_FREE_SPACE_MAP_H
+
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "page/free_space_map_page.h"
+
+/**
+ * FreeSpaceMap records the free bytes of every page of a table heap, so that an insert can pick a page with enough
+ * room without walking the page chain.
+ *
+ * The map is kept in memory, ordered by free space, and written through to a chain of FreeSpaceMapPage pages starting
+ * at the root page. It is read back lazily by Load. A map built with an invalid root page id lives only in memory.
+ * The recorded values may lag behind the pages; callers correct them with UpdatePage when an insert does not fit.
+ * If a map page can not be allocated the entry is kept in memory only, so after a restart the map may miss pages
+ * at the end of the chain.
+ */
+class FreeSpaceMap {
+ public:
+  FreeSpaceMap(BufferPoolManager *buffer_pool_manager, page_id_t root_page_id);
+
+  /**
+   * Allocate the root page of a new, empty map.
+   * @return the root page id, INVALID_PAGE_ID if no page could be allocated
+   */
+  static page_id_t CreateRoot(BufferPoolManager *buffer_pool_manager);
+
+  page_id_t GetRootPageId() const { return root_page_id_; }
+
+  bool IsPersistent() const { return root_page_id_ != INVALID_PAGE_ID; }
+
+  bool IsLoaded() const { return loaded_; }
+
+  /**
+   * Read the entries stored in the map pages into memory.
+   */
+  void Load();
+
+  /**
+   * Record a heap page that has just been appended to the table.
+   */
+  void AddPage(page_id_t page_id, uint32_t free_space);
+
+  /**
+   * Record the current free bytes of a heap page already in the map.
+   */
+  void UpdatePage(page_id_t page_id, uint32_t free_space);
+
+  /**
+   * @return recorded free bytes of a heap page, 0 if it is not in the map
+   */
+  uint32_t GetFreeSpace(page_id_t page_id) const;
+
+  /**
+   * Find the page with the least free space that still has at least required bytes.
+   * @return the page id, INVALID_PAGE_ID if no page has enough room
+   */
+  page_id_t FindPage(uint32_t required) const;
+
+  /**
+   * @return the heap page added last, i.e. the tail of the page chain
+   */
+  page_id_t GetLastPageId() const { return last_page_id_; }
+
+  size_t GetPageCount() const { return entries_.size(); }
+
+  /**
+   * @return all heap pages in the map, in the order they were added
+   */
+  vector<page_id_t> GetPageIds() const;
+
+  /**
+   * Delete every page of the map. The map is empty and in memory only afterwards.
+   */
+  void Destroy();
+
+ private:
+  struct Entry {
+    uint32_t free_space_;
+    uint32_t index_;  // position in the map pages, in the order the heap pages were added
+  };
+
+  /**
+   * Write an entry through to the map page holding it, appending a map page if needed.
+   */
+  void Persist(uint32_t index, page_id_t page_id, uint32_t free_space, bool append);
+
+ private:
+  BufferPoolManager *buffer_pool_manager_;
+  page_id_t root_page_id_;
+  bool loaded_{false};
+  vector<page_id_t> map_pages_;                      // pages of the map, in chain order
+  unordered_map<page_id_t, Entry> entries_;          // heap page -> recorded free space
+  set<pair<uint32_t, page_id_t>> by_free_space_;     // heap pages ordered by recorded free space
+  page_id_t last_page_id_{INVALID_PAGE_ID};
+};
+
+#endif  // MINISQL_FREE_SPACE_MAP_H
@@ -0,0 +1,57 @@
+#ifndef MINISQL_TABLE_BATCH_ITERATOR_H
+#define MINISQL_TABLE_BATCH_ITERATOR_H
+
+#include <functional>
+#include <vector>
+
+#include "buffer/buffer_ring.h"
+#include "record/row.h"
+#include "record/row_view.h"
+#include "storage/table_iterator.h"
+#include "transaction/transaction.h"
+
+class TableHeap;
+
+/**
+ * TableBatchIterator scans a table heap a page at a time. Each call to NextBatch pins and latches one heap page,
+ * copies out all of its live tuples and releases the page again, so a scan costs one fetch per page instead of
+ * two per tuple. Pages without live tuples are skipped.
+ */
+class TableBatchIterator {
+ public:
+  /**
+   * @param ring optional bulk-read hint used for every page the iterator fetches
+   */
+  TableBatchIterator(TableHeap *table_heap, Transaction *txn, BufferRing *ring = nullptr);
+
+  /**
+   * Iterator over the given heap pages only, visited in the given order instead of following the page chain.
+   */
+  TableBatchIterator(TableHeap *table_heap, Transaction *txn, std::vector<page_id_t> page_ids,
+                     BufferRing *ring = nullptr);
+
+  /**
+   * Replace the contents of rows with the live tuples of the next non-empty page, in slot order.
+   * @param filter optional test run on a view of each tuple before it is deserialized; rejected tuples are skipped
+   * and pages where no tuple passes count as empty
+   * @param heap heap the rows are built in, nullptr for rows owning their own heap
+   * @return false if the scan has reached the end of the table (rows is left empty)
+   */
+  bool NextBatch(std::vector<Row> &rows, const std::function<bool(const RowView &)> &filter = nullptr,
+                 MemHeap *heap = nullptr);
+
+  /** @return true once every page has been returned */
+  bool IsEnd() const { return next_page_id_ == INVALID_PAGE_ID; }
+
+ private:
+  TableHeap *table_heap_;
+  Transaction *txn_;
+  BufferRing *ring_;
+  page_id_t next_page_id_;     // page returned by the next NextBatch call
+  bool follow_chain_{true};    // false if only the pages in page_ids_ are visited
+  std::vector<page_id_t> page_ids_;
+  size_t next_index_{0};       // position in page_ids_ of the page after next_page_id_
+  TableReadAhead read_ahead_;
+};
+
+#endif  // MINISQL_TABLE_BATCH_ITERATOR_H
@@ -4,12 +4,15 @@
 #include "buffer/buffer_pool_manager.h"
 #include "page/header_page.h"
 #include "page/table_page.h"
+#include "storage/free_space_map.h"
+#include "storage/table_batch_iterator.h"
 #include "storage/table_iterator.h"
 #include "transaction/lock_manager.h"
 #include "transaction/log_manager.h"
 
 class TableHeap {
   friend class TableIterator;
+  friend class TableBatchIterator;
 
  public:
   static TableHeap *Create(BufferPoolManager *buffer_pool_manager, Schema *schema, Transaction *txn,
@@ -18,21 +21,36 @@ class TableHeap {
   }
 
   /* Catalog_Manager use this Ctor to reconstruct table_heap from table_info */
-  static TableHeap *Create(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                           LogManager *log_manager, LockManager *lock_manager) {
-    return new TableHeap(buffer_pool_manager, first_page_id, schema, log_manager, lock_manager);
+  static TableHeap *Create(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id,
+                           page_id_t free_space_map_page_id, Schema *schema, LogManager *log_manager,
+                           LockManager *lock_manager) {
+    return new TableHeap(buffer_pool_manager, first_page_id, free_space_map_page_id, schema, log_manager,
+                         lock_manager);
   }
 
   ~TableHeap() {}
 
   /**
    * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
+   * The target page is the page of the previous insert if it still has room, otherwise one found in the free space
+   * map; a new page is appended only when no page has room.
    * @param[in/out] row Tuple Row to insert, the rid of the inserted tuple is wrapped in object row
    * @param[in] txn The transaction performing the insert
    * @return true iff the insert is successful
    */
   bool InsertTuple(Row &row, Transaction *txn);
 
+  /**
+   * Insert a batch of tuples. Rows are packed back to back into pages that still have room, each page being pinned
+   * and latched once for the whole batch; the rest go to new pages that are linked to each other while they are
+   * filled and spliced onto the end of the page chain in one step.
+   * @param[in/out] rows Tuples to insert, the rid of each inserted tuple is wrapped in its row
+   * @param[in] txn The transaction performing the insert
+   * @return true iff every row was inserted; false if a row is too large (nothing is inserted then) or the buffer
+   * pool ran out of pages (the rows before the failing one are inserted)
+   */
+  bool InsertTuples(std::vector<Row> &rows, Transaction *txn);
+
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
    * @param[in] rid Resource id of the tuple of delete
@@ -82,6 +100,7 @@ class TableHeap {
       buffer_pool_manager_->UnpinPage(old_page_id, false);
       buffer_pool_manager_->DeletePage(old_page_id);
     }
+    free_space_map_.Destroy();
   }
 
   /**
@@ -90,9 +109,25 @@ class TableHeap {
   void DeleteTable(page_id_t page_id = INVALID_PAGE_ID);
 
   /**
+   * @param ring optional bulk-read hint used for every page the iterator fetches
    * @return the begin iterator of this table
    */
-  TableIterator Begin(Transaction *txn);
+  TableIterator Begin(Transaction *txn, BufferRing *ring = nullptr);
+
+  /**
+   * @param ring optional bulk-read hint used for every page the iterator fetches
+   * @return an iterator returning the tuples of this table a page at a time
+   */
+  TableBatchIterator BeginBatch(Transaction *txn, BufferRing *ring = nullptr) {
+    return TableBatchIterator(this, txn, ring);
+  }
+
+  /**
+   * Split the pages of this table into at most count groups of consecutive pages, for scanning the table from
+   * several threads at once. The pages are listed from the free space map, so finding them does not read the table.
+   * @return one iterator per group; together they return every tuple of the table exactly once
+   */
+  std::vector<TableBatchIterator> BeginPartitions(Transaction *txn, size_t count);
 
   /**
    * @return the end iterator of this table
@@ -104,6 +139,11 @@ class TableHeap {
    */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  /**
+   * @return the root page of this table's free space map
+   */
+  inline page_id_t GetFreeSpaceMapPageId() const { return free_space_map_.GetRootPageId(); }
+
   bool GetNextTupleRid(const RowId &cur_rid, RowId *next_rid);
 
  private:
@@ -115,20 +155,42 @@ class TableHeap {
           buffer_pool_manager_(buffer_pool_manager),
           schema_(schema),
           log_manager_(log_manager),
-          lock_manager_(lock_manager) {
+          lock_manager_(lock_manager),
+          free_space_map_(buffer_pool_manager, FreeSpaceMap::CreateRoot(buffer_pool_manager)) {
     auto first_page = (TablePage *)(buffer_pool_manager_->NewPage(first_page_id_));
     ASSERT(first_page != nullptr, "Can not initialize the first page.");
     first_page->Init(first_page_id_, INVALID_PAGE_ID, log_manager_, txn);
+    free_space_map_.Load();
+    free_space_map_.AddPage(first_page_id_, first_page->GetFreeSpaceRemaining());
     buffer_pool_manager_->UnpinPage(first_page_id_, true);
   };
 
-  explicit TableHeap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                     LogManager *log_manager, LockManager *lock_manager)
+  explicit TableHeap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id,
+                     page_id_t free_space_map_page_id, Schema *schema, LogManager *log_manager,
+                     LockManager *lock_manager)
       : buffer_pool_manager_(buffer_pool_manager),
         first_page_id_(first_page_id),
         schema_(schema),
         log_manager_(log_manager),
-        lock_manager_(lock_manager) {}
+        lock_manager_(lock_manager),
+        free_space_map_(buffer_pool_manager, free_space_map_page_id) {}
+
+  /**
+   * Load the free space map on first use. Without a stored map, or if it is empty, it is rebuilt from the page chain.
+   */
+  void LoadFreeSpaceMap();
+
+  /**
+   * Append a new page after the last page of the chain and record it in the free space map.
+   * @return the new page, pinned; nullptr if no page could be allocated
+   */
+  TablePage *AppendPage(Transaction *txn);
+
+  /**
+   * Splice a chain of new pages, starting at first_page_id, onto the end of the page chain and record the pages
+   * (with their free bytes) in the free space map.
+   */
+  void LinkPages(page_id_t first_page_id, const std::vector<std::pair<page_id_t, uint32_t>> &pages);
 
  private:
   BufferPoolManager *buffer_pool_manager_;
@@ -136,6 +198,8 @@ class TableHeap {
   Schema *schema_;
   [[maybe_unused]] LogManager *log_manager_;
   [[maybe_unused]] LockManager *lock_manager_;
+  FreeSpaceMap free_space_map_;
+  page_id_t last_insert_page_id_{INVALID_PAGE_ID};  // page that took the previous insert
 };
 
 #endif  // MINISQL_TABLE_HEAP_H
@@ -1,11 +1,32 @@
 #ifndef MINISQL_TABLE_ITERATOR_H
 #define MINISQL_TABLE_ITERATOR_H
 
+#include "buffer/buffer_ring.h"
 #include "common/rowid.h"
 #include "record/row.h"
 #include "transaction/transaction.h"
 
+class BufferPoolManager;
 class TableHeap;
+class TablePage;
+
+/**
+ * Read-ahead state of a scan over a heap page chain, shared by TableIterator and TableBatchIterator.
+ */
+class TableReadAhead {
+ public:
+  explicit TableReadAhead(page_id_t start_page_id = INVALID_PAGE_ID) : last_page_id_(start_page_id) {}
+
+  /**
+   * Called when the scan moves onto page: prefetch the next heap page and, once page ids advance by a steady
+   * stride, a window of TABLE_SCAN_READAHEAD_PAGES pages ahead.
+   */
+  void OnPage(BufferPoolManager *buffer_pool_manager, TablePage *page);
+
+ private:
+  page_id_t last_page_id_;                       // page visited before the current one
+  page_id_t readahead_until_{INVALID_PAGE_ID};   // last page a prefetch was requested for
+};
 
 class TableIterator {
  public:
@@ -13,7 +34,7 @@ class TableIterator {
 
  public:
   //构造函数和析构函数
-  explicit TableIterator(TableHeap *table_heap, RowId rid, Transaction *txn);
+  explicit TableIterator(TableHeap *table_heap, RowId rid, Transaction *txn, BufferRing *ring = nullptr);
   TableIterator(const TableIterator &other);
   virtual ~TableIterator();
 
@@ -30,6 +51,8 @@ class TableIterator {
   TableHeap *table_heap{};    //指向TableHeap对象的指针
   Row *row{};                 //指向表中当前行的指针
   Transaction *txn{};         //指向当前事务的指针
+  BufferRing *ring{};         //批量读取时使用的缓冲环，为空时按普通方式访问缓冲池
+  TableReadAhead read_ahead;  //顺序扫描时的预读状态
 };
 
 #endif    //MINISQL_TABLE_ITERATOR_H
@@ -0,0 +1,209 @@
+#ifndef MINISQL_EXTERNAL_SORTER_H
+#define MINISQL_EXTERNAL_SORTER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <queue>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "glog/logging.h"
+
+/**
+ * Sorts fixed-size records that may not fit into memory.
+ *
+ * Added records are buffered until memory_limit bytes are used. A full buffer is sorted and written to an anonymous
+ * temporary file as a run, and Finish merges the runs with a heap, keeping one block of every run in memory. Without
+ * spilled runs the records are returned straight from the sorted buffer. If no temporary file can be created, the
+ * records simply stay in memory.
+ * The sort is stable: records comparing equal come out in the order they were added.
+ *
+ * @tparam Less compares two records given as const char *
+ */
+template <typename Less>
+class ExternalSorter {
+ public:
+  explicit ExternalSorter(size_t record_size, Less less = Less(), size_t memory_limit = INDEX_BUILD_SORT_MEMORY)
+      : record_size_(record_size), less_(less), memory_limit_(std::max(memory_limit, record_size)) {}
+
+  ~ExternalSorter() {
+    for (auto &run : runs_) {
+      if (run.file_ != nullptr) {
+        fclose(run.file_);
+      }
+    }
+  }
+
+  DISALLOW_COPY(ExternalSorter);
+
+  /** Copy a record into the sorter. Must not be called after Finish. */
+  void Add(const char *record) {
+    ASSERT(!finished_, "Records added after Finish.");
+    if (buffer_.size() + record_size_ > memory_limit_) {
+      SpillRun();
+    }
+    buffer_.insert(buffer_.end(), record, record + record_size_);
+  }
+
+  /** Stop adding records, Next returns them in order afterwards. */
+  void Finish() {
+    finished_ = true;
+    if (runs_.empty()) {
+      SortBuffer();
+      return;
+    }
+    if (!buffer_.empty()) {
+      SpillRun();
+    }
+    if (!buffer_.empty()) {
+      /* the spill failed, so the rest is merged from memory */
+      SortBuffer();
+      Run run(nullptr);
+      run.block_.resize(buffer_.size());
+      for (size_t i = 0; i < order_.size(); i++) {
+        memcpy(run.block_.data() + i * record_size_, buffer_.data() + order_[i] * record_size_, record_size_);
+      }
+      run.end_ = run.block_.size();
+      runs_.push_back(std::move(run));
+    }
+    buffer_ = std::vector<char>();
+    order_ = std::vector<uint32_t>();
+    current_.resize(record_size_);
+    for (size_t i = 0; i < runs_.size(); i++) {
+      if (runs_[i].file_ != nullptr) {
+        rewind(runs_[i].file_);
+        FillBlock(runs_[i]);
+      }
+      if (runs_[i].end_ > 0) {
+        heap_.push(i);
+      }
+    }
+  }
+
+  /**
+   * @return the next record in order, nullptr after the last one. The record stays valid until the next call.
+   */
+  char *Next() {
+    ASSERT(finished_, "Next called before Finish.");
+    if (runs_.empty()) {
+      return pos_ < order_.size() ? buffer_.data() + order_[pos_++] * record_size_ : nullptr;
+    }
+    if (heap_.empty()) {
+      return nullptr;
+    }
+    size_t i = heap_.top();
+    heap_.pop();
+    Run &run = runs_[i];
+    memcpy(current_.data(), run.block_.data() + run.pos_, record_size_);
+    run.pos_ += record_size_;
+    if (run.pos_ < run.end_ || FillBlock(run)) {
+      heap_.push(i);
+    }
+    return current_.data();
+  }
+
+  /** @return number of sorted runs merged by Next, 0 if everything was sorted in memory */
+  size_t GetRunCount() const { return runs_.size(); }
+
+  /** @return number of records sorted in memory; only meaningful after Finish when GetRunCount is 0 */
+  size_t GetRecordCount() const { return order_.size(); }
+
+  /**
+   * Random access to the records sorted in memory, independent of Next. Only valid after Finish when GetRunCount
+   * is 0.
+   */
+  const char *RecordAt(size_t index) const { return buffer_.data() + order_[index] * record_size_; }
+
+ private:
+  // bytes read from a run at once while merging
+  static constexpr size_t RUN_BLOCK_SIZE = 64 * 1024;
+
+  // a sorted run, read from file_ block by block, or held in block_ as a whole if file_ is null
+  struct Run {
+    // file_ is nullptr for a run kept in block_
+    explicit Run(FILE *file) : file_(file), block_() {}
+
+    FILE *file_;
+    std::vector<char> block_;
+    size_t pos_{0};
+    size_t end_{0};
+  };
+
+  // orders runs by their current record for the merge heap, earlier runs first among equal records
+  struct RunGreater {
+    bool operator()(size_t a, size_t b) const {
+      const Run &ra = sorter_->runs_[a];
+      const Run &rb = sorter_->runs_[b];
+      const char *rec_a = ra.block_.data() + ra.pos_;
+      const char *rec_b = rb.block_.data() + rb.pos_;
+      if (sorter_->less_(rec_b, rec_a)) {
+        return true;
+      }
+      return !sorter_->less_(rec_a, rec_b) && a > b;
+    }
+    const ExternalSorter *sorter_;
+  };
+
+  void SortBuffer() {
+    order_.resize(buffer_.size() / record_size_);
+    std::iota(order_.begin(), order_.end(), 0);
+    const char *base = buffer_.data();
+    std::stable_sort(order_.begin(), order_.end(), [&](uint32_t a, uint32_t b) {
+      return less_(base + a * record_size_, base + b * record_size_);
+    });
+    pos_ = 0;
+  }
+
+  void SpillRun() {
+    FILE *file = tmpfile();
+    if (file == nullptr) {
+      LOG(WARNING) << "Can not create a temporary file, sorting in memory.";
+      memory_limit_ = SIZE_MAX;
+      return;
+    }
+    SortBuffer();
+    bool ok = true;
+    for (uint32_t index : order_) {
+      ok = ok && fwrite(buffer_.data() + index * record_size_, record_size_, 1, file) == 1;
+    }
+    if (!ok) {
+      LOG(WARNING) << "I/O error while writing a sort run, sorting in memory.";
+      fclose(file);
+      memory_limit_ = SIZE_MAX;
+      return;
+    }
+    runs_.emplace_back(file);
+    buffer_.clear();
+    order_.clear();
+  }
+
+  // read the next block of run, false at its end
+  bool FillBlock(Run &run) {
+    if (run.file_ == nullptr) {
+      return false;
+    }
+    size_t block_records = std::max<size_t>(1, RUN_BLOCK_SIZE / record_size_);
+    run.block_.resize(block_records * record_size_);
+    run.end_ = fread(run.block_.data(), record_size_, block_records, run.file_) * record_size_;
+    run.pos_ = 0;
+    return run.end_ > 0;
+  }
+
+  size_t record_size_;
+  Less less_;
+  size_t memory_limit_;
+  bool finished_{false};
+  // unsorted records of the current run, and their sorted order
+  std::vector<char> buffer_;
+  std::vector<uint32_t> order_;
+  size_t pos_{0};
+  std::vector<Run> runs_;
+  std::priority_queue<size_t, std::vector<size_t>, RunGreater> heap_{RunGreater{this}};
+  std::vector<char> current_;
+};
+
+#endif  // MINISQL_EXTERNAL_SORTER_H
@@ -1,9 +1,10 @@
 /*
 * 文件名: mem_heap.h
 *
-* 描述: 这个文件定义了两个内存分配器的类，MemHeap 和 SimpleMemHeap。
+* 描述: 这个文件定义了三个内存分配器的类，MemHeap、SimpleMemHeap 和 ArenaMemHeap。
 * MemHeap 是一个抽象类，定义了内存分配器的基本接口。SimpleMemHeap 是 MemHeap 的一个简单实现，
 * 它使用 std::unordered_set 来保存分配的内存，以便在对象销毁时释放所有分配的内存。
+* ArenaMemHeap 按块申请内存，每次分配只移动块内的指针，所有内存在 Reset 或析构时一次性释放。
 *
 * Author: Weilin Chang
 * Last Modify Date: 6/9/2023
@@ -12,9 +13,13 @@
 #ifndef MINISQL_MEM_HEAP_H
 #define MINISQL_MEM_HEAP_H
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 #include "common/macros.h"
 
 // 内存分配器的抽象基类。
@@ -75,4 +80,81 @@ private:
  }
 };
 
+// MemHeap 的指针碰撞（bump-pointer）实现：按块向系统申请内存，分配时只在当前块中移动指针，
+// Free 不做任何事，所有内存在 Reset 或析构时一次性释放。适合生命周期相同的一批对象，
+// 例如同一条查询产生的所有行。分配出的对象不会被调用析构函数，不能用于需要析构的对象；不是线程安全的。
+class ArenaMemHeap : public MemHeap {
+public:
+ static constexpr size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+ explicit ArenaMemHeap(size_t chunk_size = DEFAULT_CHUNK_SIZE) : chunk_size_(chunk_size) {}
+
+ ~ArenaMemHeap() override {
+   for (auto &chunk : chunks_) {
+     std::free(chunk.first);
+   }
+ }
+
+ ArenaMemHeap(const ArenaMemHeap &) = delete;
+ ArenaMemHeap &operator=(const ArenaMemHeap &) = delete;
+
+ // 在当前块中分配内存，按 ALIGNMENT 对齐；当前块放不下时申请新块，超过块大小的请求单独占用一个块。
+ // 大小为 0 的请求也会返回一个有效的指针。
+ void *Allocate(size_t size) override {
+   size = (std::max<size_t>(size, 1) + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+   if (size > remaining_) {
+     NewChunk(size);
+   }
+   void *buffer = cur_;
+   cur_ += size;
+   remaining_ -= size;
+   allocated_bytes_ += size;
+   return buffer;
+ }
+
+ // 单个对象的内存不会被回收，直到 Reset 或析构。
+ void Free([[maybe_unused]] void *ptr) override {}
+
+ // 释放之前分配的所有内存。第一个块会被保留，之后的分配从第一个块重新开始。
+ void Reset() {
+   if (chunks_.empty()) {
+     return;
+   }
+   for (size_t i = 1; i < chunks_.size(); i++) {
+     std::free(chunks_[i].first);
+   }
+   chunks_.resize(1);
+   cur_ = chunks_[0].first;
+   remaining_ = chunks_[0].second;
+   allocated_bytes_ = 0;
+ }
+
+ // 返回自上次 Reset 以来分配出去的字节数（包括对齐填充）。
+ size_t GetAllocatedBytes() const { return allocated_bytes_; }
+
+ // 返回当前持有的块的数量。
+ size_t GetChunkCount() const { return chunks_.size(); }
+
+private:
+ static constexpr size_t ALIGNMENT = alignof(std::max_align_t);
+
+ // 申请一个至少能容纳 min_size 字节的新块，并将其作为当前块。
+ void NewChunk(size_t min_size) {
+   size_t size = std::max(chunk_size_, min_size);
+   char *chunk = static_cast<char *>(std::malloc(size));
+   ASSERT(chunk != nullptr, "Out of memory exception");
+   chunks_.emplace_back(chunk, size);
+   cur_ = chunk;
+   remaining_ = size;
+ }
+
+ size_t chunk_size_;
+ // 持有的所有块及其大小
+ std::vector<std::pair<char *, size_t>> chunks_;
+ // 当前块中下一次分配的位置，以及当前块剩余的字节数
+ char *cur_{nullptr};
+ size_t remaining_{0};
+ size_t allocated_bytes_{0};
+};
+
 #endif //MINISQL_MEM_HEAP_H
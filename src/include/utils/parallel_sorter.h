@@ -0,0 +1,186 @@
+#ifndef MINISQL_PARALLEL_SORTER_H
+#define MINISQL_PARALLEL_SORTER_H
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "utils/external_sorter.h"
+
+/**
+ * Run body(0) ... body(count - 1) on count threads, one of them being the calling thread, and wait for all of them.
+ */
+template <typename Body>
+void ParallelFor(size_t count, const Body &body) {
+  std::vector<std::thread> workers;
+  workers.reserve(count > 0 ? count - 1 : 0);
+  for (size_t i = 1; i < count; i++) {
+    workers.emplace_back([&body, i] { body(i); });
+  }
+  if (count > 0) {
+    body(0);
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+/**
+ * Sorts fixed-size records produced by several partitions in parallel.
+ *
+ * Sort runs one thread per partition, each filling and sorting an ExternalSorter of its own with an equal share of
+ * memory_limit. The sorted partitions are then merged: if all of them fit into memory the key space is split at
+ * quantiles of the largest partition and every thread merges one key range straight to its final place in the output,
+ * otherwise the partitions are merged through a heap while Next is called.
+ * Records comparing equal come out in partition order, and in the order they were added within a partition.
+ *
+ * @tparam Less compares two records given as const char *
+ */
+template <typename Less>
+class ParallelSorter {
+ public:
+  using Partition = ExternalSorter<Less>;
+
+  ParallelSorter(size_t record_size, size_t partitions, Less less = Less(),
+                 size_t memory_limit = INDEX_BUILD_SORT_MEMORY)
+      : record_size_(record_size), less_(less), heap_(PartitionGreater{this}) {
+    partitions = std::max<size_t>(partitions, 1);
+    for (size_t i = 0; i < partitions; i++) {
+      partitions_.push_back(std::make_unique<Partition>(record_size, less, memory_limit / partitions));
+    }
+  }
+
+  DISALLOW_COPY(ParallelSorter);
+
+  /**
+   * Sort all records. fill(i, partition) is called once for every partition, each on its own thread, and adds the
+   * records of partition i. Next returns the records in order afterwards.
+   */
+  void Sort(const std::function<void(size_t index, Partition &partition)> &fill) {
+    ParallelFor(partitions_.size(), [&](size_t i) {
+      fill(i, *partitions_[i]);
+      partitions_[i]->Finish();
+    });
+    bool in_memory = std::all_of(partitions_.begin(), partitions_.end(),
+                                 [](const std::unique_ptr<Partition> &p) { return p->GetRunCount() == 0; });
+    if (in_memory && partitions_.size() > 1) {
+      MergeInMemory();
+      return;
+    }
+    current_.resize(partitions_.size());
+    for (size_t i = 0; i < partitions_.size(); i++) {
+      current_[i] = partitions_[i]->Next();
+      if (current_[i] != nullptr) {
+        heap_.push(i);
+      }
+    }
+  }
+
+  /**
+   * @return the next record in order, nullptr after the last one. The record stays valid until the next call.
+   */
+  char *Next() {
+    if (!output_.empty() || partitions_.empty()) {
+      return pos_ < output_.size() ? &output_[(pos_ += record_size_) - record_size_] : nullptr;
+    }
+    /* advance the partition of the record returned last, which was valid up to this call */
+    if (last_ != SIZE_MAX) {
+      current_[last_] = partitions_[last_]->Next();
+      if (current_[last_] != nullptr) {
+        heap_.push(last_);
+      }
+      last_ = SIZE_MAX;
+    }
+    if (heap_.empty()) {
+      return nullptr;
+    }
+    last_ = heap_.top();
+    heap_.pop();
+    return current_[last_];
+  }
+
+ private:
+  // orders partitions by their current record for the merge heap, earlier partitions first among equal records
+  struct PartitionGreater {
+    bool operator()(size_t a, size_t b) const {
+      if (sorter_->less_(sorter_->current_[b], sorter_->current_[a])) {
+        return true;
+      }
+      return !sorter_->less_(sorter_->current_[a], sorter_->current_[b]) && a > b;
+    }
+    const ParallelSorter *sorter_;
+  };
+
+  // merge partitions that were sorted in memory into output_, one key range per thread
+  void MergeInMemory() {
+    size_t count = partitions_.size();
+    const Partition *largest = nullptr;
+    size_t total = 0;
+    for (auto &partition : partitions_) {
+      total += partition->GetRecordCount();
+      if (largest == nullptr || partition->GetRecordCount() > largest->GetRecordCount()) {
+        largest = partition.get();
+      }
+    }
+    /* bounds[r][i]: first record of partition i in key range r. Ranges are split before the quantile records of the
+     * largest partition, so equal records always land in the same range. */
+    std::vector<std::vector<size_t>> bounds(count + 1, std::vector<size_t>(count, 0));
+    for (size_t i = 0; i < count; i++) {
+      bounds[count][i] = partitions_[i]->GetRecordCount();
+    }
+    for (size_t r = 1; r < count; r++) {
+      const char *splitter = largest->RecordAt(largest->GetRecordCount() * r / count);
+      for (size_t i = 0; i < count; i++) {
+        size_t lo = bounds[r - 1][i], hi = bounds[count][i];
+        while (lo < hi) {
+          size_t mid = lo + (hi - lo) / 2;
+          if (less_(partitions_[i]->RecordAt(mid), splitter)) {
+            lo = mid + 1;
+          } else {
+            hi = mid;
+          }
+        }
+        bounds[r][i] = lo;
+      }
+    }
+    output_.resize(total * record_size_);
+    ParallelFor(count, [&](size_t r) {
+      std::vector<size_t> pos = bounds[r];
+      size_t out = 0;
+      for (size_t v : bounds[r]) {
+        out += v;
+      }
+      while (true) {
+        /* the partition with the smallest next record, the first one among equal records */
+        size_t min = SIZE_MAX;
+        for (size_t i = 0; i < count; i++) {
+          if (pos[i] < bounds[r + 1][i] &&
+              (min == SIZE_MAX || less_(partitions_[i]->RecordAt(pos[i]), partitions_[min]->RecordAt(pos[min])))) {
+            min = i;
+          }
+        }
+        if (min == SIZE_MAX) {
+          break;
+        }
+        memcpy(&output_[out++ * record_size_], partitions_[min]->RecordAt(pos[min]++), record_size_);
+      }
+    });
+    partitions_.clear();
+  }
+
+  size_t record_size_;
+  Less less_;
+  std::vector<std::unique_ptr<Partition>> partitions_;
+  // merged records if the partitions were merged in memory, and the read position in bytes
+  std::vector<char> output_;
+  size_t pos_{0};
+  // heap merge state: current record of every partition and the partition of the record returned last
+  std::vector<char *> current_;
+  size_t last_{SIZE_MAX};
+  std::priority_queue<size_t, std::vector<size_t>, PartitionGreater> heap_;
+};
+
+#endif  // MINISQL_PARALLEL_SORTER_H
@@ -1,5 +1,7 @@
 #include "index/b_plus_tree.h"
 
+#include <algorithm>
+#include <numeric>
 #include <string>
 
 #include "glog/logging.h"
@@ -11,12 +13,14 @@
  * DONE: Student Implement
  */
 BPlusTree::BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager, const KeyManager &KM,
-                     int leaf_max_size, int internal_max_size)
+                     int leaf_max_size, int internal_max_size, bool unique)
     : index_id_(index_id),
       buffer_pool_manager_(buffer_pool_manager),
       processor_(KM),
+      page_reclaimer_(buffer_pool_manager),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {
+      internal_max_size_(internal_max_size),
+      unique_(unique) {
   auto *index_roots = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager->FetchPage(INDEX_ROOTS_PAGE_ID));
 
   /* check if this index exsist */
@@ -38,6 +42,7 @@ BPlusTree::BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager
  */
 void BPlusTree::Destroy(page_id_t current_page_id) {
   /* private members */
+  page_reclaimer_.Reclaim({});
   if (current_page_id == INVALID_PAGE_ID) {
     return;
   }
@@ -50,6 +55,12 @@ void BPlusTree::Destroy(page_id_t current_page_id) {
       page_id_t child_p_id = itn_page->ValueAt(i);
       Destroy(child_p_id);
     }
+  } else {
+    /* free the posting lists of the leaf */
+    auto *leaf_page = reinterpret_cast<LeafPage *>(notype_page);
+    for (int i = 0; i < leaf_page->GetSize(); ++i) {
+      PostingList::Destroy(buffer_pool_manager_, leaf_page->ValueAt(i));
+    }
   }
 
   /* delete this page: LeafPage and InternalPage */
@@ -68,51 +79,238 @@ bool BPlusTree::IsEmpty() const {
  * SEARCH
  *****************************************************************************/
 /*
- * Return the only value that associated with input key
+ * Return the values associated with input key: the only one of a unique key,
+ * or all of a posting list in row id order
  * This method is used for point query
  * @return : true means key exists
  */
 bool BPlusTree::GetValue(const GenericKey *key, std::vector<RowId> &result, Transaction *transaction) {
-  /* find leaf page, using subroutine. */
-  Page *page = FindLeafPage(key, root_page_id_);
-  LeafPage *leaf = reinterpret_cast<LeafPage *> (page->GetData());
-  RowId tmp_res = INVALID_ROWID; 
+  /* read the leaf without latching it, and retry if a writer changed it meanwhile */
+  for (int attempt = 0; attempt < OPTIMISTIC_READ_RETRIES && !IsEmpty(); attempt++) {
+    uint64_t version;
+    Page *page = FindLeafPageOptimistic(key, false, version);
+    if (page == nullptr) {
+      continue;
+    }
+    RowId tmp_res = INVALID_ROWID;
+    bool key_exists = reinterpret_cast<LeafPage *>(page->GetData())->Lookup(key, tmp_res, processor_);
+    bool valid = page->ValidateVersion(version);
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    /* posting pages are only safe to read with the leaf latched */
+    if (valid && key_exists && PostingList::IsList(tmp_res)) {
+      break;
+    }
+    if (valid) {
+      if (key_exists) {
+        result.push_back(tmp_res);
+      }
+      return key_exists;
+    }
+  }
 
-  bool key_exists = false;
-  if (leaf->Lookup(key, tmp_res, processor_) ) {
-    result.push_back(tmp_res);
-    key_exists = true;
-  } else {
-    key_exists = false;
+  /* find leaf page with read latch crabbing */
+  Page *page = FindLeafPageLatched(key);
+  if (page == nullptr) {
+    return false;
+  }
+  LeafPage *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  RowId tmp_res = INVALID_ROWID;
+  bool key_exists = leaf->Lookup(key, tmp_res, processor_);
+  if (key_exists) {
+    PostingList::Read(buffer_pool_manager_, tmp_res, result);
   }
 
-  buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
   return key_exists;
 }
 
+/*
+ * Look up many keys in one pass. The keys are visited in sorted order along a
+ * path of pinned pages that is read optimistically like in GetValue: a key
+ * climbs only to the lowest page of the path whose range still covers it and
+ * descends again from there. Keys in the same leaf then cost one binary search
+ * each, and the next leaf is reached through the parent the two leaves share.
+ * A key that keeps colliding with writers is looked up alone by GetValue.
+ * @return : the number of keys that exist
+ */
+size_t BPlusTree::GetValues(const std::vector<GenericKey *> &keys, std::vector<std::vector<RowId>> &result,
+                            Transaction *transaction) {
+  result.assign(keys.size(), {});
+  std::vector<size_t> order(keys.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [this, &keys](size_t lhs, size_t rhs) {
+    return processor_.CompareKeys(keys[lhs], keys[rhs]) < 0;
+  });
+
+  std::vector<PathEntry> path;
+  auto release_path = [this, &path]() {
+    for (auto &entry : path) {
+      buffer_pool_manager_->UnpinPage(entry.page_->GetPageId(), false);
+    }
+    path.clear();
+  };
+  size_t found = 0;
+  for (size_t i : order) {
+    bool key_exists = false;
+    int attempt = 0;
+    while (attempt < OPTIMISTIC_READ_RETRIES && !GetValueOnPath(keys[i], path, result[i], key_exists)) {
+      /* a writer got in the way, start over from the root */
+      release_path();
+      attempt++;
+    }
+    if (attempt == OPTIMISTIC_READ_RETRIES) {
+      key_exists = GetValue(keys[i], result[i], transaction);
+    }
+    found += key_exists ? 1 : 0;
+  }
+  release_path();
+  return found;
+}
+
+/*
+ * The pages of path stay pinned between calls, and each one was unchanged when
+ * its child was reached. A page that is still unchanged covers the same range
+ * of keys, and every key that follows is at least as large as the one before,
+ * so a page covers key as long as key is below the separator that follows the
+ * page in its parent. Every page read here is validated afterwards, a page
+ * written meanwhile makes the call return false and the path must be released.
+ */
+bool BPlusTree::GetValueOnPath(const GenericKey *key, std::vector<PathEntry> &path, std::vector<RowId> &result,
+                               bool &key_exists) {
+  key_exists = false;
+  if (path.empty()) {
+    page_id_t page_id = root_page_id_;
+    if (page_id == INVALID_PAGE_ID) {
+      return true;
+    }
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    ASSERT(page != nullptr, "Out of memory.");
+    uint64_t version;
+    if (!page->ReadVersion(version) || root_page_id_ != page_id) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      return false;
+    }
+    path.push_back({page, version, -1});
+  }
+
+  /* climb to the lowest page of the path that covers key, the root covers all keys */
+  size_t start = path.size() - 1;
+  while (start > 0) {
+    PathEntry &parent = path[start - 1];
+    auto *in_page = reinterpret_cast<InternalPage *>(parent.page_->GetData());
+    bool covered = parent.child_ + 1 < in_page->GetSize() &&
+                   processor_.CompareKeys(key, in_page->KeyAt(parent.child_ + 1)) < 0;
+    if (!parent.page_->ValidateVersion(parent.version_)) {
+      return false;
+    }
+    if (covered) {
+      break;
+    }
+    start--;
+  }
+  while (path.size() > start + 1) {
+    buffer_pool_manager_->UnpinPage(path.back().page_->GetPageId(), false);
+    path.pop_back();
+  }
+
+  /* descend from there with optimistic lock coupling, as FindLeafPageOptimistic does */
+  while (!reinterpret_cast<BPlusTreePage *>(path.back().page_->GetData())->IsLeafPage()) {
+    PathEntry &entry = path.back();
+    auto *in_page = reinterpret_cast<InternalPage *>(entry.page_->GetData());
+    int index = in_page->LookupIndex(key, processor_);
+    page_id_t next_page_id = index < 0 ? INVALID_PAGE_ID : in_page->ValueAt(index);
+    if (next_page_id == INVALID_PAGE_ID || !entry.page_->ValidateVersion(entry.version_)) {
+      return false;
+    }
+    Page *next = buffer_pool_manager_->FetchPage(next_page_id);
+    ASSERT(next != nullptr, "Out of memory.");
+    uint64_t next_version;
+    if (!next->ReadVersion(next_version) || !entry.page_->ValidateVersion(entry.version_)) {
+      buffer_pool_manager_->UnpinPage(next_page_id, false);
+      return false;
+    }
+    entry.child_ = index;
+    path.push_back({next, next_version, -1});
+  }
+
+  Page *page = path.back().page_;
+  uint64_t version = path.back().version_;
+  RowId tmp_res = INVALID_ROWID;
+  bool exists = reinterpret_cast<LeafPage *>(page->GetData())->Lookup(key, tmp_res, processor_);
+  if (!page->ValidateVersion(version)) {
+    return false;
+  }
+  if (exists && PostingList::IsList(tmp_res)) {
+    /* posting pages are only safe to read with the leaf latched */
+    page->RLatch();
+    bool valid = page->ValidateVersion(version);
+    if (valid) {
+      PostingList::Read(buffer_pool_manager_, tmp_res, result);
+    }
+    page->RUnlatch();
+    if (!valid) {
+      return false;
+    }
+  } else if (exists) {
+    result.push_back(tmp_res);
+  }
+  key_exists = exists;
+  return true;
+}
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
 /*
  * Insert constant key & value pair into b+ tree
- * if current tree is empty, start new tree, update root page id and insert
- * entry, otherwise insert into leaf page.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * First try the optimistic way: only the leaf is write latched, and the entry
+ * is inserted if the leaf has room for it. Otherwise latch the path from the
+ * root, start a new tree if the tree is empty, or insert into the leaf and
+ * split as needed. A value for an existing key of a non-unique tree never
+ * changes the leaf's size, it always goes to the key's posting list right away.
+ * @return: if user try to insert a duplicate key into a unique tree, or a
+ * duplicate pair into a non-unique one, return false, otherwise return true.
  */
 bool BPlusTree::Insert(GenericKey *key, const RowId &value, Transaction *transaction) {
-  if (IsEmpty()) {
+  Page *page = FindLeafPageLatched(key, false, true);
+  if (page != nullptr) {
+    auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+    RowId existing;
+    if (leaf_page->Lookup(key, existing, processor_)) {
+      bool inserted = !unique_ && InsertIntoPostingList(leaf_page, key, value);
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), inserted);
+      return inserted;
+    }
+    bool safe = IsSafe(leaf_page, Operation::INSERT);
+    if (safe) {
+      leaf_page->Insert(key, value, processor_);
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), safe);
+    if (safe) {
+      return true;
+    }
+  }
+
+  /* the leaf may split (or the tree is empty): redo with write latches from the root */
+  WriteSet write_set;
+  bool inserted = true;
+  if (FindLeafPagePessimistic(key, Operation::INSERT, write_set) == nullptr) {
     StartNewTree(key, value);
-    return true;
+  } else {
+    inserted = InsertIntoLeaf(key, value, write_set);
   }
-  
-  return InsertIntoLeaf(key, value);
+  ReleaseWriteSet(write_set);
+  return inserted;
 }
 /*
  * Insert constant key & value pair into an empty tree
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then update b+
  * tree's root page id and insert entry directly into leaf page.
+ * root_latch_ is write locked by the caller.
  */
 void BPlusTree::StartNewTree(GenericKey *key, const RowId &value) {
   page_id_t id;
@@ -121,50 +319,58 @@ void BPlusTree::StartNewTree(GenericKey *key, const RowId &value) {
 
   auto *root_page = reinterpret_cast<BPlusTreeLeafPage *>(new_page->GetData());
   root_page->Init(id, INVALID_PAGE_ID, processor_.GetKeySize(), LEAF_PAGE_SIZE(processor_.GetKeySize()));
+  root_page->Insert(key, value, processor_);
   root_page_id_ = id;
   UpdateRootPageId();
 
-  InsertIntoLeaf(key, value);
-
   buffer_pool_manager_->UnpinPage(id, true);
 }
 
 /*
  * Insert constant key & value pair into leaf page
- * User needs to first find the right leaf page as insertion target, then look
- * through leaf page to see whether insert key exist or not. If exist, return
- * immediately, otherwise insert entry. Remember to deal with split if necessary.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
- */
-bool BPlusTree::InsertIntoLeaf(GenericKey *key, const RowId &value, Transaction *transaction) {
-  ASSERT(!IsEmpty(), "Cannot insert into empty tree!");
-  
-  /* see whether insert key exist or not */
-  std::vector<RowId> tmpRes;
-  if (GetValue(key, tmpRes)) {
-    // duplicate key, return false
-    return false;
+ * The leaf is the last page of write_set, and every page that may change
+ * because of a split is write latched in write_set as well. If the key
+ * exists, return immediately (after adding value to its posting list in a
+ * non-unique tree), otherwise insert entry and split if necessary.
+ * @return: false for a duplicate key of a unique tree or a duplicate pair,
+ * otherwise true.
+ */
+bool BPlusTree::InsertIntoLeaf(GenericKey *key, const RowId &value, WriteSet &write_set) {
+  /* 1. see whether insert key exist or not */
+  auto *leaf_page = reinterpret_cast<LeafPage *>(write_set.latched_pages_.back()->GetData());
+  RowId existing;
+  if (leaf_page->Lookup(key, existing, processor_)) {
+    // duplicate key, return false unless the tree takes several values per key
+    return !unique_ && InsertIntoPostingList(leaf_page, key, value);
   }
 
-  /* todo(Tao): insert operation, split... */
-  /* 1. find LeafPage L */
-  Page *page = FindLeafPage(key, root_page_id_);
-  auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
-
   /* 2. if not full, insert to page */
   if (leaf_page->GetSize() < leaf_page->GetMaxSize()) {
     leaf_page->Insert(key, value, processor_);
   } else {
   /* 3. if L is full, insert (temporarily) and split to L' */
     leaf_page->Insert(key, value, processor_);
-    auto *new_leaf = Split(leaf_page, transaction);
+    auto *new_leaf = Split(leaf_page, nullptr);
     auto *new_key = new_leaf->KeyAt(0);
   /* 4. insert K'(smallest key of L') to parent */
     InsertIntoParent(leaf_page, new_key, new_leaf);
+    buffer_pool_manager_->UnpinPage(new_leaf->GetPageId(), true);
   }
+  return true;
+}
 
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);  
+/*
+ * Add value to the row ids of an existing key. The posting pages of a key are
+ * covered by the latch of the leaf holding it, and the leaf itself only has
+ * its slot value changed, so this never splits.
+ */
+bool BPlusTree::InsertIntoPostingList(LeafPage *leaf, GenericKey *key, const RowId &value) {
+  int index = leaf->KeyIndex(key, processor_);
+  RowId slot_value = leaf->ValueAt(index);
+  if (!PostingList::Insert(buffer_pool_manager_, slot_value, value)) {
+    return false;
+  }
+  leaf->SetValueAt(index, slot_value);
   return true;
 }
 
@@ -174,6 +380,8 @@ bool BPlusTree::InsertIntoLeaf(GenericKey *key, const RowId &value, Transaction
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then move half
  * of key & value pairs from input page to newly created page
+ * The new page stays pinned and is not latched: no other thread can reach it
+ * before the latched parent links it.
  */
 BPlusTreeInternalPage *BPlusTree::Split(InternalPage *node, Transaction *transaction) {
   page_id_t new_page_id = INVALID_PAGE_ID;
@@ -185,8 +393,6 @@ BPlusTreeInternalPage *BPlusTree::Split(InternalPage *node, Transaction *transac
   in_page->Init(new_page_id, parent_id, node->GetKeySize(), INTERNAL_PAGE_SIZE(node->GetKeySize()));
 
   node->MoveHalfTo(in_page, buffer_pool_manager_);
-  
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
   return in_page;
 }
 
@@ -201,14 +407,33 @@ BPlusTreeLeafPage *BPlusTree::Split(LeafPage *node, Transaction *transaction) {
 
   node->MoveHalfTo(leaf_page);
 
-  /* keep leaf nodes linked */
+  /* keep leaf nodes linked, the new leaf is complete before the next one points back at it */
   leaf_page->SetNextPageId(node->GetNextPageId());
+  leaf_page->SetPrevPageId(node->GetPageId());
   node->SetNextPageId(leaf_page->GetPageId());
-  
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  LinkBackFromNext(leaf_page);
   return leaf_page;
 }
 
+/*
+ * Point the leaf after leaf back at it, once leaf took over the place of
+ * another page in the chain. Writers only latch a leaf of another parent
+ * towards the right, so latching the next leaf while holding leaf can not
+ * deadlock: the leaves they latch towards the left share a parent they hold.
+ */
+void BPlusTree::LinkBackFromNext(LeafPage *leaf) {
+  page_id_t next_page_id = leaf->GetNextPageId();
+  if (next_page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  Page *next = buffer_pool_manager_->FetchPage(next_page_id);
+  ASSERT(next != nullptr, "Out of memory.");
+  next->WLatch();
+  reinterpret_cast<LeafPage *>(next->GetData())->SetPrevPageId(leaf->GetPageId());
+  next->WUnlatch();
+  buffer_pool_manager_->UnpinPage(next_page_id, true);
+}
+
 /*
  * Insert key & value pair into internal page after split
  * @param   old_node      input page from split() method
@@ -217,18 +442,22 @@ BPlusTreeLeafPage *BPlusTree::Split(LeafPage *node, Transaction *transaction) {
  * User needs to first find the parent page of old_node, parent node must be
  * adjusted to take info of new_node into account. Remember to deal with split
  * recursively if necessary.
+ * The parent is write latched by the caller, since old_node was not safe.
  */
 void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlusTreePage *new_node,
                                  Transaction *transaction) {
-  /* 1. if old_node is Root, create new root */
+  /* 1. if old_node is Root, create new root (root_latch_ is still held) */
   if (old_node->IsRootPage()) {
     page_id_t old_p_id = old_node->GetPageId();
     page_id_t new_p_id = new_node->GetPageId();
 
     /* create new page */
     page_id_t new_root_p_id = INVALID_PAGE_ID;
-    auto *new_root = reinterpret_cast<InternalPage *>(buffer_pool_manager_->NewPage(new_root_p_id));
-    new_root->Init(new_root_p_id, INVALID_PAGE_ID, processor_.GetKeySize(), LEAF_PAGE_SIZE(processor_.GetKeySize()));
+    Page *page = buffer_pool_manager_->NewPage(new_root_p_id);
+    ASSERT(page != nullptr, "Out of memory.");
+    auto *new_root = reinterpret_cast<InternalPage *>(page->GetData());
+    new_root->Init(new_root_p_id, INVALID_PAGE_ID, processor_.GetKeySize(),
+                   INTERNAL_PAGE_SIZE(processor_.GetKeySize()));
 
     /* populate new root page adopt this two */
     new_root->PopulateNewRoot(old_p_id, key, new_p_id);
@@ -257,66 +486,295 @@ void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlus
     InternalPage *new_page = Split(parent, transaction);
     auto *new_key = new_page->KeyAt(0);
     InsertIntoParent(parent, new_key, new_page);
+    buffer_pool_manager_->UnpinPage(new_page->GetPageId(), true);
   } else {
     ASSERT(false, "size > max_size!!");
   }
   buffer_pool_manager_->UnpinPage(P->GetPageId(), true);
 }
 
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+/*
+ * Number of entries a bulk load puts into a page of max_size: at least half
+ * of it so that no page starts out underfull, and at least two children for
+ * internal pages.
+ */
+static int BulkLoadFillCount(int max_size, double fill_factor) {
+  return std::clamp(static_cast<int>(max_size * fill_factor), std::max(max_size / 2, 2), max_size);
+}
+
+/*
+ * Build the tree bottom-up: entries are appended to the rightmost leaf. Once a
+ * page holds its fill count a new page is started, and the full one is
+ * appended to the level above, so every page is written once and no descent
+ * or split happens. Only the last page of a level may end up underfull, it is
+ * fixed up against its left sibling by BulkLoadFinish.
+ * In a non-unique tree the row ids of the last key are collected until the
+ * next key arrives, and then stored as its posting list.
+ * root_latch_ is held throughout, so concurrent writers wait for the load.
+ */
+bool BPlusTree::BulkLoad(const std::function<bool(GenericKey *&key, RowId &value)> &next, double fill_factor) {
+  root_latch_.WLock();
+  if (!IsEmpty()) {
+    root_latch_.WUnlock();
+    return false;
+  }
+  int key_size = processor_.GetKeySize();
+  int leaf_fill = BulkLoadFillCount(LEAF_PAGE_SIZE(key_size), fill_factor);
+  int internal_fill = BulkLoadFillCount(INTERNAL_PAGE_SIZE(key_size), fill_factor);
+  std::vector<BulkLoadLevel> levels(1);
+  LeafPage *leaf = nullptr;
+  GenericKey *key;
+  RowId value;
+  std::vector<RowId> postings;
+  auto flush_postings = [&]() {
+    if (postings.size() > 1) {
+      leaf->SetValueAt(leaf->GetSize() - 1, PostingList::Create(buffer_pool_manager_, postings));
+    }
+    postings.clear();
+  };
+  while (next(key, value)) {
+    if (leaf != nullptr && processor_.CompareKeys(key, leaf->KeyAt(leaf->GetSize() - 1)) == 0) {
+      if (!unique_) {
+        postings.push_back(value);
+      }
+      continue;
+    }
+    /* the last key is complete, store its row ids before its leaf may be left */
+    flush_postings();
+    postings.push_back(value);
+    if (leaf == nullptr || leaf->GetSize() >= leaf_fill) {
+      BulkLoadNextPage(levels, 0, internal_fill);
+      leaf = reinterpret_cast<LeafPage *>(levels[0].cur_->GetData());
+    }
+    leaf->CopyLastFrom(key, value);
+  }
+  if (leaf != nullptr) {
+    flush_postings();
+    root_page_id_ = BulkLoadFinish(levels, internal_fill);
+    UpdateRootPageId();
+  }
+  root_latch_.WUnlock();
+  return true;
+}
+
+void BPlusTree::BulkLoadNextPage(std::vector<BulkLoadLevel> &levels, size_t level, int internal_fill) {
+  page_id_t page_id = INVALID_PAGE_ID;
+  Page *page = buffer_pool_manager_->NewPage(page_id);
+  ASSERT(page != nullptr, "Out of memory.");
+  int key_size = processor_.GetKeySize();
+  Page *full = levels[level].cur_;
+  if (level == 0) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    leaf->Init(page_id, INVALID_PAGE_ID, key_size, LEAF_PAGE_SIZE(key_size));
+    if (full != nullptr) {
+      reinterpret_cast<LeafPage *>(full->GetData())->SetNextPageId(page_id);
+      leaf->SetPrevPageId(full->GetPageId());
+    }
+  } else {
+    reinterpret_cast<InternalPage *>(page->GetData())
+        ->Init(page_id, INVALID_PAGE_ID, key_size, INTERNAL_PAGE_SIZE(key_size));
+  }
+  levels[level].cur_ = page;
+  if (full == nullptr) {
+    return;
+  }
+  /* the first key of the full page is final: borrowing only takes from its tail */
+  auto *full_node = reinterpret_cast<BPlusTreePage *>(full->GetData());
+  GenericKey *first_key = level == 0 ? reinterpret_cast<LeafPage *>(full_node)->KeyAt(0)
+                                     : reinterpret_cast<InternalPage *>(full_node)->KeyAt(0);
+  BulkLoadAppend(levels, level + 1, first_key, full->GetPageId(), internal_fill);
+  if (levels[level].prev_ != nullptr) {
+    buffer_pool_manager_->UnpinPage(levels[level].prev_->GetPageId(), true);
+  }
+  levels[level].prev_ = full;
+}
+
+/*
+ * Internal pages built here keep the separator of their subtree as key 0, as
+ * the page split off by Split does.
+ */
+void BPlusTree::BulkLoadAppend(std::vector<BulkLoadLevel> &levels, size_t level, GenericKey *key, page_id_t child,
+                               int internal_fill) {
+  if (levels.size() == level) {
+    levels.emplace_back();
+  }
+  if (levels[level].cur_ == nullptr ||
+      reinterpret_cast<InternalPage *>(levels[level].cur_->GetData())->GetSize() >= internal_fill) {
+    BulkLoadNextPage(levels, level, internal_fill);
+  }
+  reinterpret_cast<InternalPage *>(levels[level].cur_->GetData())->CopyLastFrom(key, child, buffer_pool_manager_);
+}
+
+/*
+ * Going up level by level, an underfull last page is merged into its left
+ * sibling if they fit into one page, and borrows half of the difference from
+ * it otherwise. Then the last page is appended to the level above. A level
+ * with a single page is the top one, and a top internal page left with one
+ * child after a merge below is dropped.
+ */
+page_id_t BPlusTree::BulkLoadFinish(std::vector<BulkLoadLevel> &levels, int internal_fill) {
+  for (size_t level = 0; levels[level].prev_ != nullptr; level++) {
+    Page *prev = levels[level].prev_;
+    Page *cur = levels[level].cur_;
+    auto *prev_node = reinterpret_cast<BPlusTreePage *>(prev->GetData());
+    auto *cur_node = reinterpret_cast<BPlusTreePage *>(cur->GetData());
+    bool merge = false;
+    if (cur_node->GetSize() < cur_node->GetMinSize()) {
+      merge = prev_node->GetSize() + cur_node->GetSize() <= cur_node->GetMaxSize();
+      int moves = merge ? 0 : (prev_node->GetSize() - cur_node->GetSize()) / 2;
+      if (level == 0) {
+        auto *prev_leaf = reinterpret_cast<LeafPage *>(prev_node);
+        auto *cur_leaf = reinterpret_cast<LeafPage *>(cur_node);
+        if (merge) {
+          cur_leaf->MoveAllTo(prev_leaf);
+        }
+        for (int i = 0; i < moves; i++) {
+          prev_leaf->MoveLastToFrontOf(cur_leaf);
+        }
+      } else {
+        auto *prev_internal = reinterpret_cast<InternalPage *>(prev_node);
+        auto *cur_internal = reinterpret_cast<InternalPage *>(cur_node);
+        if (merge) {
+          cur_internal->MoveAllTo(prev_internal, cur_internal->KeyAt(0), buffer_pool_manager_);
+        }
+        /* the moved child's key becomes the new separator, the old one moves to key 1 */
+        alignas(8) char separator[KeyManager::MAX_KEY_SIZE];
+        for (int i = 0; i < moves; i++) {
+          memcpy(separator, cur_internal->KeyAt(0), processor_.GetKeySize());
+          prev_internal->MoveLastToFrontOf(cur_internal, reinterpret_cast<GenericKey *>(separator),
+                                           buffer_pool_manager_);
+          cur_internal->SetKeyAt(0, prev_internal->KeyAt(prev_internal->GetSize()));
+        }
+      }
+    }
+    if (merge) {
+      buffer_pool_manager_->UnpinPage(cur->GetPageId(), false);
+      buffer_pool_manager_->DeletePage(cur->GetPageId());
+    } else {
+      GenericKey *first_key = level == 0 ? reinterpret_cast<LeafPage *>(cur_node)->KeyAt(0)
+                                         : reinterpret_cast<InternalPage *>(cur_node)->KeyAt(0);
+      BulkLoadAppend(levels, level + 1, first_key, cur->GetPageId(), internal_fill);
+      buffer_pool_manager_->UnpinPage(cur->GetPageId(), true);
+    }
+    buffer_pool_manager_->UnpinPage(prev->GetPageId(), true);
+  }
+
+  Page *root = levels.back().cur_;
+  auto *root_node = reinterpret_cast<BPlusTreePage *>(root->GetData());
+  while (!root_node->IsLeafPage() && root_node->GetSize() == 1) {
+    page_id_t child_id = reinterpret_cast<InternalPage *>(root_node)->ValueAt(0);
+    buffer_pool_manager_->UnpinPage(root->GetPageId(), false);
+    buffer_pool_manager_->DeletePage(root->GetPageId());
+    root = buffer_pool_manager_->FetchPage(child_id);
+    root_node = reinterpret_cast<BPlusTreePage *>(root->GetData());
+  }
+  root_node->SetParentPageId(INVALID_PAGE_ID);
+  page_id_t root_id = root->GetPageId();
+  buffer_pool_manager_->UnpinPage(root_id, true);
+  return root_id;
+}
+
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
 /*
  * Delete key & value pair associated with input key
  * If current tree is empty, return immediately.
- * If not, User needs to first find the right leaf page as deletion target, then
- * delete entry from leaf page. Remember to deal with redistribute or merge if
- * necessary.
+ * First try the optimistic way: only the leaf is write latched, and the entry
+ * is deleted if the leaf does not underflow. Otherwise latch the path from
+ * the root, delete entry from leaf page, and redistribute or merge if
+ * necessary. Pages merged away are deleted after all latches are released.
+ * Removing one of several values of a key only changes its posting list, so
+ * it is always done on the optimistic way.
  */
 void BPlusTree::Remove(const GenericKey *key, Transaction *transaction) {
-  if (IsEmpty())
-    return;
+  RemoveEntry(key, nullptr);
+}
 
-  Page *page = FindLeafPage(key, root_page_id_);
-  LeafPage *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+void BPlusTree::Remove(const GenericKey *key, const RowId &value, [[maybe_unused]] Transaction *transaction) {
+  RemoveEntry(key, &value);
+}
 
-  // /* ONLY FOR DEBUG */
-  // int num_befor_delete = leaf_page->GetSize();
-  // int num_after_delete = leaf_page->RemoveAndDeleteRecord(key, processor_);
-  // bool delete_success = false;
-  // delete_success = (num_after_delete + 1 == num_befor_delete);
+void BPlusTree::RemoveEntry(const GenericKey *key, const RowId *value) {
+  Page *page = FindLeafPageLatched(key, false, true);
+  if (page == nullptr) {
+    return;
+  }
+  auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  RemoveAction action = RemoveFromPostingList(leaf_page, key, value);
+  bool safe = action != RemoveAction::REMOVE_KEY || IsSafe(leaf_page, Operation::REMOVE);
+  if (safe && action == RemoveAction::REMOVE_KEY) {
+    RemoveKey(leaf_page, key);
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), safe && action != RemoveAction::NONE);
+  if (safe) {
+    return;
+  }
 
-  // if (!delete_success) {
-  //   ASSERT(false, "Delete fail.");
-  // }
-  // /* ONLY FOR DEBUG(end) */
-  leaf_page->RemoveAndDeleteRecord(key, processor_); // Comment when DEBUG
+  /* the leaf may underflow: redo with write latches from the root */
+  WriteSet write_set;
+  page = FindLeafPagePessimistic(key, Operation::REMOVE, write_set);
+  if (page != nullptr) {
+    leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+    int size = leaf_page->GetSize();
+    if (RemoveFromPostingList(leaf_page, key, value) == RemoveAction::REMOVE_KEY &&
+        RemoveKey(leaf_page, key) < size) {
+      if (leaf_page->IsRootPage()) {
+        if (AdjustRoot(leaf_page)) {
+          write_set.deleted_pages_.push_back(leaf_page->GetPageId());
+        }
+      } else if (leaf_page->GetSize() < leaf_page->GetMinSize()) {
+        CoalesceOrRedistribute(leaf_page, write_set);
+      }
+    }
+  }
+  ReleaseWriteSet(write_set);
+}
 
+/*
+ * Without a value the whole key goes. A value that is one of several of the
+ * key leaves its posting list, while the key goes with its only value.
+ */
+BPlusTree::RemoveAction BPlusTree::RemoveFromPostingList(LeafPage *leaf, const GenericKey *key, const RowId *value) {
+  int index = leaf->KeyIndex(key, processor_);
+  if (index == leaf->GetSize() || processor_.CompareKeys(key, leaf->KeyAt(index)) != 0) {
+    return RemoveAction::NONE;
+  }
+  if (value == nullptr) {
+    return RemoveAction::REMOVE_KEY;
+  }
+  RowId slot_value = leaf->ValueAt(index);
+  if (!PostingList::IsList(slot_value)) {
+    return slot_value == *value ? RemoveAction::REMOVE_KEY : RemoveAction::NONE;
+  }
+  if (!PostingList::Remove(buffer_pool_manager_, slot_value, *value)) {
+    return RemoveAction::NONE;
+  }
+  leaf->SetValueAt(index, slot_value);
+  return RemoveAction::VALUE_REMOVED;
+}
 
-  if (leaf_page->IsRootPage()) {
-    if (AdjustRoot(leaf_page)) {
-      buffer_pool_manager_->DeletePage(leaf_page->GetPageId());
-    }
-  } else if (leaf_page->GetSize() < leaf_page->GetMinSize()) {
-    bool delete_leaf = CoalesceOrRedistribute(leaf_page, transaction);
-    if (delete_leaf) {
-      buffer_pool_manager_->DeletePage(leaf_page->GetPageId());
-    }
-  } else {
-    /* do nothing */
+int BPlusTree::RemoveKey(LeafPage *leaf, const GenericKey *key) {
+  RowId slot_value;
+  if (leaf->Lookup(key, slot_value, processor_)) {
+    PostingList::Destroy(buffer_pool_manager_, slot_value);
   }
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  return leaf->RemoveAndDeleteRecord(key, processor_);
 }
 
 /**
  * User needs to first find the sibling of input page. If sibling's size + input
  * page's size > page's max size, then redistribute. Otherwise, merge.
  * Using template N to represent either internal page or leaf page.
- * return: true means target leaf page should be deleted, false means no
- * deletion happens
+ * node and its parent are write latched by the caller; the sibling is latched
+ * here. Pages removed by merging are added to write_set.
  */
 template <typename N>
-bool BPlusTree::CoalesceOrRedistribute(N *&node, Transaction *transaction) {
+void BPlusTree::CoalesceOrRedistribute(N *node, WriteSet &write_set) {
   /* call bool BPlusTree::AdjustRoot(BPlusTreePage *old_root_node) */
   ASSERT(!node->IsRootPage(), "Root page has no siblings.");
 
@@ -347,35 +805,36 @@ bool BPlusTree::CoalesceOrRedistribute(N *&node, Transaction *transaction) {
   }
 
   /** decide Coalesce or Redistribute **/
-  N *sibling_node = reinterpret_cast<N *>(buffer_pool_manager_->FetchPage(sibling_page_id)->GetData());
+  Page *sibling = buffer_pool_manager_->FetchPage(sibling_page_id);
+  sibling->WLatch();
+  N *sibling_node = reinterpret_cast<N *>(sibling->GetData());
   int size1 = node->GetSize();
   int size2 = sibling_node->GetSize();
 
-  bool delete_node = false;
   if (size1 + size2 <= node->GetMaxSize()) {
     /* Coalesce */
-    delete_node = true;
-    bool delete_parent = Coalesce(sibling_node, node, inter_parent, idx, transaction); // NOTE: node and sibling maybe swapped
-    if (delete_parent) {
-      buffer_pool_manager_->DeletePage(inter_parent->GetPageId());
-    }
+    Coalesce(sibling_node, node, inter_parent, idx, write_set);
   } else {
     /* Redistribute */
     Redistribute(sibling_node, node, idx); // NOTE: node and sibling will not be swapped
     /* set parent's new middle key */
     int mid_idx = (idx == 0)? 1:idx;
     N *rhs_node = (idx == 0)? sibling_node:node;
-    auto *rhs_leftmost_leaf = reinterpret_cast<LeafPage *>(FindLeafPage(nullptr, rhs_node->GetPageId(), true)->GetData());
-    GenericKey *new_middle_key = rhs_leftmost_leaf->KeyAt(0);
-    inter_parent->SetKeyAt(mid_idx, new_middle_key);
-    delete_node = false;
-
-    buffer_pool_manager_->UnpinPage(rhs_leftmost_leaf->GetPageId(), false);
+    if (rhs_node->IsLeafPage()) {
+      inter_parent->SetKeyAt(mid_idx, reinterpret_cast<LeafPage *>(rhs_node)->KeyAt(0));
+    } else {
+      /* rhs_node is latched by this thread, read latch the pages below it */
+      Page *child = FetchLatched(reinterpret_cast<InternalPage *>(rhs_node)->ValueAt(0), false);
+      Page *leftmost = DescendLatched(child, nullptr, true, false);
+      inter_parent->SetKeyAt(mid_idx, reinterpret_cast<LeafPage *>(leftmost->GetData())->KeyAt(0));
+      leftmost->RUnlatch();
+      buffer_pool_manager_->UnpinPage(leftmost->GetPageId(), false);
+    }
   }
 
+  sibling->WUnlatch();
+  buffer_pool_manager_->UnpinPage(sibling_page_id, true);
   buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
-  buffer_pool_manager_->UnpinPage(sibling_node->GetPageId(), true);
-  return delete_node;
 }
 
 /*
@@ -387,10 +846,11 @@ bool BPlusTree::CoalesceOrRedistribute(N *&node, Transaction *transaction) {
  * @param   neighbor_node      sibling page of input "node"
  * @param   node               input from method coalesceOrRedistribute()
  * @param   parent             parent page of input "node"
- * @return  true means parent node should be deleted, false means no deletion happened
+ * The page merged away, and the parent if it goes away too, are added to
+ * write_set to be deleted once all latches are released.
  */
-bool BPlusTree::Coalesce(LeafPage *&neighbor_node, LeafPage *&node, InternalPage *&parent, int index,
-                         Transaction *transaction) {
+void BPlusTree::Coalesce(LeafPage *neighbor_node, LeafPage *node, InternalPage *parent, int index,
+                         WriteSet &write_set) {
   if (index == 0) {
     /* BEFORE SWAP: node(less) -> neighbor[delete]
      *              ^
@@ -411,33 +871,27 @@ bool BPlusTree::Coalesce(LeafPage *&neighbor_node, LeafPage *&node, InternalPage
      *             index != 0
      */
   }
-  node->MoveAllTo(neighbor_node); // nodePage should be deleted outside this function
+  node->MoveAllTo(neighbor_node);
+  LinkBackFromNext(neighbor_node);
+  write_set.deleted_pages_.push_back(node->GetPageId());
 
   /* delete pair in parent */
-  bool delete_parent_node = false;
   parent->Remove(index);
 
   /* operations after delete item is parent */
   if (parent->IsRootPage()) {
     /* parent IS root page */
     if (AdjustRoot(parent)) {
-      delete_parent_node = true;
-    }
-  } else {
-    /* parent is NOT root page */
-    if (parent->GetSize() < parent->GetMinSize()) {
-      /* recursively call CorR */
-      if (CoalesceOrRedistribute(parent, transaction)) {
-        delete_parent_node = true;
-      }
+      write_set.deleted_pages_.push_back(parent->GetPageId());
     }
+  } else if (parent->GetSize() < parent->GetMinSize()) {
+    /* parent is NOT root page: recursively call CorR */
+    CoalesceOrRedistribute(parent, write_set);
   }
-  
-  return delete_parent_node;
 }
 
-bool BPlusTree::Coalesce(InternalPage *&neighbor_node, InternalPage *&node, InternalPage *&parent, int index,
-                         Transaction *transaction) {
+void BPlusTree::Coalesce(InternalPage *neighbor_node, InternalPage *node, InternalPage *parent, int index,
+                         WriteSet &write_set) {
   if (index == 0) {
     /* BEFORE SWAP: node(less) -> neighbor[delete]
      *              ^
@@ -459,28 +913,21 @@ bool BPlusTree::Coalesce(InternalPage *&neighbor_node, InternalPage *&node, Inte
      */
   }
   node->MoveAllTo(neighbor_node, parent->KeyAt(index), buffer_pool_manager_);
+  write_set.deleted_pages_.push_back(node->GetPageId());
 
   /* delete pair in parent */
-  bool delete_parent_node = false;
   parent->Remove(index);
 
   /* operations after delete item is parent */
   if (parent->IsRootPage()) {
     /* parent IS root page */
     if (AdjustRoot(parent)) {
-      delete_parent_node = true;
-    }
-  } else {
-    /* parent is NOT root page */
-    if (parent->GetSize() < parent->GetMinSize()) {
-      /* recursively call CorR */
-      if (CoalesceOrRedistribute(parent, transaction)) {
-        delete_parent_node = true;
-      }
+      write_set.deleted_pages_.push_back(parent->GetPageId());
     }
+  } else if (parent->GetSize() < parent->GetMinSize()) {
+    /* parent is NOT root page: recursively call CorR */
+    CoalesceOrRedistribute(parent, write_set);
   }
-  
-  return delete_parent_node;
 }
 
 /*
@@ -583,8 +1030,6 @@ bool BPlusTree::AdjustRoot(BPlusTreePage *old_root_node) {
     buffer_pool_manager_->UnpinPage(only_child_id, true);
   } else if(old_root_node->IsLeafPage() && old_root_node->GetSize() == 0) {
     /* case 2 */
-    auto *leaf_root = reinterpret_cast<LeafPage *>(old_root_node);
-    leaf_root->RemoveAndDeleteRecord(leaf_root->KeyAt(0),processor_);
     root_page_id_ = INVALID_PAGE_ID;
     UpdateRootPageId();
   } else {
@@ -606,28 +1051,49 @@ bool BPlusTree::AdjustRoot(BPlusTreePage *old_root_node) {
  * @return : index iterator
  */
 IndexIterator BPlusTree::Begin() {
-  /* page will be unpinned in Dtor */
-  Page *page = FindLeafPage(nullptr, root_page_id_, true); 
-  page_id_t p_id = page->GetPageId();
-  buffer_pool_manager_->UnpinPage(p_id, false); // unpin after FindLeafPage
-  return IndexIterator(p_id, buffer_pool_manager_, 0);
+  Page *page = FindLeafPageLatched(nullptr, true);
+  if (page == nullptr) {
+    return End();
+  }
+  /* the iterator takes over the pin, and latches the leaf only while reading it */
+  page->RUnlatch();
+  return IndexIterator(page, buffer_pool_manager_, 0);
 }
 
 /*
  * Input parameter is low-key, find the leaf page that contains the input key
  * first, then construct index iterator
+ * A key greater than all keys of its leaf starts the iterator at the first
+ * entry of a following leaf, as the iterator must point at an entry.
  * @return : index iterator
  */
 IndexIterator BPlusTree::Begin(const GenericKey *key) {
   /* remember to use int LeafPage::KeyIndex() */
-  Page *page = FindLeafPage(key, root_page_id_);
-  page_id_t p_id = page->GetPageId();
-
+  Page *page = FindLeafPageLatched(key);
+  if (page == nullptr) {
+    return End();
+  }
   auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
   int idx = leaf_page->KeyIndex(key, processor_);
+  while (idx == leaf_page->GetSize()) {
+    page_id_t next_page_id = leaf_page->GetNextPageId();
+    if (next_page_id == INVALID_PAGE_ID) {
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      return End();
+    }
+    /* pin the next leaf before releasing this one, as IndexIterator does */
+    Page *next = buffer_pool_manager_->FetchPage(next_page_id);
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = next;
+    page->RLatch();
+    leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+    idx = 0;
+  }
 
-  buffer_pool_manager_->UnpinPage(p_id, false); // unpin after FindLeafPage
-  return IndexIterator(p_id, buffer_pool_manager_, idx);
+  page->RUnlatch();
+  return IndexIterator(page, buffer_pool_manager_, idx);
 }
 
 /*
@@ -636,7 +1102,150 @@ IndexIterator BPlusTree::Begin(const GenericKey *key) {
  * @return : index iterator
  */
 IndexIterator BPlusTree::End() {
-  return IndexIterator(INVALID_PAGE_ID, buffer_pool_manager_, -1);
+  return IndexIterator(nullptr, buffer_pool_manager_, -1);
+}
+
+/*
+ * Reverse iterators start at the last entry of the rightmost leaf, or at the
+ * last key not greater than the input key, and also end at End()
+ */
+IndexIterator BPlusTree::RBegin() {
+  Page *page = FindLeafPageLatched(nullptr);
+  if (page == nullptr) {
+    return End();
+  }
+  return RBeginAt(page, reinterpret_cast<LeafPage *>(page->GetData())->GetSize() - 1);
+}
+
+IndexIterator BPlusTree::RBegin(const GenericKey *key) {
+  Page *page = FindLeafPageLatched(key);
+  if (page == nullptr) {
+    return End();
+  }
+  auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  int idx = leaf_page->KeyIndex(key, processor_);
+  if (idx == leaf_page->GetSize() || processor_.CompareKeys(leaf_page->KeyAt(idx), key) != 0) {
+    idx--;
+  }
+  return RBeginAt(page, idx);
+}
+
+/*
+ * A key less than all keys of its leaf starts the iterator at the last entry
+ * of a previous leaf, as the iterator must point at an entry.
+ */
+IndexIterator BPlusTree::RBeginAt(Page *page, int idx) {
+  auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  /* the smallest key seen on the leaves left, which the iterator goes on below */
+  std::vector<char> resume;
+  while (idx < 0) {
+    page_id_t prev_page_id = leaf_page->GetPrevPageId();
+    if (prev_page_id == INVALID_PAGE_ID) {
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      return End();
+    }
+    /* pin the previous leaf before releasing this one, as IndexIterator does */
+    Page *prev = buffer_pool_manager_->FetchPage(prev_page_id);
+    page_id_t left_page_id = page->GetPageId();
+    if (leaf_page->GetSize() > 0 &&
+        (resume.empty() ||
+         processor_.CompareKeys(leaf_page->KeyAt(0), reinterpret_cast<const GenericKey *>(resume.data())) < 0)) {
+      const char *data = reinterpret_cast<const char *>(leaf_page->KeyAt(0));
+      resume.assign(data, data + processor_.GetKeySize());
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(left_page_id, false);
+    page = prev;
+    page->RLatch();
+    if (resume.empty()) {
+      leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+      idx = leaf_page->GetSize() - 1;
+      continue;
+    }
+    /* start below the first key of the leaf left, on a new leaf if the previous one split meanwhile */
+    auto *resume_key = reinterpret_cast<const GenericKey *>(resume.data());
+    IndexIterator::FollowSplit(page, left_page_id, resume_key, processor_, buffer_pool_manager_);
+    leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+    idx = leaf_page->KeyIndex(resume_key, processor_) - 1;
+  }
+
+  /* the iterator copies out its entry before releasing the latch */
+  return IndexIterator(page, buffer_pool_manager_, idx, true, &processor_);
+}
+
+/*
+ * MIN and MAX of the indexed columns: one descent to the leftmost or the
+ * rightmost leaf, whose first or last key is copied out with its values
+ * @return : false if the tree is empty
+ */
+bool BPlusTree::GetExtreme(bool max, GenericKey *key, std::vector<RowId> &result,
+                           [[maybe_unused]] Transaction *transaction) {
+  Page *page = FindLeafPageLatched(nullptr, !max);
+  if (page == nullptr) {
+    return false;
+  }
+  auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  int size = leaf_page->GetSize();
+  if (size > 0) {
+    int idx = max ? size - 1 : 0;
+    memcpy(key, leaf_page->KeyAt(idx), processor_.GetKeySize());
+    PostingList::Read(buffer_pool_manager_, leaf_page->ValueAt(idx), result);
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return size > 0;
+}
+
+/*
+ * Descend once to the leaf of the lower bound (the leftmost leaf without
+ * one), and start at its first key in range. Walking the leaf chain and
+ * stopping at the upper bound is left to the iterator. A reverse scan
+ * descends to the upper bound (the rightmost leaf) and walks back instead.
+ */
+IndexRangeIterator BPlusTree::BeginRange(const GenericKey *lower, bool lower_inclusive, const GenericKey *upper,
+                                         bool upper_inclusive, bool reverse) {
+  if (reverse) {
+    Page *page = FindLeafPageLatched(upper);
+    int idx = 0;
+    if (page != nullptr) {
+      auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+      idx = leaf_page->GetSize();
+      if (upper != nullptr) {
+        idx = leaf_page->KeyIndex(upper, processor_);
+        if (upper_inclusive && idx < leaf_page->GetSize() &&
+            processor_.CompareKeys(leaf_page->KeyAt(idx), upper) == 0) {
+          idx++;
+        }
+      }
+    }
+    /* the iterator reads the leaf before releasing the latch, as writers may move entries around idx */
+    return IndexRangeIterator(page, idx, lower, lower_inclusive, processor_, buffer_pool_manager_, true);
+  }
+  Page *page = FindLeafPageLatched(lower, lower == nullptr);
+  int idx = 0;
+  if (page != nullptr && lower != nullptr) {
+    auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+    idx = leaf_page->KeyIndex(lower, processor_);
+    if (!lower_inclusive && idx < leaf_page->GetSize() && processor_.CompareKeys(leaf_page->KeyAt(idx), lower) == 0) {
+      idx++;
+    }
+  }
+  if (page != nullptr) {
+    /* the iterator takes over the pin, and latches the leaf only while reading it */
+    page->RUnlatch();
+  }
+  return IndexRangeIterator(page, idx, upper, upper_inclusive, processor_, buffer_pool_manager_);
+}
+
+void BPlusTree::ScanRange(const GenericKey *lower, bool lower_inclusive, const GenericKey *upper,
+                          bool upper_inclusive, std::vector<RowId> &result, [[maybe_unused]] Transaction *transaction,
+                          bool reverse) {
+  IndexRangeIterator iter = BeginRange(lower, lower_inclusive, upper, upper_inclusive, reverse);
+  std::vector<RowId> batch;
+  while (iter.NextBatch(batch)) {
+    result.insert(result.end(), batch.begin(), batch.end());
+  }
 }
 
 /*****************************************************************************
@@ -649,8 +1258,8 @@ IndexIterator BPlusTree::End() {
  * Note: the leaf page is pinned, you need to UNPIN!! it after use.
  */
 Page *BPlusTree::FindLeafPage(const GenericKey *key, page_id_t page_id, bool leftMost) {
-  auto *begin_page = buffer_pool_manager_->FetchPage(page_id);
-  BPlusTreePage *cur_page = reinterpret_cast<BPlusTreePage *>(begin_page->GetData());
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  BPlusTreePage *cur_page = reinterpret_cast<BPlusTreePage *>(page->GetData());
 
   while (!cur_page->IsLeafPage()) {
     /* cur_page is InternalPage */
@@ -664,14 +1273,207 @@ Page *BPlusTree::FindLeafPage(const GenericKey *key, page_id_t page_id, bool lef
 
     page_id_t this_page_id = in_page->GetPageId();
 
-    cur_page = reinterpret_cast<BPlusTreePage*>(buffer_pool_manager_->FetchPage(next_pgae_id)->GetData());
+    page = buffer_pool_manager_->FetchPage(next_pgae_id);
+    cur_page = reinterpret_cast<BPlusTreePage*>(page->GetData());
     buffer_pool_manager_->UnpinPage(this_page_id, false);
   }
   
-  page_id_t ret_leaf_p_id = cur_page->GetPageId();
-  buffer_pool_manager_->UnpinPage(ret_leaf_p_id, false);
-  return buffer_pool_manager_->FetchPage(ret_leaf_p_id);
-  /* remember to unpin after use */
+  /* the leaf stays pinned: remember to unpin after use */
+  return page;
+}
+
+/*
+ * Fetch a page on the way down and latch it. The type of a page never changes
+ * while it belongs to the tree, so it can be checked before latching.
+ */
+Page *BPlusTree::FetchLatched(page_id_t page_id, bool write_leaf) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  ASSERT(page != nullptr, "Out of memory.");
+  if (write_leaf && reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage()) {
+    page->WLatch();
+  } else {
+    page->RLatch();
+  }
+  return page;
+}
+
+/*
+ * Latch crabbing: latch the child before releasing the parent, so that the
+ * child can not be split or merged in between.
+ * Note: the leaf page is pinned and latched, release it after use.
+ */
+/*
+ * A null key that is not leftMost follows the last child, reaching the
+ * rightmost leaf. A page read without latches may be torn, so an empty one
+ * yields INVALID_PAGE_ID rather than an index out of the page.
+ */
+page_id_t BPlusTree::ChildToFollow(InternalPage *page, const GenericKey *key, bool leftMost) {
+  if (leftMost) {
+    return page->ValueAt(0);
+  }
+  if (key != nullptr) {
+    return page->Lookup(key, processor_);
+  }
+  int size = page->GetSize();
+  return size < 1 ? INVALID_PAGE_ID : page->ValueAt(size - 1);
+}
+
+Page *BPlusTree::DescendLatched(Page *page, const GenericKey *key, bool leftMost, bool write_leaf) {
+  auto *cur_page = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  while (!cur_page->IsLeafPage()) {
+    auto *in_page = reinterpret_cast<InternalPage *>(cur_page);
+    page_id_t next_page_id = ChildToFollow(in_page, key, leftMost);
+    Page *next = FetchLatched(next_page_id, write_leaf);
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = next;
+    cur_page = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  }
+  return page;
+}
+
+/*
+ * Optimistic lock coupling: record the child's version before validating the
+ * parent, so the child was still linked below the parent when it was reached.
+ * Contents are only used after validation, as they may be torn by a writer.
+ */
+Page *BPlusTree::FindLeafPageOptimistic(const GenericKey *key, bool leftMost, uint64_t &version) {
+  page_id_t page_id = root_page_id_;
+  if (page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  ASSERT(page != nullptr, "Out of memory.");
+  /* the old root is write latched while the root changes, so checking the root id after the version is enough */
+  if (!page->ReadVersion(version) || root_page_id_ != page_id) {
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    return nullptr;
+  }
+  auto *cur_page = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  while (!cur_page->IsLeafPage()) {
+    auto *in_page = reinterpret_cast<InternalPage *>(cur_page);
+    page_id_t next_page_id = ChildToFollow(in_page, key, leftMost);
+    if (next_page_id == INVALID_PAGE_ID || !page->ValidateVersion(version)) {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      return nullptr;
+    }
+    Page *next = buffer_pool_manager_->FetchPage(next_page_id);
+    ASSERT(next != nullptr, "Out of memory.");
+    uint64_t next_version;
+    bool valid = next->ReadVersion(next_version) && page->ValidateVersion(version);
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (!valid) {
+      buffer_pool_manager_->UnpinPage(next_page_id, false);
+      return nullptr;
+    }
+    page = next;
+    version = next_version;
+    cur_page = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  }
+  return page;
+}
+
+Page *BPlusTree::FindLeafPageLatched(const GenericKey *key, bool leftMost, bool write_leaf) {
+  for (int attempt = 0; attempt < OPTIMISTIC_READ_RETRIES && !IsEmpty(); attempt++) {
+    uint64_t version;
+    Page *page = FindLeafPageOptimistic(key, leftMost, version);
+    if (page == nullptr) {
+      continue;
+    }
+    /* latch the leaf, it is still the right one if nobody wrote it since its version was recorded */
+    bool valid;
+    if (write_leaf) {
+      page->WLatch();
+      valid = page->ValidateVersion(version + 1);
+      if (!valid) {
+        page->WUnlatch();
+      }
+    } else {
+      page->RLatch();
+      valid = page->ValidateVersion(version);
+      if (!valid) {
+        page->RUnlatch();
+      }
+    }
+    if (valid) {
+      return page;
+    }
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+
+  /* hold root_latch_ until the root page is latched, so the root can not change in between */
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  Page *page = FetchLatched(root_page_id_, write_leaf);
+  root_latch_.RUnlock();
+  return DescendLatched(page, key, leftMost, write_leaf);
+}
+
+Page *BPlusTree::FindLeafPagePessimistic(const GenericKey *key, Operation op, WriteSet &write_set) {
+  root_latch_.WLock();
+  write_set.root_locked_ = true;
+  if (IsEmpty()) {
+    return nullptr;
+  }
+  page_id_t page_id = root_page_id_;
+  while (true) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    ASSERT(page != nullptr, "Out of memory.");
+    page->WLatch();
+    write_set.latched_pages_.push_back(page);
+    auto *cur_page = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    /* a safe page absorbs the operation, so none of its ancestors can change */
+    if (IsSafe(cur_page, op)) {
+      ReleaseAncestors(write_set);
+    }
+    if (cur_page->IsLeafPage()) {
+      return page;
+    }
+    page_id = reinterpret_cast<InternalPage *>(cur_page)->Lookup(key, processor_);
+  }
+}
+
+bool BPlusTree::IsSafe(BPlusTreePage *node, Operation op) const {
+  if (op == Operation::INSERT) {
+    /* no split: both leaf and internal pages split only when they are full */
+    return node->GetSize() < node->GetMaxSize();
+  }
+  /* no underflow: a root leaf goes away when empty, a root internal page when left with one child */
+  if (node->IsRootPage()) {
+    return node->GetSize() > (node->IsLeafPage() ? 1 : 2);
+  }
+  return node->GetSize() > node->GetMinSize();
+}
+
+void BPlusTree::ReleaseAncestors(WriteSet &write_set) {
+  if (write_set.root_locked_) {
+    root_latch_.WUnlock();
+    write_set.root_locked_ = false;
+  }
+  auto &pages = write_set.latched_pages_;
+  for (size_t i = 0; i + 1 < pages.size(); ++i) {
+    pages[i]->WUnlatch();
+    buffer_pool_manager_->UnpinPage(pages[i]->GetPageId(), false);
+  }
+  pages.erase(pages.begin(), pages.end() - 1);
+}
+
+void BPlusTree::ReleaseWriteSet(WriteSet &write_set) {
+  for (Page *page : write_set.latched_pages_) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  }
+  write_set.latched_pages_.clear();
+  if (write_set.root_locked_) {
+    root_latch_.WUnlock();
+    write_set.root_locked_ = false;
+  }
+  /* a page still pinned by a reader is kept by the reclaimer until a later write set frees it */
+  page_reclaimer_.Reclaim(write_set.deleted_pages_);
+  write_set.deleted_pages_.clear();
 }
 
 /*
@@ -683,14 +1485,17 @@ Page *BPlusTree::FindLeafPage(const GenericKey *key, page_id_t page_id, bool lef
  * updating it.
  */
 void BPlusTree::UpdateRootPageId(int insert_record) {
-  auto *index_roots = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID));
-  
+  /* the index roots page is shared by all indexes */
+  Page *page = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
+  auto *index_roots = reinterpret_cast<IndexRootsPage *>(page->GetData());
+  page->WLatch();
   if (insert_record) {
     index_roots->Insert(index_id_, root_page_id_);
   } else {
     /* update */
     index_roots->Update(index_id_, root_page_id_);
   }
+  page->WUnlatch();
   buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
 }
 
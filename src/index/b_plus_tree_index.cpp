@@ -2,20 +2,25 @@
 #include "index/b_plus_tree_index.h"
 
 #include "index/generic_key.h"
+#include "index/tree_index_util.h"
 #include "utils/tree_file_mgr.h"
 BPlusTreeIndex::BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size,
-                               BufferPoolManager *buffer_pool_manager)
+                               BufferPoolManager *buffer_pool_manager, bool unique)
     : Index(index_id, key_schema),
       processor_(key_schema_, key_size),
-      container_(index_id, buffer_pool_manager, processor_, LEAF_PAGE_SIZE(key_size), INTERNAL_PAGE_SIZE(key_size)) {}
+      container_(index_id, buffer_pool_manager, processor_, LEAF_PAGE_SIZE(key_size), INTERNAL_PAGE_SIZE(key_size),
+                 unique) {
+  ASSERT(key_size <= KeyManager::MAX_KEY_SIZE, "Index key size exceed max key size.");
+}
 
 dberr_t BPlusTreeIndex::InsertEntry(const Row &key, RowId row_id, Transaction *txn) {
   // ASSERT(row_id.Get() != INVALID_ROWID.Get(), "Invalid row id for index insert.");
-  GenericKey *index_key = processor_.InitKey();
+  //键编码在栈上的缓冲区中，不需要分配内存
+  alignas(8) char key_buf[KeyManager::MAX_KEY_SIZE];
+  auto *index_key = reinterpret_cast<GenericKey *>(key_buf);
   processor_.SerializeFromKey(index_key, key, key_schema_);
 
   bool status = container_.Insert(index_key, row_id, txn);
-  delete index_key;
   //  TreeFileManagers mgr("tree_");
   //  static int i = 0;
   //  if (i % 10 == 0) container_.PrintTree(mgr[i]);
@@ -28,50 +33,41 @@ dberr_t BPlusTreeIndex::InsertEntry(const Row &key, RowId row_id, Transaction *t
 }
 
 dberr_t BPlusTreeIndex::RemoveEntry(const Row &key, RowId row_id, Transaction *txn) {
-  GenericKey *index_key = processor_.InitKey();
+  //键编码在栈上的缓冲区中，不需要分配内存
+  alignas(8) char key_buf[KeyManager::MAX_KEY_SIZE];
+  auto *index_key = reinterpret_cast<GenericKey *>(key_buf);
   processor_.SerializeFromKey(index_key, key, key_schema_);
 
-  container_.Remove(index_key, txn);
-  delete index_key;
+  //非唯一索引只删除这一行的RowId，键随最后一个RowId删除
+  container_.Remove(index_key, row_id, txn);
   return DB_SUCCESS;
 }
 
 dberr_t BPlusTreeIndex::ScanKey(const Row &key, vector<RowId> &result, Transaction *txn, string compare_operator) {
-  GenericKey *index_key = processor_.InitKey();
+  //键编码在栈上的缓冲区中，不需要分配内存
+  alignas(8) char key_buf[KeyManager::MAX_KEY_SIZE];
+  auto *index_key = reinterpret_cast<GenericKey *>(key_buf);
   processor_.SerializeFromKey(index_key, key, key_schema_);
-  if (compare_operator == "=") {
-    container_.GetValue(index_key, result, txn);
-  } else if (compare_operator == ">") {
-    auto iter = GetBeginIterator(index_key);
-    if (container_.GetValue(index_key, result, txn))
-      ++iter;
-    result.clear();
-    for (; iter != GetEndIterator(); ++iter) {
-      result.emplace_back((*iter).second);
-    }
-  } else if (compare_operator == ">=") {
-    for (auto iter = GetBeginIterator(index_key); iter != GetEndIterator(); ++iter) {
-      result.emplace_back((*iter).second);
-    }
-  } else if (compare_operator == "<") {
-    for (auto iter = GetBeginIterator(); iter != GetBeginIterator(index_key); ++iter) {
-      result.emplace_back((*iter).second);
-    }
-  } else if (compare_operator == "<=") {
-    for (auto iter = GetBeginIterator(); iter != GetBeginIterator(index_key); ++iter) {
-      result.emplace_back((*iter).second);
-    }
-    container_.GetValue(index_key, result, txn);
-  } else if (compare_operator == "<>") {
-    for (auto iter = GetBeginIterator(); iter != GetEndIterator(); ++iter) {
-      result.emplace_back((*iter).second);
-    }
-    vector<RowId> temp;
-    if (container_.GetValue(index_key, temp, txn))
-      result.erase(find(result.begin(), result.end(), temp[0]));
+  return TreeIndexUtil::ScanKey(
+      compare_operator, result, [&] { container_.GetValue(index_key, result, txn); },
+      [&](bool lower, bool lower_inclusive, bool upper, bool upper_inclusive) {
+        container_.ScanRange(lower ? index_key : nullptr, lower_inclusive, upper ? index_key : nullptr,
+                             upper_inclusive, result, txn);
+      });
+}
+
+//所有键先编码到一块连续的缓冲区，再交给B+树按键的顺序一次查完
+dberr_t BPlusTreeIndex::ScanKeys(const std::vector<Row> &keys, std::vector<std::vector<RowId>> &result,
+                                 Transaction *txn) {
+  //每个键占用的空间向上取整到8字节，保持与单个键的缓冲区相同的对齐
+  const size_t stride = (processor_.GetKeySize() + 7) / 8;
+  std::vector<uint64_t> key_buf(keys.size() * stride);
+  std::vector<GenericKey *> index_keys(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    index_keys[i] = reinterpret_cast<GenericKey *>(key_buf.data() + i * stride);
+    processor_.SerializeFromKey(index_keys[i], keys[i], key_schema_);
   }
-  delete index_key;
-  if (!result.empty())
+  if (container_.GetValues(index_keys, result, txn) > 0)
     return DB_SUCCESS;
   else
     return DB_KEY_NOT_FOUND;
@@ -82,6 +78,26 @@ dberr_t BPlusTreeIndex::Destroy() {
   return DB_SUCCESS;
 }
 
+//每条记录是编码后的键加上RowId，排序后的键直接指向记录
+dberr_t BPlusTreeIndex::BulkLoad(const std::vector<EntrySource> &sources, Transaction *txn) {
+  const size_t key_size = processor_.GetKeySize();
+  auto less = [this](const char *lhs, const char *rhs) {
+    return processor_.CompareKeys(reinterpret_cast<const GenericKey *>(lhs),
+                                  reinterpret_cast<const GenericKey *>(rhs)) < 0;
+  };
+  auto encode = [&](const Row &key, const RowId &row_id, char *record) {
+    processor_.SerializeFromKey(reinterpret_cast<GenericKey *>(record), key, key_schema_);
+    memcpy(record + key_size, &row_id, sizeof(RowId));
+    return true;
+  };
+  auto decode = [&](char *record, GenericKey *&index_key, RowId &row_id) {
+    index_key = reinterpret_cast<GenericKey *>(record);
+    memcpy(&row_id, record + key_size, sizeof(RowId));
+  };
+  TreeIndexUtil::BulkLoad<GenericKey *>(container_, sources, key_size + sizeof(RowId), less, encode, decode, txn);
+  return DB_SUCCESS;
+}
+
 IndexIterator BPlusTreeIndex::GetBeginIterator() {
   return container_.Begin();
 }
@@ -92,4 +108,41 @@ IndexIterator BPlusTreeIndex::GetBeginIterator(GenericKey *key) {
 
 IndexIterator BPlusTreeIndex::GetEndIterator() {
   return container_.End();
+}
+
+IndexIterator BPlusTreeIndex::GetRBeginIterator() {
+  return container_.RBegin();
+}
+
+IndexIterator BPlusTreeIndex::GetRBeginIterator(GenericKey *key) {
+  return container_.RBegin(key);
+}
+
+IndexRangeIterator BPlusTreeIndex::GetRangeIterator(const Row *lower, bool lower_inclusive, const Row *upper,
+                                                    bool upper_inclusive, bool reverse) {
+  //迭代器会复制终点一侧的边界，键缓冲区留在栈上即可
+  alignas(8) char lower_buf[KeyManager::MAX_KEY_SIZE];
+  alignas(8) char upper_buf[KeyManager::MAX_KEY_SIZE];
+  GenericKey *lower_key = nullptr;
+  GenericKey *upper_key = nullptr;
+  if (lower != nullptr) {
+    lower_key = reinterpret_cast<GenericKey *>(lower_buf);
+    processor_.SerializeFromKey(lower_key, *lower, key_schema_);
+  }
+  if (upper != nullptr) {
+    upper_key = reinterpret_cast<GenericKey *>(upper_buf);
+    processor_.SerializeFromKey(upper_key, *upper, key_schema_);
+  }
+  return container_.BeginRange(lower_key, lower_inclusive, upper_key, upper_inclusive, reverse);
+}
+
+//最小键在最左边的叶子，最大键在最右边的叶子，只需下降一次
+dberr_t BPlusTreeIndex::ScanExtreme(bool max, Row &key, std::vector<RowId> &result, Transaction *txn) {
+  alignas(8) char key_buf[KeyManager::MAX_KEY_SIZE];
+  auto *index_key = reinterpret_cast<GenericKey *>(key_buf);
+  if (!container_.GetExtreme(max, index_key, result, txn)) {
+    return DB_KEY_NOT_FOUND;
+  }
+  processor_.DeserializeToKey(index_key, key, key_schema_);
+  return DB_SUCCESS;
 }
\ No newline at end of file
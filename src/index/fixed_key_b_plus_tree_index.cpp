@@ -0,0 +1,145 @@
+#include "index/fixed_key_b_plus_tree_index.h"
+
+#include <cstring>
+
+#include "index/tree_index_util.h"
+
+template <typename KeyType>
+FixedKeyBPlusTreeIndex<KeyType>::FixedKeyBPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema,
+                                                        BufferPoolManager *buffer_pool_manager, bool unique)
+    : Index(index_id, key_schema), container_(index_id, buffer_pool_manager, unique) {
+  ASSERT(key_schema->GetColumnCount() == 1, "Fixed key index must have exactly one column.");
+}
+
+template <typename KeyType>
+bool FixedKeyBPlusTreeIndex<KeyType>::ExtractKey(const Row &key, KeyType *value) {
+  Field *field = key.GetField(0);
+  if (field->IsNull())
+    return false;
+  //int和float字段序列化后就是4字节的原始值
+  char buf[sizeof(KeyType)];
+  uint32_t size = field->SerializeTo(buf);
+  ASSERT(size == sizeof(KeyType), "Unexpected key field size.");
+  memcpy(value, buf, sizeof(KeyType));
+  return true;
+}
+
+template <typename KeyType>
+dberr_t FixedKeyBPlusTreeIndex<KeyType>::InsertEntry(const Row &key, RowId row_id, Transaction *txn) {
+  KeyType index_key;
+  if (!ExtractKey(key, &index_key) || !container_.Insert(index_key, row_id, txn))
+    return DB_FAILED;
+  return DB_SUCCESS;
+}
+
+template <typename KeyType>
+dberr_t FixedKeyBPlusTreeIndex<KeyType>::RemoveEntry(const Row &key, RowId row_id, Transaction *txn) {
+  KeyType index_key;
+  if (ExtractKey(key, &index_key))
+    container_.Remove(index_key, row_id, txn);
+  return DB_SUCCESS;
+}
+
+template <typename KeyType>
+dberr_t FixedKeyBPlusTreeIndex<KeyType>::ScanKey(const Row &key, vector<RowId> &result, Transaction *txn,
+                                                 string compare_operator) {
+  KeyType index_key;
+  //空值不与任何键相等，也不参与大小比较
+  if (!ExtractKey(key, &index_key))
+    return DB_KEY_NOT_FOUND;
+  return TreeIndexUtil::ScanKey(
+      compare_operator, result, [&] { container_.GetValue(index_key, result, txn); },
+      [&](bool lower, bool lower_inclusive, bool upper, bool upper_inclusive) {
+        container_.ScanRange(lower ? &index_key : nullptr, lower_inclusive, upper ? &index_key : nullptr,
+                             upper_inclusive, result, txn);
+      });
+}
+
+//空值的键不会在树中，只查找其余的键
+template <typename KeyType>
+dberr_t FixedKeyBPlusTreeIndex<KeyType>::ScanKeys(const std::vector<Row> &keys, std::vector<std::vector<RowId>> &result,
+                                                  Transaction *txn) {
+  std::vector<KeyType> index_keys;
+  std::vector<size_t> positions;
+  index_keys.reserve(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    KeyType index_key;
+    if (ExtractKey(keys[i], &index_key)) {
+      index_keys.push_back(index_key);
+      positions.push_back(i);
+    }
+  }
+  std::vector<std::vector<RowId>> found;
+  size_t count = container_.GetValues(index_keys, found, txn);
+  result.assign(keys.size(), {});
+  for (size_t i = 0; i < positions.size(); i++)
+    result[positions[i]] = std::move(found[i]);
+  if (count > 0)
+    return DB_SUCCESS;
+  else
+    return DB_KEY_NOT_FOUND;
+}
+
+//最小键在最左边的叶子，最大键在最右边的叶子，只需下降一次
+template <typename KeyType>
+dberr_t FixedKeyBPlusTreeIndex<KeyType>::ScanExtreme(bool max, Row &key, std::vector<RowId> &result,
+                                                     Transaction *txn) {
+  KeyType index_key;
+  if (!container_.GetExtreme(max, index_key, result, txn))
+    return DB_KEY_NOT_FOUND;
+  //通过行的序列化格式构造字段，key必须是空行
+  std::vector<Field> fields;
+  fields.emplace_back(key_schema_->GetColumn(0)->GetType(), index_key);
+  Row decoded(fields);
+  std::vector<char> row_buf(decoded.GetSerializedSize(key_schema_));
+  decoded.SerializeTo(row_buf.data(), key_schema_);
+  key.DeserializeFrom(row_buf.data(), key_schema_);
+  return DB_SUCCESS;
+}
+
+template <typename KeyType>
+dberr_t FixedKeyBPlusTreeIndex<KeyType>::Destroy() {
+  container_.Destroy();
+  return DB_SUCCESS;
+}
+
+//每条记录是键的原始值加上RowId；空键不进入索引
+template <typename KeyType>
+dberr_t FixedKeyBPlusTreeIndex<KeyType>::BulkLoad(const std::vector<EntrySource> &sources, Transaction *txn) {
+  auto less = [](const char *lhs, const char *rhs) {
+    KeyType lhs_key, rhs_key;
+    memcpy(&lhs_key, lhs, sizeof(KeyType));
+    memcpy(&rhs_key, rhs, sizeof(KeyType));
+    return lhs_key < rhs_key;
+  };
+  auto encode = [](const Row &key, const RowId &row_id, char *record) {
+    KeyType index_key;
+    if (!ExtractKey(key, &index_key))
+      return false;
+    memcpy(record, &index_key, sizeof(KeyType));
+    memcpy(record + sizeof(KeyType), &row_id, sizeof(RowId));
+    return true;
+  };
+  auto decode = [](const char *record, KeyType &index_key, RowId &row_id) {
+    memcpy(&index_key, record, sizeof(KeyType));
+    memcpy(&row_id, record + sizeof(KeyType), sizeof(RowId));
+  };
+  TreeIndexUtil::BulkLoad<KeyType>(container_, sources, sizeof(KeyType) + sizeof(RowId), less, encode, decode, txn);
+  return DB_SUCCESS;
+}
+
+template <typename KeyType>
+typename FixedKeyBPlusTree<KeyType>::RangeIterator FixedKeyBPlusTreeIndex<KeyType>::GetRangeIterator(
+    const Row *lower, bool lower_inclusive, const Row *upper, bool upper_inclusive, bool reverse) {
+  KeyType lower_key;
+  KeyType upper_key;
+  //空值不与任何键比较，范围为空
+  if ((lower != nullptr && !ExtractKey(*lower, &lower_key)) || (upper != nullptr && !ExtractKey(*upper, &upper_key)))
+    return typename FixedKeyBPlusTree<KeyType>::RangeIterator(nullptr, 0, nullptr, false, nullptr);
+  return container_.BeginRange(lower != nullptr ? &lower_key : nullptr, lower_inclusive,
+                               upper != nullptr ? &upper_key : nullptr, upper_inclusive, reverse);
+}
+
+template class FixedKeyBPlusTreeIndex<int32_t>;
+
+template class FixedKeyBPlusTreeIndex<float>;
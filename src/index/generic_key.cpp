@@ -0,0 +1,191 @@
+#include "index/generic_key.h"
+
+#include <vector>
+
+namespace {
+//以大端序写入，使memcmp的结果与数值大小一致
+inline void WriteBigEndian(char *buf, uint32_t value) {
+  buf[0] = static_cast<char>(value >> 24);
+  buf[1] = static_cast<char>(value >> 16);
+  buf[2] = static_cast<char>(value >> 8);
+  buf[3] = static_cast<char>(value);
+}
+
+inline uint32_t ReadBigEndian(const char *buf) {
+  auto *bytes = reinterpret_cast<const unsigned char *>(buf);
+  return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) |
+         (static_cast<uint32_t>(bytes[2]) << 8) | static_cast<uint32_t>(bytes[3]);
+}
+
+constexpr uint32_t SIGN_BIT = 0x80000000u;
+
+//一个列在键中占用的字节数（不含null标记）
+inline uint32_t ColumnWidth(const Column *column) {
+  if (column->GetType() == TypeId::kTypeChar) {
+    return column->GetLength() + sizeof(uint32_t);
+  }
+  return Type::GetTypeSize(column->GetType());
+}
+}  // namespace
+
+uint32_t KeyManager::EncodedKeySize(const Schema *key_schema) {
+  uint32_t size = 0;
+  for (auto column : key_schema->GetColumns()) {
+    size += 1 + ColumnWidth(column);
+  }
+  return size;
+}
+
+uint32_t KeyManager::MaxCompactKeySize(const Schema *key_schema) {
+  uint32_t size = 0;
+  for (auto column : key_schema->GetColumns()) {
+    //char的每个字节最多转义为两个字节，另加两个字节的结束符
+    size += 1 + (column->GetType() == TypeId::kTypeChar ? 2 * column->GetLength() + 2 : ColumnWidth(column));
+  }
+  return size;
+}
+
+//把每一列编码为定长的、保序的二进制形式，之后比较两个键只需要一次memcmp
+void KeyManager::SerializeFromKey(GenericKey *key_buf, const Row &key, Schema *schema) const {
+  ASSERT(key.GetFieldCount() == schema->GetColumnCount(), "field nums not match.");
+  ASSERT(EncodedKeySize(schema) <= (uint32_t)key_size_, "Index key size exceed max key size.");
+  memset(key_buf->data, 0, key_size_);
+  char *buf = key_buf->data;
+  for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+    const Column *column = schema->GetColumn(i);
+    const Field *field = key.GetField(i);
+    //null值的标记为0，排在所有非null值之前，值部分保持全0
+    if (field->IsNull()) {
+      buf += 1 + ColumnWidth(column);
+      continue;
+    }
+    *buf++ = 1;
+    switch (column->GetType()) {
+      case TypeId::kTypeInt: {
+        //翻转符号位后，负数排在正数之前
+        char value_buf[sizeof(int32_t)];
+        field->SerializeTo(value_buf);
+        int32_t value = MACH_READ_INT32(value_buf);
+        WriteBigEndian(buf, static_cast<uint32_t>(value) ^ SIGN_BIT);
+        break;
+      }
+      case TypeId::kTypeFloat: {
+        //正数翻转符号位，负数翻转所有位；-0.0与0.0相等，统一编码为0.0
+        char value_buf[sizeof(float_t)];
+        field->SerializeTo(value_buf);
+        float value = MACH_READ_FROM(float_t, value_buf);
+        if (value == 0.0f)
+          value = 0.0f;
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        WriteBigEndian(buf, (bits & SIGN_BIT) ? ~bits : bits ^ SIGN_BIT);
+        break;
+      }
+      case TypeId::kTypeChar: {
+        //数据用0补齐到列长度，最后写入长度：一个串是另一个串的前缀时，较短的串排在前面
+        uint32_t len = field->GetLength();
+        ASSERT(len <= column->GetLength(), "Char key exceeds column length.");
+        memcpy(buf, field->GetData(), len);
+        WriteBigEndian(buf + column->GetLength(), len);
+        break;
+      }
+      default:
+        ASSERT(false, "Unsupported key type.");
+    }
+    buf += ColumnWidth(column);
+  }
+}
+
+//每一列的编码都不是其他编码的前缀，所以按字节比较拼接后的紧凑键与比较定长的键结果一致
+uint32_t KeyManager::ToCompactKey(const GenericKey *key, char *buf) const {
+  const char *src = key->data;
+  char *dst = buf;
+  for (auto column : key_schema_->GetColumns()) {
+    char flag = *src++;
+    *dst++ = flag;
+    if (flag == 0) {
+      src += ColumnWidth(column);
+      continue;
+    }
+    if (column->GetType() != TypeId::kTypeChar) {
+      memcpy(dst, src, ColumnWidth(column));
+      dst += ColumnWidth(column);
+      src += ColumnWidth(column);
+      continue;
+    }
+    //0x00转义为0x00 0x01，结束符0x00 0x00小于任何数据字节，较短的串排在前面
+    uint32_t len = ReadBigEndian(src + column->GetLength());
+    for (uint32_t i = 0; i < len; i++) {
+      *dst++ = src[i];
+      if (src[i] == 0)
+        *dst++ = 1;
+    }
+    *dst++ = 0;
+    *dst++ = 0;
+    src += ColumnWidth(column);
+  }
+  return dst - buf;
+}
+
+//ToCompactKey的逆变换：char列去掉转义，再用0补齐到列长度并写入长度
+void KeyManager::FromCompactKey(const char *buf, GenericKey *key) const {
+  memset(key->data, 0, key_size_);
+  char *dst = key->data;
+  for (auto column : key_schema_->GetColumns()) {
+    char flag = *buf++;
+    *dst++ = flag;
+    if (flag != 0 && column->GetType() != TypeId::kTypeChar) {
+      memcpy(dst, buf, ColumnWidth(column));
+      buf += ColumnWidth(column);
+    } else if (flag != 0) {
+      uint32_t len = 0;
+      while (buf[0] != 0 || buf[1] != 0) {
+        dst[len++] = buf[0];
+        buf += buf[0] == 0 ? 2 : 1;
+      }
+      buf += 2;
+      WriteBigEndian(dst + column->GetLength(), len);
+    }
+    dst += ColumnWidth(column);
+  }
+}
+
+//把规范化的键还原成行；只在调试和测试时使用
+void KeyManager::DeserializeToKey(const GenericKey *key_buf, Row &key, Schema *schema) const {
+  std::vector<Field> fields;
+  fields.reserve(schema->GetColumnCount());
+  const char *buf = key_buf->data;
+  for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+    const Column *column = schema->GetColumn(i);
+    TypeId type = column->GetType();
+    if (*buf++ == 0) {
+      fields.emplace_back(type);
+      buf += ColumnWidth(column);
+      continue;
+    }
+    switch (type) {
+      case TypeId::kTypeInt:
+        fields.emplace_back(type, static_cast<int32_t>(ReadBigEndian(buf) ^ SIGN_BIT));
+        break;
+      case TypeId::kTypeFloat: {
+        uint32_t bits = ReadBigEndian(buf);
+        bits = (bits & SIGN_BIT) ? bits ^ SIGN_BIT : ~bits;
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        fields.emplace_back(type, value);
+        break;
+      }
+      case TypeId::kTypeChar:
+        fields.emplace_back(type, const_cast<char *>(buf), ReadBigEndian(buf + column->GetLength()), false);
+        break;
+      default:
+        ASSERT(false, "Unsupported key type.");
+    }
+    buf += ColumnWidth(column);
+  }
+  //通过行的序列化格式构造字段，key必须是空行
+  Row decoded(fields);
+  std::vector<char> row_buf(decoded.GetSerializedSize(schema));
+  decoded.SerializeTo(row_buf.data(), schema);
+  key.DeserializeFrom(row_buf.data(), schema);
+}
@@ -2,13 +2,20 @@
 
 #include "index/basic_comparator.h"
 #include "index/generic_key.h"
+#include "index/posting_list.h"
 
 IndexIterator::IndexIterator() = default;
 
-IndexIterator::IndexIterator(page_id_t page_id, BufferPoolManager *bpm, int index)
-    : current_page_id(page_id), item_index(index), buffer_pool_manager(bpm) {
-  if (page_id != INVALID_PAGE_ID) {
-    page = reinterpret_cast<LeafPage *>(buffer_pool_manager->FetchPage(current_page_id)->GetData());
+IndexIterator::IndexIterator(Page *leaf, BufferPoolManager *bpm, int index, bool reverse,
+                             const KeyManager *processor)
+    : frame(leaf), item_index(index), buffer_pool_manager(bpm), reverse(reverse), processor(processor) {
+  if (leaf != nullptr) {
+    current_page_id = leaf->GetPageId();
+    page = reinterpret_cast<LeafPage *>(leaf->GetData());
+    if (reverse) {
+      TakeEntry();
+      frame->RUnlatch();
+    }
   }
 }
 
@@ -18,36 +25,141 @@ IndexIterator::~IndexIterator() {
 }
 
 std::pair<GenericKey *, RowId> IndexIterator::operator*() {
-  return page->GetItem(item_index);
+  frame->RLatch();
+  std::pair<GenericKey *, RowId> item;
+  if (reverse) {
+    item = {reinterpret_cast<GenericKey *>(current_key.data()), slot};
+  } else {
+    item = page->GetItem(item_index);
+  }
+  if (PostingList::IsList(item.second)) {
+    LoadPostings();
+    item.second = postings[posting_index];
+  }
+  frame->RUnlatch();
+  return item;
 }
 
 IndexIterator &IndexIterator::operator++() {
-  if (item_index < page->GetSize() - 1) {
+  frame->RLatch();
+  /* go through the row ids of a posting list before moving on to the next key */
+  LoadPostings();
+  if (!reverse && posting_index + 1 < postings.size()) {
+    posting_index++;
+    frame->RUnlatch();
+    return *this;
+  }
+  if (reverse && posting_index > 0) {
+    posting_index--;
+    frame->RUnlatch();
+    return *this;
+  }
+  postings.clear();
+  posting_index = 0;
+  if (!reverse) {
     item_index++;
-  } else if (page->GetNextPageId() != INVALID_PAGE_ID) {
-    page_id_t old_page_id = current_page_id;
-    current_page_id = page->GetNextPageId();
-    page = reinterpret_cast<LeafPage *>(buffer_pool_manager->FetchPage(current_page_id)->GetData());
-
-    /* first on next index */
-    item_index = 0;
-    buffer_pool_manager->UnpinPage(old_page_id, false);
-  } else if (page->GetNextPageId() == INVALID_PAGE_ID) {
-    /* change to index end() */
-    buffer_pool_manager->UnpinPage(current_page_id, false);
-    current_page_id = INVALID_PAGE_ID;
-    page = nullptr;
-    item_index = -1;
   } else {
-    ASSERT(false, "Can't reach here.");
+    /* find the current key again, as inserts and removes before it or a split may have moved it */
+    auto *key = reinterpret_cast<GenericKey *>(current_key.data());
+    item_index = page->KeyIndex(key, *processor);
+    if (item_index == page->GetSize()) {
+      /* a split moved the current key on to a new leaf, maybe with keys below it */
+      FollowSplit(frame, INVALID_PAGE_ID, key, *processor, buffer_pool_manager);
+      current_page_id = frame->GetPageId();
+      page = reinterpret_cast<LeafPage *>(frame->GetData());
+      item_index = page->KeyIndex(key, *processor);
+    }
+    item_index--;
+  }
+  /* move on along the leaf chain, passing over leaves emptied by a concurrent merge */
+  while (reverse ? item_index < 0 : item_index >= page->GetSize()) {
+    page_id_t next_page_id = reverse ? page->GetPrevPageId() : page->GetNextPageId();
+    if (next_page_id == INVALID_PAGE_ID) {
+      /* change to index end() */
+      frame->RUnlatch();
+      buffer_pool_manager->UnpinPage(current_page_id, false);
+      current_page_id = INVALID_PAGE_ID;
+      frame = nullptr;
+      page = nullptr;
+      item_index = -1;
+      return *this;
+    }
+    /* pin the next leaf before releasing this one, so that it can not be merged away in between */
+    Page *next = buffer_pool_manager->FetchPage(next_page_id);
+    page_id_t left_page_id = current_page_id;
+    frame->RUnlatch();
+    buffer_pool_manager->UnpinPage(current_page_id, false);
+    current_page_id = next_page_id;
+    frame = next;
+    page = reinterpret_cast<LeafPage *>(next->GetData());
+
+    /* first on next index, last below the current key on the previous one */
+    frame->RLatch();
+    if (!reverse) {
+      item_index = 0;
+    } else {
+      auto *key = reinterpret_cast<GenericKey *>(current_key.data());
+      FollowSplit(frame, left_page_id, key, *processor, buffer_pool_manager);
+      current_page_id = frame->GetPageId();
+      page = reinterpret_cast<LeafPage *>(frame->GetData());
+      item_index = page->KeyIndex(key, *processor) - 1;
+    }
+  }
+  if (reverse) {
+    TakeEntry();
   }
+  frame->RUnlatch();
   return *this;
 }
 
+void IndexIterator::FollowSplit(Page *&frame, page_id_t left_page_id, const GenericKey *resume,
+                                const KeyManager &processor, BufferPoolManager *bpm) {
+  auto *leaf = reinterpret_cast<LeafPage *>(frame->GetData());
+  page_id_t stop_page_id = left_page_id;
+  while (leaf->GetNextPageId() != stop_page_id && leaf->GetNextPageId() != INVALID_PAGE_ID) {
+    page_id_t next_page_id = leaf->GetNextPageId();
+    /* writers merging leaves latch towards the left, so do not wait for the next leaf while holding this one */
+    Page *next = bpm->FetchPage(next_page_id);
+    frame->RUnlatch();
+    next->RLatch();
+    auto *next_leaf = reinterpret_cast<LeafPage *>(next->GetData());
+    /* a leaf starting at or above resume holds no keys the scan still has to return: stay, frame may split again */
+    if (next_leaf->GetSize() == 0 || processor.CompareKeys(next_leaf->KeyAt(0), resume) >= 0) {
+      next->RUnlatch();
+      bpm->UnpinPage(next_page_id, false);
+      frame->RLatch();
+      stop_page_id = next_page_id;
+      continue;
+    }
+    bpm->UnpinPage(frame->GetPageId(), false);
+    frame = next;
+    leaf = next_leaf;
+  }
+}
+
 bool IndexIterator::operator==(const IndexIterator &itr) const {
-  return current_page_id == itr.current_page_id && item_index == itr.item_index;
+  return current_page_id == itr.current_page_id && item_index == itr.item_index &&
+         posting_index == itr.posting_index;
 }
 
 bool IndexIterator::operator!=(const IndexIterator &itr) const {
   return !(*this == itr);
-}
\ No newline at end of file
+}
+
+void IndexIterator::LoadPostings() {
+  if (!postings.empty() || (!reverse && item_index >= page->GetSize())) {
+    return;
+  }
+  RowId slot_value = reverse ? slot : page->ValueAt(item_index);
+  if (PostingList::IsList(slot_value)) {
+    PostingList::Read(buffer_pool_manager, slot_value, postings);
+    /* a reverse iterator starts at the largest row id */
+    posting_index = reverse ? postings.size() - 1 : 0;
+  }
+}
+
+void IndexIterator::TakeEntry() {
+  const char *data = reinterpret_cast<const char *>(page->KeyAt(item_index));
+  current_key.assign(data, data + processor->GetKeySize());
+  slot = page->ValueAt(item_index);
+}
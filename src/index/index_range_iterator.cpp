@@ -0,0 +1,135 @@
+#include "index/index_range_iterator.h"
+
+#include <algorithm>
+#include <climits>
+
+#include "index/index_iterator.h"
+#include "index/posting_list.h"
+
+IndexRangeIterator::IndexRangeIterator(Page *leaf, int index, const GenericKey *bound, bool bound_inclusive,
+                                       const KeyManager &processor, BufferPoolManager *bpm, bool reverse)
+    : frame_(leaf), index_(index), bound_inclusive_(bound_inclusive), reverse_(reverse), processor_(processor),
+      buffer_pool_manager_(bpm) {
+  if (bound != nullptr) {
+    const char *data = reinterpret_cast<const char *>(bound);
+    bound_.assign(data, data + processor_.GetKeySize());
+  }
+  /* read the first leaf before a writer can move keys around the start */
+  if (reverse_ && frame_ != nullptr) {
+    ReadLeaf(first_batch_);
+  }
+}
+
+IndexRangeIterator::IndexRangeIterator(IndexRangeIterator &&other) noexcept
+    : frame_(other.frame_),
+      index_(other.index_),
+      bound_(std::move(other.bound_)),
+      bound_inclusive_(other.bound_inclusive_),
+      reverse_(other.reverse_),
+      resume_(std::move(other.resume_)),
+      left_page_id_(other.left_page_id_),
+      first_batch_(std::move(other.first_batch_)),
+      processor_(other.processor_),
+      buffer_pool_manager_(other.buffer_pool_manager_) {
+  other.frame_ = nullptr;
+}
+
+IndexRangeIterator::~IndexRangeIterator() {
+  if (frame_ != nullptr) {
+    buffer_pool_manager_->UnpinPage(frame_->GetPageId(), false);
+  }
+}
+
+bool IndexRangeIterator::NextBatch(std::vector<RowId> &row_ids) {
+  row_ids.clear();
+  row_ids.swap(first_batch_);
+  /* leaves emptied by a concurrent merge, or a start past the end of the first leaf, yield nothing: go on */
+  while (frame_ != nullptr && row_ids.empty()) {
+    frame_->RLatch();
+    ReadLeaf(row_ids);
+  }
+  return !row_ids.empty();
+}
+
+void IndexRangeIterator::ReadLeaf(std::vector<RowId> &row_ids) {
+  if (reverse_ && left_page_id_ != INVALID_PAGE_ID && !resume_.empty()) {
+    IndexIterator::FollowSplit(frame_, left_page_id_, reinterpret_cast<const GenericKey *>(resume_.data()),
+                               processor_, buffer_pool_manager_);
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(frame_->GetData());
+  bool last;
+  page_id_t next_page_id;
+  if (!reverse_) {
+    int end = UpperIndex(leaf, last);
+    for (; index_ < end; index_++) {
+      PostingList::Read(buffer_pool_manager_, leaf->ValueAt(index_), row_ids);
+    }
+    next_page_id = last ? INVALID_PAGE_ID : leaf->GetNextPageId();
+  } else {
+    int begin = LowerIndex(leaf, last);
+    /* keys a merge or redistribution moved here from the leaf returned before have been returned already */
+    int end = std::min(index_, leaf->GetSize());
+    if (!resume_.empty()) {
+      end = std::min(end, leaf->KeyIndex(reinterpret_cast<const GenericKey *>(resume_.data()), processor_));
+    }
+    for (index_ = end - 1; index_ >= begin; index_--) {
+      size_t first = row_ids.size();
+      PostingList::Read(buffer_pool_manager_, leaf->ValueAt(index_), row_ids);
+      std::reverse(row_ids.begin() + first, row_ids.end());
+    }
+    /* go on below the last key returned, or below the upper bound if the first leaf had nothing under it */
+    int below = begin < end ? begin : end;
+    if (below < leaf->GetSize() && (begin < end || resume_.empty())) {
+      const char *data = reinterpret_cast<const char *>(leaf->KeyAt(below));
+      resume_.assign(data, data + processor_.GetKeySize());
+    }
+    next_page_id = last ? INVALID_PAGE_ID : leaf->GetPrevPageId();
+  }
+  /* pin the next leaf before releasing this one, so that it can not be merged away in between */
+  Page *next = next_page_id == INVALID_PAGE_ID ? nullptr : buffer_pool_manager_->FetchPage(next_page_id);
+  left_page_id_ = frame_->GetPageId();
+  frame_->RUnlatch();
+  buffer_pool_manager_->UnpinPage(left_page_id_, false);
+  frame_ = next;
+  /* a reverse scan takes the previous leaf from its end */
+  index_ = reverse_ ? INT_MAX : 0;
+}
+
+int IndexRangeIterator::UpperIndex(LeafPage *leaf, bool &last) {
+  int size = leaf->GetSize();
+  last = false;
+  if (bound_.empty() || size == 0) {
+    return size;
+  }
+  auto *upper = reinterpret_cast<const GenericKey *>(bound_.data());
+  /* most leaves of a long scan lie wholly below the bound, which one comparison shows */
+  if (processor_.CompareKeys(leaf->KeyAt(size - 1), upper) < 0) {
+    return size;
+  }
+  /* the leaf reaches the bound, so no later leaf holds keys in range */
+  last = true;
+  int index = leaf->KeyIndex(upper, processor_);
+  if (bound_inclusive_ && index < size && processor_.CompareKeys(leaf->KeyAt(index), upper) == 0) {
+    index++;
+  }
+  return index;
+}
+
+int IndexRangeIterator::LowerIndex(LeafPage *leaf, bool &last) {
+  int size = leaf->GetSize();
+  last = false;
+  if (bound_.empty() || size == 0) {
+    return 0;
+  }
+  auto *lower = reinterpret_cast<const GenericKey *>(bound_.data());
+  if (processor_.CompareKeys(leaf->KeyAt(0), lower) > 0) {
+    return 0;
+  }
+  /* the leaf reaches the bound, so no earlier leaf holds keys in range */
+  last = true;
+  int index = leaf->KeyIndex(lower, processor_);
+  if (!bound_inclusive_ && index < size && processor_.CompareKeys(leaf->KeyAt(index), lower) == 0) {
+    index++;
+  }
+  return index;
+}
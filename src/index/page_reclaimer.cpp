@@ -0,0 +1,20 @@
+#include "index/page_reclaimer.h"
+
+#include <algorithm>
+
+void PageReclaimer::Reclaim(const std::vector<page_id_t> &page_ids) {
+  if (page_ids.empty() && !has_pending_.load(std::memory_order_acquire))
+    return;
+  std::lock_guard<std::mutex> guard(latch_);
+  pending_.insert(pending_.end(), page_ids.begin(), page_ids.end());
+  //删除失败的页仍被读者钉住，留到下一次再删
+  auto freed = std::remove_if(pending_.begin(), pending_.end(),
+                             [this](page_id_t page_id) { return buffer_pool_manager_->DeletePage(page_id); });
+  pending_.erase(freed, pending_.end());
+  has_pending_.store(!pending_.empty(), std::memory_order_release);
+}
+
+size_t PageReclaimer::GetPendingCount() {
+  std::lock_guard<std::mutex> guard(latch_);
+  return pending_.size();
+}
@@ -0,0 +1,182 @@
+#include "index/posting_list.h"
+
+#include <algorithm>
+
+static BPlusTreePostingPage *AsPosting(Page *page) {
+  return reinterpret_cast<BPlusTreePostingPage *>(page->GetData());
+}
+
+//从头页开始，找到第一个最大值不小于value的页，没有则是最后一页；prev_id返回它的前一页
+static Page *FindPostingPage(BufferPoolManager *bpm, page_id_t head_id, const RowId &value, page_id_t &prev_id) {
+  prev_id = INVALID_PAGE_ID;
+  Page *page = bpm->FetchPage(head_id);
+  ASSERT(page != nullptr, "Out of memory.");
+  while (true) {
+    auto *posting = AsPosting(page);
+    int size = posting->GetSize();
+    page_id_t next_id = posting->GetNextPageId();
+    if (next_id == INVALID_PAGE_ID || (size > 0 && posting->ValueAt(size - 1).Get() >= value.Get())) {
+      return page;
+    }
+    prev_id = page->GetPageId();
+    bpm->UnpinPage(prev_id, false);
+    page = bpm->FetchPage(next_id);
+    ASSERT(page != nullptr, "Out of memory.");
+  }
+}
+
+bool PostingList::Insert(BufferPoolManager *bpm, RowId &slot_value, const RowId &value) {
+  //单个RowId变为包含两个RowId的列表
+  if (!IsList(slot_value)) {
+    if (slot_value == value) {
+      return false;
+    }
+    std::vector<RowId> values{slot_value, value};
+    slot_value = Create(bpm, values);
+    return true;
+  }
+  page_id_t prev_id;
+  Page *page = FindPostingPage(bpm, slot_value.GetPageId(), value, prev_id);
+  auto *posting = AsPosting(page);
+  int index = posting->ValueIndex(value);
+  if (index < posting->GetSize() && posting->ValueAt(index) == value) {
+    bpm->UnpinPage(page->GetPageId(), false);
+    return false;
+  }
+  if (posting->IsFull()) {
+    page_id_t new_id = INVALID_PAGE_ID;
+    Page *new_page = bpm->NewPage(new_id);
+    ASSERT(new_page != nullptr, "Out of memory.");
+    auto *new_posting = AsPosting(new_page);
+    new_posting->Init();
+    if (index == posting->GetSize() && posting->GetNextPageId() == INVALID_PAGE_ID) {
+      //RowId通常递增，追加到末尾时直接开始新页，使前面的页保持满
+      new_posting->InsertAt(0, value);
+      posting->SetNextPageId(new_id);
+    } else {
+      posting->MoveHalfTo(new_posting, new_id);
+      if (index > posting->GetSize()) {
+        new_posting->InsertAt(index - posting->GetSize(), value);
+      } else {
+        posting->InsertAt(index, value);
+      }
+    }
+    bpm->UnpinPage(new_id, true);
+  } else {
+    posting->InsertAt(index, value);
+  }
+  bpm->UnpinPage(page->GetPageId(), true);
+  return true;
+}
+
+bool PostingList::Remove(BufferPoolManager *bpm, RowId &slot_value, const RowId &value) {
+  ASSERT(IsList(slot_value), "Slot value is not a posting list.");
+  page_id_t head_id = slot_value.GetPageId();
+  page_id_t prev_id;
+  Page *page = FindPostingPage(bpm, head_id, value, prev_id);
+  page_id_t page_id = page->GetPageId();
+  auto *posting = AsPosting(page);
+  int index = posting->ValueIndex(value);
+  if (index == posting->GetSize() || !(posting->ValueAt(index) == value)) {
+    bpm->UnpinPage(page_id, false);
+    return false;
+  }
+  posting->RemoveAt(index);
+  if (posting->GetSize() == 0 && page_id == head_id) {
+    //头页的位置不变，把下一页的内容搬到头页
+    page_id_t next_id = posting->GetNextPageId();
+    Page *next = bpm->FetchPage(next_id);
+    ASSERT(next != nullptr, "Out of memory.");
+    posting->CopyFrom(AsPosting(next));
+    bpm->UnpinPage(next_id, false);
+    bpm->DeletePage(next_id);
+  } else if (posting->GetSize() == 0) {
+    Page *prev = bpm->FetchPage(prev_id);
+    ASSERT(prev != nullptr, "Out of memory.");
+    AsPosting(prev)->SetNextPageId(posting->GetNextPageId());
+    bpm->UnpinPage(prev_id, true);
+    bpm->UnpinPage(page_id, false);
+    bpm->DeletePage(page_id);
+    page = nullptr;
+  }
+  if (page != nullptr) {
+    bpm->UnpinPage(page_id, true);
+  }
+  //只剩一个RowId时释放列表，直接存在叶子里
+  Page *head = bpm->FetchPage(head_id);
+  ASSERT(head != nullptr, "Out of memory.");
+  auto *head_posting = AsPosting(head);
+  bool single = head_posting->GetSize() == 1 && head_posting->GetNextPageId() == INVALID_PAGE_ID;
+  if (single) {
+    slot_value = head_posting->ValueAt(0);
+  }
+  bpm->UnpinPage(head_id, false);
+  if (single) {
+    bpm->DeletePage(head_id);
+  }
+  return true;
+}
+
+void PostingList::Read(BufferPoolManager *bpm, const RowId &slot_value, std::vector<RowId> &result) {
+  if (!IsList(slot_value)) {
+    result.push_back(slot_value);
+    return;
+  }
+  page_id_t page_id = slot_value.GetPageId();
+  while (page_id != INVALID_PAGE_ID) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT(page != nullptr, "Out of memory.");
+    auto *posting = AsPosting(page);
+    for (int i = 0; i < posting->GetSize(); i++) {
+      result.push_back(posting->ValueAt(i));
+    }
+    page_id_t next_id = posting->GetNextPageId();
+    bpm->UnpinPage(page_id, false);
+    page_id = next_id;
+  }
+}
+
+RowId PostingList::Create(BufferPoolManager *bpm, std::vector<RowId> &values) {
+  ASSERT(!values.empty(), "Empty posting list.");
+  if (values.size() == 1) {
+    return values[0];
+  }
+  std::sort(values.begin(), values.end(), [](const RowId &a, const RowId &b) { return a.Get() < b.Get(); });
+  //按顺序填满每一页，最后一页可能不满
+  page_id_t head_id = INVALID_PAGE_ID;
+  Page *page = bpm->NewPage(head_id);
+  ASSERT(page != nullptr, "Out of memory.");
+  AsPosting(page)->Init();
+  for (size_t pos = 0; pos < values.size();) {
+    auto *posting = AsPosting(page);
+    int count = static_cast<int>(std::min<size_t>(BPlusTreePostingPage::MAX_SIZE, values.size() - pos));
+    posting->Append(values.data() + pos, count);
+    pos += count;
+    if (pos < values.size()) {
+      page_id_t next_id = INVALID_PAGE_ID;
+      Page *next = bpm->NewPage(next_id);
+      ASSERT(next != nullptr, "Out of memory.");
+      AsPosting(next)->Init();
+      posting->SetNextPageId(next_id);
+      bpm->UnpinPage(page->GetPageId(), true);
+      page = next;
+    }
+  }
+  bpm->UnpinPage(page->GetPageId(), true);
+  return RowId(head_id, POSTING_SLOT);
+}
+
+void PostingList::Destroy(BufferPoolManager *bpm, const RowId &slot_value) {
+  if (!IsList(slot_value)) {
+    return;
+  }
+  page_id_t page_id = slot_value.GetPageId();
+  while (page_id != INVALID_PAGE_ID) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT(page != nullptr, "Out of memory.");
+    page_id_t next_id = AsPosting(page)->GetNextPageId();
+    bpm->UnpinPage(page_id, false);
+    bpm->DeletePage(page_id);
+    page_id = next_id;
+  }
+}
@@ -0,0 +1,116 @@
+#include "index/slotted_b_plus_tree_index.h"
+
+#include "index/tree_index_util.h"
+
+SlottedBPlusTreeIndex::SlottedBPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema,
+                                             BufferPoolManager *buffer_pool_manager, bool unique)
+    : Index(index_id, key_schema),
+      processor_(key_schema, KeyManager::EncodedKeySize(key_schema)),
+      container_(index_id, buffer_pool_manager, unique) {
+  ASSERT(KeyManager::EncodedKeySize(key_schema) <= KeyManager::MAX_KEY_SIZE, "Index key size exceed max key size.");
+  ASSERT(KeyManager::MaxCompactKeySize(key_schema) <= SlottedBPlusTree::MAX_KEY_SIZE,
+         "Index key size exceed max key size.");
+}
+
+//先编码为定长的规范化键，再去掉char列的填充
+std::string_view SlottedBPlusTreeIndex::EncodeKey(const Row &key, char *buf) const {
+  alignas(8) char key_buf[KeyManager::MAX_KEY_SIZE];
+  auto *index_key = reinterpret_cast<GenericKey *>(key_buf);
+  processor_.SerializeFromKey(index_key, key, key_schema_);
+  return std::string_view(buf, processor_.ToCompactKey(index_key, buf));
+}
+
+dberr_t SlottedBPlusTreeIndex::InsertEntry(const Row &key, RowId row_id, Transaction *txn) {
+  char key_buf[SlottedBPlusTree::MAX_KEY_SIZE];
+  if (!container_.Insert(EncodeKey(key, key_buf), row_id, txn))
+    return DB_FAILED;
+  return DB_SUCCESS;
+}
+
+dberr_t SlottedBPlusTreeIndex::RemoveEntry(const Row &key, RowId row_id, Transaction *txn) {
+  char key_buf[SlottedBPlusTree::MAX_KEY_SIZE];
+  //非唯一索引只删除这一行的RowId，键随最后一个RowId删除
+  container_.Remove(EncodeKey(key, key_buf), row_id, txn);
+  return DB_SUCCESS;
+}
+
+dberr_t SlottedBPlusTreeIndex::ScanKey(const Row &key, vector<RowId> &result, Transaction *txn,
+                                       string compare_operator) {
+  char key_buf[SlottedBPlusTree::MAX_KEY_SIZE];
+  std::string_view index_key = EncodeKey(key, key_buf);
+  return TreeIndexUtil::ScanKey(
+      compare_operator, result, [&] { container_.GetValue(index_key, result, txn); },
+      [&](bool lower, bool lower_inclusive, bool upper, bool upper_inclusive) {
+        container_.ScanRange(lower ? &index_key : nullptr, lower_inclusive, upper ? &index_key : nullptr,
+                             upper_inclusive, result, txn);
+      });
+}
+
+//所有键先编码到一块连续的缓冲区，再交给B+树按键的顺序一次查完
+dberr_t SlottedBPlusTreeIndex::ScanKeys(const std::vector<Row> &keys, std::vector<std::vector<RowId>> &result,
+                                        Transaction *txn) {
+  std::vector<char> key_buf(keys.size() * SlottedBPlusTree::MAX_KEY_SIZE);
+  std::vector<std::string_view> index_keys(keys.size());
+  for (size_t i = 0; i < keys.size(); i++)
+    index_keys[i] = EncodeKey(keys[i], key_buf.data() + i * SlottedBPlusTree::MAX_KEY_SIZE);
+  if (container_.GetValues(index_keys, result, txn) > 0)
+    return DB_SUCCESS;
+  else
+    return DB_KEY_NOT_FOUND;
+}
+
+//最小键在最左边的叶子，最大键在最右边的叶子，只需下降一次
+dberr_t SlottedBPlusTreeIndex::ScanExtreme(bool max, Row &key, std::vector<RowId> &result, Transaction *txn) {
+  std::string index_key;
+  if (!container_.GetExtreme(max, index_key, result, txn))
+    return DB_KEY_NOT_FOUND;
+  //紧凑键先还原成规范化的键，再还原成行
+  alignas(8) char key_buf[KeyManager::MAX_KEY_SIZE];
+  processor_.FromCompactKey(index_key.data(), reinterpret_cast<GenericKey *>(key_buf));
+  processor_.DeserializeToKey(reinterpret_cast<GenericKey *>(key_buf), key, key_schema_);
+  return DB_SUCCESS;
+}
+
+dberr_t SlottedBPlusTreeIndex::Destroy() {
+  container_.Destroy();
+  return DB_SUCCESS;
+}
+
+//排序时每条记录是定长的规范化键加上RowId，按顺序取出时再转换为紧凑键
+dberr_t SlottedBPlusTreeIndex::BulkLoad(const std::vector<EntrySource> &sources, Transaction *txn) {
+  const size_t key_size = processor_.GetKeySize();
+  auto less = [this](const char *lhs, const char *rhs) {
+    return processor_.CompareKeys(reinterpret_cast<const GenericKey *>(lhs),
+                                  reinterpret_cast<const GenericKey *>(rhs)) < 0;
+  };
+  auto encode = [&](const Row &key, const RowId &row_id, char *record) {
+    processor_.SerializeFromKey(reinterpret_cast<GenericKey *>(record), key, key_schema_);
+    memcpy(record + key_size, &row_id, sizeof(RowId));
+    return true;
+  };
+  char key_buf[SlottedBPlusTree::MAX_KEY_SIZE];
+  auto decode = [&](const char *record, std::string_view &index_key, RowId &row_id) {
+    uint32_t size = processor_.ToCompactKey(reinterpret_cast<const GenericKey *>(record), key_buf);
+    index_key = std::string_view(key_buf, size);
+    memcpy(&row_id, record + key_size, sizeof(RowId));
+  };
+  TreeIndexUtil::BulkLoad<std::string_view>(container_, sources, key_size + sizeof(RowId), less, encode, decode,
+                                            txn);
+  return DB_SUCCESS;
+}
+
+SlottedBPlusTree::RangeIterator SlottedBPlusTreeIndex::GetRangeIterator(const Row *lower, bool lower_inclusive,
+                                                                        const Row *upper, bool upper_inclusive,
+                                                                        bool reverse) {
+  //迭代器会复制终点一侧的边界，键缓冲区留在栈上即可
+  char lower_buf[SlottedBPlusTree::MAX_KEY_SIZE];
+  char upper_buf[SlottedBPlusTree::MAX_KEY_SIZE];
+  std::string_view lower_key;
+  std::string_view upper_key;
+  if (lower != nullptr)
+    lower_key = EncodeKey(*lower, lower_buf);
+  if (upper != nullptr)
+    upper_key = EncodeKey(*upper, upper_buf);
+  return container_.BeginRange(lower != nullptr ? &lower_key : nullptr, lower_inclusive,
+                               upper != nullptr ? &upper_key : nullptr, upper_inclusive, reverse);
+}
@@ -0,0 +1,941 @@
+#include "index/specialized_b_plus_tree.h"
+
+#include <algorithm>
+#include <climits>
+#include <numeric>
+
+#include "glog/logging.h"
+#include "index/posting_list.h"
+#include "page/fixed_key_b_plus_tree_page.h"
+#include "page/index_roots_page.h"
+#include "page/slotted_b_plus_tree_page.h"
+
+template <typename Format>
+SpecializedBPlusTree<Format>::SpecializedBPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager,
+                                                   bool unique)
+    : index_id_(index_id),
+      buffer_pool_manager_(buffer_pool_manager),
+      page_reclaimer_(buffer_pool_manager),
+      unique_(unique) {
+  auto *index_roots =
+      reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
+  //索引已经存在时读出根页号，否则登记一个空树
+  page_id_t root_page_id = INVALID_PAGE_ID;
+  if (index_roots->GetRootId(index_id_, &root_page_id)) {
+    root_page_id_ = root_page_id;
+    buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
+  } else {
+    buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
+    UpdateRootPageId(true);
+  }
+}
+
+template <typename Format>
+void SpecializedBPlusTree<Format>::UpdateRootPageId(bool insert_record) {
+  //索引根页被所有索引共享
+  Page *page = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
+  auto *index_roots = reinterpret_cast<IndexRootsPage *>(page->GetData());
+  page->WLatch();
+  if (insert_record) {
+    index_roots->Insert(index_id_, root_page_id_);
+  } else {
+    index_roots->Update(index_id_, root_page_id_);
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+template <typename Format>
+page_id_t SpecializedBPlusTree<Format>::ChildToFollow(const InternalPage *page, const Key *key, bool rightmost) {
+  //不加锁读到的页面可能正被修改，大小不可信时放弃这次下降
+  int size = page->GetSize();
+  if (size <= 0 || size > InternalPage::MAX_SIZE)
+    return INVALID_PAGE_ID;
+  int index = key != nullptr ? page->UpperIndex(*key) - 1 : (rightmost ? size - 1 : 0);
+  if (index < 0)
+    return INVALID_PAGE_ID;
+  return page->ValueAt(index);
+}
+
+//乐观锁耦合：先记录子结点的版本再验证父结点，保证到达子结点时它仍挂在父结点下面
+//页面内容可能正被写线程修改，只有验证通过后读到的内容才可以使用
+template <typename Format>
+Page *SpecializedBPlusTree<Format>::FindLeafPageOptimistic(const Key *key, bool rightmost, uint64_t &version) {
+  page_id_t page_id = root_page_id_;
+  if (page_id == INVALID_PAGE_ID)
+    return nullptr;
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  //换根时旧根被加了写锁，所以读到版本后再确认一次根页号即可
+  if (!page->ReadVersion(version) || root_page_id_ != page_id) {
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    return nullptr;
+  }
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  while (!node->IsLeafPage()) {
+    page_id_t child_id = ChildToFollow(reinterpret_cast<InternalPage *>(node), key, rightmost);
+    if (child_id == INVALID_PAGE_ID || !page->ValidateVersion(version)) {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      return nullptr;
+    }
+    Page *child = buffer_pool_manager_->FetchPage(child_id);
+    uint64_t child_version;
+    bool valid = child->ReadVersion(child_version) && page->ValidateVersion(version);
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (!valid) {
+      buffer_pool_manager_->UnpinPage(child_id, false);
+      return nullptr;
+    }
+    page = child;
+    version = child_version;
+    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  }
+  return page;
+}
+
+template <typename Format>
+Page *SpecializedBPlusTree<Format>::FindLeafPage(const Key *key, bool write_leaf, bool rightmost) {
+  //先尝试乐观下降，给叶子加锁后确认它在记录版本之后没有被写过
+  for (int attempt = 0; attempt < OPTIMISTIC_READ_RETRIES && !IsEmpty(); attempt++) {
+    uint64_t version;
+    Page *page = FindLeafPageOptimistic(key, rightmost, version);
+    if (page == nullptr)
+      continue;
+    bool valid;
+    if (write_leaf) {
+      page->WLatch();
+      valid = page->ValidateVersion(version + 1);
+      if (!valid)
+        page->WUnlatch();
+    } else {
+      page->RLatch();
+      valid = page->ValidateVersion(version);
+      if (!valid)
+        page->RUnlatch();
+    }
+    if (valid)
+      return page;
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+
+  //与写线程冲突太多次时退回到锁耦合
+  //持有root_latch_直到根页加锁，期间根不会改变
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  //页面类型在页面属于这棵树期间不会改变，可以在加锁前读取
+  bool write = write_leaf && node->IsLeafPage();
+  write ? page->WLatch() : page->RLatch();
+  root_latch_.RUnlock();
+  //锁耦合：先锁住子结点再释放父结点
+  while (!node->IsLeafPage()) {
+    page_id_t child_id = ChildToFollow(reinterpret_cast<InternalPage *>(node), key, rightmost);
+    Page *child = buffer_pool_manager_->FetchPage(child_id);
+    node = reinterpret_cast<BPlusTreePage *>(child->GetData());
+    write = write_leaf && node->IsLeafPage();
+    write ? child->WLatch() : child->RLatch();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child;
+  }
+  return page;
+}
+
+template <typename Format>
+bool SpecializedBPlusTree<Format>::GetValue(const Key &key, std::vector<RowId> &result,
+                                            [[maybe_unused]] Transaction *transaction) {
+  //不给叶子加锁直接读取，读完验证版本，期间被修改过就重试
+  for (int attempt = 0; attempt < OPTIMISTIC_READ_RETRIES && !IsEmpty(); attempt++) {
+    uint64_t version;
+    Page *page = FindLeafPageOptimistic(&key, false, version);
+    if (page == nullptr)
+      continue;
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    int index = leaf->KeyIndex(key);
+    bool found = index < leaf->GetSize() && leaf->CompareAt(index, key) == 0;
+    RowId value = found ? leaf->ValueAt(index) : RowId();
+    bool valid = page->ValidateVersion(version);
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    //倒排列表页只能在叶子加锁时读取
+    if (valid && found && PostingList::IsList(value))
+      break;
+    if (valid) {
+      if (found)
+        result.push_back(value);
+      return found;
+    }
+  }
+  Page *page = FindLeafPage(&key);
+  if (page == nullptr)
+    return false;
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index = leaf->KeyIndex(key);
+  bool found = index < leaf->GetSize() && leaf->CompareAt(index, key) == 0;
+  if (found)
+    PostingList::Read(buffer_pool_manager_, leaf->ValueAt(index), result);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return found;
+}
+
+//按键的顺序查找，读锁一直留在当前叶子上：叶子加读锁期间它的键范围不会改变，
+//不小于上一个键、又不大于叶子最后一个键的键一定也在这个叶子里，不需要重新下降。
+//超出当前叶子的键先沿链表看下一个叶子，和写线程一样从左到右加锁；连下一个叶子也超出时才重新下降
+template <typename Format>
+size_t SpecializedBPlusTree<Format>::GetValues(const std::vector<Key> &keys, std::vector<std::vector<RowId>> &result,
+                                               [[maybe_unused]] Transaction *transaction) {
+  result.assign(keys.size(), {});
+  std::vector<size_t> order(keys.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&keys](size_t lhs, size_t rhs) { return keys[lhs] < keys[rhs]; });
+  auto beyond = [](LeafPage *leaf, const Key &key) {
+    return leaf->GetSize() == 0 || leaf->CompareAt(leaf->GetSize() - 1, key) < 0;
+  };
+  Page *page = nullptr;
+  LeafPage *leaf = nullptr;
+  size_t found = 0;
+  for (size_t i : order) {
+    if (page != nullptr && beyond(leaf, keys[i])) {
+      page_id_t next_page_id = leaf->GetNextPageId();
+      Page *next = next_page_id == INVALID_PAGE_ID ? nullptr : buffer_pool_manager_->FetchPage(next_page_id);
+      if (next != nullptr)
+        next->RLatch();
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      page = next;
+      if (page != nullptr) {
+        leaf = reinterpret_cast<LeafPage *>(page->GetData());
+        if (beyond(leaf, keys[i])) {
+          page->RUnlatch();
+          buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+          page = nullptr;
+        }
+      }
+    }
+    if (page == nullptr) {
+      page = FindLeafPage(&keys[i]);
+      if (page == nullptr)
+        break;
+      leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    }
+    int index = leaf->KeyIndex(keys[i]);
+    if (index < leaf->GetSize() && leaf->CompareAt(index, keys[i]) == 0) {
+      PostingList::Read(buffer_pool_manager_, leaf->ValueAt(index), result[i]);
+      found++;
+    }
+  }
+  if (page != nullptr) {
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+  return found;
+}
+
+//最小键在最左边的叶子，最大键在最右边的叶子，只需下降一次
+template <typename Format>
+bool SpecializedBPlusTree<Format>::GetExtreme(bool max, KeyBuf &key, std::vector<RowId> &result,
+                                              [[maybe_unused]] Transaction *transaction) {
+  Page *page = FindLeafPage(nullptr, false, max);
+  if (page == nullptr)
+    return false;
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  //没能合并掉的空叶子沿链表跳过；先钉住下一个叶子再释放当前叶子，任何时候只持有一个叶子的锁
+  while (leaf->GetSize() == 0) {
+    page_id_t next_page_id = max ? leaf->GetPrevPageId() : leaf->GetNextPageId();
+    Page *next = next_page_id == INVALID_PAGE_ID ? nullptr : buffer_pool_manager_->FetchPage(next_page_id);
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (next == nullptr)
+      return false;
+    page = next;
+    page->RLatch();
+    leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  }
+  int index = max ? leaf->GetSize() - 1 : 0;
+  key = leaf->KeyAt(index);
+  PostingList::Read(buffer_pool_manager_, leaf->ValueAt(index), result);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return true;
+}
+
+//只下降一次找到起点所在的叶子，沿链表扫描并在边界处停止的工作交给迭代器；
+//反向扫描从上界（没有上界时从最右边的叶子）开始向前扫描
+template <typename Format>
+typename SpecializedBPlusTree<Format>::RangeIterator SpecializedBPlusTree<Format>::BeginRange(
+    const Key *lower, bool lower_inclusive, const Key *upper, bool upper_inclusive, bool reverse) {
+  if (reverse) {
+    Page *page = FindLeafPage(upper, false, upper == nullptr);
+    int index = 0;
+    if (page != nullptr) {
+      auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+      index = leaf->GetSize();
+      if (upper != nullptr)
+        index = upper_inclusive ? leaf->UpperIndex(*upper) : leaf->KeyIndex(*upper);
+    }
+    //迭代器在释放锁之前读出这个叶子，写者可能移动index附近的键
+    return RangeIterator(page, index, lower, lower_inclusive, buffer_pool_manager_, true);
+  }
+  Page *page = FindLeafPage(lower);
+  int index = 0;
+  if (page != nullptr) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    if (lower != nullptr)
+      index = lower_inclusive ? leaf->KeyIndex(*lower) : leaf->UpperIndex(*lower);
+    //迭代器接管页面的pin，只在读取时给叶子加锁
+    page->RUnlatch();
+  }
+  return RangeIterator(page, index, upper, upper_inclusive, buffer_pool_manager_);
+}
+
+template <typename Format>
+void SpecializedBPlusTree<Format>::ScanRange(const Key *lower, bool lower_inclusive, const Key *upper,
+                                             bool upper_inclusive, std::vector<RowId> &result,
+                                             [[maybe_unused]] Transaction *transaction, bool reverse) {
+  RangeIterator iter = BeginRange(lower, lower_inclusive, upper, upper_inclusive, reverse);
+  std::vector<RowId> batch;
+  while (iter.NextBatch(batch))
+    result.insert(result.end(), batch.begin(), batch.end());
+}
+
+template <typename Format>
+int SpecializedBPlusTree<Format>::GetHeight() {
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return 0;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  page->RLatch();
+  root_latch_.RUnlock();
+  //沿最左边的路径数层数，树只在根上长高或变矮，各条路径一样长
+  int height = 1;
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  while (!node->IsLeafPage()) {
+    Page *child = buffer_pool_manager_->FetchPage(reinterpret_cast<InternalPage *>(node)->ValueAt(0));
+    child->RLatch();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child;
+    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    height++;
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return height;
+}
+
+/*****************************************************************************
+ * RANGE ITERATOR
+ *****************************************************************************/
+template <typename Format>
+SpecializedBPlusTree<Format>::RangeIterator::RangeIterator(Page *leaf, int index, const Key *bound,
+                                                           bool bound_inclusive, BufferPoolManager *bpm,
+                                                           bool reverse)
+    : frame_(leaf),
+      index_(index),
+      bound_(bound != nullptr ? KeyBuf(*bound) : KeyBuf()),
+      has_bound_(bound != nullptr),
+      bound_inclusive_(bound_inclusive),
+      reverse_(reverse),
+      buffer_pool_manager_(bpm) {
+  //在写者移动起点附近的键之前读出第一个叶子
+  if (reverse_ && frame_ != nullptr)
+    ReadLeaf(first_batch_);
+}
+
+template <typename Format>
+SpecializedBPlusTree<Format>::RangeIterator::RangeIterator(RangeIterator &&other) noexcept
+    : frame_(other.frame_),
+      index_(other.index_),
+      bound_(std::move(other.bound_)),
+      has_bound_(other.has_bound_),
+      bound_inclusive_(other.bound_inclusive_),
+      reverse_(other.reverse_),
+      resume_(std::move(other.resume_)),
+      has_resume_(other.has_resume_),
+      left_page_id_(other.left_page_id_),
+      first_batch_(std::move(other.first_batch_)),
+      buffer_pool_manager_(other.buffer_pool_manager_) {
+  other.frame_ = nullptr;
+}
+
+template <typename Format>
+SpecializedBPlusTree<Format>::RangeIterator::~RangeIterator() {
+  if (frame_ != nullptr)
+    buffer_pool_manager_->UnpinPage(frame_->GetPageId(), false);
+}
+
+template <typename Format>
+bool SpecializedBPlusTree<Format>::RangeIterator::NextBatch(std::vector<RowId> &row_ids) {
+  row_ids.clear();
+  row_ids.swap(first_batch_);
+  //被合并清空的叶子或者起点越过了第一个叶子的末尾时没有结果，继续下一个叶子
+  while (frame_ != nullptr && row_ids.empty()) {
+    frame_->RLatch();
+    ReadLeaf(row_ids);
+  }
+  return !row_ids.empty();
+}
+
+template <typename Format>
+void SpecializedBPlusTree<Format>::RangeIterator::ReadLeaf(std::vector<RowId> &row_ids) {
+  if (reverse_ && left_page_id_ != INVALID_PAGE_ID && has_resume_)
+    FollowSplit();
+  auto *leaf = reinterpret_cast<LeafPage *>(frame_->GetData());
+  bool last;
+  page_id_t next_page_id;
+  if (!reverse_) {
+    int end = UpperIndex(leaf, last);
+    for (; index_ < end; index_++)
+      PostingList::Read(buffer_pool_manager_, leaf->ValueAt(index_), row_ids);
+    next_page_id = last ? INVALID_PAGE_ID : leaf->GetNextPageId();
+  } else {
+    int begin = LowerIndex(leaf, last);
+    //上一个叶子被合并到这个叶子时它的键已经返回过，从返回过的最小键之前开始
+    int end = std::min(index_, leaf->GetSize());
+    if (has_resume_)
+      end = std::min(end, leaf->KeyIndex(resume_));
+    for (index_ = end - 1; index_ >= begin; index_--) {
+      size_t first = row_ids.size();
+      PostingList::Read(buffer_pool_manager_, leaf->ValueAt(index_), row_ids);
+      std::reverse(row_ids.begin() + first, row_ids.end());
+    }
+    //从返回过的最小键之前继续；第一个叶子里没有上界以下的键时从上界之前继续
+    int below = begin < end ? begin : end;
+    if (below < leaf->GetSize() && (begin < end || !has_resume_)) {
+      resume_ = leaf->KeyAt(below);
+      has_resume_ = true;
+    }
+    next_page_id = last ? INVALID_PAGE_ID : leaf->GetPrevPageId();
+  }
+  //先钉住下一个叶子再释放当前叶子，使它在这之间不会被合并掉
+  Page *next = next_page_id == INVALID_PAGE_ID ? nullptr : buffer_pool_manager_->FetchPage(next_page_id);
+  left_page_id_ = frame_->GetPageId();
+  frame_->RUnlatch();
+  buffer_pool_manager_->UnpinPage(left_page_id_, false);
+  frame_ = next;
+  //反向扫描从前一个叶子的末尾开始
+  index_ = reverse_ ? INT_MAX : 0;
+}
+
+template <typename Format>
+void SpecializedBPlusTree<Format>::RangeIterator::FollowSplit() {
+  auto *leaf = reinterpret_cast<LeafPage *>(frame_->GetData());
+  page_id_t stop_page_id = left_page_id_;
+  //前一个叶子在读取它的链接之后分裂时，分裂点之后的键移到了它和刚离开的叶子之间的新叶子里
+  while (leaf->GetNextPageId() != stop_page_id && leaf->GetNextPageId() != INVALID_PAGE_ID) {
+    page_id_t next_page_id = leaf->GetNextPageId();
+    //合并叶子的写者向左加锁，所以不能持有当前叶子的锁等待下一个叶子
+    Page *next = buffer_pool_manager_->FetchPage(next_page_id);
+    frame_->RUnlatch();
+    next->RLatch();
+    auto *next_leaf = reinterpret_cast<LeafPage *>(next->GetData());
+    //从返回过的最小键开始的叶子里没有还要返回的键，回到当前叶子，它可能又分裂了
+    if (next_leaf->GetSize() == 0 || next_leaf->CompareAt(0, resume_) >= 0) {
+      next->RUnlatch();
+      buffer_pool_manager_->UnpinPage(next_page_id, false);
+      frame_->RLatch();
+      stop_page_id = next_page_id;
+      continue;
+    }
+    buffer_pool_manager_->UnpinPage(frame_->GetPageId(), false);
+    frame_ = next;
+    leaf = next_leaf;
+  }
+}
+
+template <typename Format>
+int SpecializedBPlusTree<Format>::RangeIterator::UpperIndex(LeafPage *leaf, bool &last) const {
+  int size = leaf->GetSize();
+  last = false;
+  if (!has_bound_ || size == 0)
+    return size;
+  //长扫描中的大多数叶子整个都在边界以下，比较一次最后一个键就能确定
+  if (leaf->CompareAt(size - 1, bound_) < 0)
+    return size;
+  //叶子到达了边界，后面的叶子里没有范围内的键
+  last = true;
+  return bound_inclusive_ ? leaf->UpperIndex(bound_) : leaf->KeyIndex(bound_);
+}
+
+template <typename Format>
+int SpecializedBPlusTree<Format>::RangeIterator::LowerIndex(LeafPage *leaf, bool &last) const {
+  int size = leaf->GetSize();
+  last = false;
+  if (!has_bound_ || size == 0)
+    return 0;
+  if (leaf->CompareAt(0, bound_) > 0)
+    return 0;
+  last = true;
+  return bound_inclusive_ ? leaf->KeyIndex(bound_) : leaf->UpperIndex(bound_);
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+template <typename Format>
+void SpecializedBPlusTree<Format>::StartNewTree(const Key &key, const RowId &value) {
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(page_id);
+  ASSERT(page != nullptr, "out of memory");
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  leaf->Init(page_id);
+  leaf->InsertAt(0, key, value);
+  root_page_id_ = page_id;
+  UpdateRootPageId();
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
+
+template <typename Format>
+bool SpecializedBPlusTree<Format>::InsertIntoPostingList(LeafPage *leaf, int index, const RowId &value) {
+  if (unique_)
+    return false;
+  //列表页受叶子的写锁保护，RowId改变后写回叶子
+  RowId slot_value = leaf->ValueAt(index);
+  if (!PostingList::Insert(buffer_pool_manager_, slot_value, value))
+    return false;
+  leaf->SetValueAt(index, slot_value);
+  return true;
+}
+
+template <typename Format>
+bool SpecializedBPlusTree<Format>::Insert(const Key &key, const RowId &value,
+                                          [[maybe_unused]] Transaction *transaction) {
+  ASSERT(LeafPage::KeySize(key) <= MAX_KEY_SIZE, "Key exceeds the max key size.");
+  //乐观插入：只对叶子加写锁，叶子放得下时直接插入
+  Page *page = FindLeafPage(&key, true);
+  if (page != nullptr) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    int index = leaf->KeyIndex(key);
+    bool exists = index < leaf->GetSize() && leaf->CompareAt(index, key) == 0;
+    bool inserted = exists ? InsertIntoPostingList(leaf, index, value) : leaf->InsertAt(index, key, value);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), inserted);
+    if (exists || inserted)
+      return inserted;
+  }
+
+  //悲观插入：从根开始加写锁，遇到插入任何键都不会分裂的结点时释放它上面的所有结点
+  root_latch_.WLock();
+  bool root_locked = true;
+  if (IsEmpty()) {
+    StartNewTree(key, value);
+    root_latch_.WUnlock();
+    return true;
+  }
+  Page *path[MAX_HEIGHT];
+  int depth = 0;
+  page_id_t page_id = root_page_id_;
+  while (true) {
+    page = buffer_pool_manager_->FetchPage(page_id);
+    page->WLatch();
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    bool safe = node->IsLeafPage() ? reinterpret_cast<LeafPage *>(node)->IsInsertSafe()
+                                   : reinterpret_cast<InternalPage *>(node)->IsInsertSafe();
+    if (safe) {
+      if (root_locked) {
+        root_latch_.WUnlock();
+        root_locked = false;
+      }
+      for (int i = 0; i < depth; i++) {
+        path[i]->WUnlatch();
+        buffer_pool_manager_->UnpinPage(path[i]->GetPageId(), false);
+      }
+      depth = 0;
+    }
+    if (node->IsLeafPage())
+      break;
+    ASSERT(depth < MAX_HEIGHT, "B+ tree is too high.");
+    path[depth++] = page;
+    page_id = ChildToFollow(reinterpret_cast<InternalPage *>(node), &key, false);
+  }
+
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index = leaf->KeyIndex(key);
+  bool inserted;
+  if (index < leaf->GetSize() && leaf->CompareAt(index, key) == 0) {
+    inserted = InsertIntoPostingList(leaf, index, value);
+  } else {
+    inserted = true;
+    if (!leaf->InsertAt(index, key, value))
+      SplitLeaf(page, index, key, value, path, depth);
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), inserted);
+  for (int i = 0; i < depth; i++) {
+    path[i]->WUnlatch();
+    buffer_pool_manager_->UnpinPage(path[i]->GetPageId(), true);
+  }
+  if (root_locked)
+    root_latch_.WUnlock();
+  return inserted;
+}
+
+template <typename Format>
+void SpecializedBPlusTree<Format>::SplitLeaf(Page *page, int index, const Key &key, const RowId &value, Page **path,
+                                             int depth) {
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  page_id_t new_page_id;
+  Page *new_page = buffer_pool_manager_->NewPage(new_page_id);
+  ASSERT(new_page != nullptr, "out of memory");
+  auto *new_leaf = reinterpret_cast<LeafPage *>(new_page->GetData());
+  new_leaf->Init(new_page_id);
+  KeyBuf separator = leaf->InsertAndSplit(index, key, value, new_leaf);
+  //新叶子写好之后才挂到链表上，在父结点链接它之前其他线程只能沿链表读到它
+  new_leaf->SetNextPageId(leaf->GetNextPageId());
+  new_leaf->SetPrevPageId(page->GetPageId());
+  leaf->SetNextPageId(new_page_id);
+  LinkBackFromNext(new_leaf);
+  InsertIntoParent(page->GetPageId(), std::move(separator), new_page_id, path, depth);
+  buffer_pool_manager_->UnpinPage(new_page_id, true);
+}
+
+//只向右给相邻的叶子加锁，不会与其他写线程形成环
+template <typename Format>
+void SpecializedBPlusTree<Format>::LinkBackFromNext(LeafPage *leaf) {
+  page_id_t next_page_id = leaf->GetNextPageId();
+  if (next_page_id == INVALID_PAGE_ID)
+    return;
+  Page *next = buffer_pool_manager_->FetchPage(next_page_id);
+  next->WLatch();
+  reinterpret_cast<LeafPage *>(next->GetData())->SetPrevPageId(leaf->GetPageId());
+  next->WUnlatch();
+  buffer_pool_manager_->UnpinPage(next_page_id, true);
+}
+
+template <typename Format>
+void SpecializedBPlusTree<Format>::InsertIntoParent(page_id_t left_id, KeyBuf key, page_id_t right_id, Page **path,
+                                                    int depth) {
+  //分裂向上传播，直到某个父结点放得下分隔键或者生成新的根
+  while (depth > 0) {
+    auto *parent = reinterpret_cast<InternalPage *>(path[--depth]->GetData());
+    int index = parent->UpperIndex(key);
+    if (parent->InsertAt(index, key, right_id))
+      return;
+    page_id_t new_page_id;
+    Page *new_page = buffer_pool_manager_->NewPage(new_page_id);
+    ASSERT(new_page != nullptr, "out of memory");
+    auto *new_internal = reinterpret_cast<InternalPage *>(new_page->GetData());
+    new_internal->Init(new_page_id);
+    //分裂点上的键移到上一层
+    KeyBuf separator = parent->InsertAndSplit(index, key, right_id, new_internal);
+    buffer_pool_manager_->UnpinPage(new_page_id, true);
+    left_id = parent->GetPageId();
+    right_id = new_page_id;
+    key = std::move(separator);
+  }
+  //所有祖先都已满时root_latch_仍被持有，可以更换根
+  page_id_t root_id;
+  Page *page = buffer_pool_manager_->NewPage(root_id);
+  ASSERT(page != nullptr, "out of memory");
+  auto *root = reinterpret_cast<InternalPage *>(page->GetData());
+  root->Init(root_id);
+  root->PopulateNewRoot(left_id, key, right_id);
+  root_page_id_ = root_id;
+  UpdateRootPageId();
+  buffer_pool_manager_->UnpinPage(root_id, true);
+}
+
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+//自底向上构建：每一层只保留最右边的页面，装到填充率后新开一页，并把装满的页面追加到上一层
+//叶子之间的分隔键由页面决定（变长键做后缀截断）；非唯一树收集最后一个键的RowId，下一个键到来时存为它的倒排列表
+//每层最后一页可能不足，之后的删除会合并它；构建期间持有root_latch_，写线程会等待构建完成
+template <typename Format>
+bool SpecializedBPlusTree<Format>::BulkLoad(const std::function<bool(Key &key, RowId &value)> &next,
+                                            double fill_factor) {
+  root_latch_.WLock();
+  if (!IsEmpty()) {
+    root_latch_.WUnlock();
+    return false;
+  }
+  std::vector<BulkLoadLevel> levels;
+  LeafPage *leaf = nullptr;
+  std::vector<RowId> postings;
+  auto flush_postings = [&]() {
+    if (postings.size() > 1)
+      leaf->SetValueAt(leaf->GetSize() - 1, PostingList::Create(buffer_pool_manager_, postings));
+    postings.clear();
+  };
+  Key key{};
+  RowId value;
+  while (next(key, value)) {
+    ASSERT(LeafPage::KeySize(key) <= MAX_KEY_SIZE, "Key exceeds the max key size.");
+    //输入按键有序，与前一个键相等的重复键被跳过或者加入倒排列表
+    if (leaf != nullptr && leaf->CompareAt(leaf->GetSize() - 1, key) == 0) {
+      if (!unique_)
+        postings.push_back(value);
+      continue;
+    }
+    flush_postings();
+    postings.push_back(value);
+    bool appended = leaf != nullptr && !leaf->IsFilled(fill_factor) && leaf->InsertAt(leaf->GetSize(), key, value);
+    if (!appended) {
+      KeyBuf low = leaf == nullptr ? KeyBuf() : LeafPage::Separator(leaf->KeyAt(leaf->GetSize() - 1), key);
+      leaf = reinterpret_cast<LeafPage *>(BulkLoadNextPage(levels, 0, low, fill_factor)->GetData());
+      leaf->InsertAt(0, key, value);
+    }
+  }
+  if (!levels.empty()) {
+    flush_postings();
+    //自下而上把每层的最后一页追加到上一层，最高一层只有一个页面，它就是根
+    for (size_t level = 0; level + 1 < levels.size(); level++) {
+      BulkLoadAppend(levels, level + 1, levels[level].low_, levels[level].page_->GetPageId(), fill_factor);
+      buffer_pool_manager_->UnpinPage(levels[level].page_->GetPageId(), true);
+    }
+    root_page_id_ = levels.back().page_->GetPageId();
+    buffer_pool_manager_->UnpinPage(root_page_id_, true);
+    UpdateRootPageId();
+  }
+  root_latch_.WUnlock();
+  return true;
+}
+
+template <typename Format>
+Page *SpecializedBPlusTree<Format>::BulkLoadNextPage(std::vector<BulkLoadLevel> &levels, size_t level,
+                                                     const KeyBuf &low, double fill_factor) {
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(page_id);
+  ASSERT(page != nullptr, "out of memory");
+  if (level == 0) {
+    reinterpret_cast<LeafPage *>(page->GetData())->Init(page_id);
+  } else {
+    reinterpret_cast<InternalPage *>(page->GetData())->Init(page_id);
+  }
+  if (levels.size() == level) {
+    levels.push_back({page, low});
+    return page;
+  }
+  //装满的页面追加到上一层后就不会再被修改
+  Page *full = levels[level].page_;
+  if (level == 0) {
+    reinterpret_cast<LeafPage *>(full->GetData())->SetNextPageId(page_id);
+    reinterpret_cast<LeafPage *>(page->GetData())->SetPrevPageId(full->GetPageId());
+  }
+  BulkLoadAppend(levels, level + 1, levels[level].low_, full->GetPageId(), fill_factor);
+  buffer_pool_manager_->UnpinPage(full->GetPageId(), true);
+  levels[level] = {page, low};
+  return page;
+}
+
+//子树的分隔键插入父结点；新开的内部页面不使用第一个键，它的分隔键记在low_中
+template <typename Format>
+void SpecializedBPlusTree<Format>::BulkLoadAppend(std::vector<BulkLoadLevel> &levels, size_t level, KeyBuf low,
+                                                  page_id_t child, double fill_factor) {
+  InternalPage *parent = nullptr;
+  if (level < levels.size())
+    parent = reinterpret_cast<InternalPage *>(levels[level].page_->GetData());
+  bool appended =
+      parent != nullptr && !parent->IsFilled(fill_factor) && parent->InsertAt(parent->GetSize(), low, child);
+  if (!appended) {
+    parent = reinterpret_cast<InternalPage *>(BulkLoadNextPage(levels, level, low, fill_factor)->GetData());
+    parent->InsertAt(0, low, child);
+  }
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+template <typename Format>
+bool SpecializedBPlusTree<Format>::Remove(const Key &key, [[maybe_unused]] Transaction *transaction) {
+  return RemoveEntry(key, nullptr);
+}
+
+template <typename Format>
+bool SpecializedBPlusTree<Format>::Remove(const Key &key, const RowId &value,
+                                          [[maybe_unused]] Transaction *transaction) {
+  return RemoveEntry(key, &value);
+}
+
+template <typename Format>
+bool SpecializedBPlusTree<Format>::RemoveEntry(const Key &key, const RowId *value) {
+  //先只对叶子加写锁删除，叶子因此不足时再从根开始合并
+  Page *page = FindLeafPage(&key, true);
+  if (page == nullptr)
+    return false;
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index = leaf->KeyIndex(key);
+  bool removed = false;
+  if (index < leaf->GetSize() && leaf->CompareAt(index, key) == 0) {
+    RowId slot_value = leaf->ValueAt(index);
+    if (value != nullptr && PostingList::IsList(slot_value)) {
+      //列表中删掉一个RowId后至少还剩一个，键保留
+      removed = PostingList::Remove(buffer_pool_manager_, slot_value, *value);
+      if (removed)
+        leaf->SetValueAt(index, slot_value);
+    } else if (value == nullptr || slot_value == *value) {
+      PostingList::Destroy(buffer_pool_manager_, slot_value);
+      leaf->RemoveAt(index);
+      removed = true;
+    }
+  }
+  //根叶子只在删空时需要处理，其他叶子不足时与兄弟合并
+  bool underfull = removed && (page->GetPageId() == root_page_id_ ? leaf->GetSize() == 0 : leaf->IsUnderfull());
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), removed);
+  if (underfull)
+    Rebalance(key);
+  return removed;
+}
+
+//从根开始加写锁下降，遇到删掉一个子结点也不会不足的结点时释放它上面的所有结点，
+//再自下而上把不足的结点与同一父结点下的兄弟合并，放不进一个页面时停止，不在兄弟之间移动键
+template <typename Format>
+void SpecializedBPlusTree<Format>::Rebalance(const Key &key) {
+  root_latch_.WLock();
+  bool root_locked = true;
+  if (IsEmpty()) {
+    root_latch_.WUnlock();
+    return;
+  }
+  Page *path[MAX_HEIGHT];
+  //path[i]在path[i - 1]中的下标
+  int child_index[MAX_HEIGHT];
+  int depth = 0;
+  int index = 0;
+  page_id_t page_id = root_page_id_;
+  while (true) {
+    ASSERT(depth < MAX_HEIGHT, "B+ tree is too high.");
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    page->WLatch();
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    //根叶子删空或者根只剩一个子结点时才需要更换根
+    bool is_root = root_locked && depth == 0;
+    bool safe;
+    if (node->IsLeafPage()) {
+      auto *leaf = reinterpret_cast<LeafPage *>(node);
+      safe = is_root ? leaf->GetSize() > 0 : !leaf->IsUnderfull();
+    } else {
+      auto *internal = reinterpret_cast<InternalPage *>(node);
+      safe = is_root ? internal->GetSize() > 2 : internal->IsRemoveSafe();
+    }
+    if (safe) {
+      if (root_locked) {
+        root_latch_.WUnlock();
+        root_locked = false;
+      }
+      for (int i = 0; i < depth; i++) {
+        path[i]->WUnlatch();
+        buffer_pool_manager_->UnpinPage(path[i]->GetPageId(), false);
+      }
+      depth = 0;
+    }
+    path[depth] = page;
+    child_index[depth++] = index;
+    if (node->IsLeafPage())
+      break;
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    index = internal->UpperIndex(key) - 1;
+    page_id = internal->ValueAt(index);
+  }
+
+  std::vector<page_id_t> deleted_pages;
+  for (int level = depth - 1; level > 0; level--) {
+    auto *node = reinterpret_cast<BPlusTreePage *>(path[level]->GetData());
+    auto *parent = reinterpret_cast<InternalPage *>(path[level - 1]->GetData());
+    bool underfull = node->IsLeafPage() ? reinterpret_cast<LeafPage *>(node)->IsUnderfull()
+                                        : reinterpret_cast<InternalPage *>(node)->IsUnderfull();
+    if (!underfull || parent->GetSize() < 2)
+      break;
+    //与左边的兄弟合并，第一个子结点与右边的兄弟合并；持有父结点时才向左给兄弟加锁
+    index = child_index[level];
+    int right_index = index == 0 ? 1 : index;
+    Page *sibling = buffer_pool_manager_->FetchPage(parent->ValueAt(index == 0 ? 1 : index - 1));
+    sibling->WLatch();
+    Page *left = index == 0 ? path[level] : sibling;
+    Page *right = index == 0 ? sibling : path[level];
+    bool merged;
+    if (node->IsLeafPage()) {
+      auto *left_leaf = reinterpret_cast<LeafPage *>(left->GetData());
+      merged = left_leaf->MergeFrom(reinterpret_cast<LeafPage *>(right->GetData()));
+      if (merged)
+        LinkBackFromNext(left_leaf);
+    } else {
+      merged = reinterpret_cast<InternalPage *>(left->GetData())
+                   ->MergeFrom(reinterpret_cast<InternalPage *>(right->GetData()), parent->KeyAt(right_index));
+    }
+    if (merged) {
+      parent->RemoveAt(right_index);
+      deleted_pages.push_back(right->GetPageId());
+    }
+    sibling->WUnlatch();
+    buffer_pool_manager_->UnpinPage(sibling->GetPageId(), merged);
+    if (!merged)
+      break;
+  }
+
+  if (root_locked) {
+    auto *root = reinterpret_cast<BPlusTreePage *>(path[0]->GetData());
+    if (root->IsLeafPage() && root->GetSize() == 0) {
+      //根叶子删空，树变成空树
+      deleted_pages.push_back(root_page_id_);
+      root_page_id_ = INVALID_PAGE_ID;
+      UpdateRootPageId();
+    } else if (!root->IsLeafPage() && root->GetSize() == 1) {
+      //根只剩一个子结点时由它作为新的根，树变矮
+      deleted_pages.push_back(root_page_id_);
+      root_page_id_ = reinterpret_cast<InternalPage *>(root)->ValueAt(0);
+      UpdateRootPageId();
+    }
+  }
+  for (int i = 0; i < depth; i++) {
+    path[i]->WUnlatch();
+    buffer_pool_manager_->UnpinPage(path[i]->GetPageId(), true);
+  }
+  if (root_locked)
+    root_latch_.WUnlock();
+  //仍被读者钉住的页面由page_reclaimer_留到以后再删除
+  page_reclaimer_.Reclaim(deleted_pages);
+}
+
+/*****************************************************************************
+ * DESTROY
+ *****************************************************************************/
+template <typename Format>
+void SpecializedBPlusTree<Format>::DestroyPage(page_id_t page_id) {
+  auto *node = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+  if (node->IsLeafPage()) {
+    auto *leaf = reinterpret_cast<LeafPage *>(node);
+    for (int i = 0; i < leaf->GetSize(); ++i)
+      PostingList::Destroy(buffer_pool_manager_, leaf->ValueAt(i));
+  } else {
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    for (int i = 0; i < internal->GetSize(); ++i)
+      DestroyPage(internal->ValueAt(i));
+  }
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  buffer_pool_manager_->DeletePage(page_id);
+}
+
+template <typename Format>
+void SpecializedBPlusTree<Format>::Destroy() {
+  page_reclaimer_.Reclaim({});
+  if (IsEmpty())
+    return;
+  DestroyPage(root_page_id_);
+  root_page_id_ = INVALID_PAGE_ID;
+  UpdateRootPageId();
+}
+
+template <typename Format>
+bool SpecializedBPlusTree<Format>::Check() {
+  bool all_unpinned = buffer_pool_manager_->CheckAllUnpinned();
+  if (!all_unpinned) {
+    LOG(ERROR) << "problem in page unpin" << std::endl;
+  }
+  return all_unpinned;
+}
+
+template class SpecializedBPlusTree<FixedKeyFormat<int32_t>>;
+
+template class SpecializedBPlusTree<FixedKeyFormat<float>>;
+
+template class SpecializedBPlusTree<SlottedKeyFormat>;
@@ -80,16 +80,24 @@ void InternalPage::PairMove(void *dest, void *src, int pair_num) {
  * Find and return the child pointer(page_id) which points to the child page
  * that contains input "key"
  * Start the search from the second key(the first key should always be invalid)
- * 用了二分查找
  */
 page_id_t InternalPage::Lookup(const GenericKey *key, const KeyManager &KM) {
+  int index = LookupIndex(key, KM);
+  return index < 0 ? INVALID_PAGE_ID : ValueAt(index);
+}
+
+/*
+ * 返回包含key的子结点在本页中的下标，页中不足两个子结点时返回-1
+ * 用了二分查找
+ */
+int InternalPage::LookupIndex(const GenericKey *key, const KeyManager &KM) {
   int size = GetSize();
   if (size < 2) {
-    return INVALID_PAGE_ID;
+    return -1;
   }
 
   if (KM.CompareKeys(key, KeyAt(1)) < 0) {
-    return ValueAt(0);
+    return 0;
   }
 
   // binary search, [l, r)
@@ -104,7 +112,7 @@ page_id_t InternalPage::Lookup(const GenericKey *key, const KeyManager &KM) {
   }
 
   // key[l] < key, Key[l + 1] == Key[r] >= key
-  return ValueAt(l);
+  return l;
 }
 
 /*****************************************************************************
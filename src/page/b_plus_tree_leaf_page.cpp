@@ -25,7 +25,6 @@
  * Init method after creating a new leaf page
  * Including set page type, set current size to zero, set page id/parent id, set
  * next page id and set max size
- * 未初始化next_page_id
  */
 void LeafPage::Init(page_id_t page_id, page_id_t parent_id, int key_size, int max_size) {
   /* set meta data */
@@ -36,6 +35,7 @@ void LeafPage::Init(page_id_t page_id, page_id_t parent_id, int key_size, int ma
   SetKeySize(key_size);
   SetMaxSize(max_size);
   SetNextPageId(INVALID_PAGE_ID);
+  SetPrevPageId(INVALID_PAGE_ID);
 }
 
 /**
@@ -52,6 +52,17 @@ void LeafPage::SetNextPageId(page_id_t next_page_id) {
   }
 }
 
+/**
+ * 前一个叶子结点的页号，与next_page_id一起组成双向链表，用于反向扫描
+ */
+page_id_t LeafPage::GetPrevPageId() const {
+  return prev_page_id_;
+}
+
+void LeafPage::SetPrevPageId(page_id_t prev_page_id) {
+  prev_page_id_ = prev_page_id;
+}
+
 /**
  * DONE: Student Implement
  */
@@ -61,7 +72,7 @@ void LeafPage::SetNextPageId(page_id_t next_page_id) {
  * 二分查找
  */
 int LeafPage::KeyIndex(const GenericKey *key, const KeyManager &KM) {
-  if (!KM.CompareKeys(key, KeyAt(0)) > 0) {
+  if (GetSize() == 0 || KM.CompareKeys(key, KeyAt(0)) <= 0) {
     /* key <= A[0] */
     return 0;
   }
@@ -136,16 +147,9 @@ int LeafPage::Insert(GenericKey *key, const RowId &value, const KeyManager &KM)
   /* Maybe we can use ASSERT(size <= GetMaxSize()) for 'TEMPORARY OVERFLOW' */
   ASSERT(size <= GetMaxSize(), "LeafPage is full, cannot Insert.");
 
-  // Linear scan: O(N)
-  int idx = 0;
-  for (; idx < size; ++idx) {
-    int res = KM.CompareKeys(key, KeyAt(idx));
-    ASSERT(res != 0, "Duplicated keys.");
-    if (res < 0) {
-      /* key > KeyAt(ind - 1) && key < KeyAt(ind) */
-      break;
-    }
-  }
+  // Binary search: O(logN), key > KeyAt(idx - 1) && key < KeyAt(idx)
+  int idx = KeyIndex(key, KM);
+  ASSERT(idx == size || KM.CompareKeys(key, KeyAt(idx)) != 0, "Duplicated keys.");
 
   // Move and insert: O(N)
   if (idx < size) {
@@ -198,13 +202,11 @@ void LeafPage::CopyNFrom(void *src, int size) {
  * If the key does not exist, then return false
  */
 bool LeafPage::Lookup(const GenericKey *key, RowId &value, const KeyManager &KM) {
-  int size = GetSize();
-  /* Linear scan: O(N) */
-  for (int i = 0; i < size; ++i) {
-    if (KM.CompareKeys(key, KeyAt(i)) == 0) {
-      value = ValueAt(i);
-      return true;
-    }
+  /* Binary search: O(logN) */
+  int i = KeyIndex(key, KM);
+  if (i < GetSize() && KM.CompareKeys(key, KeyAt(i)) == 0) {
+    value = ValueAt(i);
+    return true;
   }
   return false;
 }
@@ -219,15 +221,13 @@ bool LeafPage::Lookup(const GenericKey *key, RowId &value, const KeyManager &KM)
  * @return  page size after deletion
  */
 int LeafPage::RemoveAndDeleteRecord(const GenericKey *key, const KeyManager &KM) {
-  /* Find key to delete: O(N) */
+  /* Find key to delete: O(logN) */
   int size = GetSize();
   ASSERT(size > 0, "Conot delete key in an empty leaf.");
   
-  int index = 0;
-  for (; index < size; ++index) {
-    if (KM.CompareKeys(key, KeyAt(index)) == 0) {
-      break;
-    }
+  int index = KeyIndex(key, KM);
+  if (index < size && KM.CompareKeys(key, KeyAt(index)) != 0) {
+    index = size;
   }
 
   if (index == size) {
@@ -1,5 +1,7 @@
 #include "page/bitmap_page.h"
 
+#include <cstring>
+
 #include "glog/logging.h"
 
 /**
@@ -8,13 +10,15 @@
 //分配一个空闲页，并通过page_offset返回所分配的空闲页位于该段中的下标（从0开始）
 template <size_t PageSize>
 bool BitmapPage<PageSize>::AllocatePage(uint32_t &page_offset) {
-  //检查所请求的页面是否已经被分配，或者是否超出了最大允许的页面数量
-  if (allocate_pages.test(page_offset) || page_offset >= 8 * MAX_CHARS)
-    return false;    //如果已经超出了最大允许的页面数量，则无法分配该页面
-  else {
-    allocate_pages.set(page_offset, 1);
-    return true;    //将相应的位图位（page_offset）设置为1，表示该页已被分配
-  }
+  //从上次记录的空闲位置开始按字查找空闲页，找不到说明该段已满
+  uint32_t free_page = FindFreePage();
+  if (free_page >= GetMaxSupportedSize())
+    return false;
+  bytes[free_page / 8] |= static_cast<unsigned char>(1 << (free_page % 8));
+  page_allocated_++;
+  next_free_page_ = free_page;
+  page_offset = free_page;
+  return true;
 }
 
 /**
@@ -23,14 +27,12 @@ bool BitmapPage<PageSize>::AllocatePage(uint32_t &page_offset) {
 //回收已经被分配的页
 template <size_t PageSize>
 bool BitmapPage<PageSize>::DeAllocatePage(uint32_t page_offset) {
-  //检查要回收的页面是否已经分配
-  if (!allocate_pages.test(page_offset)) {
-    //如果页面没有被分配，则不能被回收
+  //检查要回收的页面是否已经分配，如果页面没有被分配，则不能被回收
+  if (page_offset >= GetMaxSupportedSize() || IsPageFree(page_offset))
     return false;
-  }
 
   //将相应的位图位设置为0，表示该页已经被回收
-  allocate_pages.set(page_offset, 0);
+  bytes[page_offset / 8] &= static_cast<unsigned char>(~(1 << (page_offset % 8)));
   next_free_page_ = page_offset;    //更新下一个可用页面索引
   page_allocated_--;    //将分配的页面数减少 1
   return true;    //此时已经成功回收该页面
@@ -42,12 +44,26 @@ bool BitmapPage<PageSize>::DeAllocatePage(uint32_t page_offset) {
 template <size_t PageSize>
 bool BitmapPage<PageSize>::IsPageFree(uint32_t page_offset) const {
   //如果相应的位图位为0，表示该页是空闲的，返回true；否则返回false
-  return !allocate_pages.test(page_offset);
+  return IsPageFreeLow(page_offset / 8, page_offset % 8);
 }
 
 template <size_t PageSize>
 bool BitmapPage<PageSize>::IsPageFreeLow(uint32_t byte_index, uint8_t bit_index) const {
-  return false;
+  return (bytes[byte_index] & (1 << bit_index)) == 0;
+}
+
+//每次比较64位，全为1的字直接跳过；找到含有0位的字后，用ctz求出其中最低的空闲位
+template <size_t PageSize>
+uint32_t BitmapPage<PageSize>::FindFreePage() const {
+  size_t start_word = (next_free_page_ / 64) % NUM_WORDS;
+  for (size_t i = 0; i < NUM_WORDS; i++) {
+    size_t word_index = (start_word + i) % NUM_WORDS;
+    uint64_t word;
+    memcpy(&word, bytes + word_index * sizeof(uint64_t), sizeof(uint64_t));
+    if (word != ~static_cast<uint64_t>(0))
+      return static_cast<uint32_t>(word_index * 64 + __builtin_ctzll(~word));
+  }
+  return GetMaxSupportedSize();
 }
 
 //实例化不同页面大小的BitmapPage类
@@ -163,6 +163,29 @@ bool TablePage::GetTuple(Row *row, Schema *schema, Transaction *txn, LockManager
   return true;
 }
 
+uint32_t TablePage::GetTuples(std::vector<Row> *rows, Schema *schema,
+                             const std::function<bool(const RowView &)> &filter, MemHeap *heap) {
+  uint32_t count = 0;
+  RowView view;
+  rows->reserve(rows->size() + GetTupleCount());
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    uint32_t tuple_size = GetTupleSize(i);
+    if (IsDeleted(tuple_size)) {
+      continue;
+    }
+    //先在页面数据上直接判断过滤条件，只有满足条件的元组才会被反序列化
+    view.Reset(GetData() + GetTupleOffsetAtSlot(i), schema, RowId(GetTablePageId(), i));
+    ASSERT(tuple_size == view.GetSerializedSize(), "Unexpected behavior in tuple view.");
+    if (filter != nullptr && !filter(view)) {
+      continue;
+    }
+    rows->emplace_back(view.GetRowId(), heap);
+    view.Materialize(&rows->back());
+    count++;
+  }
+  return count;
+}
+
 bool TablePage::GetFirstTupleRid(RowId *first_rid) {
   // Find and return the first valid tuple.
   for (uint32_t i = 0; i < GetTupleCount(); i++) {
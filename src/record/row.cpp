@@ -47,20 +47,39 @@ uint32_t Row::DeserializeFrom(char *buf, Schema *schema) {
   offset = ReadFromBuffer(buf, offset, fields_nums);
   offset = ReadFromBuffer(buf, offset, null_nums);
 
-  //构建null bitmap
-  std::vector<uint32_t> null_bitmap(fields_nums, 0);
-  for (uint32_t i = 0; i < null_nums; i++) {
-    uint32_t null_index;
-    offset = ReadFromBuffer(buf, offset, null_index);
-    null_bitmap[null_index] = 1;
-  }
+  //null字段的下标按升序排列在头部中，依次与字段下标比对即可
+  uint32_t null_offset = offset;
+  uint32_t null_read = 0;
+  offset += null_nums * sizeof(uint32_t);
 
-  //反序列化非null字段
+  //直接在heap_中构造字段，char字段的数据也复制到heap_中
+  fields_.reserve(fields_nums);
   for (uint32_t i = 0; i < fields_nums; i++) {
-    auto field = ALLOC_P(heap_, Field)(schema->GetColumn(i)->GetType());
-    fields_.push_back(field);
-    if (!null_bitmap[i]) {
-      offset += field->DeserializeFrom(buf + offset, schema->GetColumn(i)->GetType(), &fields_[i], false);
+    TypeId type = schema->GetColumn(i)->GetType();
+    if (null_read < null_nums && MACH_READ_UINT32(buf + null_offset + null_read * sizeof(uint32_t)) == i) {
+      null_read++;
+      fields_.push_back(ALLOC_P(heap_, Field)(type));
+      continue;
+    }
+    switch (type) {
+      case TypeId::kTypeInt:
+        fields_.push_back(ALLOC_P(heap_, Field)(type, MACH_READ_INT32(buf + offset)));
+        offset += sizeof(int32_t);
+        break;
+      case TypeId::kTypeFloat:
+        fields_.push_back(ALLOC_P(heap_, Field)(type, MACH_READ_FROM(float_t, buf + offset)));
+        offset += sizeof(float_t);
+        break;
+      case TypeId::kTypeChar: {
+        uint32_t len = MACH_READ_UINT32(buf + offset);
+        char *data = reinterpret_cast<char *>(heap_->Allocate(len));
+        memcpy(data, buf + offset + sizeof(uint32_t), len);
+        fields_.push_back(ALLOC_P(heap_, Field)(type, data, len, false));
+        offset += sizeof(uint32_t) + len;
+        break;
+      }
+      default:
+        ASSERT(false, "Unsupported field type.");
     }
   }
 
@@ -93,8 +112,7 @@ uint32_t Row::GetSerializedSize(Schema *schema) const {
 void Row::SetFields(const std::vector<Field>& fields) {
   fields_.clear();
   for (auto &field : fields) {
-    void *buf = heap_->Allocate(sizeof(Field));
-    fields_.push_back(new (buf) Field(field));
+    fields_.push_back(CopyField(field));
     if (field.IsNull())
       null_nums++;
   }
@@ -102,6 +120,18 @@ void Row::SetFields(const std::vector<Field>& fields) {
   fields_nums = fields.size();
 }
 
+//字段和char数据都复制到heap_中，复制出的字段不拥有数据，随heap_一起释放
+Field *Row::CopyField(const Field &field) {
+  void *buf = heap_->Allocate(sizeof(Field));
+  if (field.GetTypeId() == TypeId::kTypeChar && !field.IsNull()) {
+    uint32_t len = field.GetLength();
+    char *data = reinterpret_cast<char *>(heap_->Allocate(len));
+    memcpy(data, field.GetData(), len);
+    return new (buf) Field(TypeId::kTypeChar, data, len, false);
+  }
+  return new (buf) Field(field);
+}
+
 void Row::GetKeyFromRow(const Schema *schema, const Schema *key_schema, Row &key_row) {
   auto columns = key_schema->GetColumns();
   std::vector<Field> fields;
@@ -0,0 +1,78 @@
+#include "record/row_view.h"
+
+//解析行头部并计算每个字段在缓冲区中的偏移量，不复制任何字段数据
+void RowView::Reset(const char *buf, Schema *schema, RowId rid) {
+  ASSERT(schema != nullptr, "Invalid schema before view.");
+  buf_ = buf;
+  schema_ = schema;
+  rid_ = rid;
+
+  //读取字段数量和null字段数量，并标记null字段
+  uint32_t fields_nums = MACH_READ_UINT32(buf);
+  uint32_t null_nums = MACH_READ_UINT32(buf + sizeof(uint32_t));
+  ASSERT(fields_nums == schema->GetColumnCount(), "Fields size do not match schema's column size.");
+  offsets_.assign(fields_nums, 0);
+  uint32_t offset = 2 * sizeof(uint32_t);
+  for (uint32_t i = 0; i < null_nums; i++) {
+    offsets_[MACH_READ_UINT32(buf + offset)] = NULL_OFFSET;
+    offset += sizeof(uint32_t);
+  }
+
+  //依次定位非null字段，char字段前有4字节的长度
+  for (uint32_t i = 0; i < fields_nums; i++) {
+    if (offsets_[i] == NULL_OFFSET)
+      continue;
+    offsets_[i] = offset;
+    if (schema->GetColumn(i)->GetType() == TypeId::kTypeChar) {
+      offset += sizeof(uint32_t) + MACH_READ_UINT32(buf + offset);
+    } else {
+      offset += Type::GetTypeSize(schema->GetColumn(i)->GetType());
+    }
+  }
+  size_ = offset;
+}
+
+int32_t RowView::GetInt(uint32_t idx) const {
+  ASSERT(GetTypeId(idx) == TypeId::kTypeInt && !IsNull(idx), "Not a non-null int field.");
+  return MACH_READ_FROM(int32_t, buf_ + offsets_[idx]);
+}
+
+float RowView::GetFloat(uint32_t idx) const {
+  ASSERT(GetTypeId(idx) == TypeId::kTypeFloat && !IsNull(idx), "Not a non-null float field.");
+  return MACH_READ_FROM(float_t, buf_ + offsets_[idx]);
+}
+
+const char *RowView::GetChars(uint32_t idx, uint32_t *len) const {
+  ASSERT(GetTypeId(idx) == TypeId::kTypeChar && !IsNull(idx), "Not a non-null char field.");
+  *len = MACH_READ_UINT32(buf_ + offsets_[idx]);
+  return buf_ + offsets_[idx] + sizeof(uint32_t);
+}
+
+//char字段不拷贝数据，直接指向视图所在的缓冲区
+Field RowView::GetField(uint32_t idx) const {
+  TypeId type = GetTypeId(idx);
+  if (IsNull(idx)) {
+    return Field(type);
+  }
+  switch (type) {
+    case TypeId::kTypeInt:
+      return Field(type, GetInt(idx));
+    case TypeId::kTypeFloat:
+      return Field(type, GetFloat(idx));
+    case TypeId::kTypeChar: {
+      uint32_t len;
+      const char *data = GetChars(idx, &len);
+      return Field(type, const_cast<char *>(data), len, false);
+    }
+    default:
+      ASSERT(false, "Unsupported field type.");
+      return Field(type);
+  }
+}
+
+uint32_t RowView::Materialize(Row *row) const {
+  row->SetRowId(rid_);
+  uint32_t __attribute__((unused)) read_bytes = row->DeserializeFrom(const_cast<char *>(buf_), schema_);
+  ASSERT(read_bytes == size_, "Unexpected behavior in row materialize.");
+  return read_bytes;
+}
@@ -0,0 +1,356 @@
+#include "storage/async_io.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+#include "glog/logging.h"
+#include "storage/disk_manager.h"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>) && defined(__NR_io_uring_setup)
+#include <linux/io_uring.h>
+#define MINISQL_HAVE_IO_URING 1
+#endif
+
+/*****************************************************************************
+ * AsyncIoContext
+ *****************************************************************************/
+AsyncIoContext::AsyncIoContext(DiskManager *disk_manager, size_t queue_depth)
+    : disk_manager_(disk_manager), queue_depth_(queue_depth == 0 ? 1 : queue_depth) {}
+
+//读取超出文件末尾的页面不需要访问磁盘，直接以全零页面完成
+bool AsyncIoContext::PrepareRead(page_id_t logical_page_id, char *page_data, uint64_t tag) {
+  ASSERT(logical_page_id >= 0, "Invalid page id.");
+  if (Outstanding() >= queue_depth_)
+    return false;
+  page_id_t physical_page_id = disk_manager_->MapPageId(logical_page_id);
+  if (static_cast<size_t>(physical_page_id) * PAGE_SIZE >= disk_manager_->file_size_) {
+    memset(page_data, 0, PAGE_SIZE);
+    ready_.push_back({tag, true});
+    return true;
+  }
+  prepared_.push_back({false, physical_page_id, page_data, tag});
+  return true;
+}
+
+//写请求在准备时就更新缓存的文件大小，之后对该页的读请求不会被当作读取文件末尾之外的页面
+bool AsyncIoContext::PrepareWrite(page_id_t logical_page_id, const char *page_data, uint64_t tag) {
+  ASSERT(logical_page_id >= 0, "Invalid page id.");
+  if (Outstanding() >= queue_depth_)
+    return false;
+  page_id_t physical_page_id = disk_manager_->MapPageId(logical_page_id);
+  disk_manager_->ExtendFileSize(static_cast<size_t>(physical_page_id + 1) * PAGE_SIZE);
+  prepared_.push_back({true, physical_page_id, const_cast<char *>(page_data), tag});
+  return true;
+}
+
+size_t AsyncIoContext::TakeReady(vector<IoCompletion> &completions, size_t max_count) {
+  size_t taken = 0;
+  while (!ready_.empty() && taken < max_count) {
+    completions.push_back(ready_.front());
+    ready_.pop_front();
+    taken++;
+  }
+  return taken;
+}
+
+/*****************************************************************************
+ * IoUringContext
+ *****************************************************************************/
+#ifdef MINISQL_HAVE_IO_URING
+namespace {
+int IoUringSetup(unsigned entries, struct io_uring_params *params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int IoUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+inline unsigned LoadAcquire(unsigned *p) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+
+inline void StoreRelease(unsigned *p, unsigned v) { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+}  // namespace
+#endif
+
+IoUringContext::IoUringContext(DiskManager *disk_manager, size_t queue_depth)
+    : AsyncIoContext(disk_manager, queue_depth) {}
+
+unique_ptr<AsyncIoContext> IoUringContext::Create(DiskManager *disk_manager, size_t queue_depth) {
+  unique_ptr<IoUringContext> context(new IoUringContext(disk_manager, queue_depth));
+  if (!context->Setup())
+    return nullptr;
+  return context;
+}
+
+//建立io_uring，并映射提交队列、完成队列和提交队列项
+bool IoUringContext::Setup() {
+#ifdef MINISQL_HAVE_IO_URING
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  ring_fd_ = IoUringSetup(static_cast<unsigned>(queue_depth_), &params);
+  if (ring_fd_ < 0)
+    return false;
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap)
+    sq_ring_size_ = cq_ring_size_ = max(sq_ring_size_, cq_ring_size_);
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                  IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) {
+    sq_ring_ = nullptr;
+    return false;
+  }
+  if (single_mmap) {
+    cq_ring_ = sq_ring_;
+  } else {
+    cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                    IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) {
+      cq_ring_ = nullptr;
+      return false;
+    }
+  }
+  sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+  if (sqes_ == MAP_FAILED) {
+    sqes_ = nullptr;
+    return false;
+  }
+
+  auto *sq = static_cast<char *>(sq_ring_);
+  auto *cq = static_cast<char *>(cq_ring_);
+  sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  cqes_ = cq + params.cq_off.cqes;
+  sq_entries_ = params.sq_entries;
+  //提交队列可能比请求的深度大，但同时在途的请求数仍以queue_depth_为上限
+  queue_depth_ = min<size_t>(queue_depth_, sq_entries_);
+  slots_.resize(sq_entries_);
+  iovecs_.resize(sq_entries_);
+  return true;
+#else
+  return false;
+#endif
+}
+
+IoUringContext::~IoUringContext() {
+#ifdef MINISQL_HAVE_IO_URING
+  if (ring_fd_ >= 0 && sqes_ != nullptr) {
+    //销毁前等待所有在途的请求完成，避免内核继续访问调用者的缓冲区
+    Submit();
+    vector<IoCompletion> completions;
+    while (in_flight_ > 0) {
+      Poll(completions, 1);
+    }
+  }
+  if (sqes_ != nullptr)
+    munmap(sqes_, sqes_size_);
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_)
+    munmap(cq_ring_, cq_ring_size_);
+  if (sq_ring_ != nullptr)
+    munmap(sq_ring_, sq_ring_size_);
+  if (ring_fd_ >= 0)
+    close(ring_fd_);
+#endif
+}
+
+//将准备好的请求写入提交队列，然后用一次io_uring_enter提交
+size_t IoUringContext::Submit() {
+#ifdef MINISQL_HAVE_IO_URING
+  if (prepared_.empty())
+    return 0;
+  unsigned tail = *sq_tail_;
+  unsigned mask = *sq_mask_;
+  size_t count = 0;
+  for (auto &request : prepared_) {
+    //提交队列已满时，剩余的请求留到下一次提交
+    if (tail - LoadAcquire(sq_head_) >= sq_entries_)
+      break;
+    unsigned index = tail & mask;
+    slots_[index] = request;
+    iovecs_[index].iov_base = request.data_;
+    iovecs_[index].iov_len = PAGE_SIZE;
+    auto *sqe = static_cast<struct io_uring_sqe *>(sqes_) + index;
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = request.is_write_ ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe->fd = disk_manager_->db_fd_;
+    sqe->addr = reinterpret_cast<uint64_t>(&iovecs_[index]);
+    sqe->len = 1;
+    sqe->off = static_cast<uint64_t>(request.physical_page_id_) * PAGE_SIZE;
+    sqe->user_data = index;
+    sq_array_[index] = index;
+    tail++;
+    count++;
+  }
+  StoreRelease(sq_tail_, tail);
+  prepared_.erase(prepared_.begin(), prepared_.begin() + count);
+
+  size_t submitted = 0;
+  while (submitted < count) {
+    int rc = IoUringEnter(ring_fd_, static_cast<unsigned>(count - submitted), 0, 0);
+    if (rc < 0) {
+      if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+        Reap();
+        continue;
+      }
+      LOG(ERROR) << "io_uring_enter failed: " << strerror(errno);
+      break;
+    }
+    submitted += rc;
+  }
+  //出错时内核没有取走剩下的条目，把它们从提交队列中撤回，作为失败的请求交给调用者
+  if (submitted < count) {
+    tail -= count - submitted;
+    StoreRelease(sq_tail_, tail);
+    for (size_t i = submitted; i < count; i++) {
+      ready_.push_back({slots_[(tail + i - submitted) & mask].tag_, false});
+    }
+  }
+  in_flight_ += submitted;
+  return submitted;
+#else
+  return 0;
+#endif
+}
+
+//从完成队列中取出已经完成的请求；读到文件末尾的部分补零
+void IoUringContext::Reap() {
+#ifdef MINISQL_HAVE_IO_URING
+  unsigned head = *cq_head_;
+  unsigned mask = *cq_mask_;
+  while (head != LoadAcquire(cq_tail_)) {
+    auto *cqe = static_cast<struct io_uring_cqe *>(cqes_) + (head & mask);
+    Request &request = slots_[cqe->user_data];
+    bool success = cqe->res >= 0;
+    if (!success) {
+      LOG(ERROR) << "I/O error while " << (request.is_write_ ? "writing: " : "reading: ") << strerror(-cqe->res);
+    } else if (cqe->res < PAGE_SIZE) {
+      if (request.is_write_) {
+        //极少出现的短写，用同步写补全
+        success = disk_manager_->WritePhysicalPage(request.physical_page_id_, request.data_);
+      } else {
+        memset(request.data_ + cqe->res, 0, PAGE_SIZE - cqe->res);
+      }
+    }
+    ready_.push_back({request.tag_, success});
+    in_flight_--;
+    head++;
+  }
+  StoreRelease(cq_head_, head);
+#endif
+}
+
+size_t IoUringContext::Poll(vector<IoCompletion> &completions, size_t min_complete) {
+#ifdef MINISQL_HAVE_IO_URING
+  Reap();
+  min_complete = min(min_complete, in_flight_ + ready_.size());
+  while (ready_.size() < min_complete) {
+    unsigned wait = static_cast<unsigned>(min_complete - ready_.size());
+    int rc = IoUringEnter(ring_fd_, 0, wait, IORING_ENTER_GETEVENTS);
+    if (rc < 0 && errno != EINTR) {
+      LOG(ERROR) << "io_uring_enter failed: " << strerror(errno);
+      break;
+    }
+    Reap();
+  }
+#endif
+  return TakeReady(completions, ready_.size());
+}
+
+/*****************************************************************************
+ * IoThreadPool
+ *****************************************************************************/
+IoThreadPool::IoThreadPool(size_t num_threads) {
+  for (size_t i = 0; i < num_threads; i++) {
+    workers_.emplace_back(&IoThreadPool::Run, this);
+  }
+}
+
+IoThreadPool::~IoThreadPool() {
+  {
+    lock_guard<mutex> lock(latch_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void IoThreadPool::Enqueue(function<void()> task) {
+  {
+    lock_guard<mutex> lock(latch_);
+    tasks_.push_back(std::move(task));
+  }
+  cv_.notify_one();
+}
+
+//停止前先把队列中剩余的任务执行完，保证已提交的请求都能完成
+void IoThreadPool::Run() {
+  unique_lock<mutex> lock(latch_);
+  while (true) {
+    cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+    if (tasks_.empty())
+      return;
+    auto task = std::move(tasks_.front());
+    tasks_.pop_front();
+    lock.unlock();
+    task();
+    lock.lock();
+  }
+}
+
+/*****************************************************************************
+ * ThreadPoolIoContext
+ *****************************************************************************/
+ThreadPoolIoContext::ThreadPoolIoContext(DiskManager *disk_manager, size_t queue_depth, IoThreadPool *pool)
+    : AsyncIoContext(disk_manager, queue_depth), pool_(pool) {}
+
+ThreadPoolIoContext::~ThreadPoolIoContext() {
+  Submit();
+  vector<IoCompletion> completions;
+  while (in_flight_ > 0) {
+    Poll(completions, 1);
+  }
+}
+
+size_t ThreadPoolIoContext::Submit() {
+  size_t count = prepared_.size();
+  for (auto &request : prepared_) {
+    pool_->Enqueue([this, request]() {
+      bool success = request.is_write_
+                         ? disk_manager_->WritePhysicalPage(request.physical_page_id_, request.data_)
+                         : disk_manager_->ReadPhysicalPage(request.physical_page_id_, request.data_);
+      {
+        lock_guard<mutex> lock(latch_);
+        done_.push_back({request.tag_, success});
+      }
+      cv_.notify_all();
+    });
+  }
+  prepared_.clear();
+  in_flight_ += count;
+  return count;
+}
+
+size_t ThreadPoolIoContext::Poll(vector<IoCompletion> &completions, size_t min_complete) {
+  min_complete = min(min_complete, in_flight_ + ready_.size());
+  unique_lock<mutex> lock(latch_);
+  cv_.wait(lock, [this, min_complete] { return ready_.size() + done_.size() >= min_complete; });
+  in_flight_ -= done_.size();
+  ready_.insert(ready_.end(), done_.begin(), done_.end());
+  done_.clear();
+  lock.unlock();
+  return TakeReady(completions, ready_.size());
+}
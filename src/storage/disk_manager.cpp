@@ -1,6 +1,10 @@
 #include "storage/disk_manager.h"
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
 #include <filesystem>
 #include <stdexcept>
 
@@ -8,34 +12,63 @@
 #include "page/bitmap_page.h"
 
 DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
-  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    //如果文件不存在，就创建一个新的文件
-    std::filesystem::path p = db_file;
-    if(p.has_parent_path()) std::filesystem::create_directories(p.parent_path());
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    //重新打开文件
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open())
-      throw std::exception();
-  }
-  //加载元数据（meta_data_)
+  std::scoped_lock<std::recursive_mutex> lock(meta_latch_);
+  //如果目录不存在，先创建目录；文件不存在时由open创建
+  std::filesystem::path p = db_file;
+  if (p.has_parent_path())
+    std::filesystem::create_directories(p.parent_path());
+  db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  if (db_fd_ < 0)
+    throw std::exception();
+  file_size_ = GetFileSize();
+  //加载元数据（meta_data_)和每个 Extent 的位图，之后的页面分配都在内存中完成
   ReadPhysicalPage(META_PAGE_ID, meta_data_);
+  auto *meta_page = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  for (uint32_t i = 0; i < meta_page->GetExtentNums(); i++) {
+    extent_bitmaps_.emplace_back(new char[PAGE_SIZE]);
+    ReadPhysicalPage(BitmapPhysicalPageId(i), extent_bitmaps_.back().get());
+  }
+  bitmap_dirty_.assign(extent_bitmaps_.size(), false);
+}
+
+//写回修改过的位图和元数据页，并将之前所有的写操作持久化到磁盘
+void DiskManager::Sync() {
+  std::scoped_lock<std::recursive_mutex> lock(meta_latch_);
+  if (closed)
+    return;
+  for (uint32_t i = 0; i < extent_bitmaps_.size(); i++) {
+    if (bitmap_dirty_[i] && WritePhysicalPage(BitmapPhysicalPageId(i), extent_bitmaps_[i].get()))
+      bitmap_dirty_[i] = false;
+  }
+  WritePhysicalPage(META_PAGE_ID, meta_data_);
+  if (fsync(db_fd_) != 0) {
+    LOG(ERROR) << "I/O error while syncing " << file_name_;
+  }
 }
 
 void DiskManager::Close()
 {
-  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  std::scoped_lock<std::recursive_mutex> lock(meta_latch_);
   if (!closed) {
-    db_io_.close();
+    Sync();
+    close(db_fd_);
+    db_fd_ = -1;
     closed = true;
   }
 }
 
+//优先使用io_uring，内核不支持时退回到I/O线程池
+std::unique_ptr<AsyncIoContext> DiskManager::CreateAsyncIoContext(size_t queue_depth, AsyncIoBackend backend) {
+  if (backend != AsyncIoBackend::THREAD_POOL) {
+    auto context = IoUringContext::Create(this, queue_depth);
+    if (context != nullptr || backend == AsyncIoBackend::IO_URING)
+      return context;
+  }
+  std::call_once(io_thread_pool_once_, [this] { io_thread_pool_ = std::make_unique<IoThreadPool>(ASYNC_IO_THREADS); });
+  return std::make_unique<ThreadPoolIoContext>(this, queue_depth, io_thread_pool_.get());
+}
+
+//读写数据页使用pread/pwrite，不需要加锁
 void DiskManager::ReadPage(page_id_t logical_page_id, char *page_data) {
   ASSERT(logical_page_id >= 0, "Invalid page id.");
   ReadPhysicalPage(MapPageId(logical_page_id), page_data);
@@ -49,63 +82,43 @@ void DiskManager::WritePage(page_id_t logical_page_id, const char *page_data) {
 /**
  * TODO: Student Implement
  */
-//从磁盘中分配一个空闲页，并返回空闲页的逻辑页号
+//从磁盘中分配一个空闲页，并返回空闲页的逻辑页号；只修改内存中的位图，不进行磁盘I/O
 page_id_t DiskManager::AllocatePage() {
+  std::scoped_lock<std::recursive_mutex> lock(meta_latch_);
   //获取元数据页，里面包含了文件的元数据信息
   auto* meta_page = reinterpret_cast<DiskFileMetaPage*>(meta_data_);
-  //获取文件中的 Extent 数量
-  uint32_t extent_count = meta_page->GetExtentNums();
 
-  //遍历每一个 Extent，找到第一个还有空闲页的 Extent
-  uint32_t extent_index;
-  for (extent_index = 0; extent_index < extent_count; extent_index++) {
-    if (meta_page->extent_used_page_[extent_index] < DiskManager::BITMAP_SIZE)
-      break;
-  }
+  //从第一个可能还有空闲页的 Extent 开始查找，前面的 Extent 都已经满了
+  uint32_t extent_index = first_free_extent_;
+  while (true) {
+    while (extent_index < meta_page->GetExtentNums() &&
+           meta_page->extent_used_page_[extent_index] >= DiskManager::BITMAP_SIZE)
+      extent_index++;
+    first_free_extent_ = extent_index;
+
+    //如果每一个 Extent 都没有空闲页了，那么就需要新分配一个 Extent，它的位图全部为空闲
+    if (extent_index == meta_page->GetExtentNums()) {
+      //如果已经分配的 Extent 数量已经达到最大限制，那么就无法再分配了
+      if (extent_index == (PAGE_SIZE - 8) / 4)
+        return INVALID_PAGE_ID;
+      meta_page->num_extents_++;
+      meta_page->extent_used_page_[extent_index] = 0;
+      extent_bitmaps_.emplace_back(new char[PAGE_SIZE]());
+      bitmap_dirty_.push_back(true);
+    }
 
-  //如果每一个 Extent 都没有空闲页了，那么就需要新分配一个 Extent
-  if (extent_index == extent_count) {
-    //如果已经分配的 Extent 数量已经达到最大限制，那么就无法再分配了
-    if (extent_index == (PAGE_SIZE - 8) / 4)
-      return INVALID_PAGE_ID;
-
-    //分配新的 Extent
-    meta_page->num_allocated_pages_++;
-    meta_page->num_extents_++;
-    meta_page->extent_used_page_[extent_index] = 1;
-
-    //将新分配的 Extent 的位图清空，表示所有页都是空闲的
-    char buf[PAGE_SIZE];
-    memset(buf, 0, PAGE_SIZE);
-    auto *bitmap = reinterpret_cast<BitmapPage<PAGE_SIZE> *>(buf);
-    uint32_t ofs = 0;
-    bitmap->AllocatePage(ofs);
-    WritePhysicalPage(1 + extent_index * (DiskManager::BITMAP_SIZE + 1), buf);
-
-    //返回新分配的页的编号
-    return meta_page->num_allocated_pages_ - 1;
-  }
-  //如果存在一个有空闲页的 Extent，那么就在该 Extent 中分配一个页
-  char buf[PAGE_SIZE];
-  ReadPhysicalPage(1 + extent_index * (DiskManager::BITMAP_SIZE + 1), buf);
-  auto* bitmap = reinterpret_cast<BitmapPage<PAGE_SIZE>*>(buf);
-  uint32_t page_index;
-
-  for (page_index = 0; page_index < BitmapPage<4096>::GetMaxSupportedSize(); page_index++) {
-    if (bitmap->IsPageFree(page_index))
-      break;
+    //在该 Extent 的位图中按字查找空闲页
+    uint32_t page_index;
+    if (GetExtentBitmap(extent_index)->AllocatePage(page_index)) {
+      //更新元数据信息，表示已经分配了一个新的页
+      meta_page->num_allocated_pages_++;
+      meta_page->extent_used_page_[extent_index]++;
+      bitmap_dirty_[extent_index] = true;
+      return static_cast<page_id_t>(extent_index * DiskManager::BITMAP_SIZE + page_index);
+    }
+    //元数据中的计数与位图不一致时以位图为准，该 Extent 视为已满
+    meta_page->extent_used_page_[extent_index] = DiskManager::BITMAP_SIZE;
   }
-  
-  //更新元数据信息，表示已经分配了一个新的页
-  meta_page->num_allocated_pages_++;
-  meta_page->extent_used_page_[extent_index]++;
-
-  //将新分配的页的状态设置为已分配
-  bitmap->AllocatePage(page_index);
-  WritePhysicalPage(1 + extent_index * (DiskManager::BITMAP_SIZE + 1), buf);
-
-  //返回新分配的页的编号
-  return meta_page->num_allocated_pages_ - 1;
 }
 
 /**
@@ -113,47 +126,42 @@ page_id_t DiskManager::AllocatePage() {
  */
 //释放磁盘中逻辑页号对应的物理页
 void DiskManager::DeAllocatePage(page_id_t logical_page_id) {
+  std::scoped_lock<std::recursive_mutex> lock(meta_latch_);
   if (IsPageFree(logical_page_id))
     return;    //如果页面已经释放，直接返回
-  else {
-    //获取文件元数据页面
-    auto *meta_page = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
-
-    //读取位图页面
-    char bitmap_buf[PAGE_SIZE];
-    const uint32_t bitmap_page_id = 1 + logical_page_id / DiskManager::BITMAP_SIZE * (DiskManager::BITMAP_SIZE + 1);
-    ReadPhysicalPage(bitmap_page_id, bitmap_buf);
-    auto *bitmap = reinterpret_cast<BitmapPage<PAGE_SIZE> *>(bitmap_buf);
-
-    //释放页面
-    const uint32_t page_id = logical_page_id % DiskManager::BITMAP_SIZE;
-    meta_page->num_allocated_pages_--;
-    meta_page->extent_used_page_[logical_page_id / DiskManager::BITMAP_SIZE]--;
-    bitmap->DeAllocatePage(page_id);
-    WritePhysicalPage(bitmap_page_id, bitmap_buf);
-  }
+
+  //获取文件元数据页面，释放页面并更新计数
+  auto *meta_page = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  const uint32_t extent_index = logical_page_id / DiskManager::BITMAP_SIZE;
+  GetExtentBitmap(extent_index)->DeAllocatePage(logical_page_id % DiskManager::BITMAP_SIZE);
+  meta_page->num_allocated_pages_--;
+  meta_page->extent_used_page_[extent_index]--;
+  bitmap_dirty_[extent_index] = true;
+  first_free_extent_ = std::min(first_free_extent_, extent_index);
 }
 
 /**
  * TODO: Student Implement
  */
-//判断该逻辑页号对应的数据页是否空闲
+//判断该逻辑页号对应的数据页是否空闲，只查询内存中的位图
 bool DiskManager::IsPageFree(page_id_t logical_page_id) {
-  const int kPageSize = PAGE_SIZE;
-  const int kBitmapSize = DiskManager::BITMAP_SIZE;
-  const int kBitmapEntrySize = kBitmapSize + 1;
-
-  //计算逻辑页号所在的位图页面
-  const int bitmap_page_num = 1 + (logical_page_id / kBitmapSize) * kBitmapEntrySize;
+  std::scoped_lock<std::recursive_mutex> lock(meta_latch_);
+  if (logical_page_id < 0)
+    return false;
+  //还没有创建的 Extent 中的页面都是空闲的
+  const uint32_t extent_index = logical_page_id / DiskManager::BITMAP_SIZE;
+  if (extent_index >= extent_bitmaps_.size())
+    return true;
+  return GetExtentBitmap(extent_index)->IsPageFree(logical_page_id % DiskManager::BITMAP_SIZE);
+}
 
-  //读取位图页面，并检查逻辑页号是否空闲
-  char bitmap_page[kPageSize];
-  ReadPhysicalPage(bitmap_page_num, bitmap_page);
-  auto *bitmap = reinterpret_cast<BitmapPage<kPageSize> *>(bitmap_page);
-  const int bitmap_index = logical_page_id % kBitmapSize;
-  const bool is_free = bitmap->IsPageFree(bitmap_index);
+//位图页在文件中紧挨着它所管理的 Extent 之前
+page_id_t DiskManager::BitmapPhysicalPageId(uint32_t extent_index) {
+  return 1 + extent_index * (DiskManager::BITMAP_SIZE + 1);
+}
 
-  return is_free;
+BitmapPage<PAGE_SIZE> *DiskManager::GetExtentBitmap(uint32_t extent_index) {
+  return reinterpret_cast<BitmapPage<PAGE_SIZE> *>(extent_bitmaps_[extent_index].get());
 }
 
 /**
@@ -172,47 +180,70 @@ page_id_t DiskManager::MapPageId(page_id_t logical_page_id) {
 }
 
 //获取文件的大小
-int DiskManager::GetFileSize(const std::string &file_name) {
+size_t DiskManager::GetFileSize() {
   struct stat stat_buf;
-  int rc = stat(file_name.c_str(), &stat_buf);
-  return rc == 0 ? stat_buf.st_size : -1;
+  int rc = fstat(db_fd_, &stat_buf);
+  return rc == 0 ? stat_buf.st_size : 0;
 }
 
 //读取物理页面
-void DiskManager::ReadPhysicalPage(page_id_t physical_page_id, char *page_data) {
-  int offset = physical_page_id * PAGE_SIZE;
+bool DiskManager::ReadPhysicalPage(page_id_t physical_page_id, char *page_data) {
+  size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
   //检查是否读取的范围超出了当前文件的长度
-  if (offset >= GetFileSize(file_name_)) {
+  if (offset >= file_size_) {
 #ifdef ENABLE_BPM_DEBUG
     LOG(INFO) << "Read less than a page" << std::endl;
 #endif
     memset(page_data, 0, PAGE_SIZE);
-  } else {
-    //根据偏移设置读取指针
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
+    return true;
+  }
+  //从偏移处读取，直到读满一页或到达文件末尾
+  size_t read_count = 0;
+  while (read_count < PAGE_SIZE) {
+    ssize_t rc = pread(db_fd_, page_data + read_count, PAGE_SIZE - read_count, offset + read_count);
+    if (rc < 0 && errno == EINTR)
+      continue;
+    if (rc < 0) {
+      LOG(ERROR) << "I/O error while reading";
+      memset(page_data, 0, PAGE_SIZE);
+      return false;
+    }
+    if (rc == 0)
+      break;
+    read_count += rc;
+  }
+  // if file ends before reading PAGE_SIZE
+  if (read_count < PAGE_SIZE) {
 #ifdef ENABLE_BPM_DEBUG
-      LOG(INFO) << "Read less than a page" << std::endl;
+    LOG(INFO) << "Read less than a page" << std::endl;
 #endif
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
-    }
+    memset(page_data + read_count, 0, PAGE_SIZE - read_count);
   }
+  return true;
 }
 
-//写入物理页面
-void DiskManager::WritePhysicalPage(page_id_t physical_page_id, const char *page_data) {
+//写入物理页面，写操作只有在Sync时才保证持久化
+bool DiskManager::WritePhysicalPage(page_id_t physical_page_id, const char *page_data) {
   size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
-  // set write cursor to offset
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG(ERROR) << "I/O error while writing";
-    return;
+  size_t write_count = 0;
+  while (write_count < PAGE_SIZE) {
+    ssize_t rc = pwrite(db_fd_, page_data + write_count, PAGE_SIZE - write_count, offset + write_count);
+    if (rc < 0 && errno == EINTR)
+      continue;
+    // check for I/O error
+    if (rc <= 0) {
+      LOG(ERROR) << "I/O error while writing";
+      return false;
+    }
+    write_count += rc;
+  }
+  ExtendFileSize(offset + PAGE_SIZE);
+  return true;
+}
+
+//更新缓存的文件大小，多个线程同时扩展文件时保留最大值
+void DiskManager::ExtendFileSize(size_t end) {
+  size_t cur_size = file_size_.load();
+  while (cur_size < end && !file_size_.compare_exchange_weak(cur_size, end)) {
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
 }
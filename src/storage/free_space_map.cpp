@@ -0,0 +1,127 @@
+#include "storage/free_space_map.h"
+
+#include <algorithm>
+
+#include "glog/logging.h"
+
+FreeSpaceMap::FreeSpaceMap(BufferPoolManager *buffer_pool_manager, page_id_t root_page_id)
+    : buffer_pool_manager_(buffer_pool_manager), root_page_id_(root_page_id) {}
+
+page_id_t FreeSpaceMap::CreateRoot(BufferPoolManager *buffer_pool_manager) {
+  page_id_t root_page_id;
+  auto page = buffer_pool_manager->NewPage(root_page_id);
+  if (page == nullptr)
+    return INVALID_PAGE_ID;
+  reinterpret_cast<FreeSpaceMapPage *>(page->GetData())->Init();
+  buffer_pool_manager->UnpinPage(root_page_id, true);
+  return root_page_id;
+}
+
+//沿着链表读出所有表项；每个表项的下标就是它在链表中的位置
+void FreeSpaceMap::Load() {
+  loaded_ = true;
+  page_id_t map_page_id = root_page_id_;
+  uint32_t index = 0;
+  while (map_page_id != INVALID_PAGE_ID) {
+    auto page = buffer_pool_manager_->FetchPage(map_page_id);
+    ASSERT(page != nullptr, "Can not fetch free space map page.");
+    auto map_page = reinterpret_cast<FreeSpaceMapPage *>(page->GetData());
+    map_pages_.push_back(map_page_id);
+    for (uint32_t i = 0; i < map_page->GetCount(); i++, index++) {
+      page_id_t page_id = map_page->GetPageId(i);
+      entries_[page_id] = {map_page->GetFreeSpace(i), index};
+      by_free_space_.insert({map_page->GetFreeSpace(i), page_id});
+      last_page_id_ = page_id;
+    }
+    page_id_t next_page_id = map_page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(map_page_id, false);
+    map_page_id = next_page_id;
+  }
+}
+
+void FreeSpaceMap::AddPage(page_id_t page_id, uint32_t free_space) {
+  auto index = static_cast<uint32_t>(entries_.size());
+  entries_[page_id] = {free_space, index};
+  by_free_space_.insert({free_space, page_id});
+  last_page_id_ = page_id;
+  Persist(index, page_id, free_space, true);
+}
+
+void FreeSpaceMap::UpdatePage(page_id_t page_id, uint32_t free_space) {
+  auto itr = entries_.find(page_id);
+  if (itr == entries_.end() || itr->second.free_space_ == free_space)
+    return;
+  by_free_space_.erase({itr->second.free_space_, page_id});
+  by_free_space_.insert({free_space, page_id});
+  itr->second.free_space_ = free_space;
+  Persist(itr->second.index_, page_id, free_space, false);
+}
+
+vector<page_id_t> FreeSpaceMap::GetPageIds() const {
+  vector<pair<uint32_t, page_id_t>> by_index;
+  by_index.reserve(entries_.size());
+  for (auto &entry : entries_)
+    by_index.emplace_back(entry.second.index_, entry.first);
+  sort(by_index.begin(), by_index.end());
+  vector<page_id_t> page_ids;
+  page_ids.reserve(by_index.size());
+  for (auto &entry : by_index)
+    page_ids.push_back(entry.second);
+  return page_ids;
+}
+
+uint32_t FreeSpaceMap::GetFreeSpace(page_id_t page_id) const {
+  auto itr = entries_.find(page_id);
+  return itr == entries_.end() ? 0 : itr->second.free_space_;
+}
+
+//按空闲空间排序后二分查找，得到能放下的最小的空闲空间（最佳适应）
+page_id_t FreeSpaceMap::FindPage(uint32_t required) const {
+  auto itr = by_free_space_.lower_bound({required, INVALID_PAGE_ID});
+  return itr == by_free_space_.end() ? INVALID_PAGE_ID : itr->second;
+}
+
+void FreeSpaceMap::Destroy() {
+  if (!loaded_)
+    Load();
+  for (auto map_page_id : map_pages_) {
+    buffer_pool_manager_->DeletePage(map_page_id);
+  }
+  map_pages_.clear();
+  entries_.clear();
+  by_free_space_.clear();
+  root_page_id_ = INVALID_PAGE_ID;
+  last_page_id_ = INVALID_PAGE_ID;
+}
+
+//表项写入它所在的空闲空间页；追加时如果最后一页已满，则新建一页并接在链表末尾
+void FreeSpaceMap::Persist(uint32_t index, page_id_t page_id, uint32_t free_space, bool append) {
+  if (!IsPersistent())
+    return;
+  ASSERT(loaded_, "Free space map must be loaded before it is modified.");
+  uint32_t map_index = index / FreeSpaceMapPage::MAX_ENTRY_COUNT;
+  if (map_index == map_pages_.size()) {
+    page_id_t new_page_id;
+    auto new_page = buffer_pool_manager_->NewPage(new_page_id);
+    if (new_page == nullptr) {
+      LOG(ERROR) << "Can not allocate free space map page." << std::endl;
+      return;
+    }
+    reinterpret_cast<FreeSpaceMapPage *>(new_page->GetData())->Init();
+    buffer_pool_manager_->UnpinPage(new_page_id, true);
+    auto prev_page = buffer_pool_manager_->FetchPage(map_pages_.back());
+    reinterpret_cast<FreeSpaceMapPage *>(prev_page->GetData())->SetNextPageId(new_page_id);
+    buffer_pool_manager_->UnpinPage(map_pages_.back(), true);
+    map_pages_.push_back(new_page_id);
+  }
+  auto page = buffer_pool_manager_->FetchPage(map_pages_[map_index]);
+  if (page == nullptr)
+    return;
+  auto map_page = reinterpret_cast<FreeSpaceMapPage *>(page->GetData());
+  if (append) {
+    map_page->Append(page_id, free_space);
+  } else {
+    map_page->SetFreeSpace(index % FreeSpaceMapPage::MAX_ENTRY_COUNT, free_space);
+  }
+  buffer_pool_manager_->UnpinPage(map_pages_[map_index], true);
+}
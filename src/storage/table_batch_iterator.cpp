@@ -0,0 +1,45 @@
+#include "storage/table_batch_iterator.h"
+
+#include "storage/table_heap.h"
+
+TableBatchIterator::TableBatchIterator(TableHeap *table_heap, Transaction *txn, BufferRing *ring)
+    : table_heap_(table_heap),
+      txn_(txn),
+      ring_(ring),
+      next_page_id_(table_heap->GetFirstPageId()),
+      read_ahead_(INVALID_PAGE_ID) {}
+
+TableBatchIterator::TableBatchIterator(TableHeap *table_heap, Transaction *txn, std::vector<page_id_t> page_ids,
+                                       BufferRing *ring)
+    : table_heap_(table_heap),
+      txn_(txn),
+      ring_(ring),
+      next_page_id_(page_ids.empty() ? INVALID_PAGE_ID : page_ids[0]),
+      follow_chain_(false),
+      page_ids_(std::move(page_ids)),
+      next_index_(1),
+      read_ahead_(INVALID_PAGE_ID) {}
+
+//每个页面只固定、加锁一次，取出其中所有未删除的元组后立即释放；没有元组的页面直接跳过
+bool TableBatchIterator::NextBatch(std::vector<Row> &rows, const std::function<bool(const RowView &)> &filter,
+                                   MemHeap *heap) {
+  rows.clear();
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  while (next_page_id_ != INVALID_PAGE_ID) {
+    page_id_t page_id = next_page_id_;
+    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager->FetchPage(page_id, ring_));
+    ASSERT(page != nullptr, "Can not fetch table page.");
+    page->RLatch();
+    read_ahead_.OnPage(buffer_pool_manager, page);
+    page->GetTuples(&rows, table_heap_->schema_, filter, heap);
+    if (follow_chain_)
+      next_page_id_ = page->GetNextPageId();
+    else
+      next_page_id_ = next_index_ < page_ids_.size() ? page_ids_[next_index_++] : INVALID_PAGE_ID;
+    page->RUnlatch();
+    buffer_pool_manager->UnpinPage(page_id, false);
+    if (!rows.empty())
+      return true;
+  }
+  return false;
+}
@@ -9,46 +9,159 @@ bool TableHeap::InsertTuple(Row &row, Transaction *txn) {
   uint32_t serialized_size = row.GetSerializedSize(schema_);
   if (serialized_size > TablePage::SIZE_MAX_ROW)
     return false;
+  LoadFreeSpaceMap();
 
-  //获取第一个页面
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  if (cur_page == nullptr)
-    return false;
+  //先尝试上一次插入的页面，放不下时再从空闲空间表中查找
+  uint32_t required = serialized_size + TablePage::SIZE_TUPLE;
+  page_id_t page_id = last_insert_page_id_;
+  if (page_id == INVALID_PAGE_ID || free_space_map_.GetFreeSpace(page_id) < required)
+    page_id = free_space_map_.FindPage(required);
 
-  //查找合适的页面来插入元组
   while (true) {
-    if (cur_page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_)) {
-      //元组插入成功，更新页面并返回 true
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
+    //没有页面能放下时，在链表末尾追加新页面
+    bool is_new_page = page_id == INVALID_PAGE_ID;
+    TablePage *cur_page = is_new_page ? AppendPage(txn)
+                                      : static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (cur_page == nullptr)
+      return false;
+    page_id = cur_page->GetTablePageId();
+
+    bool inserted = cur_page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
+    free_space_map_.UpdatePage(page_id, cur_page->GetFreeSpaceRemaining());
+    buffer_pool_manager_->UnpinPage(page_id, inserted);
+    if (inserted) {
+      last_insert_page_id_ = page_id;
       return true;
     }
+    //空闲空间表中的记录已经过期，更正之后重新查找；新页面都放不下则无法插入
+    if (is_new_page)
+      return false;
+    page_id = free_space_map_.FindPage(required);
+  }
+}
 
-    //获取下一页的页面 ID
-    page_id_t next_page_id = cur_page->GetNextPageId();
+//批量插入：每个页面在整批中只固定、加锁一次，尽量连续地写满
+bool TableHeap::InsertTuples(std::vector<Row> &rows, Transaction *txn) {
+  //先检查所有行的大小，有行过大时不插入任何行
+  std::vector<uint32_t> required(rows.size());
+  for (size_t i = 0; i < rows.size(); i++) {
+    uint32_t serialized_size = rows[i].GetSerializedSize(schema_);
+    if (serialized_size > TablePage::SIZE_MAX_ROW)
+      return false;
+    required[i] = serialized_size + TablePage::SIZE_TUPLE;
+  }
+  LoadFreeSpaceMap();
+
+  //先写入已有页面：上一次插入的页面，以及空闲空间表中能放下下一行的页面
+  size_t next = 0;
+  while (next < rows.size()) {
+    page_id_t page_id = last_insert_page_id_;
+    if (page_id == INVALID_PAGE_ID || free_space_map_.GetFreeSpace(page_id) < required[next])
+      page_id = free_space_map_.FindPage(required[next]);
+    if (page_id == INVALID_PAGE_ID)
+      break;
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr)
+      return false;
+    size_t first = next;
+    page->WLatch();
+    while (next < rows.size() && page->InsertTuple(rows[next], schema_, txn, lock_manager_, log_manager_))
+      next++;
+    page->WUnlatch();
+    //一行都没有放下说明空闲空间表中的记录已经过期，更正之后会换一个页面
+    free_space_map_.UpdatePage(page_id, page->GetFreeSpaceRemaining());
+    buffer_pool_manager_->UnpinPage(page_id, next > first);
+    if (next > first)
+      last_insert_page_id_ = page_id;
+  }
+  if (next == rows.size())
+    return true;
 
-    if (next_page_id != INVALID_PAGE_ID) {
-      //如果下一页有效，则获取下一页
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
-      cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
+  //剩余的行写入新页面；新页面在写入时互相链接，写完之后一次接到链表末尾
+  page_id_t first_new_page_id = INVALID_PAGE_ID;
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  TablePage *prev_page = nullptr;
+  std::vector<std::pair<page_id_t, uint32_t>> new_pages;
+  while (next < rows.size()) {
+    page_id_t page_id;
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(page_id));
+    if (page == nullptr)
+      break;
+    page->Init(page_id, prev_page_id, log_manager_, txn);
+    while (next < rows.size() && page->InsertTuple(rows[next], schema_, txn, lock_manager_, log_manager_))
+      next++;
+    if (prev_page == nullptr) {
+      first_new_page_id = page_id;
+    } else {
+      prev_page->SetNextPageId(page_id);
+      buffer_pool_manager_->UnpinPage(prev_page_id, true);
     }
-    else {
-      //如果下一页无效，则创建新页面
-      auto *new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(next_page_id));
-      if (new_page == nullptr) {
-        buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
-        return false;
-      }
+    new_pages.emplace_back(page_id, page->GetFreeSpaceRemaining());
+    prev_page = page;
+    prev_page_id = page_id;
+  }
+  if (prev_page != nullptr)
+    buffer_pool_manager_->UnpinPage(prev_page_id, true);
+  if (first_new_page_id != INVALID_PAGE_ID) {
+    LinkPages(first_new_page_id, new_pages);
+    last_insert_page_id_ = prev_page_id;
+  }
+  return next == rows.size();
+}
 
-      //初始化新页面并更新当前页面下一页 ID
-      new_page->Init(next_page_id, cur_page->GetTablePageId(), log_manager_, txn);
-      cur_page->SetNextPageId(next_page_id);
+void TableHeap::LinkPages(page_id_t first_page_id, const std::vector<std::pair<page_id_t, uint32_t>> &pages) {
+  //找到链表真正的末尾，空闲空间表可能没有记下最后几个页面
+  page_id_t last_page_id = free_space_map_.GetLastPageId();
+  auto last_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(last_page_id));
+  ASSERT(last_page != nullptr, "Can not fetch the last table page.");
+  while (last_page->GetNextPageId() != INVALID_PAGE_ID) {
+    page_id_t next_page_id = last_page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(last_page_id, false);
+    last_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
+    ASSERT(last_page != nullptr, "Can not fetch table page.");
+    last_page_id = next_page_id;
+    free_space_map_.AddPage(last_page_id, last_page->GetFreeSpaceRemaining());
+  }
+  last_page->SetNextPageId(first_page_id);
+  buffer_pool_manager_->UnpinPage(last_page_id, true);
+  auto first_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id));
+  ASSERT(first_page != nullptr, "Can not fetch table page.");
+  first_page->SetPrevPageId(last_page_id);
+  buffer_pool_manager_->UnpinPage(first_page_id, true);
+  for (auto &page : pages) {
+    free_space_map_.AddPage(page.first, page.second);
+  }
+}
 
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
-      cur_page = new_page;
-    }
+void TableHeap::LoadFreeSpaceMap() {
+  if (free_space_map_.IsLoaded())
+    return;
+  free_space_map_.Load();
+  if (free_space_map_.GetPageCount() > 0)
+    return;
+  //沿页面链表重建空闲空间表
+  page_id_t page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    ASSERT(page != nullptr, "Can not fetch table page.");
+    free_space_map_.AddPage(page_id, page->GetFreeSpaceRemaining());
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
   }
 }
 
+TablePage *TableHeap::AppendPage(Transaction *txn) {
+  page_id_t new_page_id;
+  auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(new_page_id));
+  if (new_page == nullptr)
+    return nullptr;
+  //初始化新页面，再把它接到链表末尾
+  new_page->Init(new_page_id, INVALID_PAGE_ID, log_manager_, txn);
+  LinkPages(new_page_id, {{new_page_id, new_page->GetFreeSpaceRemaining()}});
+  return new_page;
+}
+
 bool TableHeap::MarkDelete(const RowId &rid, Transaction *txn) {
   //获取包含该元组的页
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
@@ -84,6 +197,10 @@ bool TableHeap::UpdateTuple(const Row &row, const RowId &rid, Transaction *txn)
 
   //尝试更新元组
   bool updated = page->UpdateTuple(row, &old_row_, schema_, txn, lock_manager_, log_manager_);
+  if (updated) {
+    LoadFreeSpaceMap();
+    free_space_map_.UpdatePage(rid.GetPageId(), page->GetFreeSpaceRemaining());
+  }
 
   if (!updated) {
     //如果更新失败，标记删除旧行并插入新行
@@ -115,8 +232,10 @@ void TableHeap::ApplyDelete(const RowId &rid, Transaction *txn) {
   //获取包含该元组的页
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   assert(page != nullptr);
-  //删除该元组
+  //删除该元组，腾出的空间记入空闲空间表，供之后的插入使用
   page->ApplyDelete(rid, txn, log_manager_);
+  LoadFreeSpaceMap();
+  free_space_map_.UpdatePage(rid.GetPageId(), page->GetFreeSpaceRemaining());
   //Unpin该页
   buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);
 }
@@ -161,8 +280,10 @@ void TableHeap::DeleteTable(page_id_t page_id) {
     buffer_pool_manager_->UnpinPage(page_id, false);
     buffer_pool_manager_->DeletePage(page_id);
   }
-  else
+  else {
     DeleteTable(first_page_id_);
+    free_space_map_.Destroy();
+  }
 }
 
 bool TableHeap::GetNextTupleRid(const RowId &cur_rid, RowId *next_rid) {
@@ -214,12 +335,12 @@ bool TableHeap::GetNextTupleRid(const RowId &cur_rid, RowId *next_rid) {
  * TODO: Student Implement
  */
 //获取堆表的首迭代器
-TableIterator TableHeap::Begin(Transaction *txn) {
+TableIterator TableHeap::Begin(Transaction *txn, BufferRing *ring) {
   if (first_page_id_ == INVALID_PAGE_ID)
     //堆表为空，则返回一个的非法的构造器
     return TableIterator(this, INVALID_ROWID, txn);
 
-  auto *first_page = (TablePage *)buffer_pool_manager_->FetchPage(first_page_id_);
+  auto *first_page = (TablePage *)buffer_pool_manager_->FetchPage(first_page_id_, ring);
   if (!first_page)
     //第一页不存在，则返回一个的非法的构造器
     return TableIterator(this, INVALID_ROWID, txn);
@@ -235,7 +356,41 @@ TableIterator TableHeap::Begin(Transaction *txn) {
   //在操作结束后，unpin该页
   buffer_pool_manager_->UnpinPage(first_page_id_, false);
 
-  return TableIterator(this, first_row_id, txn);
+  return TableIterator(this, first_row_id, txn, ring);
+}
+
+//把堆表的页面分成若干段，供并行扫描使用
+//页面列表取自空闲空间表，它只可能漏掉链表末尾的页面，所以再从表中最后一页沿链表向后补齐
+std::vector<TableBatchIterator> TableHeap::BeginPartitions(Transaction *txn, size_t count) {
+  LoadFreeSpaceMap();
+  std::vector<page_id_t> page_ids = free_space_map_.GetPageIds();
+  page_id_t page_id = page_ids.empty() ? first_page_id_ : page_ids.back();
+  if (!page_ids.empty()) {
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    ASSERT(page != nullptr, "Can not fetch table page.");
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    ASSERT(page != nullptr, "Can not fetch table page.");
+    page_ids.push_back(page_id);
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+
+  //把页面平均分成若干段连续的页面
+  count = std::max<size_t>(1, std::min(count, page_ids.size()));
+  std::vector<TableBatchIterator> partitions;
+  partitions.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    auto begin = page_ids.begin() + page_ids.size() * i / count;
+    auto end = page_ids.begin() + page_ids.size() * (i + 1) / count;
+    partitions.emplace_back(this, txn, std::vector<page_id_t>(begin, end));
+  }
+  return partitions;
 }
 
 /**
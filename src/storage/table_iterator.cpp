@@ -6,15 +6,19 @@
 //使用初始化列表来初始化成员
 //如果传入的rid有效，则通过调用table_heap的GetTuple获取元组
 //如果传入的rid无效，则不进行操作
-TableIterator::TableIterator(TableHeap *table_heap, RowId rid, Transaction* txn)
-    : table_heap(table_heap), row(new Row(rid)), txn(txn) {
+TableIterator::TableIterator(TableHeap *table_heap, RowId rid, Transaction* txn, BufferRing *ring)
+    : table_heap(table_heap), row(new Row(rid)), txn(txn), ring(ring), read_ahead(rid.GetPageId()) {
   if (rid.GetPageId() != INVALID_PAGE_ID)
     this->table_heap->GetTuple(row, txn);
 }
 
 //拷贝构造函数，创建一个新的TableIterator，并复制other的所有状态
 TableIterator::TableIterator(const TableIterator &other)
-    : table_heap(other.table_heap), row(other.row ? new Row(*other.row) : nullptr), txn(other.txn) {}
+    : table_heap(other.table_heap),
+      row(other.row ? new Row(*other.row) : nullptr),
+      txn(other.txn),
+      ring(other.ring),
+      read_ahead(other.read_ahead) {}
 
 //析构函数，释放动态分配的Row
 TableIterator::~TableIterator() {
@@ -28,6 +32,8 @@ TableIterator &TableIterator::operator=(const TableIterator &other) noexcept {
   if (this != &other) {
     table_heap = other.table_heap;
     txn = other.txn;
+    ring = other.ring;
+    read_ahead = other.read_ahead;
     if (row != nullptr) {
       delete row;
     }
@@ -63,7 +69,7 @@ Row *TableIterator::operator->() {
 //重载++操作符
 TableIterator& TableIterator::operator++() {
   BufferPoolManager* buffer_pool_manager = table_heap->buffer_pool_manager_;
-  auto cur_page = reinterpret_cast<TablePage*>(buffer_pool_manager->FetchPage(row->GetRowId().GetPageId()));
+  auto cur_page = reinterpret_cast<TablePage*>(buffer_pool_manager->FetchPage(row->GetRowId().GetPageId(), ring));
   cur_page->RLatch();
   assert(cur_page != nullptr);    //所有页面均已固定
 
@@ -71,12 +77,13 @@ TableIterator& TableIterator::operator++() {
   if (!cur_page->GetNextTupleRid(row->GetRowId(), &next_tuple_rid)) {
     while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
       //获取下一页的页面ID，并使用buffer_pool_manager获取对应的页面。
-      auto next_page = reinterpret_cast<TablePage*>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
+      auto next_page = reinterpret_cast<TablePage*>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId(), ring));
       cur_page->RUnlatch();
       //解除当前页面的固定状态，将cur_page更新为下一页，对新的页面再进行读锁定
       buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
       cur_page = next_page;
       cur_page->RLatch();
+      read_ahead.OnPage(buffer_pool_manager, cur_page);
       if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
         break;    //如果新的当前页面存在第一个元组，则跳出循环
       }
@@ -85,8 +92,9 @@ TableIterator& TableIterator::operator++() {
   delete row;    //释放之前的行，避免内存泄露
   row = new Row(next_tuple_rid);    //使用下一个元组的行ID创建新的行对象
 
-  if (*this != table_heap->End()) {    //如果迭代器不等于table_heap的末尾迭代器
-    table_heap->GetTuple(row, nullptr);    //获取新行对应的元组数据
+  //新行所在的页面已经被固定，直接从该页面读取元组数据，不再通过TableHeap::GetTuple重复获取页面
+  if (next_tuple_rid.GetPageId() != INVALID_PAGE_ID) {
+    cur_page->GetTuple(row, table_heap->schema_, txn, table_heap->lock_manager_);
   }
   cur_page->RUnlatch();
   buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
@@ -100,3 +108,31 @@ TableIterator TableIterator::operator++(int) {
   ++(*this);
   return temp;
 }
+
+//进入新页面时预读链表中的下一页
+//如果最近两次翻页的页号间隔相同，认为是顺序扫描，按该间隔预读后面一个窗口内的页面，已经预读过的页面不再重复请求
+void TableReadAhead::OnPage(BufferPoolManager *buffer_pool_manager, TablePage *page) {
+  page_id_t page_id = page->GetTablePageId();
+  page_id_t next_page_id = page->GetNextPageId();
+  page_id_t stride = page_id - last_page_id_;
+  bool sequential = last_page_id_ != INVALID_PAGE_ID && stride > 0 && next_page_id - page_id == stride;
+  last_page_id_ = page_id;
+  if (next_page_id == INVALID_PAGE_ID)
+    return;
+  if (!sequential) {
+    buffer_pool_manager->PrefetchPage(next_page_id);
+    readahead_until_ = next_page_id;
+    return;
+  }
+
+  page_id_t window_end = next_page_id + stride * static_cast<page_id_t>(TABLE_SCAN_READAHEAD_PAGES - 1);
+  page_id_t start = next_page_id;
+  if (readahead_until_ != INVALID_PAGE_ID && readahead_until_ >= next_page_id &&
+      (readahead_until_ - page_id) % stride == 0)
+    start = readahead_until_ + stride;
+  for (page_id_t prefetch_id = start; prefetch_id <= window_end; prefetch_id += stride) {
+    if (!buffer_pool_manager->PrefetchPage(prefetch_id))
+      break;
+    readahead_until_ = prefetch_id;
+  }
+}
@@ -1,6 +1,9 @@
 #include "buffer/buffer_pool_manager.h"
 
+#include <atomic>
+#include <chrono>
 #include <cstdio>
+#include <thread>
 #include <random>
 #include <string>
 
@@ -72,3 +75,195 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
   delete bpm;
   delete disk_manager;
 }
+
+TEST(BufferPoolManagerTest, BulkReadRingTest) {
+  const std::string db_name = "bpm_ring_test.db";
+  const size_t buffer_pool_size = 16;
+  const int hot_pages = 4;
+  const int total_pages = 64;
+
+  for (bool use_ring : {true, false}) {
+    remove(db_name.c_str());
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+    page_id_t page_id;
+    for (int i = 0; i < total_pages; ++i) {
+      auto *page = bpm->NewPage(page_id);
+      ASSERT_NE(nullptr, page);
+      ASSERT_EQ(i, page_id);
+      page->GetData()[0] = 'h';
+      bpm->UnpinPage(page_id, true);
+    }
+    // Touch the hot pages so that they are the most recently used ones.
+    for (int i = 0; i < hot_pages; ++i) {
+      ASSERT_NE(nullptr, bpm->FetchPage(i));
+      bpm->UnpinPage(i, false);
+      ASSERT_TRUE(bpm->FlushPage(i));
+    }
+
+    // Scan every other page, with or without a small bulk-read ring.
+    BufferRing ring(4, 4);
+    for (int i = hot_pages; i < total_pages; ++i) {
+      auto *page = bpm->FetchPage(i, use_ring ? &ring : nullptr);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ('h', page->GetData()[0]);
+      bpm->UnpinPage(i, false);
+    }
+    if (use_ring) {
+      EXPECT_EQ(4, ring.Size());
+    }
+
+    // Change the hot pages behind the buffer pool's back: a resident page still shows the old content.
+    char empty_page[PAGE_SIZE] = {0};
+    for (int i = 0; i < hot_pages; ++i) {
+      disk_manager->WritePage(i, empty_page);
+    }
+    for (int i = 0; i < hot_pages; ++i) {
+      auto *page = bpm->FetchPage(i);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(use_ring ? 'h' : '\0', page->GetData()[0]);
+      bpm->UnpinPage(i, false);
+    }
+    EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+    delete bpm;
+    disk_manager->Close();
+    delete disk_manager;
+    remove(db_name.c_str());
+  }
+}
+
+TEST(BufferPoolManagerTest, BackgroundFlusherTest) {
+  const std::string db_name = "bpm_flusher_test.db";
+  const size_t buffer_pool_size = 10;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    page->GetData()[0] = static_cast<char>('a' + i);
+    bpm->UnpinPage(page_id, true);
+  }
+  EXPECT_EQ(buffer_pool_size, bpm->GetDirtyPageCount());
+
+  // Scenario: a later clean unpin must not hide an earlier modification.
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  bpm->UnpinPage(0, false);
+  EXPECT_EQ(buffer_pool_size, bpm->GetDirtyPageCount());
+
+  // Scenario: pinned pages are skipped by FlushDirtyPages but written by a checkpoint.
+  ASSERT_NE(nullptr, bpm->FetchPage(1));
+  EXPECT_EQ(2, bpm->FlushDirtyPages(2));
+  EXPECT_EQ(buffer_pool_size - 2, bpm->GetDirtyPageCount());
+
+  // Scenario: the background flusher writes every unpinned dirty page without any foreground eviction.
+  bpm->StartBackgroundFlusher(std::chrono::milliseconds(1), 2, 0);
+  for (int i = 0; i < 1000 && bpm->GetDirtyPageCount() > 1; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(1, bpm->GetDirtyPageCount());
+  bpm->Checkpoint();
+  EXPECT_EQ(0, bpm->GetDirtyPageCount());
+  bpm->UnpinPage(1, false);
+
+  char data[PAGE_SIZE];
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    disk_manager->ReadPage(i, data);
+    EXPECT_EQ(static_cast<char>('a' + i), data[0]);
+  }
+
+  // Scenario: stopping the flusher does not wait for its next round.
+  bpm->StartBackgroundFlusher(std::chrono::milliseconds(60000), 2, 0);
+  auto start = std::chrono::steady_clock::now();
+  bpm->StopBackgroundFlusher();
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+
+  // Scenario: a checkpoint waits for the writer holding a dirty page's latch, and meanwhile does not hold up
+  // fetches of other pages.
+  auto *page = bpm->FetchPage(2);
+  ASSERT_EQ(page, bpm->FetchPage(2));
+  bpm->UnpinPage(2, true);
+  page->WLatch();
+  page->GetData()[0] = 'x';
+  std::atomic<bool> checkpointed{false};
+  std::thread checkpoint([&] {
+    bpm->Checkpoint();
+    checkpointed = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  ASSERT_NE(nullptr, bpm->FetchPage(3));
+  bpm->UnpinPage(3, false);
+  EXPECT_FALSE(checkpointed);
+  page->GetData()[1] = 'y';
+  page->WUnlatch();
+  checkpoint.join();
+  bpm->UnpinPage(2, false);
+  disk_manager->ReadPage(2, data);
+  EXPECT_EQ('x', data[0]);
+  EXPECT_EQ('y', data[1]);
+  EXPECT_EQ(0, bpm->GetDirtyPageCount());
+
+  delete bpm;
+  disk_manager->Close();
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, PrefetchTest) {
+  const std::string db_name = "bpm_prefetch_test.db";
+  const size_t buffer_pool_size = 8;
+  const int total_pages = 64;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  page_id_t page_id;
+  for (int i = 0; i < total_pages; ++i) {
+    auto *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    *reinterpret_cast<int *>(page->GetData()) = i;
+    bpm->UnpinPage(page_id, true);
+  }
+
+  // Scenario: fetches racing with background reads of the same pages always see the page content.
+  for (int i = 0; i < total_pages; ++i) {
+    bpm->PrefetchPage((i + 1) % total_pages);
+    bpm->PrefetchPage((i + 2) % total_pages);
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, *reinterpret_cast<int *>(page->GetData()));
+    bpm->UnpinPage(i, false);
+  }
+
+  // Scenario: prefetched pages stay unpinned, and a page that is free on disk can still be handed out by NewPage
+  // after being asked for.
+  bpm->PrefetchPage(total_pages);
+  for (int i = 0; i < total_pages; i += 7) {
+    bpm->PrefetchPage(i);
+  }
+  auto *new_page = bpm->NewPage(page_id);
+  ASSERT_NE(nullptr, new_page);
+  EXPECT_EQ(total_pages, page_id);
+  EXPECT_EQ(0, *reinterpret_cast<int *>(new_page->GetData()));
+  bpm->UnpinPage(page_id, false);
+
+  // Scenario: a page freed on disk while still pinned in the pool is not handed out again, and stays reachable for
+  // its holder.
+  auto *pinned = bpm->FetchPage(3);
+  ASSERT_NE(nullptr, pinned);
+  disk_manager->DeAllocatePage(3);
+  EXPECT_EQ(nullptr, bpm->NewPage(page_id));
+  EXPECT_EQ(pinned, bpm->FetchPage(3));
+  bpm->UnpinPage(3, false);
+  bpm->UnpinPage(3, false);
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  disk_manager->Close();
+  delete disk_manager;
+  remove(db_name.c_str());
+}
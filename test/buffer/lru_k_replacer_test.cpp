@@ -0,0 +1,71 @@
+#include "buffer/lru_k_replacer.h"
+#include "gtest/gtest.h"
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(7, 2);
+
+  // Scenario: access frames 1..6 once, frame 1 a second time, and make them all evictable.
+  for (int i = 1; i <= 6; ++i) {
+    lru_k_replacer.Pin(i);
+  }
+  lru_k_replacer.Pin(1);
+  for (int i = 1; i <= 6; ++i) {
+    lru_k_replacer.Unpin(i);
+  }
+  lru_k_replacer.Unpin(1);
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // Scenario: frames with fewer than k accesses go first, in order of their first access. Frame 1 has been
+  // accessed twice, so it is kept even though it was touched first.
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+  EXPECT_EQ(3, lru_k_replacer.Size());
+
+  // Scenario: pinning removes a frame from the replacer and counts as an access; frame 5 now has two accesses.
+  lru_k_replacer.Pin(3);
+  lru_k_replacer.Pin(5);
+  EXPECT_EQ(2, lru_k_replacer.Size());
+  lru_k_replacer.Unpin(5);
+
+  // Scenario: 6 is the only frame with one access, then 1 has the oldest second-to-last access.
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(6, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(0, lru_k_replacer.Size());
+}
+
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  const int pool_size = 8;
+  LRUKReplacer lru_k_replacer(pool_size, 2);
+
+  // Frames 0 and 1 hold hot index pages that are accessed repeatedly.
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < 2; ++i) {
+      lru_k_replacer.Pin(i);
+      lru_k_replacer.Unpin(i);
+    }
+  }
+
+  // A sequential scan streams many pages through the remaining frames, each page accessed exactly once.
+  for (int i = 2; i < pool_size; ++i) {
+    lru_k_replacer.Pin(i);
+    lru_k_replacer.Unpin(i);
+  }
+  for (int page = 0; page < 100; ++page) {
+    int victim;
+    ASSERT_TRUE(lru_k_replacer.Victim(&victim));
+    EXPECT_GE(victim, 2);
+    lru_k_replacer.Pin(victim);
+    lru_k_replacer.Unpin(victim);
+  }
+  EXPECT_EQ(pool_size, lru_k_replacer.Size());
+}
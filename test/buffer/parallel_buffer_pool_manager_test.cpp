@@ -0,0 +1,151 @@
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(ParallelBufferPoolManagerTest, BinaryDataTest) {
+  const std::string db_name = "parallel_bpm_test.db";
+  const size_t num_instances = 4;
+  const size_t buffer_pool_size = 12;
+
+  std::random_device r;
+  std::default_random_engine rng(r());
+  std::uniform_int_distribution<char> uniform_dist(0);
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  EXPECT_EQ(buffer_pool_size, bpm->GetPoolSize());
+
+  page_id_t page_id_temp;
+  auto *page0 = bpm->NewPage(page_id_temp);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, page_id_temp);
+
+  char random_binary_data[PAGE_SIZE];
+  for (char &i : random_binary_data) {
+    i = uniform_dist(rng);
+  }
+  random_binary_data[PAGE_SIZE / 2] = '\0';
+  random_binary_data[PAGE_SIZE - 1] = '\0';
+  std::memcpy(page0->GetData(), random_binary_data, PAGE_SIZE);
+
+  // Scenario: page ids are handed out sequentially and spread over the instances until every frame is pinned.
+  for (size_t i = 1; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(page_id_temp));
+    EXPECT_EQ(i, page_id_temp);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(page_id_temp));
+  // A failed NewPage must give its page id back to the disk manager.
+  EXPECT_TRUE(bpm->IsPageFree(buffer_pool_size));
+
+  // Scenario: unpinning every page lets us evict them and bring page 0 back from disk.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_TRUE(bpm->UnpinPage(i, i == 0));
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(page_id_temp));
+    EXPECT_EQ(buffer_pool_size + i, page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  }
+  page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, memcmp(page0->GetData(), random_binary_data, PAGE_SIZE));
+  EXPECT_FALSE(bpm->DeletePage(0));
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+  EXPECT_TRUE(bpm->DeletePage(0));
+  EXPECT_TRUE(bpm->IsPageFree(0));
+
+  disk_manager->Close();
+  remove(db_name.c_str());
+  delete bpm;
+  delete disk_manager;
+}
+
+namespace {
+/**
+ * Run a fetch/unpin workload from several threads against bpm and return the number of operations per second.
+ * Every thread writes its own tag into the pages it touches and checks that the page still holds a valid tag.
+ */
+double RunConcurrentWorkload(BufferPoolManager *bpm, const std::vector<page_id_t> &page_ids, int num_threads,
+                             int ops_per_thread) {
+  std::vector<std::thread> threads;
+  std::atomic<int> failures{0};
+  auto start = std::chrono::steady_clock::now();
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t]() {
+      std::default_random_engine rng(t);
+      std::uniform_int_distribution<size_t> dist(0, page_ids.size() - 1);
+      for (int i = 0; i < ops_per_thread; i++) {
+        page_id_t page_id = page_ids[dist(rng)];
+        Page *page = bpm->FetchPage(page_id);
+        if (page == nullptr || page->GetPageId() != page_id) {
+          failures++;
+          continue;
+        }
+        page->WLatch();
+        *reinterpret_cast<page_id_t *>(page->GetData()) = page_id;
+        page->WUnlatch();
+        bpm->UnpinPage(page_id, true);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  EXPECT_EQ(0, failures.load());
+  return num_threads * ops_per_thread / elapsed;
+}
+}  // namespace
+
+TEST(ParallelBufferPoolManagerTest, ConcurrentThroughputTest) {
+  const std::string db_name = "parallel_bpm_throughput_test.db";
+  const size_t buffer_pool_size = 64;
+  const size_t num_pages = 256;
+  const int num_threads = 8;
+  const int ops_per_thread = 5000;
+
+  double throughput[2];
+  for (int round = 0; round < 2; round++) {
+    remove(db_name.c_str());
+    auto *disk_manager = new DiskManager(db_name);
+    BufferPoolManager *bpm;
+    if (round == 0) {
+      bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+    } else {
+      bpm = new ParallelBufferPoolManager(8, buffer_pool_size, disk_manager);
+    }
+    std::vector<page_id_t> page_ids;
+    for (size_t i = 0; i < num_pages; i++) {
+      page_id_t page_id;
+      ASSERT_NE(nullptr, bpm->NewPage(page_id));
+      page_ids.push_back(page_id);
+      bpm->UnpinPage(page_id, true);
+    }
+    throughput[round] = RunConcurrentWorkload(bpm, page_ids, num_threads, ops_per_thread);
+
+    // Every page must hold the tag of the last writer, which is always its own id.
+    for (auto page_id : page_ids) {
+      Page *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(page_id, *reinterpret_cast<page_id_t *>(page->GetData()));
+      bpm->UnpinPage(page_id, false);
+    }
+    EXPECT_TRUE(bpm->CheckAllUnpinned());
+    delete bpm;
+    disk_manager->Close();
+    delete disk_manager;
+    remove(db_name.c_str());
+  }
+  std::cout << "single instance: " << throughput[0] << " ops/s, 8 instances: " << throughput[1] << " ops/s"
+            << std::endl;
+}
@@ -39,6 +39,28 @@ TEST(CatalogTest, CatalogMetaTest) {
   delete other;
 }
 
+TEST(CatalogTest, TableMetaOldLayoutTest) {
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  std::string table_name = "table-1";
+  TableMetadata *meta = TableMetadata::Create(3, table_name, 7, 9, new Schema(columns));
+  char *buf = new char[PAGE_SIZE];
+  uint32_t size = meta->SerializeTo(buf);
+  // Metadata written before the free space map page id was stored: old magic number, no page id after the root
+  uint32_t fsm_offset = 3 * sizeof(uint32_t) + table_name.size() + sizeof(page_id_t);
+  MACH_WRITE_UINT32(buf, 344528);
+  memmove(buf + fsm_offset, buf + fsm_offset + sizeof(page_id_t), size - fsm_offset - sizeof(page_id_t));
+  TableMetadata *other = nullptr;
+  ASSERT_EQ(size - sizeof(page_id_t), TableMetadata::DeserializeFrom(buf, other));
+  EXPECT_EQ(3, other->GetTableId());
+  EXPECT_EQ(table_name, other->GetTableName());
+  EXPECT_EQ(7, other->GetFirstPageId());
+  EXPECT_EQ(INVALID_PAGE_ID, other->GetFreeSpaceMapPageId());
+  EXPECT_EQ(1, other->GetSchema()->GetColumnCount());
+  delete meta;
+  delete other;
+  delete[] buf;
+}
+
 TEST(CatalogTest, CatalogTableTest) {
   /** Stage 2: Testing simple operation */
   auto db_01 = new DBStorageEngine(db_file_name, true);
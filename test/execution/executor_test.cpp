@@ -109,6 +109,47 @@ TEST_F(ExecutorTest, SimpleRawInsertTest) {
   ASSERT_TRUE(result_set[0].GetField(2)->CompareEquals(Field(kTypeFloat, static_cast<float>(2.33))));
 }
 
+// INSERT INTO table-2 VALUES (1), (2); then (3), (2) and (3), (4), (3), with a unique index on id
+TEST_F(ExecutorTest, RawInsertUniqueIndexTest) {
+  TableInfo *table_info = nullptr;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, true)};
+  auto *schema = new Schema(columns);
+  ASSERT_EQ(DB_SUCCESS, GetExecutorContext()->GetCatalog()->CreateTable("table-2", schema, GetTxn(), table_info));
+  IndexInfo *index_info = nullptr;
+  std::vector<std::string> index_keys{"id"};
+  ASSERT_EQ(DB_SUCCESS, GetExecutorContext()->GetCatalog()->CreateIndex("table-2", "index-2", index_keys, GetTxn(),
+                                                                       index_info, "bptree"));
+  ASSERT_TRUE(index_info->IsUnique());
+
+  auto insert = [&](std::vector<int> ids) {
+    std::vector<std::vector<AbstractExpressionRef>> raw_values;
+    for (int id : ids) {
+      raw_values.push_back({MakeConstantValueExpression(Field(kTypeInt, id))});
+    }
+    auto value_plan = std::make_shared<ValuesPlanNode>(nullptr, raw_values);
+    auto insert_plan = std::make_shared<InsertPlanNode>(nullptr, value_plan, "table-2");
+    std::vector<Row> result_set{};
+    GetExecutionEngine()->ExecutePlan(insert_plan, &result_set, GetTxn(), GetExecutorContext());
+    return result_set.size();
+  };
+  ASSERT_EQ(2, insert({1, 2}));
+  // 2 is already in the index, so the whole batch is rejected before it reaches the table
+  ASSERT_EQ(0, insert({3, 2}));
+  // so is a batch that holds the same key twice
+  ASSERT_EQ(0, insert({3, 4, 3}));
+
+  auto scan_plan = std::make_shared<SeqScanPlanNode>(table_info->GetSchema(), "table-2", nullptr);
+  std::vector<Row> result_set{};
+  GetExecutionEngine()->ExecutePlan(scan_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(2, result_set.size());
+  std::vector<Field> fields;
+  fields.emplace_back(kTypeInt, 3);
+  Row key(fields);
+  std::vector<RowId> rids;
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index_info->GetIndex()->ScanKey(key, rids, GetTxn()));
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index_info->GetIndex()->ScanKey(key, rids, GetTxn(), ">"));
+}
+
 // UPDATE table-1 SET name = "minisql" where id = 500;
 TEST_F(ExecutorTest, SimpleUpdateTest) {
   // Construct a sequential scan of the table
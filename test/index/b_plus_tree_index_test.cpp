@@ -1,10 +1,16 @@
 #include "index/b_plus_tree_index.h"
 
+#include <algorithm>
+#include <map>
 #include <string>
+#include <vector>
 
 #include "common/instance.h"
 #include "gtest/gtest.h"
 #include "index/generic_key.h"
+#include "utils/external_sorter.h"
+#include "utils/parallel_sorter.h"
+#include "utils/utils.h"
 
 static const std::string db_name = "bp_tree_index_test.db";
 
@@ -66,4 +72,480 @@ TEST(BPlusTreeTests, BPlusTreeIndexSimpleTest) {
     i++;
   }
   delete index;
-}
\ No newline at end of file
+}
+TEST(BPlusTreeTests, NormalizedKeyOrderTest) {
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, true, false),
+                                   new Column("name", TypeId::kTypeChar, 8, 1, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 2, true, false)};
+  Schema schema(columns);
+  ASSERT_EQ(3 + 4 + 12 + 4, KeyManager::EncodedKeySize(&schema));
+  KeyManager KP(&schema, 32);
+
+  int ints[] = {INT32_MIN, -65537, -1, 0, 1, 255, 256, INT32_MAX};
+  const char *strs[] = {"", "\0", "a", "a\0", "ab", "b", "zzzzzzzz"};
+  uint32_t lens[] = {0, 1, 1, 2, 2, 1, 8};
+  float floats[] = {-1e30f, -2.5f, -0.0f, 0.0f, 1e-30f, 2.5f, 1e30f};
+  std::vector<std::vector<Field>> keys;
+  for (int i : ints) {
+    keys.push_back({Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, const_cast<char *>("k"), 1, false),
+                    Field(TypeId::kTypeFloat, 0.0f)});
+  }
+  for (int i = 0; i < 7; i++) {
+    keys.push_back({Field(TypeId::kTypeInt, 7), Field(TypeId::kTypeChar, const_cast<char *>(strs[i]), lens[i], false),
+                    Field(TypeId::kTypeFloat, floats[i])});
+  }
+  for (int i = 0; i < 7; i++) {
+    keys.push_back({Field(TypeId::kTypeInt, 7), Field(TypeId::kTypeChar, const_cast<char *>("m"), 1, false),
+                    Field(TypeId::kTypeFloat, floats[i])});
+  }
+  // Nulls sort before every other value of their column.
+  keys.push_back({Field(TypeId::kTypeInt), Field(TypeId::kTypeChar), Field(TypeId::kTypeFloat)});
+  keys.push_back({Field(TypeId::kTypeInt, 7), Field(TypeId::kTypeChar), Field(TypeId::kTypeFloat, 1.0f)});
+
+  std::vector<GenericKey *> encoded;
+  for (auto &fields : keys) {
+    encoded.push_back(KP.InitKey());
+    KP.SerializeFromKey(encoded.back(), Row(fields), &schema);
+  }
+  // memcmp order of the keys is the order of their fields, column by column.
+  auto expected_order = [](std::vector<Field> &lhs, std::vector<Field> &rhs) {
+    for (size_t c = 0; c < lhs.size(); c++) {
+      if (lhs[c].IsNull() || rhs[c].IsNull()) {
+        if (lhs[c].IsNull() != rhs[c].IsNull()) {
+          return lhs[c].IsNull() ? -1 : 1;
+        }
+        continue;
+      }
+      if (lhs[c].CompareLessThan(rhs[c]) == CmpBool::kTrue) {
+        return -1;
+      }
+      if (lhs[c].CompareGreaterThan(rhs[c]) == CmpBool::kTrue) {
+        return 1;
+      }
+    }
+    return 0;
+  };
+  for (size_t i = 0; i < keys.size(); i++) {
+    for (size_t j = 0; j < keys.size(); j++) {
+      int res = KP.CompareKeys(encoded[i], encoded[j]);
+      int expected = expected_order(keys[i], keys[j]);
+      EXPECT_EQ(expected, (res > 0) - (res < 0)) << "keys " << i << " and " << j;
+    }
+  }
+
+  // Keys decode back to the fields they were built from.
+  for (size_t i = 0; i < keys.size(); i++) {
+    Row decoded(INVALID_ROWID);
+    KP.DeserializeToKey(encoded[i], decoded, &schema);
+    ASSERT_EQ(3, decoded.GetFieldCount());
+    for (uint32_t c = 0; c < 3; c++) {
+      EXPECT_EQ(keys[i][c].IsNull(), decoded.GetField(c)->IsNull());
+      if (!keys[i][c].IsNull()) {
+        EXPECT_EQ(CmpBool::kTrue, decoded.GetField(c)->CompareEquals(keys[i][c]));
+      }
+    }
+    free(encoded[i]);
+  }
+}
+
+TEST(BPlusTreeTests, ExternalSorterTest) {
+  // Records are (key, sequence number) pairs; a 4 KB memory limit forces many runs to be merged
+  struct Record {
+    int key;
+    int seq;
+  };
+  auto less = [](const char *lhs, const char *rhs) {
+    return reinterpret_cast<const Record *>(lhs)->key < reinterpret_cast<const Record *>(rhs)->key;
+  };
+  const int n = 10000;
+  std::vector<int> keys;
+  for (int i = 0; i < n; i++) {
+    keys.push_back(i % 1000);
+  }
+  ShuffleArray(keys);
+  ExternalSorter<decltype(less)> sorter(sizeof(Record), less, 4096);
+  for (int i = 0; i < n; i++) {
+    Record record{keys[i], i};
+    sorter.Add(reinterpret_cast<const char *>(&record));
+  }
+  sorter.Finish();
+  ASSERT_LT(1, sorter.GetRunCount());
+  // Sorted by key, and stable: equal keys keep the order they were added in
+  Record last{-1, -1};
+  int count = 0;
+  for (char *data = sorter.Next(); data != nullptr; data = sorter.Next()) {
+    auto *record = reinterpret_cast<Record *>(data);
+    ASSERT_TRUE(last.key < record->key || (last.key == record->key && last.seq < record->seq));
+    last = *record;
+    count++;
+  }
+  ASSERT_EQ(n, count);
+}
+
+TEST(BPlusTreeTests, ParallelSorterTest) {
+  struct Record {
+    int key;
+    int seq;
+  };
+  auto less = [](const char *lhs, const char *rhs) {
+    return reinterpret_cast<const Record *>(lhs)->key < reinterpret_cast<const Record *>(rhs)->key;
+  };
+  const int n = 20000;
+  const size_t partitions = 4;
+  std::vector<int> keys;
+  for (int i = 0; i < n; i++) {
+    keys.push_back(i % 1500);
+  }
+  ShuffleArray(keys);
+  // Merged in memory by key ranges, and through a heap when the partitions spill to disk
+  for (size_t memory_limit : {size_t(INDEX_BUILD_SORT_MEMORY), size_t(16384)}) {
+    using Sorter = ParallelSorter<decltype(less)>;
+    Sorter sorter(sizeof(Record), partitions, less, memory_limit);
+    sorter.Sort([&](size_t index, Sorter::Partition &partition) {
+      for (size_t i = n * index / partitions; i < n * (index + 1) / partitions; i++) {
+        Record record{keys[i], static_cast<int>(i)};
+        partition.Add(reinterpret_cast<const char *>(&record));
+      }
+    });
+    // Sorted by key, equal keys in partition order and then in the order they were added
+    Record last{-1, -1};
+    int count = 0;
+    for (char *data = sorter.Next(); data != nullptr; data = sorter.Next()) {
+      auto *record = reinterpret_cast<Record *>(data);
+      ASSERT_TRUE(last.key < record->key || (last.key == record->key && last.seq < record->seq));
+      last = *record;
+      count++;
+    }
+    ASSERT_EQ(n, count);
+  }
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexBulkLoadTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, {0});
+  BPlusTreeIndex index(0, index_schema, 16, engine.bpm_);
+  // Shuffled keys, where every tenth key comes again later with another row id, which must be dropped
+  const int n = 30000;
+  std::vector<int> keys;
+  for (int i = 0; i < n; i++) {
+    keys.push_back(i);
+  }
+  ShuffleArray(keys);
+  for (int i = 0; i < n; i += 10) {
+    keys.push_back(i);
+  }
+  std::vector<RowId> first_rid(n);
+  for (size_t i = keys.size(); i-- > 0;) {
+    first_rid[keys[i]] = RowId(i);
+  }
+  // Four sources, each producing a consecutive slice of the keys on its own thread
+  const size_t num_sources = 4;
+  std::vector<size_t> pos(num_sources);
+  std::vector<Index::EntrySource> sources;
+  for (size_t s = 0; s < num_sources; s++) {
+    pos[s] = keys.size() * s / num_sources;
+    size_t end = keys.size() * (s + 1) / num_sources;
+    sources.emplace_back([&, s, end](Row &key, RowId &row_id) {
+      if (pos[s] == end) {
+        return false;
+      }
+      std::vector<Field> fields{Field(TypeId::kTypeInt, keys[pos[s]])};
+      Row(fields).GetKeyFromRow(&table_schema, index_schema, key);
+      row_id = RowId(pos[s]++);
+      return true;
+    });
+  }
+  ASSERT_EQ(DB_SUCCESS, index.BulkLoad(sources, nullptr));
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  int expected = 0;
+  for (auto iter = index.GetBeginIterator(); iter != index.GetEndIterator(); ++iter) {
+    ASSERT_EQ(first_rid[expected++].Get(), (*iter).second.Get());
+  }
+  ASSERT_EQ(n, expected);
+  // The built tree keeps working: removing two thirds of the keys merges pages, then they are inserted again
+  for (int i = 0; i < n; i++) {
+    if (i % 3 != 0) {
+      std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+      ASSERT_EQ(DB_SUCCESS, index.RemoveEntry(Row(fields), first_rid[i], nullptr));
+    }
+  }
+  for (int i = 0; i < n; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    std::vector<RowId> result;
+    ASSERT_EQ(i % 3 == 0 ? DB_SUCCESS : DB_KEY_NOT_FOUND, index.ScanKey(Row(fields), result, nullptr));
+    if (i % 3 != 0) {
+      ASSERT_EQ(DB_SUCCESS, index.InsertEntry(Row(fields), first_rid[i], nullptr));
+    }
+  }
+  for (int i = 0; i < n; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    std::vector<RowId> result;
+    ASSERT_EQ(DB_SUCCESS, index.ScanKey(Row(fields), result, nullptr));
+    ASSERT_EQ(first_rid[i].Get(), result[0].Get());
+  }
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+}
+
+TEST(BPlusTreeTests, NonUniqueIndexTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("status", TypeId::kTypeInt, 0, false, false)};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, {0});
+  BPlusTreeIndex index(0, index_schema, 16, engine.bpm_, false);
+  // Five statuses shared by many rows: the lists of the largest ones span several posting pages
+  const std::vector<int> counts{2000, 1, 2, 3, 700};
+  std::vector<std::pair<int, RowId>> entries;
+  for (int key = 0; key < static_cast<int>(counts.size()); key++) {
+    for (int i = 0; i < counts[key]; i++) {
+      entries.emplace_back(key, RowId(i / 50 + key * 1000, i % 50));
+    }
+  }
+  ShuffleArray(entries);
+  auto key_row = [](int key) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, key)};
+    return Row(fields);
+  };
+  for (auto &entry : entries) {
+    ASSERT_EQ(DB_SUCCESS, index.InsertEntry(key_row(entry.first), entry.second, nullptr));
+  }
+  ASSERT_EQ(DB_FAILED, index.InsertEntry(key_row(0), RowId(0, 0), nullptr));
+  // "=" returns every row of a key in row id order
+  auto check_key = [&](BPlusTreeIndex &idx, int key, int expected) {
+    std::vector<RowId> result;
+    ASSERT_EQ(expected > 0 ? DB_SUCCESS : DB_KEY_NOT_FOUND, idx.ScanKey(key_row(key), result, nullptr));
+    ASSERT_EQ(static_cast<size_t>(expected), result.size());
+    for (size_t i = 1; i < result.size(); i++) {
+      ASSERT_LT(result[i - 1].Get(), result[i].Get());
+    }
+  };
+  for (int key = 0; key < static_cast<int>(counts.size()); key++) {
+    check_key(index, key, counts[key]);
+  }
+  // A batch lookup returns the rows of each key in the order of the batch
+  std::vector<std::vector<RowId>> batch;
+  ASSERT_EQ(DB_SUCCESS, index.ScanKeys({key_row(4), key_row(9), key_row(0), key_row(4)}, batch, nullptr));
+  ASSERT_EQ(4u, batch.size());
+  ASSERT_EQ(std::vector<size_t>({700, 0, 2000, 700}),
+            std::vector<size_t>({batch[0].size(), batch[1].size(), batch[2].size(), batch[3].size()}));
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index.ScanKeys({key_row(-1), key_row(5)}, batch, nullptr));
+  // The iterator returns a key once for each of its rows, and range scans skip all rows of an excluded key
+  size_t total = 0;
+  for (auto iter = index.GetBeginIterator(); iter != index.GetEndIterator(); ++iter) {
+    total++;
+  }
+  ASSERT_EQ(entries.size(), total);
+  std::vector<RowId> result;
+  ASSERT_EQ(DB_SUCCESS, index.ScanKey(key_row(1), result, nullptr, ">"));
+  ASSERT_EQ(2u + 3 + 700, result.size());
+  result.clear();
+  ASSERT_EQ(DB_SUCCESS, index.ScanKey(key_row(0), result, nullptr, "<>"));
+  ASSERT_EQ(1u + 2 + 3 + 700, result.size());
+  // Removing rows shrinks the lists, a key goes away with its last row
+  for (auto &entry : entries) {
+    if (entry.first == 0 && entry.second.GetSlotNum() % 2 == 0) {
+      ASSERT_EQ(DB_SUCCESS, index.RemoveEntry(key_row(0), entry.second, nullptr));
+    }
+  }
+  check_key(index, 0, 1000);
+  index.RemoveEntry(key_row(2), RowId(2000, 0), nullptr);
+  check_key(index, 2, 1);
+  index.RemoveEntry(key_row(1), RowId(1000, 0), nullptr);
+  check_key(index, 1, 0);
+  index.RemoveEntry(key_row(3), RowId(1, 1), nullptr);
+  check_key(index, 3, 3);
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  // A bulk load gathers the rows of every key into its posting list
+  BPlusTreeIndex loaded(1, index_schema, 16, engine.bpm_, false);
+  size_t pos = 0;
+  std::vector<Index::EntrySource> sources{[&](Row &key, RowId &row_id) {
+    if (pos == entries.size()) {
+      return false;
+    }
+    key_row(entries[pos].first).GetKeyFromRow(&table_schema, index_schema, key);
+    row_id = entries[pos++].second;
+    return true;
+  }};
+  ASSERT_EQ(DB_SUCCESS, loaded.BulkLoad(sources, nullptr));
+  for (int key = 0; key < static_cast<int>(counts.size()); key++) {
+    check_key(loaded, key, counts[key]);
+  }
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexRangeScanTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, {0});
+  BPlusTreeIndex index(0, index_schema, 16, engine.bpm_);
+  // Even keys only, so that odd bounds fall between keys and often past the end of a leaf
+  const int n = 20000;
+  std::vector<int> keys;
+  for (int i = 0; i < n; i += 2) {
+    keys.push_back(i);
+  }
+  ShuffleArray(keys);
+  auto key_row = [](int key) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, key)};
+    return Row(fields);
+  };
+  for (int key : keys) {
+    ASSERT_EQ(DB_SUCCESS, index.InsertEntry(key_row(key), RowId(key, 0), nullptr));
+  }
+  // Every operator against a key that exists and one that does not
+  auto expected = [&](int key, const std::string &op) {
+    std::vector<int64_t> rids;
+    for (int i = 0; i < n; i += 2) {
+      if ((op == "<" && i < key) || (op == "<=" && i <= key) || (op == ">" && i > key) || (op == ">=" && i >= key) ||
+          (op == "<>" && i != key)) {
+        rids.push_back(RowId(i, 0).Get());
+      }
+    }
+    return rids;
+  };
+  for (int key : {-1, 0, 1, 5000, 5001, n - 2, n - 1, n + 1}) {
+    for (std::string op : {"<", "<=", ">", ">=", "<>"}) {
+      std::vector<RowId> result;
+      std::vector<int64_t> want = expected(key, op);
+      ASSERT_EQ(want.empty() ? DB_KEY_NOT_FOUND : DB_SUCCESS, index.ScanKey(key_row(key), result, nullptr, op));
+      ASSERT_EQ(want.size(), result.size()) << key << " " << op;
+      for (size_t i = 0; i < want.size(); i++) {
+        ASSERT_EQ(want[i], result[i].Get());
+      }
+    }
+  }
+  // Batches come leaf by leaf in key order, and the scan stops at the upper bound
+  Row lower = key_row(1001);
+  Row upper = key_row(9000);
+  IndexRangeIterator range = index.GetRangeIterator(&lower, true, &upper, true);
+  std::vector<RowId> batch;
+  int next = 1002;
+  int batches = 0;
+  while (range.NextBatch(batch)) {
+    batches++;
+    for (auto &rid : batch) {
+      ASSERT_EQ(RowId(next, 0).Get(), rid.Get());
+      next += 2;
+    }
+  }
+  ASSERT_EQ(9002, next);
+  ASSERT_GT(batches, 1);
+  ASSERT_TRUE(range.IsEnd());
+  // An iterator started at a missing key points at the next key, also where that key starts the next leaf
+  for (int key = 1; key < n; key += 2) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, key)};
+    alignas(8) char key_buf[KeyManager::MAX_KEY_SIZE];
+    KeyManager processor(index_schema, 16);
+    processor.SerializeFromKey(reinterpret_cast<GenericKey *>(key_buf), Row(fields), index_schema);
+    auto iter = index.GetBeginIterator(reinterpret_cast<GenericKey *>(key_buf));
+    if (key == n - 1) {
+      ASSERT_TRUE(iter == index.GetEndIterator());
+    } else {
+      ASSERT_EQ(RowId(key + 1, 0).Get(), (*iter).second.Get());
+    }
+  }
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexReverseScanTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, {0});
+  BPlusTreeIndex index(0, index_schema, 16, engine.bpm_, false);
+  auto key_row = [](int key) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, key)};
+    return Row(fields);
+  };
+  std::vector<RowId> result;
+  Row empty_max(INVALID_ROWID);
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index.ScanExtreme(true, empty_max, result, nullptr));
+  // Even keys, every hundredth one with a posting list, then a third of them removed so that leaves merge
+  const int n = 30000;
+  std::vector<int> keys;
+  for (int i = 0; i < n; i += 2) {
+    keys.push_back(i);
+  }
+  ShuffleArray(keys);
+  std::map<int, std::vector<int64_t>> rids;
+  for (int key : keys) {
+    for (int copy = 0; copy < (key % 100 == 0 ? 3 : 1); copy++) {
+      ASSERT_EQ(DB_SUCCESS, index.InsertEntry(key_row(key), RowId(key, copy), nullptr));
+      rids[key].push_back(RowId(key, copy).Get());
+    }
+  }
+  for (size_t i = 0; i < keys.size() / 3; i++) {
+    for (auto rid : rids[keys[i]]) {
+      ASSERT_EQ(DB_SUCCESS, index.RemoveEntry(key_row(keys[i]), RowId(rid), nullptr));
+    }
+    rids.erase(keys[i]);
+  }
+  // The reverse iterator returns the entries of the forward one backwards
+  std::vector<int64_t> forward;
+  for (auto iter = index.GetBeginIterator(); iter != index.GetEndIterator(); ++iter) {
+    forward.push_back((*iter).second.Get());
+  }
+  std::vector<int64_t> backward;
+  for (auto iter = index.GetRBeginIterator(); iter != index.GetEndIterator(); ++iter) {
+    backward.push_back((*iter).second.Get());
+  }
+  std::reverse(backward.begin(), backward.end());
+  ASSERT_EQ(forward, backward);
+  // A reverse iterator started at a missing key points at the previous key
+  KeyManager processor(index_schema, 16);
+  alignas(8) char key_buf[KeyManager::MAX_KEY_SIZE];
+  auto *index_key = reinterpret_cast<GenericKey *>(key_buf);
+  for (int key : {-1, 1, 5001, n - 1, n + 1}) {
+    processor.SerializeFromKey(index_key, key_row(key), index_schema);
+    auto iter = index.GetRBeginIterator(index_key);
+    auto prev = rids.lower_bound(key);
+    if (prev == rids.begin()) {
+      ASSERT_TRUE(iter == index.GetEndIterator());
+    } else {
+      ASSERT_EQ((--prev)->second.back(), (*iter).second.Get());
+    }
+  }
+  // Descending range scans come out in reverse key and row id order, and stop at the lower bound
+  for (auto bounds : std::vector<std::pair<int, int>>{{1001, 9000}, {1000, 9001}, {-1, n + 1}, {5000, 5000}}) {
+    for (bool inclusive : {true, false}) {
+      Row lower = key_row(bounds.first);
+      Row upper = key_row(bounds.second);
+      IndexRangeIterator range = index.GetRangeIterator(&lower, inclusive, &upper, inclusive, true);
+      std::vector<int64_t> want;
+      for (auto &entry : rids) {
+        if (inclusive ? entry.first >= bounds.first && entry.first <= bounds.second
+                      : entry.first > bounds.first && entry.first < bounds.second) {
+          want.insert(want.end(), entry.second.begin(), entry.second.end());
+        }
+      }
+      std::reverse(want.begin(), want.end());
+      std::vector<int64_t> got;
+      std::vector<RowId> batch;
+      while (range.NextBatch(batch)) {
+        for (auto &rid : batch) {
+          got.push_back(rid.Get());
+        }
+      }
+      ASSERT_EQ(want, got) << bounds.first << " " << bounds.second << " " << inclusive;
+    }
+  }
+  {
+    IndexRangeIterator open_range = index.GetRangeIterator(nullptr, false, nullptr, false, true);
+    std::vector<RowId> first_batch;
+    ASSERT_TRUE(open_range.NextBatch(first_batch));
+    ASSERT_EQ(rids.rbegin()->second.back(), first_batch[0].Get());
+  }
+  // MIN and MAX come from the edge leaves with all rows of their key
+  Row min_key(INVALID_ROWID);
+  ASSERT_EQ(DB_SUCCESS, index.ScanExtreme(false, min_key, result, nullptr));
+  ASSERT_EQ(CmpBool::kTrue, min_key.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, rids.begin()->first)));
+  ASSERT_EQ(rids.begin()->second.size(), result.size());
+  result.clear();
+  Row max_key(INVALID_ROWID);
+  ASSERT_EQ(DB_SUCCESS, index.ScanExtreme(true, max_key, result, nullptr));
+  ASSERT_EQ(CmpBool::kTrue, max_key.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, rids.rbegin()->first)));
+  ASSERT_EQ(rids.rbegin()->second.size(), result.size());
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+}
@@ -1,8 +1,12 @@
 #include "index/b_plus_tree.h"
 
+#include <atomic>
+#include <thread>
+
 #include "common/instance.h"
 #include "gtest/gtest.h"
 #include "index/comparator.h"
+#include "page/index_roots_page.h"
 #include "utils/tree_file_mgr.h"
 #include "utils/utils.h"
 
@@ -91,4 +95,491 @@ TEST(BPlusTreeTests, SampleTest) {
     ASSERT_TRUE(tree.GetValue(delete_seq[i], ans));
     ASSERT_EQ(kv_map[delete_seq[i]], ans[ans.size() - 1]);
   }
-}
\ No newline at end of file
+}
+
+TEST(BPlusTreeTests, ConcurrentTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {
+      new Column("int", TypeId::kTypeInt, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 16);
+  BPlusTree tree(0, engine.bpm_, KP);
+  const int num_threads = 4;
+  const int n = 20000;
+  vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    keys.push_back(key);
+  }
+  // Each thread inserts its own shuffled slice of the keys, so leaves and internal pages split under contention
+  vector<vector<int>> slices(num_threads);
+  for (int i = 0; i < n; i++) {
+    slices[i % num_threads].push_back(i);
+  }
+  for (auto &slice : slices) {
+    ShuffleArray(slice);
+  }
+  vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      for (int i : slices[t]) {
+        tree.Insert(keys[i], RowId(i));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+  ASSERT_TRUE(tree.Check());
+  // Threads holding even keys remove them while the others look up their odd keys, which must never be missed
+  // while leaves are merged and redistributed around them. A reverse scan meanwhile must not repeat keys moved
+  // into the leaf it goes on with.
+  std::atomic<int> missed{0};
+  std::atomic<int> unordered{0};
+  std::atomic<bool> done{false};
+  std::thread reader([&] {
+    while (!done) {
+      vector<RowId> result;
+      tree.ScanRange(nullptr, false, nullptr, false, result, nullptr, true);
+      for (size_t i = 1; i < result.size(); i++) {
+        if (result[i - 1].Get() <= result[i].Get()) {
+          unordered++;
+        }
+      }
+    }
+  });
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      vector<RowId> result;
+      for (int i : slices[t]) {
+        if (t % 2 == 0) {
+          tree.Remove(keys[i]);
+        } else if (!tree.GetValue(keys[i], result)) {
+          missed++;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  done = true;
+  reader.join();
+  ASSERT_EQ(0, missed.load());
+  ASSERT_EQ(0, unordered.load());
+  ASSERT_TRUE(tree.Check());
+  // Only the odd keys are left, in order
+  int i = 1;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    ASSERT_EQ(RowId(i), (*iter).second);
+    i += 2;
+  }
+  ASSERT_EQ(n + 1, i);
+  // The prev links kept up with the concurrent splits and merges
+  for (auto iter = tree.RBegin(); iter != tree.End(); ++iter) {
+    i -= 2;
+    ASSERT_EQ(RowId(i), (*iter).second);
+  }
+  ASSERT_EQ(1, i);
+  for (auto *key : keys) {
+    free(key);
+  }
+  delete table_schema;
+}
+
+TEST(BPlusTreeTests, ReverseScanSplitTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {
+      new Column("int", TypeId::kTypeInt, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 16);
+  BPlusTree tree(0, engine.bpm_, KP);
+  const int num_writers = 4;
+  const int n = 40000;
+  vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    keys.push_back(key);
+  }
+  for (int i = 0; i < n; i += 4) {
+    tree.Insert(keys[i], RowId(i));
+  }
+  // Writers fill in the keys between the multiples of 4, splitting the leaves that reverse scans step onto: every
+  // scan must still return all multiples of 4, strictly descending
+  std::atomic<bool> done{false};
+  std::atomic<int> missed{0};
+  std::atomic<int> unordered{0};
+  auto check = [&](const vector<int64_t> &result) {
+    int expected = n - 4;
+    for (size_t i = 0; i < result.size(); i++) {
+      if (i > 0 && result[i - 1] <= result[i]) {
+        unordered++;
+      }
+      if (result[i] == expected) {
+        expected -= 4;
+      }
+    }
+    if (expected != -4) {
+      missed++;
+    }
+  };
+  vector<std::thread> readers;
+  readers.emplace_back([&] {
+    while (!done) {
+      vector<RowId> rows;
+      tree.ScanRange(nullptr, false, nullptr, false, rows, nullptr, true);
+      vector<int64_t> result;
+      for (auto &rid : rows) {
+        result.push_back(rid.Get());
+      }
+      check(result);
+    }
+  });
+  readers.emplace_back([&] {
+    while (!done) {
+      vector<int64_t> result;
+      for (auto iter = tree.RBegin(); iter != tree.End(); ++iter) {
+        result.push_back((*iter).second.Get());
+      }
+      check(result);
+    }
+  });
+  vector<std::thread> writers;
+  for (int t = 0; t < num_writers; t++) {
+    writers.emplace_back([&, t] {
+      vector<int> slice;
+      for (int i = t; i < n; i += num_writers) {
+        if (i % 4 != 0) {
+          slice.push_back(i);
+        }
+      }
+      ShuffleArray(slice);
+      for (int i : slice) {
+        tree.Insert(keys[i], RowId(i));
+      }
+    });
+  }
+  for (auto &writer : writers) {
+    writer.join();
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  ASSERT_EQ(0, missed.load());
+  ASSERT_EQ(0, unordered.load());
+  ASSERT_TRUE(tree.Check());
+  for (auto *key : keys) {
+    free(key);
+  }
+  delete table_schema;
+}
+
+TEST(BPlusTreeTests, OptimisticLookupTest) {
+  // A write latch invalidates versions recorded before it, and optimistic reads fail while it is held
+  Page page;
+  uint64_t version;
+  ASSERT_TRUE(page.ReadVersion(version));
+  ASSERT_TRUE(page.ValidateVersion(version));
+  page.WLatch();
+  uint64_t locked_version;
+  ASSERT_FALSE(page.ReadVersion(locked_version));
+  ASSERT_TRUE(page.ValidateVersion(version + 1));
+  page.WUnlatch();
+  ASSERT_FALSE(page.ValidateVersion(version));
+
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {
+      new Column("int", TypeId::kTypeInt, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 16);
+  BPlusTree tree(0, engine.bpm_, KP);
+  const int n = 20000;
+  vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    keys.push_back(key);
+  }
+  for (int i = 0; i < n; i += 4) {
+    tree.Insert(keys[i], RowId(i));
+  }
+  // Writers insert and remove the other keys twice, splitting and merging the pages around the stable keys that
+  // readers keep looking up without latches: they must always be found, with their own values
+  std::atomic<bool> done{false};
+  std::atomic<int> wrong{0};
+  vector<std::thread> readers;
+  for (int t = 0; t < 2; t++) {
+    readers.emplace_back([&] {
+      while (!done) {
+        for (int i = 0; i < n; i += 4) {
+          vector<RowId> result;
+          if (!tree.GetValue(keys[i], result) || result[0].Get() != RowId(i).Get()) {
+            wrong++;
+          }
+        }
+      }
+    });
+  }
+  vector<std::thread> writers;
+  for (int t = 0; t < 2; t++) {
+    writers.emplace_back([&, t] {
+      vector<int> slice;
+      for (int i = t + 1; i < n; i += 2) {
+        if (i % 4 != 0) {
+          slice.push_back(i);
+        }
+      }
+      for (int round = 0; round < 2; round++) {
+        ShuffleArray(slice);
+        for (int i : slice) {
+          tree.Insert(keys[i], RowId(i));
+        }
+        for (int i : slice) {
+          tree.Remove(keys[i]);
+        }
+      }
+    });
+  }
+  for (auto &writer : writers) {
+    writer.join();
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  ASSERT_EQ(0, wrong.load());
+  ASSERT_TRUE(tree.Check());
+  int i = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    ASSERT_EQ(RowId(i), (*iter).second);
+    i += 4;
+  }
+  ASSERT_EQ(n, i);
+  for (auto *key : keys) {
+    free(key);
+  }
+  delete table_schema;
+}
+
+TEST(BPlusTreeTests, BatchLookupTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {
+      new Column("int", TypeId::kTypeInt, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 16);
+  BPlusTree tree(0, engine.bpm_, KP, UNDEFINED_SIZE, UNDEFINED_SIZE, false);
+  const int n = 30000;
+  vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    keys.push_back(key);
+  }
+  // Even keys are stable, every hundredth one with a posting list of three rows
+  for (int i = 0; i < n; i += 2) {
+    tree.Insert(keys[i], RowId(i));
+    if (i % 100 == 0) {
+      tree.Insert(keys[i], RowId(n + i));
+      tree.Insert(keys[i], RowId(2 * n + i));
+    }
+  }
+  // An unsorted batch with repeated and missing keys gets the same answers as single lookups, in its own order
+  vector<GenericKey *> probes;
+  for (int i = 0; i < n; i += 3) {
+    probes.push_back(keys[i]);
+  }
+  probes.push_back(keys[0]);
+  probes.push_back(keys[n - 1]);
+  ShuffleArray(probes);
+  vector<vector<RowId>> result;
+  size_t expected_found = 0;
+  ASSERT_EQ(0, tree.GetValues({}, result));
+  ASSERT_TRUE(result.empty());
+  for (auto *probe : probes) {
+    vector<RowId> values;
+    expected_found += tree.GetValue(probe, values) ? 1 : 0;
+  }
+  ASSERT_EQ(expected_found, tree.GetValues(probes, result));
+  ASSERT_EQ(probes.size(), result.size());
+  for (size_t i = 0; i < probes.size(); i++) {
+    vector<RowId> values;
+    tree.GetValue(probes[i], values);
+    ASSERT_EQ(values, result[i]);
+  }
+  ASSERT_TRUE(tree.Check());
+  // Writers insert and remove the odd keys, splitting and merging the pages under the shared path of readers that
+  // keep looking up all even keys in one batch
+  vector<GenericKey *> stable;
+  for (int i = 0; i < n; i += 2) {
+    stable.push_back(keys[i]);
+  }
+  std::atomic<bool> done{false};
+  std::atomic<int> wrong{0};
+  vector<std::thread> readers;
+  for (int t = 0; t < 2; t++) {
+    readers.emplace_back([&] {
+      while (!done) {
+        vector<vector<RowId>> values;
+        if (tree.GetValues(stable, values) != stable.size()) {
+          wrong++;
+          continue;
+        }
+        for (size_t i = 0; i < stable.size(); i++) {
+          if (values[i][0].Get() != RowId(2 * i).Get() || values[i].size() != (i % 50 == 0 ? 3u : 1u)) {
+            wrong++;
+          }
+        }
+      }
+    });
+  }
+  vector<std::thread> writers;
+  for (int t = 0; t < 2; t++) {
+    writers.emplace_back([&, t] {
+      vector<int> slice;
+      for (int i = 2 * t + 1; i < n; i += 4) {
+        slice.push_back(i);
+      }
+      ShuffleArray(slice);
+      for (int i : slice) {
+        tree.Insert(keys[i], RowId(i));
+      }
+      for (int i : slice) {
+        tree.Remove(keys[i]);
+      }
+    });
+  }
+  for (auto &writer : writers) {
+    writer.join();
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  ASSERT_EQ(0, wrong.load());
+  ASSERT_TRUE(tree.Check());
+  for (auto *key : keys) {
+    free(key);
+  }
+  delete table_schema;
+}
+
+// Check that every internal page below page_id has the internal page capacity and, below the root, its minimum size
+static void CheckInternalPages(BufferPoolManager *bpm, page_id_t page_id, int key_size, bool is_root, int &height) {
+  auto *node = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(page_id)->GetData());
+  height = 1;
+  if (!node->IsLeafPage()) {
+    auto *internal = reinterpret_cast<BPlusTreeInternalPage *>(node);
+    EXPECT_EQ(INTERNAL_PAGE_SIZE(key_size), internal->GetMaxSize());
+    if (!is_root) {
+      EXPECT_GE(internal->GetSize(), internal->GetMinSize());
+    }
+    for (int i = 0; i < internal->GetSize(); i++) {
+      CheckInternalPages(bpm, internal->ValueAt(i), key_size, false, height);
+    }
+    height++;
+  }
+  bpm->UnpinPage(page_id, false);
+}
+
+TEST(BPlusTreeTests, RootSplitRedistributeTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {
+      new Column("int", TypeId::kTypeInt, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  // Wide keys leave room for 8 entries in a leaf and 9 in an internal page, so a few hundred keys split the root
+  // internal page twice, growing the tree to four levels
+  const int key_size = 400;
+  KeyManager KP(table_schema, key_size);
+  BPlusTree tree(0, engine.bpm_, KP);
+  const int n = 600;
+  vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    keys.push_back(key);
+    tree.Insert(key, RowId(i));
+  }
+  auto check_pages = [&](int &height) {
+    page_id_t root_id;
+    auto *roots = reinterpret_cast<IndexRootsPage *>(engine.bpm_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
+    ASSERT_TRUE(roots->GetRootId(0, &root_id));
+    engine.bpm_->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
+    CheckInternalPages(engine.bpm_, root_id, key_size, true, height);
+  };
+  int height = 0;
+  check_pages(height);
+  ASSERT_EQ(4, height);
+  // Draining the leftmost pages merges them into their right siblings. Draining the next pages from the right then
+  // underflows an internal page next to such a merged page, which is too full to merge with, and has to lend entries
+  vector<int> order;
+  for (int i = 0; i < n / 4; i++) {
+    order.push_back(i);
+  }
+  for (int i = n / 2 - 1; i >= n / 4; i--) {
+    order.push_back(i);
+  }
+  for (int i : order) {
+    tree.Remove(keys[i]);
+    check_pages(height);
+  }
+  vector<RowId> result;
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(i >= n / 2, tree.GetValue(keys[i], result));
+  }
+  ASSERT_TRUE(tree.Check());
+  for (auto *key : keys) {
+    free(key);
+  }
+  delete table_schema;
+}
+
+TEST(BPlusTreeTests, PinnedPageReclaimTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {
+      new Column("int", TypeId::kTypeInt, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 400);
+  BPlusTree tree(0, engine.bpm_, KP);
+  const int n = 200;
+  vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    keys.push_back(key);
+    tree.Insert(key, RowId(i));
+  }
+  {
+    // An iterator keeps its leaf pinned while the keys around it are removed and the leaf is merged away
+    auto iter = tree.Begin(keys[n / 2]);
+    for (int i = n / 2 + 20; i >= n / 2 - 20; i--) {
+      tree.Remove(keys[i]);
+    }
+    ASSERT_EQ(1, tree.GetPendingDeleteCount());
+  }
+  // The next write set frees the page once the iterator is gone
+  for (int i = 0; i < 10; i++) {
+    tree.Remove(keys[i]);
+  }
+  ASSERT_EQ(0, tree.GetPendingDeleteCount());
+  ASSERT_TRUE(tree.Check());
+  for (auto *key : keys) {
+    free(key);
+  }
+  delete table_schema;
+}
@@ -0,0 +1,508 @@
+#include "index/fixed_key_b_plus_tree_index.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <thread>
+
+#include "common/instance.h"
+#include "gtest/gtest.h"
+#include "index/b_plus_tree.h"
+#include "index/generic_key.h"
+#include "utils/utils.h"
+
+static const std::string db_name = "fixed_key_bp_tree_test.db";
+
+static std::vector<RowId> ExpectedScan(const std::map<int, RowId> &kv_map, int key, const std::string &op) {
+  std::vector<RowId> expected;
+  for (auto &kv : kv_map) {
+    if ((op == "=" && kv.first == key) || (op == ">" && kv.first > key) || (op == ">=" && kv.first >= key) ||
+        (op == "<" && kv.first < key) || (op == "<=" && kv.first <= key) || (op == "<>" && kv.first != key)) {
+      expected.push_back(kv.second);
+    }
+  }
+  return expected;
+}
+
+TEST(BPlusTreeTests, FixedKeySearchTest) {
+  // The SIMD search agrees with lower_bound and upper_bound for every array size up to a full page, with keys
+  // probed between, on and beyond the stored ones
+  std::vector<int32_t> ints;
+  std::vector<float> floats;
+  for (int n = 0; n <= FixedKeyInternalPage<int32_t>::MAX_SIZE; n += (n < 40 ? 1 : 37)) {
+    ints.clear();
+    floats.clear();
+    for (int i = 0; i < n; i++) {
+      ints.push_back(2 * i - n);
+      floats.push_back(0.5f * (2 * i - n));
+    }
+    for (int probe = -n - 2; probe <= n + 2; probe++) {
+      int32_t int_key = probe;
+      float float_key = 0.5f * probe;
+      ASSERT_EQ(std::lower_bound(ints.begin(), ints.end(), int_key) - ints.begin(),
+                FixedKeySearch::Search<false>(ints.data(), n, int_key));
+      ASSERT_EQ(std::upper_bound(ints.begin(), ints.end(), int_key) - ints.begin(),
+                FixedKeySearch::Search<true>(ints.data(), n, int_key));
+      ASSERT_EQ(std::lower_bound(floats.begin(), floats.end(), float_key) - floats.begin(),
+                FixedKeySearch::Search<false>(floats.data(), n, float_key));
+      ASSERT_EQ(std::upper_bound(floats.begin(), floats.end(), float_key) - floats.begin(),
+                FixedKeySearch::Search<true>(floats.data(), n, float_key));
+    }
+  }
+}
+
+TEST(BPlusTreeTests, FixedKeyIndexTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  const TableSchema table_schema(columns);
+  auto *key_schema = Schema::ShallowCopySchema(&table_schema, {0});
+  FixedKeyBPlusTreeIndex<int32_t> index(0, key_schema, engine.bpm_);
+  // Insert shuffled keys, negative ones included, so that leaves and internal pages split
+  const int n = 20000;
+  std::vector<int> keys;
+  for (int i = 0; i < n; i++) {
+    keys.push_back(2 * (i - n / 2));
+  }
+  ShuffleArray(keys);
+  std::map<int, RowId> kv_map;
+  for (int i = 0; i < n; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, keys[i])};
+    RowId rid(i / 100, i % 100);
+    ASSERT_EQ(DB_SUCCESS, index.InsertEntry(Row(fields), rid, nullptr));
+    kv_map.emplace(keys[i], rid);
+  }
+  // Duplicate keys are rejected
+  std::vector<Field> dup_fields{Field(TypeId::kTypeInt, keys[0])};
+  ASSERT_EQ(DB_FAILED, index.InsertEntry(Row(dup_fields), RowId(0, 0), nullptr));
+  // Remove a third of the keys
+  for (int i = 0; i < n / 3; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, keys[i])};
+    ASSERT_EQ(DB_SUCCESS, index.RemoveEntry(Row(fields), kv_map[keys[i]], nullptr));
+    kv_map.erase(keys[i]);
+  }
+  // Every operator agrees with the map, for present keys, removed keys, gaps and keys out of range
+  std::vector<int> probes{-n - 10, -n, keys[0], keys[n / 3], keys[n - 1], 1, 0, n - 2, n + 10};
+  for (int probe : probes) {
+    for (const std::string op : {"=", ">", ">=", "<", "<=", "<>"}) {
+      std::vector<Field> fields{Field(TypeId::kTypeInt, probe)};
+      std::vector<RowId> result;
+      dberr_t err = index.ScanKey(Row(fields), result, nullptr, op);
+      std::vector<RowId> expected = ExpectedScan(kv_map, probe, op);
+      ASSERT_EQ(expected.empty() ? DB_KEY_NOT_FOUND : DB_SUCCESS, err) << probe << " " << op;
+      ASSERT_EQ(expected.size(), result.size()) << probe << " " << op;
+      for (size_t i = 0; i < expected.size(); i++) {
+        ASSERT_EQ(expected[i].Get(), result[i].Get());
+      }
+    }
+  }
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  // Destroy frees the tree, which can be filled again afterwards
+  ASSERT_EQ(DB_SUCCESS, index.Destroy());
+  std::vector<Field> fields{Field(TypeId::kTypeInt, 1)};
+  std::vector<RowId> result;
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index.ScanKey(Row(fields), result, nullptr, ">="));
+  ASSERT_EQ(DB_SUCCESS, index.InsertEntry(Row(fields), RowId(1, 1), nullptr));
+  ASSERT_EQ(DB_SUCCESS, index.ScanKey(Row(fields), result, nullptr));
+}
+
+TEST(BPlusTreeTests, FixedKeyFloatIndexTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("account", TypeId::kTypeFloat, 0, false, false)};
+  const TableSchema table_schema(columns);
+  auto *key_schema = Schema::ShallowCopySchema(&table_schema, {0});
+  FixedKeyBPlusTreeIndex<float> index(0, key_schema, engine.bpm_);
+  for (int i = 0; i < 1000; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeFloat, (i - 500) * 0.5f)};
+    ASSERT_EQ(DB_SUCCESS, index.InsertEntry(Row(fields), RowId(0, i), nullptr));
+  }
+  std::vector<Field> fields{Field(TypeId::kTypeFloat, -0.25f)};
+  std::vector<RowId> result;
+  ASSERT_EQ(DB_SUCCESS, index.ScanKey(Row(fields), result, nullptr, "<"));
+  ASSERT_EQ(500, result.size());
+  for (int i = 0; i < 500; i++) {
+    ASSERT_EQ(RowId(0, i).Get(), result[i].Get());
+  }
+}
+
+TEST(BPlusTreeTests, FixedKeyNonUniqueIndexTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("status", TypeId::kTypeInt, 0, false, false)};
+  const TableSchema table_schema(columns);
+  auto *key_schema = Schema::ShallowCopySchema(&table_schema, {0});
+  FixedKeyBPlusTreeIndex<int32_t> index(0, key_schema, engine.bpm_, false);
+  // 100 keys shared by 50 rows each, so that the row ids of a key go to its posting list
+  for (int i = 0; i < 5000; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i % 100)};
+    ASSERT_EQ(DB_SUCCESS, index.InsertEntry(Row(fields), RowId(0, i), nullptr));
+  }
+  std::vector<Field> fields{Field(TypeId::kTypeInt, 7)};
+  Row key(fields);
+  ASSERT_EQ(DB_FAILED, index.InsertEntry(key, RowId(0, 7), nullptr));
+  std::vector<RowId> result;
+  ASSERT_EQ(DB_SUCCESS, index.ScanKey(key, result, nullptr));
+  ASSERT_EQ(50, result.size());
+  for (int i = 0; i < 50; i++) {
+    ASSERT_EQ(RowId(0, 7 + 100 * i).Get(), result[i].Get());
+  }
+  // Removing a row keeps the other rows of its key
+  ASSERT_EQ(DB_SUCCESS, index.RemoveEntry(key, RowId(0, 107), nullptr));
+  result.clear();
+  ASSERT_EQ(DB_SUCCESS, index.ScanKey(key, result, nullptr));
+  ASSERT_EQ(49, result.size());
+  result.clear();
+  std::vector<Field> lower_fields{Field(TypeId::kTypeInt, 95)};
+  ASSERT_EQ(DB_SUCCESS, index.ScanKey(Row(lower_fields), result, nullptr, ">="));
+  ASSERT_EQ(250, result.size());
+}
+
+TEST(BPlusTreeTests, FixedKeyBulkLoadTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  const TableSchema table_schema(columns);
+  auto *key_schema = Schema::ShallowCopySchema(&table_schema, {0});
+  FixedKeyBPlusTreeIndex<int32_t> index(0, key_schema, engine.bpm_);
+  // Shuffled keys with repeats: the first row id of every key is kept
+  const int n = 50000;
+  std::vector<int> keys;
+  for (int i = 0; i < n; i++) {
+    keys.push_back(3 * (i - n / 2));
+  }
+  ShuffleArray(keys);
+  for (int i = 0; i < n; i += 7) {
+    keys.push_back(keys[i]);
+  }
+  std::map<int, RowId> kv_map;
+  for (size_t i = 0; i < keys.size(); i++) {
+    kv_map.emplace(keys[i], RowId(i));
+  }
+  size_t pos = 0;
+  ASSERT_EQ(DB_SUCCESS, index.BulkLoad({[&](Row &key, RowId &row_id) {
+                                         if (pos == keys.size()) {
+                                           return false;
+                                         }
+                                         std::vector<Field> fields{Field(TypeId::kTypeInt, keys[pos])};
+                                         Row(fields).GetKeyFromRow(&table_schema, key_schema, key);
+                                         row_id = RowId(pos++);
+                                         return true;
+                                       }},
+                                       nullptr));
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  // Inserting into the full pages splits them as usual
+  for (int i = 0; i < 1000; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, 3 * i + 1)};
+    ASSERT_EQ(DB_SUCCESS, index.InsertEntry(Row(fields), RowId(n + i), nullptr));
+    kv_map.emplace(3 * i + 1, RowId(n + i));
+  }
+  std::vector<int> probes{-3 * n, keys[0], keys[n / 2], 0, 1, 2, 3 * n};
+  for (int probe : probes) {
+    for (const std::string op : {"=", ">", ">=", "<", "<=", "<>"}) {
+      std::vector<Field> fields{Field(TypeId::kTypeInt, probe)};
+      std::vector<RowId> result;
+      index.ScanKey(Row(fields), result, nullptr, op);
+      std::vector<RowId> expected = ExpectedScan(kv_map, probe, op);
+      ASSERT_EQ(expected.size(), result.size()) << probe << " " << op;
+      for (size_t i = 0; i < expected.size(); i++) {
+        ASSERT_EQ(expected[i].Get(), result[i].Get());
+      }
+    }
+  }
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+}
+
+TEST(BPlusTreeTests, FixedKeyConcurrentTest) {
+  DBStorageEngine engine(db_name);
+  FixedKeyBPlusTree<int32_t> tree(0, engine.bpm_);
+  const int num_writers = 4;
+  const int n = 40000;
+  // Writers insert interleaved shuffled slices, then remove all keys not divisible by 4 so that leaves merge, while
+  // readers keep scanning forwards and backwards: every scan must come out strictly ordered
+  std::atomic<bool> done{false};
+  std::atomic<int> unordered{0};
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 2; t++) {
+    readers.emplace_back([&, t] {
+      bool reverse = t == 1;
+      while (!done) {
+        std::vector<RowId> result;
+        tree.ScanRange(nullptr, false, nullptr, false, result, nullptr, reverse);
+        for (size_t i = 1; i < result.size(); i++) {
+          if (reverse ? result[i - 1].Get() <= result[i].Get() : result[i - 1].Get() >= result[i].Get()) {
+            unordered++;
+          }
+        }
+      }
+    });
+  }
+  std::vector<std::thread> writers;
+  for (int t = 0; t < num_writers; t++) {
+    writers.emplace_back([&, t] {
+      std::vector<int> slice;
+      for (int i = t; i < n; i += num_writers) {
+        slice.push_back(i);
+      }
+      ShuffleArray(slice);
+      for (int i : slice) {
+        tree.Insert(i, RowId(i));
+      }
+      for (int i : slice) {
+        if (i % 4 != 0) {
+          tree.Remove(i);
+        }
+      }
+    });
+  }
+  for (auto &writer : writers) {
+    writer.join();
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  ASSERT_EQ(0, unordered.load());
+  ASSERT_TRUE(tree.Check());
+  std::vector<RowId> result;
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(i % 4 == 0, tree.GetValue(i, result));
+  }
+  result.clear();
+  tree.ScanRange(nullptr, false, nullptr, false, result);
+  ASSERT_EQ(n / 4, result.size());
+}
+
+TEST(BPlusTreeTests, FixedKeyReverseScanSplitTest) {
+  DBStorageEngine engine(db_name);
+  FixedKeyBPlusTree<int32_t> tree(0, engine.bpm_);
+  const int num_writers = 4;
+  const int n = 40000;
+  for (int i = 0; i < n; i += 4) {
+    tree.Insert(i, RowId(i));
+  }
+  // Writers fill in the keys between the multiples of 4, splitting the leaves that a reverse scan steps onto: every
+  // scan must still return all multiples of 4, strictly descending
+  std::atomic<bool> done{false};
+  std::atomic<int> missed{0};
+  std::atomic<int> unordered{0};
+  std::thread reader([&] {
+    while (!done) {
+      std::vector<RowId> result;
+      tree.ScanRange(nullptr, false, nullptr, false, result, nullptr, true);
+      int expected = n - 4;
+      for (size_t i = 0; i < result.size(); i++) {
+        if (i > 0 && result[i - 1].Get() <= result[i].Get()) {
+          unordered++;
+        }
+        if (result[i].Get() == expected) {
+          expected -= 4;
+        }
+      }
+      if (expected != -4) {
+        missed++;
+      }
+    }
+  });
+  std::vector<std::thread> writers;
+  for (int t = 0; t < num_writers; t++) {
+    writers.emplace_back([&, t] {
+      std::vector<int> slice;
+      for (int i = t; i < n; i += num_writers) {
+        if (i % 4 != 0) {
+          slice.push_back(i);
+        }
+      }
+      ShuffleArray(slice);
+      for (int i : slice) {
+        tree.Insert(i, RowId(i));
+      }
+    });
+  }
+  for (auto &writer : writers) {
+    writer.join();
+  }
+  done = true;
+  reader.join();
+  ASSERT_EQ(0, missed.load());
+  ASSERT_EQ(0, unordered.load());
+  ASSERT_TRUE(tree.Check());
+}
+
+TEST(BPlusTreeTests, FixedKeyMergeTest) {
+  DBStorageEngine engine(db_name);
+  FixedKeyBPlusTree<int32_t> tree(0, engine.bpm_);
+  const int n = 30000;
+  std::vector<int> keys;
+  for (int i = 0; i < n; i++) {
+    keys.push_back(i);
+  }
+  ShuffleArray(keys);
+  for (int key : keys) {
+    ASSERT_TRUE(tree.Insert(key, RowId(key)));
+  }
+  int height = tree.GetHeight();
+  ASSERT_GE(height, 2);
+  // Removing a pair compares the row id
+  ASSERT_FALSE(tree.Remove(keys[0], RowId(keys[0] + 1)));
+  // Removing all but a few keys merges the leaves and lowers the tree
+  for (int i = 0; i < n - 10; i++) {
+    ASSERT_TRUE(tree.Remove(keys[i], RowId(keys[i])));
+  }
+  ASSERT_EQ(1, tree.GetHeight());
+  ASSERT_EQ(0, tree.GetPendingDeleteCount());
+  std::vector<int> left(keys.end() - 10, keys.end());
+  std::sort(left.begin(), left.end());
+  std::vector<RowId> result;
+  tree.ScanRange(nullptr, false, nullptr, false, result);
+  ASSERT_EQ(left.size(), result.size());
+  for (size_t i = 0; i < left.size(); i++) {
+    ASSERT_EQ(RowId(left[i]).Get(), result[i].Get());
+  }
+  for (int key : left) {
+    ASSERT_TRUE(tree.Remove(key));
+  }
+  ASSERT_TRUE(tree.IsEmpty());
+  ASSERT_TRUE(tree.Check());
+}
+
+TEST(BPlusTreeTests, FixedKeyReverseAndExtremeTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  const TableSchema table_schema(columns);
+  auto *key_schema = Schema::ShallowCopySchema(&table_schema, {0});
+  FixedKeyBPlusTreeIndex<int32_t> index(0, key_schema, engine.bpm_);
+  Row key(INVALID_ROWID);
+  std::vector<RowId> result;
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index.ScanExtreme(false, key, result, nullptr));
+  const int n = 10000;
+  std::vector<int> keys;
+  for (int i = 0; i < n; i++) {
+    keys.push_back(2 * i);
+  }
+  ShuffleArray(keys);
+  for (int k : keys) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, k)};
+    ASSERT_EQ(DB_SUCCESS, index.InsertEntry(Row(fields), RowId(k), nullptr));
+  }
+  // Emptied leaves at both ends are skipped
+  for (int i = 0; i < 600; i++) {
+    std::vector<Field> low{Field(TypeId::kTypeInt, 2 * i)};
+    std::vector<Field> high{Field(TypeId::kTypeInt, 2 * (n - 1 - i))};
+    ASSERT_EQ(DB_SUCCESS, index.RemoveEntry(Row(low), RowId(2 * i), nullptr));
+    ASSERT_EQ(DB_SUCCESS, index.RemoveEntry(Row(high), RowId(2 * (n - 1 - i)), nullptr));
+  }
+  ASSERT_EQ(DB_SUCCESS, index.ScanExtreme(false, key, result, nullptr));
+  ASSERT_EQ(1, result.size());
+  ASSERT_EQ(RowId(1200).Get(), result[0].Get());
+  ASSERT_EQ(CmpBool::kTrue, key.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, 1200)));
+  Row max_key(INVALID_ROWID);
+  result.clear();
+  ASSERT_EQ(DB_SUCCESS, index.ScanExtreme(true, max_key, result, nullptr));
+  ASSERT_EQ(CmpBool::kTrue, max_key.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, 2 * (n - 601))));
+  // A reverse range returns the keys in descending order
+  std::vector<Field> lower_fields{Field(TypeId::kTypeInt, 3001)};
+  std::vector<Field> upper_fields{Field(TypeId::kTypeInt, 9000)};
+  Row lower(lower_fields);
+  Row upper(upper_fields);
+  {
+    auto iter = index.GetRangeIterator(&lower, true, &upper, false, true);
+    std::vector<RowId> batch;
+    result.clear();
+    while (iter.NextBatch(batch)) {
+      result.insert(result.end(), batch.begin(), batch.end());
+    }
+    ASSERT_EQ((8998 - 3002) / 2 + 1, result.size());
+    for (size_t i = 0; i < result.size(); i++) {
+      ASSERT_EQ(RowId(8998 - 2 * i).Get(), result[i].Get());
+    }
+  }
+  // A batch lookup matches single lookups, for keys given in any order. The dense run of keys goes on from leaf to
+  // leaf, the others are far apart.
+  std::vector<int> probe_keys{5000, 1, 0, 3000, 19998, 1201, 1200};
+  for (int k = 7000; k < 12000; k += 37) {
+    probe_keys.push_back(k);
+  }
+  ShuffleArray(probe_keys);
+  std::vector<Row> probes;
+  for (int k : probe_keys) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, k)};
+    probes.emplace_back(fields);
+  }
+  std::vector<std::vector<RowId>> found;
+  ASSERT_EQ(DB_SUCCESS, index.ScanKeys(probes, found, nullptr));
+  ASSERT_EQ(probes.size(), found.size());
+  for (size_t i = 0; i < probes.size(); i++) {
+    std::vector<RowId> single;
+    index.ScanKey(probes[i], single, nullptr);
+    ASSERT_EQ(single.size(), found[i].size());
+    for (size_t j = 0; j < single.size(); j++) {
+      ASSERT_EQ(single[j].Get(), found[i][j].Get());
+    }
+  }
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+}
+
+// Compare the fixed key tree with the generic tree on the same single int column: both return the same values,
+// and the insert and lookup timings of both are printed
+TEST(BPlusTreeTests, FixedKeyBenchmarkTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  Schema *table_schema = new Schema(columns);
+  const int n = 50000;
+  std::vector<int> keys;
+  for (int i = 0; i < n; i++) {
+    keys.push_back(i);
+  }
+  ShuffleArray(keys);
+  auto seconds_since = [](std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  };
+
+  KeyManager KP(table_schema, 16);
+  BPlusTree generic_tree(0, engine.bpm_, KP);
+  std::vector<GenericKey *> generic_keys;
+  for (int i = 0; i < n; i++) {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, keys[i])};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    generic_keys.push_back(key);
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < n; i++) {
+    generic_tree.Insert(generic_keys[i], RowId(keys[i]));
+  }
+  double generic_insert = seconds_since(start);
+  std::vector<RowId> generic_result;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < n; i++) {
+    generic_tree.GetValue(generic_keys[i], generic_result);
+  }
+  double generic_lookup = seconds_since(start);
+
+  FixedKeyBPlusTree<int32_t> fixed_tree(1, engine.bpm_);
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < n; i++) {
+    fixed_tree.Insert(keys[i], RowId(keys[i]));
+  }
+  double fixed_insert = seconds_since(start);
+  std::vector<RowId> fixed_result;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < n; i++) {
+    fixed_tree.GetValue(keys[i], fixed_result);
+  }
+  double fixed_lookup = seconds_since(start);
+
+  ASSERT_EQ(n, generic_result.size());
+  ASSERT_EQ(n, fixed_result.size());
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(generic_result[i].Get(), fixed_result[i].Get());
+  }
+  ASSERT_TRUE(fixed_tree.Check());
+  std::cout << "generic tree: " << n / generic_insert << " inserts/s, " << n / generic_lookup << " lookups/s"
+            << std::endl;
+  std::cout << "fixed key tree: " << n / fixed_insert << " inserts/s, " << n / fixed_lookup << " lookups/s"
+            << std::endl;
+  for (auto *key : generic_keys) {
+    free(key);
+  }
+  delete table_schema;
+}
@@ -0,0 +1,330 @@
+#include "index/slotted_b_plus_tree_index.h"
+
+#include <atomic>
+#include <cstdio>
+#include <map>
+#include <thread>
+
+#include "common/instance.h"
+#include "gtest/gtest.h"
+#include "utils/utils.h"
+
+static const std::string db_name = "slotted_bp_tree_test.db";
+
+static std::vector<RowId> ExpectedScan(const std::multimap<std::string, RowId> &kv_map, const std::string &key,
+                                       const std::string &op) {
+  std::vector<RowId> expected;
+  for (auto &kv : kv_map) {
+    if ((op == "=" && kv.first == key) || (op == ">" && kv.first > key) || (op == ">=" && kv.first >= key) ||
+        (op == "<" && kv.first < key) || (op == "<=" && kv.first <= key) || (op == "<>" && kv.first != key)) {
+      expected.push_back(kv.second);
+    }
+  }
+  return expected;
+}
+
+static Row CharRow(const std::string &key) {
+  std::vector<Field> fields{Field(TypeId::kTypeChar, const_cast<char *>(key.data()), key.size(), true)};
+  return Row(fields);
+}
+
+// Scan with every operator and compare with the map, which orders strings like the index: byte-wise, a prefix first
+static void CheckScans(SlottedBPlusTreeIndex &index, const std::multimap<std::string, RowId> &kv_map,
+                       const std::vector<std::string> &probes) {
+  for (auto &probe : probes) {
+    for (const std::string op : {"=", ">", ">=", "<", "<=", "<>"}) {
+      std::vector<RowId> result;
+      dberr_t err = index.ScanKey(CharRow(probe), result, nullptr, op);
+      std::vector<RowId> expected = ExpectedScan(kv_map, probe, op);
+      ASSERT_EQ(expected.empty() ? DB_KEY_NOT_FOUND : DB_SUCCESS, err) << probe << " " << op;
+      ASSERT_EQ(expected.size(), result.size()) << probe << " " << op;
+      for (size_t i = 0; i < expected.size(); i++) {
+        ASSERT_EQ(expected[i].Get(), result[i].Get()) << probe << " " << op;
+      }
+    }
+  }
+}
+
+TEST(BPlusTreeTests, SlottedKeyIndexTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("name", TypeId::kTypeChar, 128, 0, false, true)};
+  const TableSchema table_schema(columns);
+  auto *key_schema = Schema::ShallowCopySchema(&table_schema, {0});
+  SlottedBPlusTreeIndex index(0, key_schema, engine.bpm_);
+  // Keys of varying length sharing long prefixes, some of them prefixes of others or holding zero bytes
+  const int n = 20000;
+  std::vector<std::string> keys;
+  char buf[32];
+  for (int i = 0; i < n; i++) {
+    snprintf(buf, sizeof(buf), "customer-%d", i);
+    keys.emplace_back(buf);
+  }
+  keys.emplace_back("customer-1\0", 11);
+  keys.emplace_back("customer-1\0\0", 12);
+  keys.emplace_back(std::string(128, 'z'));
+  keys.emplace_back("");
+  ShuffleArray(keys);
+  std::multimap<std::string, RowId> kv_map;
+  for (size_t i = 0; i < keys.size(); i++) {
+    RowId rid(i / 100, i % 100);
+    ASSERT_EQ(DB_SUCCESS, index.InsertEntry(CharRow(keys[i]), rid, nullptr));
+    kv_map.emplace(keys[i], rid);
+  }
+  // Duplicate keys are rejected
+  ASSERT_EQ(DB_FAILED, index.InsertEntry(CharRow(keys[0]), RowId(0, 0), nullptr));
+  // Remove a third of the keys
+  for (size_t i = 0; i < keys.size() / 3; i++) {
+    ASSERT_EQ(DB_SUCCESS, index.RemoveEntry(CharRow(keys[i]), kv_map.find(keys[i])->second, nullptr));
+    kv_map.erase(keys[i]);
+  }
+  std::vector<std::string> probes{"", "a", "customer-", "customer-1", std::string("customer-1\0", 11), keys[0],
+                                  keys[keys.size() / 2], keys.back(), "customer-99999", std::string(128, 'z')};
+  CheckScans(index, kv_map, probes);
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  ASSERT_EQ(DB_SUCCESS, index.Destroy());
+  std::vector<RowId> result;
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index.ScanKey(CharRow("customer-1"), result, nullptr, ">="));
+}
+
+TEST(BPlusTreeTests, SlottedKeyFanoutTest) {
+  // 20000 short keys of a char(128) column: slots sized for 128-byte keys hold about 15 keys per page, which
+  // takes four levels, while the slotted pages need two
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("name", TypeId::kTypeChar, 128, 0, false, true)};
+  const TableSchema table_schema(columns);
+  auto *key_schema = Schema::ShallowCopySchema(&table_schema, {0});
+  alignas(8) char key_buf[KeyManager::MAX_KEY_SIZE];
+  char compact_buf[SlottedBPlusTree::MAX_KEY_SIZE];
+  KeyManager processor(key_schema, KeyManager::EncodedKeySize(key_schema));
+  SlottedBPlusTree tree(0, engine.bpm_);
+  const int n = 20000;
+  std::vector<int> ids;
+  for (int i = 0; i < n; i++) {
+    ids.push_back(i);
+  }
+  ShuffleArray(ids);
+  auto encode = [&](int id) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "user%08d", id);
+    processor.SerializeFromKey(reinterpret_cast<GenericKey *>(key_buf), CharRow(buf), key_schema);
+    return std::string(compact_buf, processor.ToCompactKey(reinterpret_cast<GenericKey *>(key_buf), compact_buf));
+  };
+  for (int id : ids) {
+    ASSERT_TRUE(tree.Insert(encode(id), RowId(id)));
+  }
+  ASSERT_EQ(2, tree.GetHeight());
+  std::vector<RowId> result;
+  for (int id = 0; id < n; id++) {
+    ASSERT_TRUE(tree.GetValue(encode(id), result));
+  }
+  result.clear();
+  std::string lower = encode(100);
+  std::string upper = encode(n - 100);
+  std::string_view lower_key = lower;
+  std::string_view upper_key = upper;
+  tree.ScanRange(&lower_key, true, &upper_key, false, result);
+  ASSERT_EQ(n - 200, result.size());
+  for (int i = 0; i < n - 200; i++) {
+    ASSERT_EQ(RowId(100 + i).Get(), result[i].Get());
+  }
+  ASSERT_TRUE(tree.Check());
+}
+
+TEST(BPlusTreeTests, SlottedKeyBulkLoadTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("city", TypeId::kTypeChar, 64, 0, true, false),
+                                   new Column("zip", TypeId::kTypeInt, 1, true, false)};
+  const TableSchema table_schema(columns);
+  auto *key_schema = Schema::ShallowCopySchema(&table_schema, {0});
+  SlottedBPlusTreeIndex index(0, key_schema, engine.bpm_, false);
+  // A non-unique index built in bulk from shuffled keys with many repeats keeps every row id
+  const int n = 30000;
+  std::vector<std::string> keys;
+  char buf[32];
+  for (int i = 0; i < n; i++) {
+    snprintf(buf, sizeof(buf), "city-%d", i % 3000);
+    keys.emplace_back(buf);
+  }
+  ShuffleArray(keys);
+  std::multimap<std::string, RowId> kv_map;
+  for (size_t i = 0; i < keys.size(); i++) {
+    kv_map.emplace(keys[i], RowId(i));
+  }
+  size_t pos = 0;
+  ASSERT_EQ(DB_SUCCESS, index.BulkLoad({[&](Row &key, RowId &row_id) {
+                                         if (pos == keys.size()) {
+                                           return false;
+                                         }
+                                         std::vector<Field> fields{
+                                             Field(TypeId::kTypeChar, const_cast<char *>(keys[pos].data()),
+                                                   keys[pos].size(), true),
+                                             Field(TypeId::kTypeInt, 0)};
+                                         Row(fields).GetKeyFromRow(&table_schema, key_schema, key);
+                                         row_id = RowId(pos++);
+                                         return true;
+                                       }},
+                                       nullptr));
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  // Inserts and removes work on the bulk loaded pages
+  for (int i = 0; i < 1000; i++) {
+    snprintf(buf, sizeof(buf), "city-%d", i * 7);
+    ASSERT_EQ(DB_SUCCESS, index.InsertEntry(CharRow(buf), RowId(n + i), nullptr));
+    kv_map.emplace(buf, RowId(n + i));
+  }
+  for (size_t i = 0; i < keys.size(); i += 5) {
+    ASSERT_EQ(DB_SUCCESS, index.RemoveEntry(CharRow(keys[i]), RowId(i), nullptr));
+    auto range = kv_map.equal_range(keys[i]);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second.Get() == RowId(i).Get()) {
+        kv_map.erase(it);
+        break;
+      }
+    }
+  }
+  // Row ids were added in increasing order, so the map lists those of a key in row id order like the index
+  CheckScans(index, kv_map, {"", "city-0", "city-1", keys[0], keys[n / 2], "city-2999", "city-3", "d"});
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+}
+
+TEST(BPlusTreeTests, SlottedKeyMergeTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("name", TypeId::kTypeChar, 32, 0, false, true)};
+  const TableSchema table_schema(columns);
+  auto *key_schema = Schema::ShallowCopySchema(&table_schema, {0});
+  SlottedBPlusTreeIndex index(0, key_schema, engine.bpm_, false);
+  // Two rows per key, keys with zero bytes at both ends of the order
+  const int n = 10000;
+  std::vector<std::string> keys;
+  char buf[32];
+  for (int i = 0; i < n; i++) {
+    snprintf(buf, sizeof(buf), "item-%05d", i);
+    keys.emplace_back(buf);
+  }
+  keys.emplace_back("\0a", 2);
+  keys.emplace_back("item-99999\0", 11);
+  std::multimap<std::string, RowId> kv_map;
+  for (size_t i = 0; i < keys.size(); i++) {
+    for (uint32_t j = 0; j < 2; j++) {
+      ASSERT_EQ(DB_SUCCESS, index.InsertEntry(CharRow(keys[i]), RowId(i, j), nullptr));
+      kv_map.emplace(keys[i], RowId(i, j));
+    }
+  }
+  // MIN and MAX decode the compact keys back into rows
+  Row min_key(INVALID_ROWID);
+  std::vector<RowId> result;
+  ASSERT_EQ(DB_SUCCESS, index.ScanExtreme(false, min_key, result, nullptr));
+  ASSERT_EQ(CmpBool::kTrue, min_key.GetField(0)->CompareEquals(
+                                Field(TypeId::kTypeChar, const_cast<char *>(keys[n].data()), keys[n].size(), true)));
+  ASSERT_EQ(2, result.size());
+  Row max_key(INVALID_ROWID);
+  result.clear();
+  ASSERT_EQ(DB_SUCCESS, index.ScanExtreme(true, max_key, result, nullptr));
+  ASSERT_EQ(CmpBool::kTrue,
+            max_key.GetField(0)->CompareEquals(
+                Field(TypeId::kTypeChar, const_cast<char *>(keys[n + 1].data()), keys[n + 1].size(), true)));
+  // Removing the rows of most keys merges the pages; a batch lookup sees the rows that are left
+  for (int i = 0; i < n; i++) {
+    if (i % 50 != 0) {
+      ASSERT_EQ(DB_SUCCESS, index.RemoveEntry(CharRow(keys[i]), RowId(i, 0), nullptr));
+      ASSERT_EQ(DB_SUCCESS, index.RemoveEntry(CharRow(keys[i]), RowId(i, 1), nullptr));
+      kv_map.erase(keys[i]);
+    }
+  }
+  std::vector<Row> probes{CharRow(keys[100]), CharRow(keys[101]), CharRow(keys[0]), CharRow("item")};
+  std::vector<std::vector<RowId>> found;
+  ASSERT_EQ(DB_SUCCESS, index.ScanKeys(probes, found, nullptr));
+  ASSERT_EQ(2, found[0].size());
+  ASSERT_EQ(0, found[1].size());
+  ASSERT_EQ(2, found[2].size());
+  ASSERT_EQ(0, found[3].size());
+  CheckScans(index, kv_map, {"", keys[0], keys[50], keys[51], keys[n - 1], "item-5"});
+  // A reverse range returns keys and their rows in descending order
+  Row lower = CharRow(keys[1000]);
+  Row upper = CharRow(keys[n - 1000]);
+  {
+    auto iter = index.GetRangeIterator(&lower, false, &upper, true, true);
+    std::vector<RowId> batch;
+    result.clear();
+    while (iter.NextBatch(batch)) {
+      result.insert(result.end(), batch.begin(), batch.end());
+    }
+  }
+  std::vector<RowId> expected;
+  for (auto it = kv_map.rbegin(); it != kv_map.rend(); ++it) {
+    if (it->first > keys[1000] && it->first <= keys[n - 1000]) {
+      expected.push_back(it->second);
+    }
+  }
+  ASSERT_EQ(expected.size(), result.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    ASSERT_EQ(expected[i].Get(), result[i].Get());
+  }
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+}
+
+TEST(BPlusTreeTests, SlottedKeyConcurrentTest) {
+  DBStorageEngine engine(db_name);
+  SlottedBPlusTree tree(0, engine.bpm_);
+  const int num_writers = 4;
+  const int n = 40000;
+  // Keys of varying length so that splits cut pages at different entry counts
+  auto key_of = [](int i) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%0*d", 6 + i % 7, i);
+    return std::string(buf);
+  };
+  // Writers insert interleaved shuffled slices, then remove all keys not divisible by 4 so that pages merge, while
+  // readers keep scanning forwards and backwards: every scan must come out strictly ordered by key
+  std::atomic<bool> done{false};
+  std::atomic<int> unordered{0};
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 2; t++) {
+    readers.emplace_back([&, t] {
+      bool reverse = t == 1;
+      while (!done) {
+        std::vector<RowId> result;
+        tree.ScanRange(nullptr, false, nullptr, false, result, nullptr, reverse);
+        for (size_t i = 1; i < result.size(); i++) {
+          std::string prev = key_of(result[i - 1].Get());
+          if (reverse ? prev <= key_of(result[i].Get()) : prev >= key_of(result[i].Get())) {
+            unordered++;
+          }
+        }
+      }
+    });
+  }
+  std::vector<std::thread> writers;
+  for (int t = 0; t < num_writers; t++) {
+    writers.emplace_back([&, t] {
+      std::vector<int> slice;
+      for (int i = t; i < n; i += num_writers) {
+        slice.push_back(i);
+      }
+      ShuffleArray(slice);
+      for (int i : slice) {
+        tree.Insert(key_of(i), RowId(i));
+      }
+      for (int i : slice) {
+        if (i % 4 != 0) {
+          tree.Remove(key_of(i));
+        }
+      }
+    });
+  }
+  for (auto &writer : writers) {
+    writer.join();
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  ASSERT_EQ(0, unordered.load());
+  ASSERT_TRUE(tree.Check());
+  std::vector<RowId> result;
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(i % 4 == 0, tree.GetValue(key_of(i), result));
+  }
+  result.clear();
+  tree.ScanRange(nullptr, false, nullptr, false, result);
+  ASSERT_EQ(n / 4, result.size());
+}
@@ -3,8 +3,12 @@
 #include "common/instance.h"
 #include "gtest/gtest.h"
 #include "page/table_page.h"
+#include "planner/expressions/column_value_expression.h"
+#include "planner/expressions/comparison_expression.h"
+#include "planner/expressions/constant_value_expression.h"
 #include "record/field.h"
 #include "record/row.h"
+#include "record/row_view.h"
 #include "record/schema.h"
 
 char *chars[] = {const_cast<char *>(""), const_cast<char *>("hello"), const_cast<char *>("world!"),
@@ -101,3 +105,126 @@ TEST(TupleTest, RowTest) {
   ASSERT_TRUE(table_page.MarkDelete(row.GetRowId(), nullptr, nullptr, nullptr));
   table_page.ApplyDelete(row.GetRowId(), nullptr, nullptr);
 }
+
+TEST(TupleTest, RowViewTest) {
+  TablePage table_page;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 2, true, false),
+                                   new Column("note", TypeId::kTypeChar, 16, 3, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  table_page.Init(0, INVALID_PAGE_ID, nullptr, nullptr);
+  std::vector<std::vector<Field>> rows_fields;
+  for (int i = 0; i < 3; i++) {
+    rows_fields.push_back({Field(TypeId::kTypeInt, 100 + i),
+                           Field(TypeId::kTypeChar, chars[i + 1], strlen(chars[i + 1]), false),
+                           Field(TypeId::kTypeFloat, 1.5f * i), Field(TypeId::kTypeChar)});
+    Row row(rows_fields.back());
+    ASSERT_TRUE(table_page.InsertTuple(row, schema.get(), nullptr, nullptr, nullptr));
+  }
+  // The middle field is null in the second row.
+  std::vector<Field> with_null = {Field(TypeId::kTypeInt, 7), Field(TypeId::kTypeChar),
+                                  Field(TypeId::kTypeFloat, -2.5f), Field(TypeId::kTypeChar, chars[1], 5, false)};
+  Row null_row(with_null);
+  ASSERT_TRUE(table_page.InsertTuple(null_row, schema.get(), nullptr, nullptr, nullptr));
+
+  Row stored(null_row.GetRowId());
+  ASSERT_TRUE(table_page.GetTuple(&stored, schema.get(), nullptr, nullptr));
+  char buf[PAGE_SIZE];
+  uint32_t size = stored.SerializeTo(buf, schema.get());
+  RowView view(buf, schema.get(), null_row.GetRowId());
+  EXPECT_EQ(size, view.GetSerializedSize());
+  EXPECT_EQ(null_row.GetRowId(), view.GetRowId());
+  ASSERT_EQ(4, view.GetFieldCount());
+  EXPECT_EQ(7, view.GetInt(0));
+  EXPECT_TRUE(view.IsNull(1));
+  EXPECT_TRUE(view.GetField(1).IsNull());
+  EXPECT_FLOAT_EQ(-2.5f, view.GetFloat(2));
+  uint32_t len;
+  const char *data = view.GetChars(3, &len);
+  EXPECT_EQ(5, len);
+  EXPECT_EQ(0, memcmp("hello", data, len));
+  // Char fields point into the viewed buffer instead of copying it.
+  EXPECT_GE(view.GetField(3).GetData(), buf);
+  EXPECT_LT(view.GetField(3).GetData(), buf + size);
+  for (uint32_t i = 0; i < 4; i++) {
+    if (!with_null[i].IsNull()) {
+      EXPECT_EQ(CmpBool::kTrue, view.GetField(i).CompareEquals(with_null[i]));
+    }
+  }
+  Row materialized(INVALID_ROWID);
+  EXPECT_EQ(size, view.Materialize(&materialized));
+  EXPECT_EQ(null_row.GetRowId(), materialized.GetRowId());
+  EXPECT_EQ(CmpBool::kTrue, materialized.GetField(3)->CompareEquals(with_null[3]));
+
+  // A predicate gives the same answer on the view as on the row, and filters tuples before they are deserialized.
+  auto predicate = std::make_shared<ComparisonExpression>(
+      std::make_shared<ColumnValueExpression>(0, 0, TypeId::kTypeInt),
+      std::make_shared<ConstantValueExpression>(Field(TypeId::kTypeInt, 101)), ">=");
+  EXPECT_EQ(CmpBool::kFalse, predicate->Evaluate(view).CompareEquals(Field(TypeId::kTypeInt, 1)));
+  EXPECT_EQ(CmpBool::kFalse, predicate->Evaluate(&stored).CompareEquals(Field(TypeId::kTypeInt, 1)));
+  std::vector<Row> matched;
+  EXPECT_EQ(2, table_page.GetTuples(&matched, schema.get(), [&predicate](const RowView &row) {
+    return predicate->Evaluate(row).CompareEquals(Field(TypeId::kTypeInt, 1)) == CmpBool::kTrue;
+  }));
+  ASSERT_EQ(2, matched.size());
+  for (int i = 0; i < 2; i++) {
+    for (uint32_t j = 0; j < 3; j++) {
+      EXPECT_EQ(CmpBool::kTrue, matched[i].GetField(j)->CompareEquals(rows_fields[i + 1][j]));
+    }
+    EXPECT_TRUE(matched[i].GetField(3)->IsNull());
+  }
+  std::vector<Row> all;
+  EXPECT_EQ(4, table_page.GetTuples(&all, schema.get()));
+}
+
+TEST(TupleTest, ArenaRowTest) {
+  ArenaMemHeap arena(1024);
+  // Allocations are aligned, never null, and large requests get a chunk of their own.
+  for (size_t size : {0, 1, 7, 24, 100}) {
+    void *ptr = arena.Allocate(size);
+    ASSERT_NE(nullptr, ptr);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(ptr) % alignof(std::max_align_t));
+  }
+  EXPECT_EQ(1, arena.GetChunkCount());
+  memset(arena.Allocate(4096), 0, 4096);
+  EXPECT_EQ(2, arena.GetChunkCount());
+  arena.Reset();
+  EXPECT_EQ(1, arena.GetChunkCount());
+  EXPECT_EQ(0, arena.GetAllocatedBytes());
+
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 2, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  std::vector<Field> fields = {Field(TypeId::kTypeInt, 188), Field(TypeId::kTypeChar, chars[2], 6, true),
+                               Field(TypeId::kTypeFloat)};
+  char buf[PAGE_SIZE];
+  Row(fields).SerializeTo(buf, schema.get());
+
+  // Rows sharing the arena allocate from it; copies and moved rows keep their values.
+  std::vector<Row> rows;
+  for (int i = 0; i < 100; i++) {
+    rows.emplace_back(RowId(0, i), &arena);
+    rows.back().DeserializeFrom(buf, schema.get());
+  }
+  EXPECT_LT(0, arena.GetAllocatedBytes());
+  Row moved(std::move(rows[99]));
+  Row copy(rows[50]);
+  for (Row *row : {&moved, &copy}) {
+    ASSERT_EQ(3, row->GetFieldCount());
+    for (uint32_t i = 0; i < 2; i++) {
+      EXPECT_EQ(CmpBool::kTrue, row->GetField(i)->CompareEquals(fields[i]));
+    }
+    EXPECT_TRUE(row->GetField(2)->IsNull());
+  }
+  EXPECT_EQ(RowId(0, 99), moved.GetRowId());
+  EXPECT_EQ(0, rows[99].GetFieldCount());
+
+  // The owned copy does not depend on the arena.
+  rows.clear();
+  arena.Reset();
+  memset(arena.Allocate(1000), 0xff, 1000);
+  EXPECT_EQ(CmpBool::kTrue, copy.GetField(1)->CompareEquals(fields[1]));
+  EXPECT_EQ(CmpBool::kTrue, Row(copy, &arena).GetField(1)->CompareEquals(fields[1]));
+}
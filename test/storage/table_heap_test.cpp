@@ -1,6 +1,7 @@
 #include "storage/table_heap.h"
 
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "common/instance.h"
@@ -60,3 +61,270 @@ TEST(TableHeapTest, TableHeapSampleTest) {
   }
   ASSERT_EQ(size, 0);
 }
+
+TEST(TableHeapTest, SequentialScanTest) {
+  // A pool much smaller than the table, so that the scan relies on read-ahead and the bulk-read ring.
+  const std::string scan_db_file_name = "table_heap_scan_test.db";
+  remove(scan_db_file_name.c_str());
+  auto disk_mgr_ = new DiskManager(scan_db_file_name);
+  auto bpm_ = new ParallelBufferPoolManager(4, 16, disk_mgr_, ReplacerType::LRU_K);
+  const int row_nums = 2000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+  char characters[64];
+  for (int i = 0; i < row_nums; i++) {
+    RandomUtils::RandomString(characters, 64);
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, 64, true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  }
+
+  for (bool use_ring : {false, true}) {
+    BufferRing ring(4, 4);
+    std::vector<bool> seen(row_nums, false);
+    int count = 0;
+    for (auto itr = table_heap->Begin(nullptr, use_ring ? &ring : nullptr); itr != table_heap->End(); itr++) {
+      char buf[sizeof(int32_t)];
+      itr->GetField(0)->SerializeTo(buf);
+      int id = MACH_READ_INT32(buf);
+      ASSERT_TRUE(id >= 0 && id < row_nums);
+      EXPECT_FALSE(seen[id]);
+      seen[id] = true;
+      count++;
+    }
+    EXPECT_EQ(row_nums, count);
+    EXPECT_TRUE(bpm_->CheckAllUnpinned());
+  }
+
+  delete table_heap;
+  delete bpm_;
+  delete disk_mgr_;
+  remove(scan_db_file_name.c_str());
+}
+
+TEST(TableHeapTest, FreeSpaceMapTest) {
+  const std::string fsm_db_file_name = "table_heap_fsm_test.db";
+  remove(fsm_db_file_name.c_str());
+  auto disk_mgr_ = new DiskManager(fsm_db_file_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  const int row_nums = 1000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+  char characters[64];
+  memset(characters, 'x', sizeof(characters));
+  std::vector<RowId> rids;
+  std::unordered_set<page_id_t> pages;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, 64, true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    rids.push_back(row.GetRowId());
+    pages.insert(row.GetRowId().GetPageId());
+  }
+  ASSERT_GT(pages.size(), 2);
+
+  // Scenario: space freed on the first page is reused before the table grows.
+  page_id_t first_page_id = table_heap->GetFirstPageId();
+  int freed = 0;
+  for (auto &rid : rids) {
+    if (rid.GetPageId() == first_page_id && freed < 5) {
+      ASSERT_TRUE(table_heap->MarkDelete(rid, nullptr));
+      table_heap->ApplyDelete(rid, nullptr);
+      freed++;
+    }
+  }
+  ASSERT_EQ(5, freed);
+  int inserted = 0;
+  int reused = 0;
+  while (true) {
+    Fields fields{Field(TypeId::kTypeInt, row_nums + inserted), Field(TypeId::kTypeChar, characters, 64, true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    inserted++;
+    if (pages.count(row.GetRowId().GetPageId()) == 0)
+      break;
+    reused += row.GetRowId().GetPageId() == first_page_id;
+  }
+  EXPECT_EQ(freed, reused);
+
+  // Scenario: a heap reopened from its stored map keeps filling existing pages and appends at the real tail.
+  page_id_t fsm_page_id = table_heap->GetFreeSpaceMapPageId();
+  ASSERT_NE(INVALID_PAGE_ID, fsm_page_id);
+  delete table_heap;
+  table_heap = TableHeap::Create(bpm_, first_page_id, fsm_page_id, schema.get(), nullptr, nullptr);
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, row_nums + inserted + i), Field(TypeId::kTypeChar, characters, 64, true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  }
+  int count = 0;
+  for (auto itr = table_heap->Begin(nullptr); itr != table_heap->End(); itr++) {
+    count++;
+  }
+  EXPECT_EQ(2 * row_nums + inserted - freed, count);
+  EXPECT_TRUE(bpm_->CheckAllUnpinned());
+
+  delete table_heap;
+  delete bpm_;
+  delete disk_mgr_;
+  remove(fsm_db_file_name.c_str());
+}
+
+TEST(TableHeapTest, BulkInsertTest) {
+  const std::string bulk_db_file_name = "table_heap_bulk_test.db";
+  remove(bulk_db_file_name.c_str());
+  auto disk_mgr_ = new DiskManager(bulk_db_file_name);
+  // A pool much smaller than the table: pages must be released as soon as they are filled.
+  auto bpm_ = new BufferPoolManager(16, disk_mgr_);
+  const int row_nums = 5000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+  char characters[64];
+  RandomUtils::RandomString(characters, 64);
+  {
+    Fields fields{Field(TypeId::kTypeInt, -1), Field(TypeId::kTypeChar, characters, 10, true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  }
+
+  std::vector<Row> rows;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, i % 64, true)};
+    rows.emplace_back(fields);
+  }
+  ASSERT_TRUE(table_heap->InsertTuples(rows, nullptr));
+  EXPECT_TRUE(bpm_->CheckAllUnpinned());
+
+  // Every row got its own rid and can be read back from it.
+  std::unordered_set<int64_t> rids;
+  for (int i = 0; i < row_nums; i++) {
+    ASSERT_TRUE(rids.insert(rows[i].GetRowId().Get()).second);
+    Row row(rows[i].GetRowId());
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+    EXPECT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, i)));
+    EXPECT_EQ(CmpBool::kTrue, row.GetField(1)->CompareEquals(*rows[i].GetField(1)));
+  }
+
+  // The new pages are part of the page chain, after the rows inserted before them.
+  int count = 0;
+  for (auto itr = table_heap->Begin(nullptr); itr != table_heap->End(); itr++) {
+    char buf[sizeof(int32_t)];
+    itr->GetField(0)->SerializeTo(buf);
+    EXPECT_EQ(count - 1, MACH_READ_INT32(buf));
+    count++;
+  }
+  EXPECT_EQ(row_nums + 1, count);
+
+  // An empty batch is a no-op.
+  std::vector<Row> empty;
+  EXPECT_TRUE(table_heap->InsertTuples(empty, nullptr));
+  count = 0;
+  for (auto itr = table_heap->Begin(nullptr); itr != table_heap->End(); itr++) {
+    count++;
+  }
+  EXPECT_EQ(row_nums + 1, count);
+
+  delete table_heap;
+  delete bpm_;
+  delete disk_mgr_;
+  remove(bulk_db_file_name.c_str());
+}
+
+TEST(TableHeapTest, BatchScanTest) {
+  const std::string batch_db_file_name = "table_heap_batch_test.db";
+  remove(batch_db_file_name.c_str());
+  auto disk_mgr_ = new DiskManager(batch_db_file_name);
+  auto bpm_ = new BufferPoolManager(16, disk_mgr_);
+  const int row_nums = 3000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+  char characters[64];
+  RandomUtils::RandomString(characters, 64);
+  std::vector<Row> rows;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, i % 64, true)};
+    rows.emplace_back(fields);
+  }
+  ASSERT_TRUE(table_heap->InsertTuples(rows, nullptr));
+
+  // Delete every row of the second page and every third row elsewhere.
+  page_id_t emptied_page_id = INVALID_PAGE_ID;
+  for (auto &row : rows) {
+    if (row.GetRowId().GetPageId() != rows[0].GetRowId().GetPageId()) {
+      emptied_page_id = row.GetRowId().GetPageId();
+      break;
+    }
+  }
+  ASSERT_NE(INVALID_PAGE_ID, emptied_page_id);
+  std::unordered_set<int32_t> expected;
+  for (int i = 0; i < row_nums; i++) {
+    if (rows[i].GetRowId().GetPageId() == emptied_page_id || i % 3 == 0) {
+      ASSERT_TRUE(table_heap->MarkDelete(rows[i].GetRowId(), nullptr));
+      table_heap->ApplyDelete(rows[i].GetRowId(), nullptr);
+    } else {
+      expected.insert(i);
+    }
+  }
+
+  // Both scans return every live row exactly once, in page order, and leave nothing pinned.
+  BufferRing ring = BufferRing::ForBulkRead(bpm_->GetPoolSize());
+  for (BufferRing *scan_ring : {static_cast<BufferRing *>(nullptr), &ring}) {
+    auto itr = table_heap->BeginBatch(nullptr, scan_ring);
+    std::unordered_set<int32_t> seen;
+    std::vector<Row> batch;
+    int prev = -1;
+    while (itr.NextBatch(batch)) {
+      ASSERT_FALSE(batch.empty());
+      for (auto &row : batch) {
+        EXPECT_NE(emptied_page_id, row.GetRowId().GetPageId());
+        char buf[sizeof(int32_t)];
+        row.GetField(0)->SerializeTo(buf);
+        int32_t id = MACH_READ_INT32(buf);
+        EXPECT_LT(prev, id);
+        prev = id;
+        EXPECT_TRUE(seen.insert(id).second);
+        EXPECT_EQ(CmpBool::kTrue, row.GetField(1)->CompareEquals(*rows[id].GetField(1)));
+      }
+    }
+    EXPECT_TRUE(itr.IsEnd());
+    EXPECT_TRUE(batch.empty());
+    EXPECT_FALSE(itr.NextBatch(batch));
+    EXPECT_EQ(expected, seen);
+    EXPECT_TRUE(bpm_->CheckAllUnpinned());
+  }
+
+  // Partitions cover the live rows exactly once between them, each in page order.
+  auto partitions = table_heap->BeginPartitions(nullptr, 4);
+  ASSERT_EQ(4, partitions.size());
+  std::unordered_set<int32_t> seen;
+  for (auto &partition : partitions) {
+    std::vector<Row> batch;
+    int prev = -1;
+    while (partition.NextBatch(batch)) {
+      for (auto &row : batch) {
+        char buf[sizeof(int32_t)];
+        row.GetField(0)->SerializeTo(buf);
+        int32_t id = MACH_READ_INT32(buf);
+        EXPECT_LT(prev, id);
+        prev = id;
+        EXPECT_TRUE(seen.insert(id).second);
+      }
+    }
+    EXPECT_TRUE(partition.IsEnd());
+  }
+  EXPECT_EQ(expected, seen);
+  EXPECT_TRUE(bpm_->CheckAllUnpinned());
+
+  delete table_heap;
+  delete bpm_;
+  delete disk_mgr_;
+  remove(batch_db_file_name.c_str());
+}